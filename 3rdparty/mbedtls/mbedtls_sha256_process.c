@@ -0,0 +1,296 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/cpuid.h>
+#include <openenclave/internal/crypto/sha.h>
+#include <string.h>
+#include "mbedtls/include/mbedtls/platform_util.h"
+#include "mbedtls/include/mbedtls/sha256.h"
+
+/*
+ * MBEDTLS links this function definition when MBEDTLS_SHA256_PROCESS_ALT is
+ * defined in the MBEDTLS config.h file. It processes a block with the SHA
+ * extensions of the CPU when the CPU has them, and with portable code
+ * otherwise, so SHA-256, and HMAC-SHA256 on top of it, use the CPU.
+ */
+int mbedtls_internal_sha256_process(
+    mbedtls_sha256_context* ctx,
+    const unsigned char data[64]);
+
+static const uint32_t _k[64] __attribute__((aligned(16))) = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define S0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define S1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define G0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define G1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+static void _process_portable(uint32_t state[8], const unsigned char data[64])
+{
+    uint32_t w[64];
+    uint32_t s[8];
+    size_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        w[i] = (uint32_t)data[4 * i] << 24 | (uint32_t)data[4 * i + 1] << 16 |
+               (uint32_t)data[4 * i + 2] << 8 | (uint32_t)data[4 * i + 3];
+    }
+
+    for (; i < 64; i++)
+        w[i] = G1(w[i - 2]) + w[i - 7] + G0(w[i - 15]) + w[i - 16];
+
+    memcpy(s, state, sizeof(s));
+
+    for (i = 0; i < 64; i++)
+    {
+        uint32_t t1 = s[7] + S1(s[4]) + CH(s[4], s[5], s[6]) + _k[i] + w[i];
+        uint32_t t2 = S0(s[0]) + MAJ(s[0], s[1], s[2]);
+
+        s[7] = s[6];
+        s[6] = s[5];
+        s[5] = s[4];
+        s[4] = s[3] + t1;
+        s[3] = s[2];
+        s[2] = s[1];
+        s[1] = s[0];
+        s[0] = t1 + t2;
+    }
+
+    for (i = 0; i < 8; i++)
+        state[i] += s[i];
+
+    mbedtls_platform_zeroize(w, sizeof(w));
+    mbedtls_platform_zeroize(s, sizeof(s));
+}
+
+#if defined(__x86_64__)
+
+/* Byte order of the message words, for pshufb */
+static const uint8_t _byte_swap_mask[16] __attribute__((aligned(16))) =
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+
+/*
+ * The registers of the SHA extensions kernel:
+ *     xmm0: message words plus round constants (implicit operand of
+ *           sha256rnds2)
+ *     xmm1, xmm2: the ABEF and CDGH state words
+ *     xmm3 - xmm6: the message schedule, 4 words each
+ *     xmm7: temporary
+ *     xmm8: the byte swap mask
+ *     xmm9, xmm10: the state on entry
+ */
+
+/* Load and byte swap 4 message words */
+#define LOAD_MSG(offset, msg)                      \
+    "movdqu " #offset "(%[data]), " msg "\n\t" \
+    "pshufb %%xmm8, " msg "\n\t"
+
+/* 4 rounds with the message words in msg */
+#define ROUNDS(msg, offset)                        \
+    "movdqa " msg ", %%xmm0\n\t"                   \
+    "paddd " #offset "(%[k]), %%xmm0\n\t"          \
+    "sha256rnds2 %%xmm0, %%xmm1, %%xmm2\n\t"       \
+    "pshufd $0x0e, %%xmm0, %%xmm0\n\t"             \
+    "sha256rnds2 %%xmm0, %%xmm2, %%xmm1\n\t"
+
+/* Finish the computation of the message words in next */
+#define SCHEDULE(next, cur, prev)                  \
+    "movdqa " cur ", %%xmm7\n\t"                   \
+    "palignr $4, " prev ", %%xmm7\n\t"             \
+    "paddd %%xmm7, " next "\n\t"                   \
+    "sha256msg2 " cur ", " next "\n\t"
+
+/* Start the computation of the message words in msg */
+#define SCHEDULE1(msg, next) "sha256msg1 " next ", " msg "\n\t"
+
+#define M0 "%%xmm3"
+#define M1 "%%xmm4"
+#define M2 "%%xmm5"
+#define M3 "%%xmm6"
+
+static void _process_sha_ni(uint32_t state[8], const unsigned char data[64])
+{
+    __asm__ volatile(
+        // Load the state as ABEF and CDGH.
+        "movdqu (%[state]), %%xmm7\n\t"
+        "movdqu 16(%[state]), %%xmm2\n\t"
+        "pshufd $0xb1, %%xmm7, %%xmm7\n\t"
+        "pshufd $0x1b, %%xmm2, %%xmm2\n\t"
+        "movdqa %%xmm7, %%xmm1\n\t"
+        "palignr $8, %%xmm2, %%xmm1\n\t"
+        "pblendw $0xf0, %%xmm7, %%xmm2\n\t"
+        "movdqa %%xmm1, %%xmm9\n\t"
+        "movdqa %%xmm2, %%xmm10\n\t"
+        "movdqa (%[mask]), %%xmm8\n\t"
+
+        // Rounds 0 to 15, on the message words.
+        LOAD_MSG(0, M0)
+        ROUNDS(M0, 0)
+        LOAD_MSG(16, M1)
+        ROUNDS(M1, 16)
+        SCHEDULE1(M0, M1)
+        LOAD_MSG(32, M2)
+        ROUNDS(M2, 32)
+        SCHEDULE1(M1, M2)
+        LOAD_MSG(48, M3)
+        ROUNDS(M3, 48)
+        SCHEDULE(M0, M3, M2)
+        SCHEDULE1(M2, M3)
+
+        // Rounds 16 to 63, on the scheduled words.
+        ROUNDS(M0, 64)
+        SCHEDULE(M1, M0, M3)
+        SCHEDULE1(M3, M0)
+        ROUNDS(M1, 80)
+        SCHEDULE(M2, M1, M0)
+        SCHEDULE1(M0, M1)
+        ROUNDS(M2, 96)
+        SCHEDULE(M3, M2, M1)
+        SCHEDULE1(M1, M2)
+        ROUNDS(M3, 112)
+        SCHEDULE(M0, M3, M2)
+        SCHEDULE1(M2, M3)
+        ROUNDS(M0, 128)
+        SCHEDULE(M1, M0, M3)
+        SCHEDULE1(M3, M0)
+        ROUNDS(M1, 144)
+        SCHEDULE(M2, M1, M0)
+        SCHEDULE1(M0, M1)
+        ROUNDS(M2, 160)
+        SCHEDULE(M3, M2, M1)
+        SCHEDULE1(M1, M2)
+        ROUNDS(M3, 176)
+        SCHEDULE(M0, M3, M2)
+        SCHEDULE1(M2, M3)
+        ROUNDS(M0, 192)
+        SCHEDULE(M1, M0, M3)
+        SCHEDULE1(M3, M0)
+        ROUNDS(M1, 208)
+        SCHEDULE(M2, M1, M0)
+        ROUNDS(M2, 224)
+        SCHEDULE(M3, M2, M1)
+        ROUNDS(M3, 240)
+
+        // Add the state on entry, and store the state back as ABCD and
+        // EFGH.
+        "paddd %%xmm9, %%xmm1\n\t"
+        "paddd %%xmm10, %%xmm2\n\t"
+        "pshufd $0x1b, %%xmm1, %%xmm7\n\t"
+        "pshufd $0xb1, %%xmm2, %%xmm2\n\t"
+        "movdqa %%xmm7, %%xmm1\n\t"
+        "pblendw $0xf0, %%xmm2, %%xmm1\n\t"
+        "palignr $8, %%xmm7, %%xmm2\n\t"
+        "movdqu %%xmm1, (%[state])\n\t"
+        "movdqu %%xmm2, 16(%[state])\n\t"
+        // Clear the message words.
+        "pxor %%xmm0, %%xmm0\n\t"
+        "pxor %%xmm3, %%xmm3\n\t"
+        "pxor %%xmm4, %%xmm4\n\t"
+        "pxor %%xmm5, %%xmm5\n\t"
+        "pxor %%xmm6, %%xmm6\n\t"
+        "pxor %%xmm7, %%xmm7\n\t"
+        :
+        : [state] "r"(state),
+          [data] "r"(data),
+          [k] "r"(_k),
+          [mask] "r"(_byte_swap_mask)
+        : "memory",
+          "cc",
+          "xmm0",
+          "xmm1",
+          "xmm2",
+          "xmm3",
+          "xmm4",
+          "xmm5",
+          "xmm6",
+          "xmm7",
+          "xmm8",
+          "xmm9",
+          "xmm10");
+}
+
+/* Whether to use the SHA extensions: 1 if so, -1 if not, 0 if not known yet */
+static volatile int _use_sha_ni;
+
+static int _has_sha_ni(void)
+{
+    uint32_t leaf1[OE_CPUID_REG_COUNT];
+    uint32_t leaf7[OE_CPUID_REG_COUNT];
+
+    /* The CPUID values are not known until the enclave is initialized */
+    if (oe_get_cpuid_leaf(1, 0, leaf1) != 0 ||
+        oe_get_cpuid_leaf(7, 0, leaf7) != 0)
+        return 0;
+
+    if ((leaf1[OE_CPUID_RCX] & OE_CPUID_SSSE3_FEATURE) &&
+        (leaf1[OE_CPUID_RCX] & OE_CPUID_SSE4_1_FEATURE) &&
+        (leaf7[OE_CPUID_RBX] & OE_CPUID_SHA_FEATURE))
+        return 1;
+
+    return -1;
+}
+
+bool oe_sha256_use_cpu_extensions(bool enable)
+{
+    if (!enable)
+    {
+        _use_sha_ni = -1;
+        return false;
+    }
+
+    _use_sha_ni = _has_sha_ni();
+    return _use_sha_ni > 0;
+}
+
+#else /* !defined(__x86_64__) */
+
+bool oe_sha256_use_cpu_extensions(bool enable)
+{
+    OE_UNUSED(enable);
+    return false;
+}
+
+#endif /* defined(__x86_64__) */
+
+int mbedtls_internal_sha256_process(
+    mbedtls_sha256_context* ctx,
+    const unsigned char data[64])
+{
+#if defined(__x86_64__)
+    if (_use_sha_ni == 0)
+        _use_sha_ni = _has_sha_ni();
+
+    if (_use_sha_ni > 0)
+    {
+        _process_sha_ni(ctx->state, data);
+        return 0;
+    }
+#endif
+
+    _process_portable(ctx->state, data);
+    return 0;
+}
+
+#if !defined(MBEDTLS_DEPRECATED_REMOVED)
+void mbedtls_sha256_process(
+    mbedtls_sha256_context* ctx,
+    const unsigned char data[64])
+{
+    mbedtls_internal_sha256_process(ctx, data);
+}
+#endif
@@ -238,6 +238,398 @@ done:
     return result;
 }
 
+// Add size rounded up to OE_CLAIMS_BUFFER_ALIGNMENT to *total.
+static oe_result_t _add_aligned_size(size_t size, size_t* total)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(oe_safe_add_sizet(size, OE_CLAIMS_BUFFER_ALIGNMENT - 1, &size));
+    size &= ~((size_t)OE_CLAIMS_BUFFER_ALIGNMENT - 1);
+    OE_CHECK(oe_safe_add_sizet(*total, size, total));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_add_claim_buffer_size(
+    size_t name_size,
+    size_t value_size,
+    size_t* size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_add_aligned_size(name_size, size));
+    OE_CHECK(_add_aligned_size(value_size, size));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_copy_claim_to_buffer(
+    oe_claim_t* claim,
+    const char* name,
+    size_t name_size,
+    const void* value,
+    size_t value_size,
+    uint8_t** data)
+{
+    claim->name = (char*)*data;
+    memcpy(claim->name, name, name_size);
+    *data += oe_round_up_to_multiple(name_size, OE_CLAIMS_BUFFER_ALIGNMENT);
+
+    claim->value = *data;
+    claim->value_size = value_size;
+    if (value_size)
+        memcpy(claim->value, value, value_size);
+    *data += oe_round_up_to_multiple(value_size, OE_CLAIMS_BUFFER_ALIGNMENT);
+}
+
+// Copy claims allocated by a plugin to a claims buffer.
+static oe_result_t _copy_claims_to_buffer(
+    const oe_claim_t* claims,
+    size_t claims_length,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
+    oe_claim_t** claims_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t size = 0;
+    uint8_t* data = NULL;
+
+    OE_CHECK(oe_safe_mul_sizet(claims_length, sizeof(*claims), &size));
+
+    for (size_t i = 0; i < claims_length; i++)
+        OE_CHECK(oe_add_claim_buffer_size(
+            oe_strlen(claims[i].name) + 1, claims[i].value_size, &size));
+
+    if (*claims_buffer_size < size)
+    {
+        *claims_buffer_size = size;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    *claims_out = (oe_claim_t*)claims_buffer;
+    data = (uint8_t*)claims_buffer + claims_length * sizeof(*claims);
+
+    for (size_t i = 0; i < claims_length; i++)
+        oe_copy_claim_to_buffer(
+            &(*claims_out)[i],
+            claims[i].name,
+            oe_strlen(claims[i].name) + 1,
+            claims[i].value,
+            claims[i].value_size,
+            &data);
+
+    *claims_buffer_size = size;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_verify_evidence_with_claims_buffer(
+    const uint8_t* evidence_buffer,
+    size_t evidence_buffer_size,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
+    oe_claim_t** claims,
+    size_t* claims_length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_plugin_list_node_t* plugin_node;
+    oe_verifier_t* verifier = NULL;
+    oe_attestation_header_t* evidence =
+        (oe_attestation_header_t*)evidence_buffer;
+    oe_attestation_header_t* endorsements =
+        (oe_attestation_header_t*)endorsements_buffer;
+    oe_claim_t* plugin_claims = NULL;
+    size_t plugin_claims_length = 0;
+
+    if (!evidence_buffer || evidence_buffer_size < sizeof(*evidence) ||
+        (endorsements_buffer &&
+         endorsements_buffer_size < sizeof(*endorsements)) ||
+        !claims_buffer_size || (*claims_buffer_size && !claims_buffer) ||
+        (uintptr_t)claims_buffer % OE_CLAIMS_BUFFER_ALIGNMENT || !claims ||
+        !claims_length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    plugin_node = oe_attest_find_plugin(verifiers, &evidence->format_id, NULL);
+    if (plugin_node == NULL)
+        OE_RAISE(OE_NOT_FOUND);
+
+    if (endorsements && memcmp(
+                            &evidence->format_id,
+                            &endorsements->format_id,
+                            sizeof(evidence->format_id)) != 0)
+        OE_RAISE(OE_CONSTRAINT_FAILED);
+
+    verifier = (oe_verifier_t*)plugin_node->plugin;
+
+    if (verifier->verify_evidence_with_claims_buffer)
+    {
+        OE_CHECK_NO_TRACE(verifier->verify_evidence_with_claims_buffer(
+            verifier,
+            evidence->data,
+            evidence->data_size,
+            endorsements ? endorsements->data : NULL,
+            endorsements ? endorsements->data_size : 0,
+            policies,
+            policies_size,
+            claims_buffer,
+            claims_buffer_size,
+            &plugin_claims,
+            &plugin_claims_length));
+
+        if (!_check_claims(plugin_claims, plugin_claims_length))
+            OE_RAISE(OE_CONSTRAINT_FAILED);
+
+        *claims = plugin_claims;
+        *claims_length = plugin_claims_length;
+        plugin_claims = NULL;
+    }
+    else
+    {
+        OE_CHECK(verifier->verify_evidence(
+            verifier,
+            evidence->data,
+            evidence->data_size,
+            endorsements ? endorsements->data : NULL,
+            endorsements ? endorsements->data_size : 0,
+            policies,
+            policies_size,
+            &plugin_claims,
+            &plugin_claims_length));
+
+        if (!_check_claims(plugin_claims, plugin_claims_length))
+            OE_RAISE(OE_CONSTRAINT_FAILED);
+
+        OE_CHECK_NO_TRACE(_copy_claims_to_buffer(
+            plugin_claims,
+            plugin_claims_length,
+            claims_buffer,
+            claims_buffer_size,
+            claims));
+        *claims_length = plugin_claims_length;
+    }
+
+    result = OE_OK;
+
+done:
+    // The claims of the fallback path are allocated by the plugin.
+    if (plugin_claims && !verifier->verify_evidence_with_claims_buffer)
+        verifier->free_claims(verifier, plugin_claims, plugin_claims_length);
+
+    return result;
+}
+
+// Verify the evidence of the given plugin in a batch, or one at a time if the
+// plugin does not support batches.
+static void _verify_plugin_evidence_batch(
+    oe_verifier_t* verifier,
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const oe_attestation_header_t* endorsements,
+    const oe_policy_t* policies,
+    size_t policies_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (verifier->verify_evidence_batch)
+    {
+        result = verifier->verify_evidence_batch(
+            verifier,
+            items,
+            items_length,
+            endorsements ? endorsements->data : NULL,
+            endorsements ? endorsements->data_size : 0,
+            policies,
+            policies_size);
+
+        // The plugin could not verify the batch at all.
+        if (result != OE_OK)
+        {
+            for (size_t i = 0; i < items_length; i++)
+            {
+                if (items[i].claims)
+                    verifier->free_claims(
+                        verifier, items[i].claims, items[i].claims_length);
+
+                items[i].result = result;
+                items[i].claims = NULL;
+                items[i].claims_length = 0;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < items_length; i++)
+        {
+            items[i].result = verifier->verify_evidence(
+                verifier,
+                items[i].evidence_buffer,
+                items[i].evidence_buffer_size,
+                endorsements ? endorsements->data : NULL,
+                endorsements ? endorsements->data_size : 0,
+                policies,
+                policies_size,
+                &items[i].claims,
+                &items[i].claims_length);
+        }
+    }
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        if (items[i].result == OE_OK &&
+            !_check_claims(items[i].claims, items[i].claims_length))
+        {
+            verifier->free_claims(
+                verifier, items[i].claims, items[i].claims_length);
+            items[i].result = OE_CONSTRAINT_FAILED;
+        }
+
+        if (items[i].result != OE_OK)
+        {
+            items[i].claims = NULL;
+            items[i].claims_length = 0;
+        }
+    }
+}
+
+oe_result_t oe_verify_evidence_batch(
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_attestation_header_t* endorsements =
+        (oe_attestation_header_t*)endorsements_buffer;
+    oe_verifier_t** item_verifiers = NULL;
+    oe_evidence_batch_item_t* plugin_items = NULL;
+    size_t* plugin_item_indexes = NULL;
+    size_t size;
+
+    if (!items || !items_length ||
+        (endorsements_buffer &&
+         endorsements_buffer_size < sizeof(*endorsements)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*item_verifiers), &size));
+    if (!(item_verifiers = (oe_verifier_t**)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*plugin_items), &size));
+    if (!(plugin_items = (oe_evidence_batch_item_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(
+        oe_safe_mul_sizet(items_length, sizeof(*plugin_item_indexes), &size));
+    if (!(plugin_item_indexes = (size_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // Find the plugin of each piece of evidence.
+    for (size_t i = 0; i < items_length; i++)
+    {
+        oe_attestation_header_t* evidence =
+            (oe_attestation_header_t*)items[i].evidence_buffer;
+        oe_plugin_list_node_t* plugin_node;
+
+        item_verifiers[i] = NULL;
+        items[i].claims = NULL;
+        items[i].claims_length = 0;
+
+        if (!evidence || items[i].evidence_buffer_size < sizeof(*evidence))
+        {
+            items[i].result = OE_INVALID_PARAMETER;
+            continue;
+        }
+
+        plugin_node =
+            oe_attest_find_plugin(verifiers, &evidence->format_id, NULL);
+        if (plugin_node == NULL)
+        {
+            items[i].result = OE_NOT_FOUND;
+            continue;
+        }
+
+        if (endorsements && memcmp(
+                                &evidence->format_id,
+                                &endorsements->format_id,
+                                sizeof(evidence->format_id)) != 0)
+        {
+            items[i].result = OE_CONSTRAINT_FAILED;
+            continue;
+        }
+
+        item_verifiers[i] = (oe_verifier_t*)plugin_node->plugin;
+    }
+
+    // Verify the evidence of each plugin together.
+    for (size_t i = 0; i < items_length; i++)
+    {
+        oe_verifier_t* verifier = item_verifiers[i];
+        size_t count = 0;
+
+        if (!verifier)
+            continue;
+
+        for (size_t j = i; j < items_length; j++)
+        {
+            oe_attestation_header_t* evidence;
+
+            if (item_verifiers[j] != verifier)
+                continue;
+
+            evidence = (oe_attestation_header_t*)items[j].evidence_buffer;
+            plugin_items[count].evidence_buffer = evidence->data;
+            plugin_items[count].evidence_buffer_size = evidence->data_size;
+            plugin_items[count].result = OE_UNEXPECTED;
+            plugin_items[count].claims = NULL;
+            plugin_items[count].claims_length = 0;
+            plugin_item_indexes[count++] = j;
+            item_verifiers[j] = NULL;
+        }
+
+        _verify_plugin_evidence_batch(
+            verifier,
+            plugin_items,
+            count,
+            endorsements,
+            policies,
+            policies_size);
+
+        for (size_t j = 0; j < count; j++)
+        {
+            oe_evidence_batch_item_t* item = &items[plugin_item_indexes[j]];
+
+            item->result = plugin_items[j].result;
+            item->claims = plugin_items[j].claims;
+            item->claims_length = plugin_items[j].claims_length;
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    oe_free(plugin_item_indexes);
+    oe_free(plugin_items);
+    oe_free(item_verifiers);
+    return result;
+}
+
 static oe_result_t _get_uuid(
     const oe_claim_t* claims,
     size_t claims_length,
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "collateral.h"
+#include <openenclave/attestation/sgx/report.h>
 #include <openenclave/bits/attestation.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/crypto/cert.h>
@@ -20,6 +21,13 @@
 #include <openenclave/internal/utils.h>
 #include "../common.h"
 #include "tcbinfo.h"
+#include "truststore.h"
+
+#ifndef OE_BUILD_ENCLAVE
+#include "../../host/hostthread.h"
+typedef oe_mutex oe_mutex_t;
+#define OE_MUTEX_INITIALIZER OE_H_MUTEX_INITIALIZER
+#endif
 
 // Defaults to Intel SGX 1.8 Release Date.
 oe_datetime_t _sgx_minimim_crl_tcb_issue_date = {2017, 3, 17};
@@ -38,6 +46,9 @@ oe_result_t __oe_sgx_set_minimum_crl_tcb_issue_date(
     OE_CHECK(oe_datetime_is_valid(&tmp));
     _sgx_minimim_crl_tcb_issue_date = tmp;
 
+    // Quotes verified before may no longer be accepted.
+    oe_sgx_invalidate_verified_quote_cache();
+
     result = OE_OK;
 done:
     return result;
@@ -55,7 +66,7 @@ static oe_result_t _get_tcb_info_validity(
 }
 
 static oe_result_t _get_crl_validity(
-    const oe_crl_t* crls,
+    const oe_crl_t* const* crls,
     const uint32_t crls_count,
     oe_datetime_t* from,
     oe_datetime_t* until)
@@ -67,7 +78,7 @@ static oe_result_t _get_crl_validity(
     if (crls_count > 0)
     {
         OE_CHECK_MSG(
-            oe_crl_get_update_dates(&crls[0], from, until),
+            oe_crl_get_update_dates(crls[0], from, until),
             "Failed to get CRL update dates. %s",
             oe_result_str(result));
 
@@ -75,7 +86,7 @@ static oe_result_t _get_crl_validity(
         {
             OE_CHECK_MSG(
                 oe_crl_get_update_dates(
-                    &crls[0], &crl_this_update_date, &crl_next_update_date),
+                    crls[0], &crl_this_update_date, &crl_next_update_date),
                 "Failed to get CRL update dates. %s",
                 oe_result_str(result));
 
@@ -98,7 +109,7 @@ done:
 
 static oe_result_t _get_revocation_validity(
     const oe_parsed_tcb_info_t* parsed_tcb_info,
-    const oe_crl_t* crls,
+    const oe_crl_t* const* crls,
     const uint32_t crls_count,
     oe_datetime_t* from,
     oe_datetime_t* until)
@@ -182,8 +193,367 @@ typedef struct _url
     char str[256];
 } url_t;
 
+/*
+**==============================================================================
+**
+** The collateral cache:
+**
+**     The TCB info, QE identity and CRLs of a platform are issued per FMSPC
+**     and PCK CA, and are replaced at most daily. The collateral fetched for
+**     a PCK certificate is therefore reused for all the quotes of platforms
+**     with the same FMSPC and PCK CA, until the earliest nextUpdate date
+**     among its parts. The cache only saves fetching the collateral: quotes
+**     are verified against it as before.
+**
+**==============================================================================
+*/
+
+/* Maximum number of platforms whose collateral is cached */
+#define OE_SGX_COLLATERAL_CACHE_SIZE 16
+
+typedef enum _pck_ca_type
+{
+    PCK_CA_UNKNOWN,
+    PCK_CA_PROCESSOR,
+    PCK_CA_PLATFORM
+} pck_ca_type_t;
+
+typedef struct _collateral_cache_entry
+{
+    uint8_t fmspc[6];
+    pck_ca_type_t ca_type;
+    oe_datetime_t next_update;
+    uint64_t last_used;
+
+    /* All the parts are stored in collateral.host_out_buffer */
+    oe_get_sgx_quote_verification_collateral_args_t collateral;
+} collateral_cache_entry_t;
+
+static collateral_cache_entry_t _cache[OE_SGX_COLLATERAL_CACHE_SIZE];
+static size_t _cache_size;
+static uint64_t _cache_clock;
+static oe_sgx_collateral_cache_stats_t _cache_stats;
+static oe_mutex_t _cache_mutex = OE_MUTEX_INITIALIZER;
+
+/**
+ * Get the type of the CA that issued the PCK certificate from the URL of its
+ * CRL, which ends with "ca=processor" or "ca=platform".
+ */
+static pck_ca_type_t _get_pck_ca_type(const oe_cert_t* leaf_cert)
+{
+    pck_ca_type_t ca_type = PCK_CA_UNKNOWN;
+    char** urls = NULL;
+    size_t num_urls = 0;
+    uint8_t* buffer = NULL;
+    size_t buffer_size = 0;
+
+    if (oe_get_crl_distribution_points(
+            leaf_cert, &urls, &num_urls, NULL, &buffer_size) !=
+        OE_BUFFER_TOO_SMALL)
+        goto done;
+
+    if (!(buffer = (uint8_t*)oe_malloc(buffer_size)))
+        goto done;
+
+    if (oe_get_crl_distribution_points(
+            leaf_cert, &urls, &num_urls, buffer, &buffer_size) != OE_OK ||
+        num_urls == 0)
+        goto done;
+
+    if (oe_strstr(urls[0], "ca=processor"))
+        ca_type = PCK_CA_PROCESSOR;
+    else if (oe_strstr(urls[0], "ca=platform"))
+        ca_type = PCK_CA_PLATFORM;
+
+done:
+    oe_free(buffer);
+    return ca_type;
+}
+
+/**
+ * Copy the collateral into a single allocation owned by
+ * copy->host_out_buffer, which oe_free_sgx_quote_verification_collateral_args()
+ * releases.
+ */
+static oe_result_t _copy_collateral(
+    const oe_get_sgx_quote_verification_collateral_args_t* collateral,
+    oe_get_sgx_quote_verification_collateral_args_t* copy)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    struct
+    {
+        uint8_t* const* src;
+        size_t size;
+        uint8_t** dest;
+    } parts[] = {
+        {&collateral->tcb_info, collateral->tcb_info_size, &copy->tcb_info},
+        {&collateral->tcb_info_issuer_chain,
+         collateral->tcb_info_issuer_chain_size,
+         &copy->tcb_info_issuer_chain},
+        {&collateral->pck_crl, collateral->pck_crl_size, &copy->pck_crl},
+        {&collateral->pck_crl_issuer_chain,
+         collateral->pck_crl_issuer_chain_size,
+         &copy->pck_crl_issuer_chain},
+        {&collateral->root_ca_crl,
+         collateral->root_ca_crl_size,
+         &copy->root_ca_crl},
+        {&collateral->qe_identity,
+         collateral->qe_identity_size,
+         &copy->qe_identity},
+        {&collateral->qe_identity_issuer_chain,
+         collateral->qe_identity_issuer_chain_size,
+         &copy->qe_identity_issuer_chain},
+    };
+    size_t size = 0;
+    uint8_t* buffer = NULL;
+    uint8_t* p;
+
+    for (size_t i = 0; i < OE_COUNTOF(parts); i++)
+        OE_CHECK(oe_safe_add_sizet(size, parts[i].size, &size));
+
+    if (!(buffer = (uint8_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memset(copy, 0, sizeof(*copy));
+    memcpy(copy->fmspc, collateral->fmspc, sizeof(copy->fmspc));
+    copy->tcb_info_size = collateral->tcb_info_size;
+    copy->tcb_info_issuer_chain_size = collateral->tcb_info_issuer_chain_size;
+    copy->pck_crl_size = collateral->pck_crl_size;
+    copy->pck_crl_issuer_chain_size = collateral->pck_crl_issuer_chain_size;
+    copy->root_ca_crl_size = collateral->root_ca_crl_size;
+    copy->qe_identity_size = collateral->qe_identity_size;
+    copy->qe_identity_issuer_chain_size =
+        collateral->qe_identity_issuer_chain_size;
+
+    p = buffer;
+    for (size_t i = 0; i < OE_COUNTOF(parts); i++)
+    {
+        memcpy(p, *parts[i].src, parts[i].size);
+        *parts[i].dest = p;
+        p += parts[i].size;
+    }
+
+    copy->host_out_buffer = buffer;
+    buffer = NULL;
+    result = OE_OK;
+
+done:
+    oe_free(buffer);
+    return result;
+}
+
+/**
+ * Get the earliest nextUpdate date of the TCB info, the QE identity and the
+ * CRLs of the collateral.
+ */
+static oe_result_t _get_collateral_next_update(
+    const oe_get_sgx_quote_verification_collateral_args_t* collateral,
+    const ParsedExtensionInfo* parsed_extension_info,
+    oe_datetime_t* next_update)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_tcb_info_tcb_level_t platform_tcb_level = {{0}};
+    oe_parsed_tcb_info_t parsed_tcb_info = {0};
+    oe_qe_identity_info_tcb_level_t qe_tcb_level = {{0}};
+    oe_parsed_qe_identity_info_t parsed_qe_identity = {0};
+    const uint8_t* crls[] = {collateral->pck_crl, collateral->root_ca_crl};
+    const size_t crl_sizes[] = {collateral->pck_crl_size,
+                                collateral->root_ca_crl_size};
+    oe_crl_t* crl = NULL;
+    oe_datetime_t until;
+
+    // The nextUpdate date is read before the TCB level of the platform is
+    // checked, so the date is valid when the platform is not up to date.
+    for (uint32_t i = 0; i < OE_COUNTOF(platform_tcb_level.sgx_tcb_comp_svn);
+         ++i)
+    {
+        platform_tcb_level.sgx_tcb_comp_svn[i] =
+            parsed_extension_info->comp_svn[i];
+    }
+    platform_tcb_level.pce_svn = parsed_extension_info->pce_svn;
+
+    result = oe_parse_tcb_info_json(
+        collateral->tcb_info,
+        collateral->tcb_info_size,
+        &platform_tcb_level,
+        &parsed_tcb_info);
+    if (result != OE_OK && result != OE_TCB_LEVEL_INVALID)
+        OE_RAISE_MSG(result, "Failed to parse TCB info.", NULL);
+
+    *next_update = parsed_tcb_info.next_update;
+
+    // The ISV SVN of the QE is unknown here, match the latest TCB level.
+    qe_tcb_level.isvsvn[0] = OE_UINT32_MAX;
+
+    OE_CHECK_MSG(
+        oe_parse_qe_identity_info_json(
+            collateral->qe_identity,
+            collateral->qe_identity_size,
+            &qe_tcb_level,
+            &parsed_qe_identity),
+        "Failed to parse QE identity. %s",
+        oe_result_str(result));
+
+    if (oe_datetime_compare(&parsed_qe_identity.next_update, next_update) < 0)
+        *next_update = parsed_qe_identity.next_update;
+
+    for (size_t i = 0; i < OE_COUNTOF(crls); i++)
+    {
+        OE_CHECK_MSG(
+            oe_sgx_trust_store_get_crl(crls[i], crl_sizes[i], &crl),
+            "Failed to read CRL. %s",
+            oe_result_str(result));
+        result = oe_crl_get_update_dates(crl, NULL, &until);
+        oe_sgx_trust_store_release_crl(crl);
+        OE_CHECK_MSG(
+            result, "Failed to get CRL update dates. %s", oe_result_str(result));
+
+        if (oe_datetime_compare(&until, next_update) < 0)
+            *next_update = until;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Remove the entry at the given index, with _cache_mutex held */
+static void _remove_cache_entry(size_t index)
+{
+    oe_free_sgx_quote_verification_collateral_args(&_cache[index].collateral);
+    _cache[index] = _cache[--_cache_size];
+    memset(&_cache[_cache_size], 0, sizeof(_cache[_cache_size]));
+}
+
+/**
+ * Copy the cached collateral of the given platform, if any and not expired,
+ * into the collateral arguments.
+ */
+static bool _find_cached_collateral(
+    const uint8_t fmspc[6],
+    pck_ca_type_t ca_type,
+    const oe_datetime_t* now,
+    oe_get_sgx_quote_verification_collateral_args_t* collateral)
+{
+    bool found = false;
+
+    oe_mutex_lock(&_cache_mutex);
+
+    for (size_t i = 0; i < _cache_size; i++)
+    {
+        collateral_cache_entry_t* entry = &_cache[i];
+
+        if (entry->ca_type != ca_type ||
+            memcmp(entry->fmspc, fmspc, sizeof(entry->fmspc)) != 0)
+            continue;
+
+        if (oe_datetime_compare(now, &entry->next_update) >= 0)
+        {
+            _remove_cache_entry(i);
+            _cache_stats.expirations++;
+        }
+        else if (_copy_collateral(&entry->collateral, collateral) == OE_OK)
+        {
+            entry->last_used = ++_cache_clock;
+            found = true;
+        }
+
+        break;
+    }
+
+    if (found)
+        _cache_stats.hits++;
+    else
+        _cache_stats.misses++;
+
+    oe_mutex_unlock(&_cache_mutex);
+
+    return found;
+}
+
+/**
+ * Store a copy of the collateral of the given platform, replacing the least
+ * recently used entry when the cache is full. Failing to store it is not an
+ * error.
+ */
+static void _cache_collateral(
+    const uint8_t fmspc[6],
+    pck_ca_type_t ca_type,
+    const oe_datetime_t* next_update,
+    const oe_get_sgx_quote_verification_collateral_args_t* collateral)
+{
+    oe_get_sgx_quote_verification_collateral_args_t copy;
+    collateral_cache_entry_t* entry = NULL;
+
+    if (_copy_collateral(collateral, &copy) != OE_OK)
+        return;
+
+    oe_mutex_lock(&_cache_mutex);
+
+    for (size_t i = 0; i < _cache_size; i++)
+    {
+        // Another thread may have fetched the same collateral.
+        if (_cache[i].ca_type == ca_type &&
+            memcmp(_cache[i].fmspc, fmspc, sizeof(_cache[i].fmspc)) == 0)
+        {
+            entry = &_cache[i];
+            break;
+        }
+
+        if (_cache_size == OE_SGX_COLLATERAL_CACHE_SIZE &&
+            (!entry || _cache[i].last_used < entry->last_used))
+            entry = &_cache[i];
+    }
+
+    if (entry)
+        oe_free_sgx_quote_verification_collateral_args(&entry->collateral);
+    else
+        entry = &_cache[_cache_size++];
+
+    memcpy(entry->fmspc, fmspc, sizeof(entry->fmspc));
+    entry->ca_type = ca_type;
+    entry->next_update = *next_update;
+    entry->last_used = ++_cache_clock;
+    entry->collateral = copy;
+
+    oe_mutex_unlock(&_cache_mutex);
+}
+
+oe_result_t oe_sgx_get_collateral_cache_stats(
+    oe_sgx_collateral_cache_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_cache_mutex);
+    *stats = _cache_stats;
+    stats->entries = _cache_size;
+    oe_mutex_unlock(&_cache_mutex);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_invalidate_collateral_cache(void)
+{
+    oe_mutex_lock(&_cache_mutex);
+
+    while (_cache_size)
+        _remove_cache_entry(_cache_size - 1);
+
+    oe_mutex_unlock(&_cache_mutex);
+
+    return OE_OK;
+}
+
 /**
- * Call into host to fetch collateral given the PCK certificate.
+ * Fetch the collateral given the PCK certificate, from the collateral cache
+ * or by calling into the host.
  */
 oe_result_t oe_get_sgx_quote_verification_collateral_from_certs(
     oe_cert_t* leaf_cert,
@@ -191,6 +561,9 @@ oe_result_t oe_get_sgx_quote_verification_collateral_from_certs(
 {
     oe_result_t result = OE_FAILURE;
     ParsedExtensionInfo parsed_extension_info = {{0}};
+    pck_ca_type_t ca_type;
+    oe_datetime_t now = {0};
+    oe_datetime_t next_update = {0};
 
     if (leaf_cert == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -203,8 +576,23 @@ oe_result_t oe_get_sgx_quote_verification_collateral_from_certs(
         parsed_extension_info.fmspc,
         sizeof(parsed_extension_info.fmspc)));
 
+    ca_type = _get_pck_ca_type(leaf_cert);
+    OE_CHECK(oe_datetime_now(&now));
+
+    if (_find_cached_collateral(args->fmspc, ca_type, &now, args))
+    {
+        result = OE_OK;
+        goto done;
+    }
+
     OE_CHECK(oe_get_sgx_quote_verification_collateral(args));
 
+    // Collateral that expired already is never reused.
+    if (_get_collateral_next_update(
+            args, &parsed_extension_info, &next_update) == OE_OK &&
+        oe_datetime_compare(&now, &next_update) < 0)
+        _cache_collateral(args->fmspc, ca_type, &next_update, args);
+
     result = OE_OK;
 done:
 
@@ -220,15 +608,14 @@ oe_result_t oe_validate_revocation_list(
     oe_result_t result = OE_UNEXPECTED;
 
     ParsedExtensionInfo parsed_extension_info = {{0}};
-    oe_cert_chain_t tcb_issuer_chain = {0};
-    oe_cert_chain_t crl_issuer_chain = {0};
+    oe_cert_chain_t* tcb_issuer_chain = NULL;
+    oe_cert_chain_t* crl_issuer_chain = NULL;
     oe_cert_t tcb_cert = {0};
     oe_parsed_tcb_info_t parsed_tcb_info = {0};
     oe_tcb_info_tcb_level_t platform_tcb_level = {{0}};
 
     uint32_t version = 0;
-    oe_crl_t crls[2] = {{{0}}};
-    const oe_crl_t* crl_ptrs[2] = {&crls[0], &crls[1]};
+    oe_crl_t* crls[2] = {NULL, NULL};
     oe_datetime_t from = {0};
     oe_datetime_t until = {0};
     oe_datetime_t latest_from = {0};
@@ -249,32 +636,32 @@ oe_result_t oe_validate_revocation_list(
 
     OE_STATIC_ASSERT(OE_COUNTOF(crls) >= OE_SGX_ENDORSEMENTS_CRL_COUNT);
 
-    OE_STATIC_ASSERT(OE_COUNTOF(crl_ptrs) >= OE_SGX_ENDORSEMENTS_CRL_COUNT);
-
     OE_CHECK_MSG(
         _parse_sgx_extensions(pck_cert, &parsed_extension_info),
         "Failed to parse SGX extensions from leaf cert. %s",
         oe_result_str(result));
 
+    // The issuer chains and CRLs are shared by all the quotes verified with
+    // the same collateral, they are only parsed and verified once.
     OE_CHECK_MSG(
-        oe_cert_chain_read_pem(
-            &tcb_issuer_chain,
+        oe_sgx_trust_store_get_cert_chain(
             sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_ISSUER_CHAIN]
                 .data,
             sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_TCB_ISSUER_CHAIN]
-                .size),
+                .size,
+            &tcb_issuer_chain),
         "Failed to read TCB chain certificate. %s",
         oe_result_str(result));
 
     OE_CHECK_MSG(
-        oe_cert_chain_read_pem(
-            &crl_issuer_chain,
+        oe_sgx_trust_store_get_cert_chain(
             sgx_endorsements
                 ->items[OE_SGX_ENDORSEMENT_FIELD_CRL_ISSUER_CHAIN_PCK_CERT]
                 .data,
             sgx_endorsements
                 ->items[OE_SGX_ENDORSEMENT_FIELD_CRL_ISSUER_CHAIN_PCK_CERT]
-                .size),
+                .size,
+            &crl_issuer_chain),
         "Failed to read CRL issuer cert chain. %s",
         oe_result_str(result));
 
@@ -289,14 +676,14 @@ oe_result_t oe_validate_revocation_list(
     for (uint32_t i = 0; i < OE_SGX_ENDORSEMENTS_CRL_COUNT; ++i)
     {
         OE_CHECK_MSG(
-            oe_crl_read_pem(
-                &crls[i],
+            oe_sgx_trust_store_get_crl(
                 sgx_endorsements
                     ->items[OE_SGX_ENDORSEMENT_FIELD_CRL_PCK_CERT + i]
                     .data,
                 sgx_endorsements
                     ->items[OE_SGX_ENDORSEMENT_FIELD_CRL_PCK_CERT + i]
-                    .size),
+                    .size,
+                &crls[i]),
             "Failed to read CRL. %s",
             oe_result_str(result));
     }
@@ -318,7 +705,10 @@ oe_result_t oe_validate_revocation_list(
     // for certificates in the chain.
     OE_CHECK_MSG(
         oe_cert_verify(
-            pck_cert, &crl_issuer_chain, crl_ptrs, OE_COUNTOF(crl_ptrs)),
+            pck_cert,
+            crl_issuer_chain,
+            (const oe_crl_t* const*)crls,
+            OE_COUNTOF(crls)),
         "Failed to verify leaf certificate. %s",
         oe_result_str(result));
 
@@ -367,14 +757,14 @@ oe_result_t oe_validate_revocation_list(
             parsed_tcb_info.tcb_info_start,
             parsed_tcb_info.tcb_info_size,
             (sgx_ecdsa256_signature_t*)parsed_tcb_info.signature,
-            &tcb_issuer_chain),
+            tcb_issuer_chain),
         "Failed to verify ECDSA 256 signature in TCB. %s",
         oe_result_str(result));
 
     OE_CHECK_MSG(
         _get_revocation_validity(
             &parsed_tcb_info,
-            crls,
+            (const oe_crl_t* const*)crls,
             OE_COUNTOF(crls),
             &latest_from,
             &earliest_until),
@@ -408,7 +798,7 @@ oe_result_t oe_validate_revocation_list(
 
     // Get TCB cert validity period.
     OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&tcb_issuer_chain, &tcb_cert),
+        oe_cert_chain_get_leaf_cert(tcb_issuer_chain, &tcb_cert),
         "Failed to get TCB certificate.",
         NULL);
     oe_cert_get_validity_dates(&tcb_cert, &from, &until);
@@ -435,10 +825,10 @@ oe_result_t oe_validate_revocation_list(
 done:
     for (int32_t i = (int32_t)OE_SGX_ENDORSEMENTS_CRL_COUNT - 1; i >= 0; --i)
     {
-        oe_crl_free(&crls[i]);
+        oe_sgx_trust_store_release_crl(crls[i]);
     }
-    oe_cert_chain_free(&tcb_issuer_chain);
-    oe_cert_chain_free(&crl_issuer_chain);
+    oe_sgx_trust_store_release_cert_chain(tcb_issuer_chain);
+    oe_sgx_trust_store_release_cert_chain(crl_issuer_chain);
     oe_cert_free(&tcb_cert);
 
     return result;
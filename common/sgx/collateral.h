@@ -35,7 +35,9 @@ oe_result_t oe_validate_revocation_list(
 
 /**
  * Fetch quote verification collateral from the quote provider given the PCK
- * certificate and CA certificate.
+ * certificate and CA certificate. Collateral fetched for the same platform
+ * FMSPC and PCK CA is reused until its earliest nextUpdate date, see
+ * oe_sgx_get_collateral_cache_stats().
  *
  * Caller is responsbile for freeing the quote verification collateral resources
  * by calling oe_free_sgx_quote_verification_collateral_args().
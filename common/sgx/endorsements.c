@@ -10,6 +10,7 @@
 
 #include "collateral.h"
 #include "quote.h"
+#include "truststore.h"
 
 #define CREATION_DATETIME_SIZE 21
 
@@ -338,7 +339,7 @@ oe_result_t oe_get_sgx_endorsements(
 
     const uint8_t* pem_pck_certificate = NULL;
     size_t pem_pck_certificate_size = 0;
-    oe_cert_chain_t pck_cert_chain = {0};
+    oe_cert_chain_t* issuer_chain = NULL;
     oe_cert_t leaf_cert = {0};
     oe_cert_t intermediate_cert = {0};
 
@@ -359,17 +360,14 @@ oe_result_t oe_get_sgx_endorsements(
             remote_report_size,
             &pem_pck_certificate,
             &pem_pck_certificate_size,
-            &pck_cert_chain),
+            &leaf_cert,
+            &issuer_chain),
         "Failed to get certificate chain from quote. %s",
         oe_result_str(result));
 
-    // Fetch leaf and intermediate certificates.
+    // Fetch the intermediate certificate.
     OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert),
-        "Failed to get leaf certificate. %s",
-        oe_result_str(result));
-    OE_CHECK_MSG(
-        oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
+        oe_cert_chain_get_cert(issuer_chain, 0, &intermediate_cert),
         "Failed to get intermediate certificate. %s",
         oe_result_str(result));
 
@@ -394,7 +392,7 @@ oe_result_t oe_get_sgx_endorsements(
 done:
     oe_cert_free(&leaf_cert);
     oe_cert_free(&intermediate_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    oe_sgx_trust_store_release_cert_chain(issuer_chain);
     oe_free_sgx_quote_verification_collateral_args(
         &quote_verification_collateral);
 
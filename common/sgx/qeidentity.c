@@ -7,6 +7,7 @@
 #include <openenclave/internal/utils.h>
 #include "../common.h"
 #include "tcbinfo.h"
+#include "truststore.h"
 
 extern oe_datetime_t _sgx_minimim_crl_tcb_issue_date;
 
@@ -31,7 +32,7 @@ oe_result_t oe_validate_qe_identity(
     oe_result_t result = OE_FAILURE;
     const uint8_t* pem_pck_certificate = NULL;
     size_t pem_pck_certificate_size = 0;
-    oe_cert_chain_t pck_cert_chain = {0};
+    oe_cert_chain_t* pck_cert_chain = NULL;
     oe_cert_t leaf_cert = {0};
     oe_parsed_qe_identity_info_t parsed_info = {0};
     oe_qe_identity_info_tcb_level_t platform_tcb_level = {{0}};
@@ -58,9 +59,9 @@ oe_result_t oe_validate_qe_identity(
         sgx_endorsements->items[OE_SGX_ENDORSEMENT_FIELD_QE_ID_ISSUER_CHAIN]
             .size;
 
-    // validate the cert chain.
-    OE_CHECK(oe_cert_chain_read_pem(
-        &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size));
+    // validate the cert chain, shared through the trust store.
+    OE_CHECK(oe_sgx_trust_store_get_cert_chain(
+        pem_pck_certificate, pem_pck_certificate_size, &pck_cert_chain));
 
     // Configure the platform isvsvn from the QE report.
     // The platform isvsvn is needed for matching tcb level
@@ -83,12 +84,12 @@ oe_result_t oe_validate_qe_identity(
         parsed_info.info_start,
         parsed_info.info_size,
         (sgx_ecdsa256_signature_t*)parsed_info.signature,
-        &pck_cert_chain));
+        pck_cert_chain));
     OE_TRACE_INFO("oe_verify_ecdsa256_signature succeeded\n");
 
     // Get leaf certificate
     OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert),
+        oe_cert_chain_get_leaf_cert(pck_cert_chain, &leaf_cert),
         "Failed to get leaf certificate. %s",
         oe_result_str(result));
     OE_CHECK_MSG(
@@ -209,8 +210,7 @@ oe_result_t oe_validate_qe_identity(
     result = OE_OK;
 
 done:
-    if (pck_cert_chain.impl[0] != 0)
-        oe_cert_chain_free(&pck_cert_chain);
+    oe_sgx_trust_store_release_cert_chain(pck_cert_chain);
     oe_cert_free(&leaf_cert);
 
     return result;
@@ -1,21 +1,32 @@
 // Copyright (c) Open Enclave SDK contributors.
 // Licensed under the MIT License.
 #include "quote.h"
+#include <openenclave/attestation/sgx/report.h>
 #include <openenclave/bits/sgx/sgxtypes.h>
 #include <openenclave/internal/crypto/cert.h>
 #include <openenclave/internal/crypto/ec.h>
 #include <openenclave/internal/crypto/sha.h>
 #include <openenclave/internal/datetime.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
 #include "collateral.h"
 #include "endorsements.h"
 #include "qeidentity.h"
+#include "truststore.h"
 
 #include <time.h>
 
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/internal/thread.h>
+#else
+#include "../../host/hostthread.h"
+typedef oe_mutex oe_mutex_t;
+#define OE_MUTEX_INITIALIZER OE_H_MUTEX_INITIALIZER
+#endif
+
 // Public key of Intel's root certificate.
 static const char* g_expected_root_certificate_key =
     "-----BEGIN PUBLIC KEY-----\n"
@@ -205,66 +216,42 @@ done:
     return result;
 }
 
-static oe_result_t oe_verify_quote_internal(
-    const uint8_t* quote,
-    size_t quote_size)
+/**
+ * Verify the PCK certificate chain of the quote up to the root of trust, and
+ * the signature of the QE report with the PCK certificate. These only depend
+ * on the platform and QE of the quote.
+ */
+static oe_result_t _verify_pck_chain_and_qe_report(
+    sgx_quote_auth_data_t* quote_auth_data,
+    const sgx_qe_cert_data_t* qe_cert_data)
 {
     oe_result_t result = OE_UNEXPECTED;
-    sgx_quote_t* sgx_quote = NULL;
-    sgx_quote_auth_data_t* quote_auth_data = NULL;
-    sgx_qe_auth_data_t qe_auth_data = {0};
-    sgx_qe_cert_data_t qe_cert_data = {0};
-    oe_cert_chain_t pck_cert_chain = {0};
-    oe_sha256_context_t sha256_ctx = {0};
-    OE_SHA256 sha256 = {0};
-    oe_ec_public_key_t attestation_key = {0};
+    oe_cert_chain_t* issuer_chain = NULL;
     oe_cert_t leaf_cert = {0};
     oe_cert_t root_cert = {0};
-    oe_cert_t intermediate_cert = {0};
     oe_ec_public_key_t leaf_public_key = {0};
     oe_ec_public_key_t root_public_key = {0};
     oe_ec_public_key_t expected_root_public_key = {0};
     bool key_equal = false;
 
-    uint8_t* pem_pck_certificate = NULL;
-    size_t pem_pck_certificate_size = 0;
-
-    OE_CHECK_MSG(
-        _parse_quote(
-            quote,
-            quote_size,
-            &sgx_quote,
-            &quote_auth_data,
-            &qe_auth_data,
-            &qe_cert_data),
-        "Failed to parse quote. %s",
-        oe_result_str(result));
-
-    pem_pck_certificate = qe_cert_data.data;
-    pem_pck_certificate_size = qe_cert_data.size;
-
     // PckCertificate Chain validations.
     {
-        // Read and validate the chain.
+        // Read and validate the chain. Only the PCK certificate is parsed for
+        // each quote, its issuers are shared through the trust store.
         OE_CHECK_MSG(
-            oe_cert_chain_read_pem(
-                &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size),
+            oe_sgx_trust_store_read_pck_cert_chain(
+                qe_cert_data->data,
+                qe_cert_data->size,
+                &leaf_cert,
+                &issuer_chain),
             "Failed to parse certificate chain.",
             NULL);
 
-        // Fetch leaf and root certificates.
-        OE_CHECK_MSG(
-            oe_cert_chain_get_leaf_cert(&pck_cert_chain, &leaf_cert),
-            "Failed to get leaf certificate.",
-            NULL);
+        // Fetch the root certificate.
         OE_CHECK_MSG(
-            oe_cert_chain_get_root_cert(&pck_cert_chain, &root_cert),
+            oe_cert_chain_get_root_cert(issuer_chain, &root_cert),
             "Failed to get root certificate.",
             NULL);
-        OE_CHECK_MSG(
-            oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
-            "Failed to get intermediate certificate.",
-            NULL);
 
         // Get public keys.
         OE_CHECK_MSG(
@@ -296,60 +283,20 @@ static oe_result_t oe_verify_quote_internal(
                 NULL);
     }
 
-    // Quote validations.
-    {
-        // Verify SHA256 ECDSA (qe_report_body_signature, qe_report_body,
-        // PckCertificate.pub_key)
-        //
-        // Hash with PCK(QE report body) == QE report body signature
-        //
-        OE_CHECK_MSG(
-            _ecdsa_verify(
-                &leaf_public_key,
-                &quote_auth_data->qe_report_body,
-                sizeof(quote_auth_data->qe_report_body),
-                &quote_auth_data->qe_report_body_signature),
-            "QE report signature validation using PCK public key + SHA256 "
-            "ECDSA",
-            NULL);
-
-        // Assert SHA256 (attestation_key + qe_auth_data.data) ==
-        // qe_report_body.report_data[0..32]
-        OE_CHECK(oe_sha256_init(&sha256_ctx));
-        OE_CHECK(oe_sha256_update(
-            &sha256_ctx,
-            (const uint8_t*)&quote_auth_data->attestation_key,
-            sizeof(quote_auth_data->attestation_key)));
-        if (qe_auth_data.size > 0)
-            OE_CHECK(oe_sha256_update(
-                &sha256_ctx, qe_auth_data.data, qe_auth_data.size));
-        OE_CHECK(oe_sha256_final(&sha256_ctx, &sha256));
-
-        if (!oe_constant_time_mem_equal(
-                &sha256,
-                &quote_auth_data->qe_report_body.report_data,
-                sizeof(sha256)))
-            OE_RAISE_MSG(
-                OE_QUOTE_VERIFICATION_ERROR,
-                "QE authentication data signature verification failed.",
-                NULL);
-
-        // Verify SHA256 ECDSA (attestation_key, SGX_QUOTE_SIGNED_DATA,
-        // signature)
-        //
-        // Hash with attestation_key(sgx_quote) == quote_auth_data signature
-        //
-        OE_CHECK(_read_public_key(
-            &quote_auth_data->attestation_key, &attestation_key));
-        OE_CHECK_MSG(
-            _ecdsa_verify(
-                &attestation_key,
-                sgx_quote,
-                SGX_QUOTE_SIGNED_DATA_SIZE,
-                &quote_auth_data->signature),
-            "Report signature validation using attestation key + SHA256 ECDSA",
-            NULL);
-    }
+    // Verify SHA256 ECDSA (qe_report_body_signature, qe_report_body,
+    // PckCertificate.pub_key)
+    //
+    // Hash with PCK(QE report body) == QE report body signature
+    //
+    OE_CHECK_MSG(
+        _ecdsa_verify(
+            &leaf_public_key,
+            &quote_auth_data->qe_report_body,
+            sizeof(quote_auth_data->qe_report_body),
+            &quote_auth_data->qe_report_body_signature),
+        "QE report signature validation using PCK public key + SHA256 "
+        "ECDSA",
+        NULL);
 
     result = OE_OK;
 
@@ -357,11 +304,97 @@ done:
     oe_ec_public_key_free(&leaf_public_key);
     oe_ec_public_key_free(&root_public_key);
     oe_ec_public_key_free(&expected_root_public_key);
-    oe_ec_public_key_free(&attestation_key);
     oe_cert_free(&leaf_cert);
     oe_cert_free(&root_cert);
-    oe_cert_free(&intermediate_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    oe_sgx_trust_store_release_cert_chain(issuer_chain);
+    return result;
+}
+
+/**
+ * Verify that the attestation key is the one the QE report vouches for, and
+ * the signature of the quote with the attestation key.
+ */
+static oe_result_t _verify_quote_signature(
+    sgx_quote_t* sgx_quote,
+    sgx_quote_auth_data_t* quote_auth_data,
+    const sgx_qe_auth_data_t* qe_auth_data)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t sha256_ctx = {0};
+    OE_SHA256 sha256 = {0};
+    oe_ec_public_key_t attestation_key = {0};
+
+    // Assert SHA256 (attestation_key + qe_auth_data.data) ==
+    // qe_report_body.report_data[0..32]
+    OE_CHECK(oe_sha256_init(&sha256_ctx));
+    OE_CHECK(oe_sha256_update(
+        &sha256_ctx,
+        (const uint8_t*)&quote_auth_data->attestation_key,
+        sizeof(quote_auth_data->attestation_key)));
+    if (qe_auth_data->size > 0)
+        OE_CHECK(oe_sha256_update(
+            &sha256_ctx, qe_auth_data->data, qe_auth_data->size));
+    OE_CHECK(oe_sha256_final(&sha256_ctx, &sha256));
+
+    if (!oe_constant_time_mem_equal(
+            &sha256,
+            &quote_auth_data->qe_report_body.report_data,
+            sizeof(sha256)))
+        OE_RAISE_MSG(
+            OE_QUOTE_VERIFICATION_ERROR,
+            "QE authentication data signature verification failed.",
+            NULL);
+
+    // Verify SHA256 ECDSA (attestation_key, SGX_QUOTE_SIGNED_DATA,
+    // signature)
+    //
+    // Hash with attestation_key(sgx_quote) == quote_auth_data signature
+    //
+    OE_CHECK(
+        _read_public_key(&quote_auth_data->attestation_key, &attestation_key));
+    OE_CHECK_MSG(
+        _ecdsa_verify(
+            &attestation_key,
+            sgx_quote,
+            SGX_QUOTE_SIGNED_DATA_SIZE,
+            &quote_auth_data->signature),
+        "Report signature validation using attestation key + SHA256 ECDSA",
+        NULL);
+
+    result = OE_OK;
+
+done:
+    oe_ec_public_key_free(&attestation_key);
+    return result;
+}
+
+static oe_result_t oe_verify_quote_internal(
+    const uint8_t* quote,
+    size_t quote_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+
+    OE_CHECK_MSG(
+        _parse_quote(
+            quote,
+            quote_size,
+            &sgx_quote,
+            &quote_auth_data,
+            &qe_auth_data,
+            &qe_cert_data),
+        "Failed to parse quote. %s",
+        oe_result_str(result));
+
+    OE_CHECK(_verify_pck_chain_and_qe_report(quote_auth_data, &qe_cert_data));
+    OE_CHECK(_verify_quote_signature(sgx_quote, quote_auth_data, &qe_auth_data));
+
+    result = OE_OK;
+
+done:
     return result;
 }
 
@@ -370,7 +403,8 @@ oe_result_t oe_get_quote_cert_chain_internal(
     const size_t quote_size,
     const uint8_t** pem_pck_certificate,
     size_t* pem_pck_certificate_size,
-    oe_cert_chain_t* pck_cert_chain)
+    oe_cert_t* pck_cert,
+    oe_cert_chain_t** issuer_chain)
 {
     oe_result_t result = OE_UNEXPECTED;
     sgx_quote_t* sgx_quote = NULL;
@@ -378,7 +412,8 @@ oe_result_t oe_get_quote_cert_chain_internal(
     sgx_qe_auth_data_t qe_auth_data = {0};
     sgx_qe_cert_data_t qe_cert_data = {0};
 
-    if (quote == NULL || pem_pck_certificate == NULL || pck_cert_chain == NULL)
+    if (quote == NULL || pem_pck_certificate == NULL || pck_cert == NULL ||
+        issuer_chain == NULL)
     {
         OE_RAISE(OE_INVALID_PARAMETER);
     }
@@ -399,8 +434,11 @@ oe_result_t oe_get_quote_cert_chain_internal(
     *pem_pck_certificate_size = qe_cert_data.size;
 
     // Read and validate the chain.
-    OE_CHECK(oe_cert_chain_read_pem(
-        pck_cert_chain, *pem_pck_certificate, *pem_pck_certificate_size));
+    OE_CHECK(oe_sgx_trust_store_read_pck_cert_chain(
+        *pem_pck_certificate,
+        *pem_pck_certificate_size,
+        pck_cert,
+        issuer_chain));
 
     result = OE_OK;
 done:
@@ -425,6 +463,391 @@ static void _update_validity(
     }
 }
 
+static oe_result_t _get_quote_validity(
+    const uint8_t* quote,
+    const size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_datetime_t* valid_from,
+    oe_datetime_t* valid_until);
+
+/*
+**==============================================================================
+**
+** The verified quote cache:
+**
+**     Maps the digests of a quote and of its endorsements (other than their
+**     creation datetime) to the validity period computed when the quote was
+**     verified successfully against them. Entries expire at the end of that
+**     period. Entries are dense in _verified_quotes and chained per hash
+**     bucket; the least recently used entry is replaced once the cache is
+**     full.
+**
+**==============================================================================
+*/
+
+#define NO_VERIFIED_QUOTE OE_SIZE_MAX
+
+typedef struct _verified_quote_key
+{
+    OE_SHA256 quote_digest;
+    OE_SHA256 endorsements_digest;
+} verified_quote_key_t;
+
+typedef struct _verified_quote
+{
+    verified_quote_key_t key;
+    oe_datetime_t valid_from;
+    oe_datetime_t valid_until;
+    uint64_t last_used;
+
+    /* Index of the next entry of the same bucket */
+    size_t next;
+} verified_quote_t;
+
+static verified_quote_t* _verified_quotes;
+static size_t* _verified_quote_buckets;
+static size_t _num_verified_quote_buckets;
+static size_t _max_verified_quotes;
+static size_t _num_verified_quotes;
+static uint64_t _verified_quote_clock;
+static oe_sgx_verified_quote_cache_stats_t _verified_quote_stats;
+static oe_mutex_t _verified_quote_mutex = OE_MUTEX_INITIALIZER;
+
+static oe_result_t _update_endorsements_digest(
+    oe_sha256_context_t* context,
+    const oe_sgx_endorsements_t* sgx_endorsements)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    // The creation datetime only sets the default validation time.
+    for (uint32_t i = 0; i < OE_SGX_ENDORSEMENT_FIELD_CREATION_DATETIME; i++)
+    {
+        const oe_sgx_endorsement_item* item = &sgx_endorsements->items[i];
+
+        OE_CHECK(oe_sha256_update(context, &item->size, sizeof(item->size)));
+        OE_CHECK(oe_sha256_update(context, item->data, item->size));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _get_verified_quote_key(
+    const uint8_t* quote,
+    size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    verified_quote_key_t* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256(quote, quote_size, &key->quote_digest));
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(_update_endorsements_digest(&context, sgx_endorsements));
+    OE_CHECK(oe_sha256_final(&context, &key->endorsements_digest));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* The functions below are called with _verified_quote_mutex held */
+
+static size_t _get_verified_quote_bucket(const verified_quote_key_t* key)
+{
+    uint64_t hash;
+
+    memcpy(&hash, key->quote_digest.buf, sizeof(hash));
+    return (size_t)hash & (_num_verified_quote_buckets - 1);
+}
+
+static size_t _find_verified_quote_index(const verified_quote_key_t* key)
+{
+    size_t index = _verified_quote_buckets[_get_verified_quote_bucket(key)];
+
+    while (index != NO_VERIFIED_QUOTE &&
+           memcmp(&_verified_quotes[index].key, key, sizeof(*key)) != 0)
+        index = _verified_quotes[index].next;
+
+    return index;
+}
+
+/* Return the link to the entry at the given index in its bucket */
+static size_t* _get_verified_quote_link(size_t index)
+{
+    size_t* link = &_verified_quote_buckets[_get_verified_quote_bucket(
+        &_verified_quotes[index].key)];
+
+    while (*link != index)
+        link = &_verified_quotes[*link].next;
+
+    return link;
+}
+
+static void _remove_verified_quote(size_t index)
+{
+    size_t last = --_num_verified_quotes;
+
+    *_get_verified_quote_link(index) = _verified_quotes[index].next;
+
+    // Keep the entries dense by moving the last entry into the hole.
+    if (index != last)
+    {
+        *_get_verified_quote_link(last) = index;
+        _verified_quotes[index] = _verified_quotes[last];
+    }
+}
+
+static void _clear_verified_quotes(void)
+{
+    for (size_t i = 0; i < _num_verified_quote_buckets; i++)
+        _verified_quote_buckets[i] = NO_VERIFIED_QUOTE;
+
+    _num_verified_quotes = 0;
+}
+
+static bool _verified_quote_cache_enabled(void)
+{
+    bool enabled;
+
+    oe_mutex_lock(&_verified_quote_mutex);
+    enabled = _max_verified_quotes != 0;
+    oe_mutex_unlock(&_verified_quote_mutex);
+
+    return enabled;
+}
+
+/**
+ * Get the validity period of a verified quote, if cached and not expired.
+ * Only the lookups made to verify a quote update the hit and miss counters.
+ */
+static bool _find_verified_quote(
+    const verified_quote_key_t* key,
+    bool verifying,
+    oe_datetime_t* valid_from,
+    oe_datetime_t* valid_until)
+{
+    bool found = false;
+    oe_datetime_t now = {0};
+    size_t index;
+
+    if (oe_datetime_now(&now) != OE_OK)
+        return false;
+
+    oe_mutex_lock(&_verified_quote_mutex);
+
+    if (!_max_verified_quotes)
+        goto done;
+
+    if ((index = _find_verified_quote_index(key)) != NO_VERIFIED_QUOTE)
+    {
+        verified_quote_t* entry = &_verified_quotes[index];
+
+        if (oe_datetime_compare(&now, &entry->valid_until) > 0)
+        {
+            _remove_verified_quote(index);
+            _verified_quote_stats.expirations++;
+        }
+        else
+        {
+            *valid_from = entry->valid_from;
+            *valid_until = entry->valid_until;
+            entry->last_used = ++_verified_quote_clock;
+            found = true;
+        }
+    }
+
+    if (verifying)
+    {
+        if (found)
+            _verified_quote_stats.hits++;
+        else
+            _verified_quote_stats.misses++;
+    }
+
+done:
+    oe_mutex_unlock(&_verified_quote_mutex);
+
+    return found;
+}
+
+static void _cache_verified_quote(
+    const verified_quote_key_t* key,
+    const oe_datetime_t* valid_from,
+    const oe_datetime_t* valid_until)
+{
+    oe_datetime_t now = {0};
+    verified_quote_t* entry;
+    size_t bucket;
+
+    // A quote whose validity period ended already is never reused.
+    if (oe_datetime_now(&now) != OE_OK ||
+        oe_datetime_compare(&now, valid_until) > 0)
+        return;
+
+    oe_mutex_lock(&_verified_quote_mutex);
+
+    // Another thread may have verified the same quote, or the cache may
+    // have been disabled since the lookup.
+    if (!_max_verified_quotes ||
+        _find_verified_quote_index(key) != NO_VERIFIED_QUOTE)
+        goto done;
+
+    if (_num_verified_quotes == _max_verified_quotes)
+    {
+        size_t lru = 0;
+
+        for (size_t i = 1; i < _num_verified_quotes; i++)
+        {
+            if (_verified_quotes[i].last_used <
+                _verified_quotes[lru].last_used)
+                lru = i;
+        }
+
+        _remove_verified_quote(lru);
+    }
+
+    entry = &_verified_quotes[_num_verified_quotes];
+    entry->key = *key;
+    entry->valid_from = *valid_from;
+    entry->valid_until = *valid_until;
+    entry->last_used = ++_verified_quote_clock;
+
+    bucket = _get_verified_quote_bucket(key);
+    entry->next = _verified_quote_buckets[bucket];
+    _verified_quote_buckets[bucket] = _num_verified_quotes++;
+
+done:
+    oe_mutex_unlock(&_verified_quote_mutex);
+}
+
+oe_result_t oe_sgx_set_verified_quote_cache_size(size_t max_entries)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    verified_quote_t* entries = NULL;
+    size_t* buckets = NULL;
+    size_t num_buckets = 1;
+
+    if (max_entries > OE_SIZE_MAX / 4)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (max_entries)
+    {
+        // Keep the chains short with at least twice as many buckets.
+        while (num_buckets < max_entries * 2)
+            num_buckets *= 2;
+
+        entries =
+            (verified_quote_t*)oe_calloc(max_entries, sizeof(verified_quote_t));
+        buckets = (size_t*)oe_calloc(num_buckets, sizeof(size_t));
+
+        if (!entries || !buckets)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    oe_mutex_lock(&_verified_quote_mutex);
+    {
+        verified_quote_t* old_entries = _verified_quotes;
+        size_t* old_buckets = _verified_quote_buckets;
+
+        _verified_quotes = entries;
+        _verified_quote_buckets = buckets;
+        _num_verified_quote_buckets = max_entries ? num_buckets : 0;
+        _max_verified_quotes = max_entries;
+        _clear_verified_quotes();
+
+        entries = old_entries;
+        buckets = old_buckets;
+    }
+    oe_mutex_unlock(&_verified_quote_mutex);
+
+    result = OE_OK;
+
+done:
+    oe_free(entries);
+    oe_free(buckets);
+    return result;
+}
+
+oe_result_t oe_sgx_get_verified_quote_cache_stats(
+    oe_sgx_verified_quote_cache_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_verified_quote_mutex);
+    *stats = _verified_quote_stats;
+    stats->entries = _num_verified_quotes;
+    oe_mutex_unlock(&_verified_quote_mutex);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_invalidate_verified_quote_cache(void)
+{
+    oe_mutex_lock(&_verified_quote_mutex);
+    _clear_verified_quotes();
+    oe_mutex_unlock(&_verified_quote_mutex);
+
+    return OE_OK;
+}
+
+/**
+ * Verify the quote and get its validity period for the endorsements, or get
+ * them from the verified quote cache.
+ */
+static oe_result_t _verify_quote_validity(
+    const uint8_t* quote,
+    size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_datetime_t* valid_from,
+    oe_datetime_t* valid_until)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    verified_quote_key_t key = {{{0}}};
+    bool use_cache = _verified_quote_cache_enabled();
+
+    if (use_cache)
+    {
+        OE_CHECK(_get_verified_quote_key(
+            quote, quote_size, sgx_endorsements, &key));
+
+        if (_find_verified_quote(&key, true, valid_from, valid_until))
+        {
+            result = OE_OK;
+            goto done;
+        }
+    }
+
+    OE_CHECK_MSG(
+        oe_verify_quote_internal(quote, quote_size),
+        "Failed to verify remote quote.",
+        NULL);
+
+    OE_CHECK_MSG(
+        _get_quote_validity(
+            quote, quote_size, sgx_endorsements, valid_from, valid_until),
+        "Failed to validate quote. %s",
+        oe_result_str(result));
+
+    if (use_cache)
+        _cache_verified_quote(&key, valid_from, valid_until);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_verify_sgx_quote(
     const uint8_t* quote,
     size_t quote_size,
@@ -479,32 +902,18 @@ done:
     return result;
 }
 
-oe_result_t oe_verify_quote_with_sgx_endorsements(
-    const uint8_t* quote,
-    size_t quote_size,
+/**
+ * Check the validation time against the validity period of a verified quote.
+ */
+static oe_result_t _check_validation_time(
     const oe_sgx_endorsements_t* sgx_endorsements,
-    oe_datetime_t* input_validation_time)
+    const oe_datetime_t* input_validation_time,
+    const oe_datetime_t* validity_from,
+    const oe_datetime_t* validity_until)
 {
     oe_result_t result = OE_UNEXPECTED;
-    oe_datetime_t validity_from = {0};
-    oe_datetime_t validity_until = {0};
     oe_datetime_t validation_time = {0};
 
-    OE_CHECK_MSG(
-        oe_verify_quote_internal(quote, quote_size),
-        "Failed to verify remote quote.",
-        NULL);
-
-    OE_CHECK_MSG(
-        oe_get_sgx_quote_validity(
-            quote,
-            quote_size,
-            sgx_endorsements,
-            &validity_from,
-            &validity_until),
-        "Failed to validate quote. %s",
-        oe_result_str(result));
-
     // Verify quote/endorsements for the given time.  Use endorsements
     // creation time if one was not provided.
     if (input_validation_time == NULL)
@@ -529,16 +938,16 @@ oe_result_t oe_verify_quote_with_sgx_endorsements(
     }
 
     oe_datetime_log("Validation datetime: ", &validation_time);
-    if (oe_datetime_compare(&validation_time, &validity_from) < 0)
+    if (oe_datetime_compare(&validation_time, validity_from) < 0)
     {
         char vtime[OE_DATETIME_STRING_SIZE];
         char vfrom[OE_DATETIME_STRING_SIZE];
         size_t tsize = OE_DATETIME_STRING_SIZE;
         oe_datetime_to_string(&validation_time, vtime, &tsize);
         tsize = OE_DATETIME_STRING_SIZE;
-        oe_datetime_to_string(&validity_from, vfrom, &tsize);
+        oe_datetime_to_string(validity_from, vfrom, &tsize);
 
-        oe_datetime_log("Latest valid datetime: ", &validity_from);
+        oe_datetime_log("Latest valid datetime: ", validity_from);
         OE_RAISE_MSG(
             OE_VERIFY_FAILED_TO_FIND_VALIDITY_PERIOD,
             "Validation time %s is earlier than the "
@@ -546,16 +955,16 @@ oe_result_t oe_verify_quote_with_sgx_endorsements(
             vtime,
             vfrom);
     }
-    if (oe_datetime_compare(&validation_time, &validity_until) > 0)
+    if (oe_datetime_compare(&validation_time, validity_until) > 0)
     {
         char vtime[OE_DATETIME_STRING_SIZE];
         char vuntil[OE_DATETIME_STRING_SIZE];
         size_t tsize = OE_DATETIME_STRING_SIZE;
         oe_datetime_to_string(&validation_time, vtime, &tsize);
         tsize = OE_DATETIME_STRING_SIZE;
-        oe_datetime_to_string(&validity_until, vuntil, &tsize);
+        oe_datetime_to_string(validity_until, vuntil, &tsize);
 
-        oe_datetime_log("Earliest expiration datetime: ", &validity_until);
+        oe_datetime_log("Earliest expiration datetime: ", validity_until);
         OE_RAISE_MSG(
             OE_VERIFY_FAILED_TO_FIND_VALIDITY_PERIOD,
             "Validation time %s is later than the "
@@ -570,7 +979,395 @@ done:
     return result;
 }
 
-oe_result_t oe_get_sgx_quote_validity(
+oe_result_t oe_verify_quote_with_sgx_endorsements(
+    const uint8_t* quote,
+    size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_datetime_t* input_validation_time)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t validity_from = {0};
+    oe_datetime_t validity_until = {0};
+
+    OE_CHECK(_verify_quote_validity(
+        quote, quote_size, sgx_endorsements, &validity_from, &validity_until));
+
+    OE_CHECK(_check_validation_time(
+        sgx_endorsements,
+        input_validation_time,
+        &validity_from,
+        &validity_until));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** Batch verification:
+**
+**     Quotes from the same platform and QE share their PCK certificate chain
+**     and QE report, and usually their endorsements. These, and the validity
+**     period they determine, are verified once per group of quotes sharing
+**     them. Only the attestation key and quote signature are verified for
+**     each quote, on several threads on the host.
+**
+**==============================================================================
+*/
+
+/* Maximum number of threads verifying the quote signatures of a batch */
+#define MAX_QUOTE_BATCH_THREADS 8
+
+/* Minimum number of quote signatures verified by each thread */
+#define MIN_QUOTES_PER_BATCH_THREAD 16
+
+#define NO_QUOTE_BATCH_GROUP OE_SIZE_MAX
+
+typedef struct _quote_batch_group
+{
+    /* Digest of the PCK chain, QE report and endorsements of the quotes */
+    OE_SHA256 key;
+    oe_result_t result;
+    oe_datetime_t valid_from;
+    oe_datetime_t valid_until;
+} quote_batch_group_t;
+
+typedef struct _quote_batch_state
+{
+    /* Index of the group of the quote, or NO_QUOTE_BATCH_GROUP if the quote
+     * was found in the verified quote cache or could not be grouped */
+    size_t group;
+    verified_quote_key_t key;
+} quote_batch_state_t;
+
+typedef struct _quote_batch_worker
+{
+    oe_sgx_quote_batch_item_t* items;
+    size_t items_length;
+    size_t first;
+    size_t stride;
+} quote_batch_worker_t;
+
+static oe_result_t _get_quote_batch_group_key(
+    const uint8_t* quote,
+    size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+    oe_sha256_context_t context;
+
+    OE_CHECK(_parse_quote(
+        quote,
+        quote_size,
+        &sgx_quote,
+        &quote_auth_data,
+        &qe_auth_data,
+        &qe_cert_data));
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, &qe_cert_data.size, sizeof(uint32_t)));
+    OE_CHECK(oe_sha256_update(&context, qe_cert_data.data, qe_cert_data.size));
+    OE_CHECK(oe_sha256_update(
+        &context,
+        &quote_auth_data->qe_report_body,
+        sizeof(quote_auth_data->qe_report_body)));
+    OE_CHECK(oe_sha256_update(
+        &context,
+        &quote_auth_data->qe_report_body_signature,
+        sizeof(quote_auth_data->qe_report_body_signature)));
+    OE_CHECK(_update_endorsements_digest(&context, sgx_endorsements));
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Verify what the quotes of a group share: the PCK chain, the QE report and
+ * their validity period for the endorsements. */
+static oe_result_t _verify_quote_batch_group(
+    const uint8_t* quote,
+    size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    quote_batch_group_t* group)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+
+    OE_CHECK(_parse_quote(
+        quote,
+        quote_size,
+        &sgx_quote,
+        &quote_auth_data,
+        &qe_auth_data,
+        &qe_cert_data));
+
+    OE_CHECK(_verify_pck_chain_and_qe_report(quote_auth_data, &qe_cert_data));
+
+    OE_CHECK_MSG(
+        _get_quote_validity(
+            quote,
+            quote_size,
+            sgx_endorsements,
+            &group->valid_from,
+            &group->valid_until),
+        "Failed to validate quote. %s",
+        oe_result_str(result));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _verify_quote_batch_signature(
+    const uint8_t* quote,
+    size_t quote_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_quote_t* sgx_quote = NULL;
+    sgx_quote_auth_data_t* quote_auth_data = NULL;
+    sgx_qe_auth_data_t qe_auth_data = {0};
+    sgx_qe_cert_data_t qe_cert_data = {0};
+
+    OE_CHECK(_parse_quote(
+        quote,
+        quote_size,
+        &sgx_quote,
+        &quote_auth_data,
+        &qe_auth_data,
+        &qe_cert_data));
+
+    OE_CHECK(_verify_quote_signature(sgx_quote, quote_auth_data, &qe_auth_data));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Verify the signatures of the share of the worker among the quotes whose
+ * result is still OE_UNEXPECTED. Each worker writes different items. */
+static void _verify_quote_batch_signatures(quote_batch_worker_t* worker)
+{
+    for (size_t i = worker->first; i < worker->items_length;
+         i += worker->stride)
+    {
+        oe_sgx_quote_batch_item_t* item = &worker->items[i];
+
+        if (item->result == OE_UNEXPECTED)
+            item->result =
+                _verify_quote_batch_signature(item->quote, item->quote_size);
+    }
+}
+
+#ifndef OE_BUILD_ENCLAVE
+static void* _quote_batch_thread(void* arg)
+{
+    _verify_quote_batch_signatures((quote_batch_worker_t*)arg);
+    return NULL;
+}
+#endif
+
+static void _verify_quote_batch_signatures_in_parallel(
+    oe_sgx_quote_batch_item_t* items,
+    size_t items_length,
+    size_t num_pending)
+{
+    quote_batch_worker_t workers[MAX_QUOTE_BATCH_THREADS];
+    bool started[MAX_QUOTE_BATCH_THREADS] = {false};
+    size_t num_workers = 1;
+#ifndef OE_BUILD_ENCLAVE
+    oe_thread_t threads[MAX_QUOTE_BATCH_THREADS];
+
+    num_workers = num_pending / MIN_QUOTES_PER_BATCH_THREAD;
+    if (num_workers > MAX_QUOTE_BATCH_THREADS)
+        num_workers = MAX_QUOTE_BATCH_THREADS;
+    else if (num_workers == 0)
+        num_workers = 1;
+#else
+    OE_UNUSED(num_pending);
+#endif
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        workers[i].items = items;
+        workers[i].items_length = items_length;
+        workers[i].first = i;
+        workers[i].stride = num_workers;
+    }
+
+#ifndef OE_BUILD_ENCLAVE
+    for (size_t i = 1; i < num_workers; i++)
+        started[i] =
+            oe_thread_create(&threads[i], _quote_batch_thread, &workers[i]) ==
+            0;
+#endif
+
+    // The calling thread verifies the share of the first worker, and the
+    // shares of the workers whose thread could not be created.
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        if (!started[i])
+            _verify_quote_batch_signatures(&workers[i]);
+    }
+
+#ifndef OE_BUILD_ENCLAVE
+    for (size_t i = 1; i < num_workers; i++)
+    {
+        if (started[i])
+            oe_thread_join(threads[i]);
+    }
+#endif
+}
+
+oe_result_t oe_verify_quotes_with_sgx_endorsements(
+    oe_sgx_quote_batch_item_t* items,
+    size_t items_length,
+    oe_datetime_t* input_validation_time)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    quote_batch_group_t* groups = NULL;
+    quote_batch_state_t* states = NULL;
+    size_t num_groups = 0;
+    size_t num_pending = 0;
+    size_t size;
+    bool use_cache = _verified_quote_cache_enabled();
+
+    if (!items && items_length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (items_length == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*groups), &size));
+    if (!(groups = (quote_batch_group_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*states), &size));
+    if (!(states = (quote_batch_state_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // Verify each group of quotes once. The quotes whose signature remains
+    // to be verified are left with OE_UNEXPECTED.
+    for (size_t i = 0; i < items_length; i++)
+    {
+        oe_sgx_quote_batch_item_t* item = &items[i];
+        quote_batch_state_t* state = &states[i];
+        OE_SHA256 group_key;
+        size_t group;
+
+        state->group = NO_QUOTE_BATCH_GROUP;
+
+        if (!item->quote || !item->sgx_endorsements)
+        {
+            item->result = OE_INVALID_PARAMETER;
+            continue;
+        }
+
+        if (use_cache)
+        {
+            item->result = _get_verified_quote_key(
+                item->quote,
+                item->quote_size,
+                item->sgx_endorsements,
+                &state->key);
+            if (item->result != OE_OK)
+                continue;
+
+            if (_find_verified_quote(
+                    &state->key, true, &item->valid_from, &item->valid_until))
+                continue;
+        }
+
+        item->result = _get_quote_batch_group_key(
+            item->quote, item->quote_size, item->sgx_endorsements, &group_key);
+        if (item->result != OE_OK)
+            continue;
+
+        // The quotes of a platform are usually next to each other.
+        for (group = num_groups; group > 0; group--)
+        {
+            if (memcmp(&groups[group - 1].key, &group_key, sizeof(group_key)) ==
+                0)
+                break;
+        }
+
+        if (group == 0)
+        {
+            group = ++num_groups;
+            groups[group - 1].key = group_key;
+            groups[group - 1].result = _verify_quote_batch_group(
+                item->quote,
+                item->quote_size,
+                item->sgx_endorsements,
+                &groups[group - 1]);
+        }
+
+        state->group = group - 1;
+
+        if (groups[state->group].result == OE_OK)
+        {
+            item->result = OE_UNEXPECTED;
+            num_pending++;
+        }
+        else
+            item->result = groups[state->group].result;
+    }
+
+    if (num_pending)
+        _verify_quote_batch_signatures_in_parallel(
+            items, items_length, num_pending);
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        oe_sgx_quote_batch_item_t* item = &items[i];
+        const quote_batch_state_t* state = &states[i];
+
+        if (item->result != OE_OK)
+            continue;
+
+        if (state->group != NO_QUOTE_BATCH_GROUP)
+        {
+            item->valid_from = groups[state->group].valid_from;
+            item->valid_until = groups[state->group].valid_until;
+
+            if (use_cache)
+                _cache_verified_quote(
+                    &state->key, &item->valid_from, &item->valid_until);
+        }
+
+        item->result = _check_validation_time(
+            item->sgx_endorsements,
+            input_validation_time,
+            &item->valid_from,
+            &item->valid_until);
+    }
+
+    result = OE_OK;
+
+done:
+    oe_free(states);
+    oe_free(groups);
+    return result;
+}
+
+static oe_result_t _get_quote_validity(
     const uint8_t* quote,
     const size_t quote_size,
     const oe_sgx_endorsements_t* sgx_endorsements,
@@ -586,7 +1383,7 @@ oe_result_t oe_get_sgx_quote_validity(
 
     const uint8_t* pem_pck_certificate = NULL;
     size_t pem_pck_certificate_size = 0;
-    oe_cert_chain_t pck_cert_chain = {0};
+    oe_cert_chain_t* issuer_chain = NULL;
 
     oe_cert_t root_cert = {0};
     oe_cert_t intermediate_cert = {0};
@@ -623,21 +1420,18 @@ oe_result_t oe_get_sgx_quote_validity(
             quote_size,
             &pem_pck_certificate,
             &pem_pck_certificate_size,
-            &pck_cert_chain),
+            &pck_cert,
+            &issuer_chain),
         "Failed to retreive PCK cert chain. %s",
         oe_result_str(result));
 
     // Fetch certificates.
     OE_CHECK_MSG(
-        oe_cert_chain_get_leaf_cert(&pck_cert_chain, &pck_cert),
-        "Failed to get leaf certificate.",
-        NULL);
-    OE_CHECK_MSG(
-        oe_cert_chain_get_root_cert(&pck_cert_chain, &root_cert),
+        oe_cert_chain_get_root_cert(issuer_chain, &root_cert),
         "Failed to get root certificate.",
         NULL);
     OE_CHECK_MSG(
-        oe_cert_chain_get_cert(&pck_cert_chain, 1, &intermediate_cert),
+        oe_cert_chain_get_cert(issuer_chain, 0, &intermediate_cert),
         "Failed to get intermediate certificate.",
         NULL);
 
@@ -692,7 +1486,44 @@ done:
     oe_cert_free(&pck_cert);
     oe_cert_free(&intermediate_cert);
     oe_cert_free(&root_cert);
-    oe_cert_chain_free(&pck_cert_chain);
+    oe_sgx_trust_store_release_cert_chain(issuer_chain);
+
+    return result;
+}
 
+oe_result_t oe_get_sgx_quote_validity(
+    const uint8_t* quote,
+    const size_t quote_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_datetime_t* valid_from,
+    oe_datetime_t* valid_until)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    verified_quote_key_t key = {{{0}}};
+
+    if ((quote == NULL) || (sgx_endorsements == NULL) || (valid_from == NULL) ||
+        (valid_until == NULL))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // The validity period of a quote verified with the same endorsements is
+    // cached, e.g. when the claims of verified evidence are extracted.
+    if (_verified_quote_cache_enabled())
+    {
+        OE_CHECK(_get_verified_quote_key(
+            quote, quote_size, sgx_endorsements, &key));
+
+        if (_find_verified_quote(&key, false, valid_from, valid_until))
+        {
+            result = OE_OK;
+            goto done;
+        }
+    }
+
+    OE_CHECK(_get_quote_validity(
+        quote, quote_size, sgx_endorsements, valid_from, valid_until));
+
+    result = OE_OK;
+
+done:
     return result;
 }
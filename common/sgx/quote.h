@@ -23,16 +23,20 @@ OE_EXTERNC_BEGIN
  * @param[out] pem_pck_certifcate Pointer to the quote where the certificate PCK
  * starts.
  * @param[out] pem_pck_certificate_size Size of the PCK certificate.
- * @param[out] pck_cert_chain Reference to an instance of oe_cert_chain_t where
- * to store the chain.  Caller needs to free resources by calling
- * oe_cert_chain_free()
+ * @param[out] pck_cert Reference to an instance of oe_cert_t where to store
+ * the PCK certificate, verified against its issuers. Caller needs to free
+ * resources by calling oe_cert_free()
+ * @param[out] issuer_chain Receives the chain of issuers of the PCK
+ * certificate, shared through the SGX trust store. Caller needs to release it
+ * by calling oe_sgx_trust_store_release_cert_chain()
  */
 oe_result_t oe_get_quote_cert_chain_internal(
     const uint8_t* quote,
     const size_t quote_size,
     const uint8_t** pem_pck_certificate,
     size_t* pem_pck_certificate_size,
-    oe_cert_chain_t* pck_cert_chain);
+    oe_cert_t* pck_cert,
+    oe_cert_chain_t** issuer_chain);
 
 /*!
  * Verify SGX quote and endorsements.
@@ -73,6 +77,44 @@ oe_result_t oe_verify_quote_with_sgx_endorsements(
     const oe_sgx_endorsements_t* endorsements,
     oe_datetime_t* input_validation_time);
 
+/*!
+ * A quote verified by oe_verify_quotes_with_sgx_endorsements(), with the
+ * result of its verification.
+ */
+typedef struct _oe_sgx_quote_batch_item
+{
+    const uint8_t* quote;
+    size_t quote_size;
+    const oe_sgx_endorsements_t* sgx_endorsements;
+
+    /* Set on return */
+    oe_result_t result;
+    oe_datetime_t valid_from;
+    oe_datetime_t valid_until;
+} oe_sgx_quote_batch_item_t;
+
+/*!
+ * Verify a batch of SGX quotes and endorsements, as
+ * oe_verify_quote_with_sgx_endorsements() does for each of them, and get the
+ * validity period of each verified quote.
+ *
+ * The PCK certificate chain, the QE report and the validity period are
+ * verified once for all the quotes that share them and their endorsements.
+ * The remaining signatures of each quote are verified on several threads on
+ * the host.
+ *
+ * @param[in,out] items The quotes to verify. The result of each item is set
+ * on return, and its validity period if the result is OE_OK.
+ * @param[in] items_length The number of items.
+ * @param[in] input_validation_time Optional time to use for validation of all
+ * the quotes, defaults to the creation time of the endorsements of each quote
+ * if null.
+ */
+oe_result_t oe_verify_quotes_with_sgx_endorsements(
+    oe_sgx_quote_batch_item_t* items,
+    size_t items_length,
+    oe_datetime_t* input_validation_time);
+
 /*!
  * Find the valid datetime range for the given quote and sgx endorsements.
  * This function accounts for the following items:
@@ -4,10 +4,19 @@
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/safemath.h>
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../common.h"
 
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/internal/thread.h>
+#else
+#include "../../host/hostthread.h"
+typedef oe_mutex oe_mutex_t;
+#define OE_MUTEX_INITIALIZER OE_H_MUTEX_INITIALIZER
+#endif
+
 // Public key of Intel's root certificate.
 static const char* _trusted_root_key_pem =
     "-----BEGIN PUBLIC KEY-----\n"
@@ -333,14 +342,13 @@ done:
 // 3. The status of the platform's tcb level is the status of the chosen tcb
 // level.
 // 4. If no tcb level was chosen, then the status of the platform is unknown.
-static void _determine_platform_tcb_info_tcb_level(
-    oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_tcb_info_tcb_level_t* tcb_level)
+//
+// The comparison is a partial order, so the levels cannot be binary searched.
+// This returns whether the platform satisfies step 2 for the given level.
+static bool _platform_meets_tcb_info_tcb_level(
+    const oe_tcb_info_tcb_level_t* platform_tcb_level,
+    const oe_tcb_info_tcb_level_t* tcb_level)
 {
-    // If the platform's status has already been determined, return.
-    if (platform_tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-        return;
-
     // Compare all of the platform's comp svn values with the corresponding
     // values in the current tcb level.
     for (uint32_t i = 0; i < OE_COUNTOF(platform_tcb_level->sgx_tcb_comp_svn);
@@ -348,31 +356,86 @@ static void _determine_platform_tcb_info_tcb_level(
     {
         if (platform_tcb_level->sgx_tcb_comp_svn[i] <
             tcb_level->sgx_tcb_comp_svn[i])
-            return;
+            return false;
     }
-    if (platform_tcb_level->pce_svn < tcb_level->pce_svn)
-        return;
 
-    // If all the values of the tcb level are less than corresponding values of
-    // the platform, then the platform's status is the status of the current tcb
-    // level.
-    platform_tcb_level->status.AsUINT32 = tcb_level->status.AsUINT32;
+    return platform_tcb_level->pce_svn >= tcb_level->pce_svn;
 }
 
-// Found matching TCB level, move itr to the end of the array.
-static void _move_to_end_of_tcb_levels(const uint8_t** itr, const uint8_t* end)
+// Growable array of the tcb levels read from a json string.
+typedef struct _tcb_level_array
 {
-    // Need a counter for '[', ']' to avoid early itr stop due to
-    // potential '[', ']' inside array;
-    uint64_t square_bracket_count = 0;
-    while (*itr < end && (**itr != ']' || square_bracket_count != 0))
+    uint8_t* data;
+    size_t level_size;
+    size_t count;
+    size_t capacity;
+} tcb_level_array_t;
+
+static oe_result_t _append_tcb_level(
+    tcb_level_array_t* array,
+    const void* tcb_level)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (array->count == array->capacity)
     {
-        if (**itr == '[')
-            square_bracket_count++;
-        else if (**itr == ']')
-            square_bracket_count--;
-        (*itr)++;
+        size_t capacity = array->capacity ? array->capacity * 2 : 8;
+        size_t size = 0;
+        uint8_t* data = NULL;
+
+        OE_CHECK(oe_safe_mul_sizet(capacity, array->level_size, &size));
+
+        if (!(data = (uint8_t*)oe_realloc(array->data, size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        array->data = data;
+        array->capacity = capacity;
     }
+
+    memcpy(
+        array->data + array->count * array->level_size,
+        tcb_level,
+        array->level_size);
+    array->count++;
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+/**
+ * Allocate a compiled info of the given size, followed by the levels of the
+ * array, and return a pointer to the levels.
+ */
+static oe_result_t _allocate_compiled_info(
+    size_t info_size,
+    const tcb_level_array_t* levels,
+    void** compiled,
+    void** compiled_levels)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t levels_size = 0;
+    size_t size = 0;
+    uint8_t* p = NULL;
+
+    // The info structures contain size_t fields, so the levels that follow
+    // them are suitably aligned.
+    OE_CHECK(
+        oe_safe_mul_sizet(levels->count, levels->level_size, &levels_size));
+    OE_CHECK(oe_safe_add_sizet(info_size, levels_size, &size));
+
+    if (!(p = (uint8_t*)oe_calloc(1, size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (levels_size)
+        memcpy(p + info_size, levels->data, levels_size);
+
+    *compiled = p;
+    *compiled_levels = p + info_size;
+
+    result = OE_OK;
+done:
+    return result;
 }
 
 /**
@@ -387,10 +450,9 @@ static void _move_to_end_of_tcb_levels(const uint8_t** itr, const uint8_t* end)
 static oe_result_t _read_tcb_info_tcb_level_v1(
     const uint8_t** itr,
     const uint8_t* end,
-    oe_tcb_info_tcb_level_t* platform_tcb_level)
+    oe_tcb_info_tcb_level_t* tcb_level)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
-    oe_tcb_info_tcb_level_t tcb_level = {{0}};
     const uint8_t* status = NULL;
     size_t status_length = 0;
 
@@ -398,7 +460,7 @@ static oe_result_t _read_tcb_info_tcb_level_v1(
 
     OE_TRACE_VERBOSE("Reading tcb");
     OE_CHECK(_read_property_name_and_colon("tcb", itr, end));
-    OE_CHECK(_read_tcb_info_tcb_level(itr, end, &tcb_level));
+    OE_CHECK(_read_tcb_info_tcb_level(itr, end, tcb_level));
     OE_CHECK(_read(',', itr, end));
 
     OE_TRACE_VERBOSE("Reading status");
@@ -408,12 +470,9 @@ static oe_result_t _read_tcb_info_tcb_level_v1(
 
     OE_CHECK(_read('}', itr, end));
 
-    tcb_level.status = _parse_tcb_status(status, status_length);
-    if (tcb_level.status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-    {
-        _determine_platform_tcb_info_tcb_level(platform_tcb_level, &tcb_level);
+    tcb_level->status = _parse_tcb_status(status, status_length);
+    if (tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
         result = OE_OK;
-    }
 
 done:
     return result;
@@ -438,7 +497,6 @@ static oe_result_t _read_tcb_info_tcb_level_v2(
     const uint8_t* info_json,
     const uint8_t** itr,
     const uint8_t* end,
-    oe_tcb_info_tcb_level_t* platform_tcb_level,
     oe_tcb_info_tcb_level_t* tcb_level)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
@@ -490,10 +548,7 @@ static oe_result_t _read_tcb_info_tcb_level_v2(
 
     tcb_level->status = _parse_tcb_status(status, status_length);
     if (tcb_level->status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-    {
-        _determine_platform_tcb_info_tcb_level(platform_tcb_level, tcb_level);
         result = OE_OK;
-    }
 
 done:
     return result;
@@ -522,18 +577,21 @@ done:
  *    "tcbEvaluationDataNumber" : integer
  *    "tcbLevels" : [ objects of type oe_tcb_info_tcb_level_t ]
  * }
+ *
+ * All the tcb levels are appended to the levels array.
  */
 static oe_result_t _read_tcb_info(
     const uint8_t* tcb_info_json,
     const uint8_t** itr,
     const uint8_t* end,
-    oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_tcb_info_t* parsed_info)
+    oe_parsed_tcb_info_t* parsed_info,
+    tcb_level_array_t* levels)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
     uint64_t value = 0;
     const uint8_t* date_str = NULL;
     size_t date_size = 0;
+    oe_tcb_info_tcb_level_t tcb_level;
 
     parsed_info->tcb_info_start = *itr;
     OE_CHECK(_read('{', itr, end));
@@ -618,20 +676,10 @@ static oe_result_t _read_tcb_info(
         OE_CHECK(_read('[', itr, end));
         while (*itr < end)
         {
+            memset(&tcb_level, 0, sizeof(tcb_level));
             OE_CHECK(_read_tcb_info_tcb_level_v2(
-                tcb_info_json,
-                itr,
-                end,
-                platform_tcb_level,
-                &parsed_info->tcb_level));
-
-            // Optimization
-            if (platform_tcb_level->status.AsUINT32 !=
-                OE_TCB_LEVEL_STATUS_UNKNOWN)
-            {
-                // Found matching TCB level, go to the end of the array.
-                _move_to_end_of_tcb_levels(itr, end);
-            }
+                tcb_info_json, itr, end, &tcb_level));
+            OE_CHECK(_append_tcb_level(levels, &tcb_level));
 
             // Read end of array or comma separator.
             if (*itr < end && **itr == ']')
@@ -648,7 +696,10 @@ static oe_result_t _read_tcb_info(
         OE_CHECK(_read('[', itr, end));
         while (*itr < end)
         {
-            OE_CHECK(_read_tcb_info_tcb_level_v1(itr, end, platform_tcb_level));
+            memset(&tcb_level, 0, sizeof(tcb_level));
+            OE_CHECK(_read_tcb_info_tcb_level_v1(itr, end, &tcb_level));
+            OE_CHECK(_append_tcb_level(levels, &tcb_level));
+
             // Read end of array or comma separator.
             if (*itr < end && **itr == ']')
                 break;
@@ -684,72 +735,293 @@ done:
  *    "signature" : "hex string"
  * }
  */
-oe_result_t oe_parse_tcb_info_json(
+oe_result_t oe_compile_tcb_info_json(
     const uint8_t* tcb_info_json,
     size_t tcb_info_json_size,
-    oe_tcb_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_tcb_info_t* parsed_info)
+    oe_compiled_tcb_info_t** compiled)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
     const uint8_t* itr = tcb_info_json;
     const uint8_t* end = tcb_info_json + tcb_info_json_size;
+    oe_parsed_tcb_info_t parsed_info;
+    tcb_level_array_t levels = {NULL, sizeof(oe_tcb_info_tcb_level_t), 0, 0};
+    oe_compiled_tcb_info_t* info = NULL;
+    void* info_levels = NULL;
 
-    if (tcb_info_json == NULL || tcb_info_json_size == 0 ||
-        platform_tcb_level == NULL || parsed_info == NULL)
+    if (tcb_info_json == NULL || tcb_info_json_size == 0 || compiled == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Pointer wrapping.
     if (end <= itr)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    // Initialize status
-    platform_tcb_level->status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+    *compiled = NULL;
+    memset(&parsed_info, 0, sizeof(parsed_info));
 
     itr = _skip_ws(itr, end);
     OE_CHECK(_read('{', &itr, end));
 
     OE_TRACE_VERBOSE("Reading tcbInfo");
     OE_CHECK(_read_property_name_and_colon("tcbInfo", &itr, end));
-    OE_CHECK(_read_tcb_info(
-        tcb_info_json, &itr, end, platform_tcb_level, parsed_info));
+    OE_CHECK(_read_tcb_info(tcb_info_json, &itr, end, &parsed_info, &levels));
     OE_CHECK(_read(',', &itr, end));
 
     OE_TRACE_VERBOSE("Reading signature");
     OE_CHECK(_read_property_name_and_colon("signature", &itr, end));
     OE_CHECK(_read_hex_string(
-        &itr, end, parsed_info->signature, sizeof(parsed_info->signature)));
+        &itr, end, parsed_info.signature, sizeof(parsed_info.signature)));
 
     OE_CHECK(_read('}', &itr, end));
 
-    if (itr == end)
+    if (itr != end)
+        OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+
+    OE_CHECK(_allocate_compiled_info(
+        sizeof(*info), &levels, (void**)&info, &info_levels));
+
+    info->info = parsed_info;
+    info->info.tcb_info_start = NULL;
+    info->tcb_info_offset =
+        (size_t)(parsed_info.tcb_info_start - tcb_info_json);
+    info->num_tcb_levels = levels.count;
+    info->tcb_levels = (oe_tcb_info_tcb_level_t*)info_levels;
+
+    *compiled = info;
+    result = OE_OK;
+done:
+    oe_free(levels.data);
+    return result;
+}
+
+void oe_free_compiled_tcb_info(oe_compiled_tcb_info_t* compiled)
+{
+    // The tcb levels are in the same allocation.
+    oe_free(compiled);
+}
+
+oe_result_t oe_match_compiled_tcb_info(
+    const oe_compiled_tcb_info_t* compiled,
+    const uint8_t* tcb_info_json,
+    oe_tcb_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_tcb_info_t* parsed_info)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const oe_tcb_info_tcb_level_t* tcb_level = NULL;
+
+    if (compiled == NULL || tcb_info_json == NULL ||
+        platform_tcb_level == NULL || parsed_info == NULL ||
+        compiled->num_tcb_levels == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *parsed_info = compiled->info;
+    parsed_info->tcb_info_start = tcb_info_json + compiled->tcb_info_offset;
+
+    platform_tcb_level->status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+
+    for (size_t i = 0; i < compiled->num_tcb_levels; i++)
     {
-        if (platform_tcb_level->status.fields.up_to_date != 1)
+        if (_platform_meets_tcb_info_tcb_level(
+                platform_tcb_level, &compiled->tcb_levels[i]))
         {
-            for (uint32_t i = 0;
-                 i < OE_COUNTOF(platform_tcb_level->sgx_tcb_comp_svn);
-                 ++i)
-                OE_TRACE_VERBOSE(
-                    "sgx_tcb_comp_svn[%d] = 0x%x",
-                    i,
-                    platform_tcb_level->sgx_tcb_comp_svn[i]);
-            OE_TRACE_VERBOSE("pce_svn = 0x%x", platform_tcb_level->pce_svn);
-            OE_RAISE_MSG(
-                OE_TCB_LEVEL_INVALID,
-                "Platform TCB (%d) is not up-to-date",
-                platform_tcb_level->status);
+            tcb_level = &compiled->tcb_levels[i];
+            platform_tcb_level->status.AsUINT32 = tcb_level->status.AsUINT32;
+            break;
         }
+    }
+
+    // The tcb level of a V2 TCB info is the matching level, or the last one.
+    if (compiled->info.version == 2)
+        parsed_info->tcb_level =
+            tcb_level ? *tcb_level
+                      : compiled->tcb_levels[compiled->num_tcb_levels - 1];
 
-        // Display any advisory IDs as warnings
-        if (platform_tcb_level->advisory_ids_size > 0)
+    if (platform_tcb_level->status.fields.up_to_date != 1)
+    {
+        for (uint32_t i = 0;
+             i < OE_COUNTOF(platform_tcb_level->sgx_tcb_comp_svn);
+             ++i)
+            OE_TRACE_VERBOSE(
+                "sgx_tcb_comp_svn[%d] = 0x%x",
+                i,
+                platform_tcb_level->sgx_tcb_comp_svn[i]);
+        OE_TRACE_VERBOSE("pce_svn = 0x%x", platform_tcb_level->pce_svn);
+        OE_RAISE_MSG(
+            OE_TCB_LEVEL_INVALID,
+            "Platform TCB (%d) is not up-to-date",
+            platform_tcb_level->status);
+    }
+
+    // Display any advisory IDs as warnings
+    if (platform_tcb_level->advisory_ids_size > 0)
+    {
+        OE_TRACE_WARNING(
+            "Found %d AdvisoryIDs for this tcb level.",
+            platform_tcb_level->advisory_ids_size);
+    }
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** The compiled info cache:
+**
+**     Maps the contents of a TCB info or QE identity json string to its
+**     compiled form, so that the same collateral is parsed only once while it
+**     is used to verify several quotes. The entries are keyed by a copy of
+**     the json string, which is cheaper to compare than to hash, and are
+**     never stale. The least recently used entry is replaced once the cache
+**     is full.
+**
+**==============================================================================
+*/
+
+#define MAX_CACHED_COMPILED_INFOS 16
+
+typedef struct _compiled_info_entry
+{
+    uint8_t* json;
+    size_t json_size;
+    uint64_t last_used;
+
+    /* oe_compiled_tcb_info_t or oe_compiled_qe_identity_info_t, allocated
+     * as a single block */
+    void* compiled;
+} compiled_info_entry_t;
+
+static compiled_info_entry_t _compiled_tcb_infos[MAX_CACHED_COMPILED_INFOS];
+static compiled_info_entry_t
+    _compiled_qe_identity_infos[MAX_CACHED_COMPILED_INFOS];
+static uint64_t _compiled_info_clock;
+
+/* Held while an entry is looked up and matched, since entries are freed when
+ * they are replaced */
+static oe_mutex_t _compiled_info_mutex = OE_MUTEX_INITIALIZER;
+
+// Must be called with _compiled_info_mutex held.
+static void* _find_compiled_info(
+    compiled_info_entry_t* cache,
+    const uint8_t* json,
+    size_t json_size)
+{
+    for (size_t i = 0; i < MAX_CACHED_COMPILED_INFOS; i++)
+    {
+        if (cache[i].compiled && cache[i].json_size == json_size &&
+            memcmp(cache[i].json, json, json_size) == 0)
         {
-            OE_TRACE_WARNING(
-                "Found %d AdvisoryIDs for this tcb level.",
-                platform_tcb_level->advisory_ids_size);
+            cache[i].last_used = ++_compiled_info_clock;
+            return cache[i].compiled;
         }
+    }
 
-        result = OE_OK;
+    return NULL;
+}
+
+// Must be called with _compiled_info_mutex held. Takes ownership of the
+// compiled info and returns the cached one, which differs from it if another
+// thread cached the same json first. Failing to cache it is not an error.
+static void* _cache_compiled_info(
+    compiled_info_entry_t* cache,
+    const uint8_t* json,
+    size_t json_size,
+    void* compiled,
+    void** to_free)
+{
+    compiled_info_entry_t* entry = NULL;
+    void* cached = NULL;
+    uint8_t* copy = NULL;
+
+    *to_free = NULL;
+
+    if ((cached = _find_compiled_info(cache, json, json_size)))
+    {
+        *to_free = compiled;
+        return cached;
     }
+
+    // The caller still owns the compiled info if it is not cached.
+    if (!(copy = (uint8_t*)oe_malloc(json_size)))
+    {
+        *to_free = compiled;
+        return compiled;
+    }
+
+    memcpy(copy, json, json_size);
+
+    for (size_t i = 0; i < MAX_CACHED_COMPILED_INFOS; i++)
+    {
+        if (!cache[i].compiled)
+        {
+            entry = &cache[i];
+            break;
+        }
+
+        if (!entry || cache[i].last_used < entry->last_used)
+            entry = &cache[i];
+    }
+
+    oe_free(entry->json);
+    oe_free(entry->compiled);
+    entry->json = copy;
+    entry->json_size = json_size;
+    entry->last_used = ++_compiled_info_clock;
+    entry->compiled = compiled;
+
+    return compiled;
+}
+
+oe_result_t oe_parse_tcb_info_json(
+    const uint8_t* tcb_info_json,
+    size_t tcb_info_json_size,
+    oe_tcb_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_tcb_info_t* parsed_info)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+    oe_compiled_tcb_info_t* compiled = NULL;
+    void* to_free = NULL;
+    bool locked = false;
+
+    if (tcb_info_json == NULL || tcb_info_json_size == 0 ||
+        platform_tcb_level == NULL || parsed_info == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_compiled_info_mutex);
+    locked = true;
+
+    if (!(compiled = _find_compiled_info(
+              _compiled_tcb_infos, tcb_info_json, tcb_info_json_size)))
+    {
+        // Do not hold the lock while parsing.
+        oe_mutex_unlock(&_compiled_info_mutex);
+        locked = false;
+
+        OE_CHECK(oe_compile_tcb_info_json(
+            tcb_info_json, tcb_info_json_size, &compiled));
+
+        oe_mutex_lock(&_compiled_info_mutex);
+        locked = true;
+
+        compiled = (oe_compiled_tcb_info_t*)_cache_compiled_info(
+            _compiled_tcb_infos,
+            tcb_info_json,
+            tcb_info_json_size,
+            compiled,
+            &to_free);
+    }
+
+    OE_CHECK(oe_match_compiled_tcb_info(
+        compiled, tcb_info_json, platform_tcb_level, parsed_info));
+
+    result = OE_OK;
 done:
+    if (locked)
+        oe_mutex_unlock(&_compiled_info_mutex);
+
+    oe_free(to_free);
+
     return result;
 }
 
@@ -935,26 +1207,21 @@ done:
 // 3. The status of the platform's tcb level is the status of the chosen tcb
 // level.
 // 4. If no tcb level was chosen, then the status of the platform is unknown.
-static void _determine_platform_qe_tcb_level(
-    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
-    oe_qe_identity_info_tcb_level_t* tcb_level)
+//
+// This returns whether the platform satisfies step 2 for the given level.
+static bool _platform_meets_qe_tcb_level(
+    const oe_qe_identity_info_tcb_level_t* platform_tcb_level,
+    const oe_qe_identity_info_tcb_level_t* tcb_level)
 {
-    // If the platform's status has already been determined, return.
-    if (platform_tcb_level->tcb_status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-        return;
-
     // Compare all of the platform's comp svn values with the corresponding
     // values in the current tcb level.
     for (uint32_t i = 0; i < OE_COUNTOF(platform_tcb_level->isvsvn); ++i)
     {
         if (platform_tcb_level->isvsvn[i] < tcb_level->isvsvn[i])
-            return;
+            return false;
     }
 
-    // If all the values of the tcb level are less than corresponding values of
-    // the platform, then the platform's status is the status of the current tcb
-    // level.
-    platform_tcb_level->tcb_status = tcb_level->tcb_status;
+    return true;
 }
 
 /**
@@ -977,7 +1244,6 @@ static oe_result_t _read_qe_tcb_level(
     const uint8_t* info_json,
     const uint8_t** itr,
     const uint8_t* end,
-    oe_qe_identity_info_tcb_level_t* platform_qe_tcb_level,
     oe_qe_identity_info_tcb_level_t* tcb_level)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
@@ -1031,10 +1297,7 @@ static oe_result_t _read_qe_tcb_level(
 
     tcb_level->tcb_status = _parse_tcb_status(status, status_length);
     if (tcb_level->tcb_status.AsUINT32 != OE_TCB_LEVEL_STATUS_UNKNOWN)
-    {
-        _determine_platform_qe_tcb_level(platform_qe_tcb_level, tcb_level);
         result = OE_OK;
-    }
 
 done:
     return result;
@@ -1057,13 +1320,15 @@ done:
  *    "isvprodid" : integer,
  *    "tcbLevels" : [ objects of type oe_qe_identity_info_tcb_level_t ]
  * }
+ *
+ * All the tcb levels are appended to the levels array.
  */
 static oe_result_t _read_qe_identity_info_v2(
     const uint8_t* info_json,
     const uint8_t** itr,
     const uint8_t* end,
-    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_qe_identity_info_t* parsed_info)
+    oe_parsed_qe_identity_info_t* parsed_info,
+    tcb_level_array_t* levels)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
     uint64_t value = 0;
@@ -1071,15 +1336,7 @@ static oe_result_t _read_qe_identity_info_v2(
     size_t size = 0;
     uint8_t four_bytes_buf[4];
     uint8_t sixteen_bytes_buf[16];
-
-    if (platform_tcb_level == NULL)
-        OE_RAISE_MSG(
-            OE_INVALID_PARAMETER,
-            "QE identity info v2 requires platform tcb level.",
-            NULL);
-
-    // Initialize status.
-    platform_tcb_level->tcb_status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+    oe_qe_identity_info_tcb_level_t tcb_level;
 
     parsed_info->info_start = *itr;
     OE_CHECK(_read('{', itr, end));
@@ -1171,16 +1428,8 @@ static oe_result_t _read_qe_identity_info_v2(
     OE_CHECK(_read('[', itr, end));
     while (*itr < end)
     {
-        OE_CHECK(_read_qe_tcb_level(
-            info_json, itr, end, platform_tcb_level, &parsed_info->tcb_level));
-
-        // Optimization
-        if (platform_tcb_level->tcb_status.AsUINT32 !=
-            OE_TCB_LEVEL_STATUS_UNKNOWN)
-        {
-            // Found matching TCB level, go to the end of the array.
-            _move_to_end_of_tcb_levels(itr, end);
-        }
+        OE_CHECK(_read_qe_tcb_level(info_json, itr, end, &tcb_level));
+        OE_CHECK(_append_tcb_level(levels, &tcb_level));
 
         // Read end of array or comma separator.
         if (*itr < end && **itr == ']')
@@ -1190,9 +1439,6 @@ static oe_result_t _read_qe_identity_info_v2(
     }
     OE_CHECK(_read(']', itr, end));
 
-    // Synchronize legacy V1 field.
-    parsed_info->isvsvn = (uint16_t)parsed_info->tcb_level.isvsvn[0];
-
     // itr is expected to point to the '}' that denotes the end of the qe
     // identity object. The signature is generated over the entire object
     // including the '}'.
@@ -1221,24 +1467,30 @@ done:
  *    "signature" : "hex string"
  * }
  */
-oe_result_t oe_parse_qe_identity_info_json(
+oe_result_t oe_compile_qe_identity_info_json(
     const uint8_t* info_json,
     size_t info_json_size,
-    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
-    oe_parsed_qe_identity_info_t* parsed_info)
+    oe_compiled_qe_identity_info_t** compiled)
 {
     oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
-
     const uint8_t* itr = info_json;
     const uint8_t* end = info_json + info_json_size;
+    oe_parsed_qe_identity_info_t parsed_info;
+    tcb_level_array_t levels = {
+        NULL, sizeof(oe_qe_identity_info_tcb_level_t), 0, 0};
+    oe_compiled_qe_identity_info_t* info = NULL;
+    void* info_levels = NULL;
 
-    if (info_json == NULL || info_json_size == 0 || parsed_info == NULL)
+    if (info_json == NULL || info_json_size == 0 || compiled == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Pointer wrapping.
     if (end <= itr)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    *compiled = NULL;
+    memset(&parsed_info, 0, sizeof(parsed_info));
+
     itr = _skip_ws(itr, end);
     OE_CHECK(_read('{', &itr, end));
 
@@ -1247,27 +1499,97 @@ oe_result_t oe_parse_qe_identity_info_json(
     {
         OE_TRACE_VERBOSE("Reading enclaveIdentity");
         OE_CHECK(_read_qe_identity_info_v2(
-            info_json, &itr, end, platform_tcb_level, parsed_info));
+            info_json, &itr, end, &parsed_info, &levels));
         OE_CHECK(_read(',', &itr, end));
     }
     else
     {
         OE_TRACE_VERBOSE("Reading qeIdentity");
         OE_CHECK(_read_property_name_and_colon("qeIdentity", &itr, end));
-        OE_CHECK(_read_qe_identity_info_v1(&itr, end, parsed_info));
+        OE_CHECK(_read_qe_identity_info_v1(&itr, end, &parsed_info));
         OE_CHECK(_read(',', &itr, end));
     }
 
     OE_TRACE_VERBOSE("Reading signature");
     OE_CHECK(_read_property_name_and_colon("signature", &itr, end));
     OE_CHECK(_read_hex_string(
-        &itr, end, parsed_info->signature, sizeof(parsed_info->signature)));
+        &itr, end, parsed_info.signature, sizeof(parsed_info.signature)));
     OE_CHECK(_read('}', &itr, end));
 
-    if (itr == end)
+    if (itr != end)
+        OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+
+    OE_CHECK(_allocate_compiled_info(
+        sizeof(*info), &levels, (void**)&info, &info_levels));
+
+    info->info = parsed_info;
+    info->info.info_start = NULL;
+    info->info_offset = (size_t)(parsed_info.info_start - info_json);
+    info->num_tcb_levels = levels.count;
+    info->tcb_levels = (oe_qe_identity_info_tcb_level_t*)info_levels;
+
+    *compiled = info;
+    result = OE_OK;
+done:
+    oe_free(levels.data);
+    OE_TRACE_VERBOSE(
+        "oe_compile_qe_identity_info_json ended with [%s]\n",
+        oe_result_str(result));
+    return result;
+}
+
+void oe_free_compiled_qe_identity_info(
+    oe_compiled_qe_identity_info_t* compiled)
+{
+    // The tcb levels are in the same allocation.
+    oe_free(compiled);
+}
+
+oe_result_t oe_match_compiled_qe_identity_info(
+    const oe_compiled_qe_identity_info_t* compiled,
+    const uint8_t* info_json,
+    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_qe_identity_info_t* parsed_info)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const oe_qe_identity_info_tcb_level_t* tcb_level = NULL;
+
+    if (compiled == NULL || info_json == NULL || parsed_info == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *parsed_info = compiled->info;
+    parsed_info->info_start = info_json + compiled->info_offset;
+
+    if (compiled->info.version == 2)
     {
-        if (parsed_info->version == 2 &&
-            platform_tcb_level->tcb_status.fields.up_to_date != 1)
+        if (platform_tcb_level == NULL || compiled->num_tcb_levels == 0)
+            OE_RAISE_MSG(
+                OE_INVALID_PARAMETER,
+                "QE identity info v2 requires platform tcb level.",
+                NULL);
+
+        platform_tcb_level->tcb_status.AsUINT32 = OE_TCB_LEVEL_STATUS_UNKNOWN;
+
+        for (size_t i = 0; i < compiled->num_tcb_levels; i++)
+        {
+            if (_platform_meets_qe_tcb_level(
+                    platform_tcb_level, &compiled->tcb_levels[i]))
+            {
+                tcb_level = &compiled->tcb_levels[i];
+                platform_tcb_level->tcb_status = tcb_level->tcb_status;
+                break;
+            }
+        }
+
+        // The tcb level is the matching level, or the last one.
+        parsed_info->tcb_level =
+            tcb_level ? *tcb_level
+                      : compiled->tcb_levels[compiled->num_tcb_levels - 1];
+
+        // Synchronize legacy V1 field.
+        parsed_info->isvsvn = (uint16_t)parsed_info->tcb_level.isvsvn[0];
+
+        if (platform_tcb_level->tcb_status.fields.up_to_date != 1)
         {
             for (uint32_t i = 0; i < OE_COUNTOF(platform_tcb_level->isvsvn);
                  ++i)
@@ -1278,18 +1600,69 @@ oe_result_t oe_parse_qe_identity_info_json(
                 "QE Identity Information (%d) is not up-to-date",
                 platform_tcb_level->tcb_status.AsUINT32);
         }
+    }
 
-        // Display any advisory IDs as warnings
-        if (parsed_info->tcb_level.advisory_ids_size > 0)
-        {
-            OE_TRACE_WARNING(
-                "Found %d AdvisoryIDs for this tcb level.",
-                parsed_info->tcb_level.advisory_ids_size);
-        }
-        result = OE_OK;
+    // Display any advisory IDs as warnings
+    if (parsed_info->tcb_level.advisory_ids_size > 0)
+    {
+        OE_TRACE_WARNING(
+            "Found %d AdvisoryIDs for this tcb level.",
+            parsed_info->tcb_level.advisory_ids_size);
+    }
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+oe_result_t oe_parse_qe_identity_info_json(
+    const uint8_t* info_json,
+    size_t info_json_size,
+    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_qe_identity_info_t* parsed_info)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+    oe_compiled_qe_identity_info_t* compiled = NULL;
+    void* to_free = NULL;
+    bool locked = false;
+
+    if (info_json == NULL || info_json_size == 0 || parsed_info == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&_compiled_info_mutex);
+    locked = true;
+
+    if (!(compiled = _find_compiled_info(
+              _compiled_qe_identity_infos, info_json, info_json_size)))
+    {
+        // Do not hold the lock while parsing.
+        oe_mutex_unlock(&_compiled_info_mutex);
+        locked = false;
+
+        OE_CHECK(oe_compile_qe_identity_info_json(
+            info_json, info_json_size, &compiled));
+
+        oe_mutex_lock(&_compiled_info_mutex);
+        locked = true;
+
+        compiled = (oe_compiled_qe_identity_info_t*)_cache_compiled_info(
+            _compiled_qe_identity_infos,
+            info_json,
+            info_json_size,
+            compiled,
+            &to_free);
     }
 
+    OE_CHECK(oe_match_compiled_qe_identity_info(
+        compiled, info_json, platform_tcb_level, parsed_info));
+
+    result = OE_OK;
 done:
+    if (locked)
+        oe_mutex_unlock(&_compiled_info_mutex);
+
+    oe_free(to_free);
+
     OE_TRACE_VERBOSE(
         "oe_parse_qe_identity_info_json ended with [%s]\n",
         oe_result_str(result));
@@ -103,6 +103,10 @@ typedef struct _oe_parsed_tcb_info
  * If the plaform's tcb level status was determined to be not uptodate,
  * then OE_TCB_LEVEL_INVALID is returned.
  *
+ * The json string is compiled once with oe_compile_tcb_info_json(), and the
+ * compiled form of the most recently used ones is cached, keyed by a copy of
+ * the json string.
+ *
  * @param[in] tcb_info_json The json string to parse.
  * @param[in] tcb_info_json_size The string length of info_json
  * @param[in] platform_tcb_level The platform tcb level.
@@ -116,6 +120,57 @@ oe_result_t oe_parse_tcb_info_json(
     oe_tcb_info_tcb_level_t* platform_tcb_level,
     oe_parsed_tcb_info_t* parsed_info);
 
+/**
+ * Compiled form of a TCB info json string.
+ *
+ * Holds every field of the TCB info, and all of its tcb levels in the order
+ * of the json, so that the status of any platform can be determined without
+ * parsing the json again. The tcb levels are stored in the same allocation
+ * as the structure.
+ */
+typedef struct _oe_compiled_tcb_info
+{
+    //! The parsed fields, with tcb_info_start set to NULL.
+    oe_parsed_tcb_info_t info;
+
+    //! Offset of the tcbInfo object in the json string.
+    size_t tcb_info_offset;
+
+    size_t num_tcb_levels;
+    oe_tcb_info_tcb_level_t* tcb_levels;
+} oe_compiled_tcb_info_t;
+
+/**
+ * Parse the given tcb info json string into a compiled TCB info.
+ *
+ * @param[in] tcb_info_json The json string to parse.
+ * @param[in] tcb_info_json_size The string length of tcb_info_json.
+ * @param[out] compiled The compiled TCB info, to be freed with
+ * oe_free_compiled_tcb_info().
+ */
+oe_result_t oe_compile_tcb_info_json(
+    const uint8_t* tcb_info_json,
+    size_t tcb_info_json_size,
+    oe_compiled_tcb_info_t** compiled);
+
+void oe_free_compiled_tcb_info(oe_compiled_tcb_info_t* compiled);
+
+/**
+ * Determine the status of the platform_tcb_level against a compiled TCB info,
+ * as oe_parse_tcb_info_json() does, and populate the parsed_info structure.
+ *
+ * @param[in] compiled The compiled TCB info.
+ * @param[in] tcb_info_json The json string the TCB info was compiled from.
+ * parsed_info->tcb_info_start points into it.
+ * @param[in,out] platform_tcb_level The platform tcb level.
+ * @param[out] parsed_info The parsed results.
+ */
+oe_result_t oe_match_compiled_tcb_info(
+    const oe_compiled_tcb_info_t* compiled,
+    const uint8_t* tcb_info_json,
+    oe_tcb_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_tcb_info_t* parsed_info);
+
 oe_result_t oe_verify_ecdsa256_signature(
     const uint8_t* tcb_info_start,
     size_t tcb_info_size,
@@ -179,6 +234,10 @@ typedef struct _oe_parsed_qe_identity_info
 /*!
  * Parse a QE or QVE identity json string.
  *
+ * The json string is compiled once with oe_compile_qe_identity_info_json(),
+ * and the compiled form of the most recently used ones is cached, keyed by a
+ * copy of the json string.
+ *
  * @param[in] info_json The json string to parse.
  * @param[in] info_json_size The string length of info_json
  * @param[in,out] platform_tcb_level The platform tcb level.
@@ -192,6 +251,58 @@ oe_result_t oe_parse_qe_identity_info_json(
     oe_qe_identity_info_tcb_level_t* platform_tcb_level,
     oe_parsed_qe_identity_info_t* parsed_info);
 
+/*! \struct oe_compiled_qe_identity_info_t
+ *  \brief Compiled form of a QE or QVE identity json string.
+ *
+ * Holds every field of the identity, and all of its tcb levels in the order
+ * of the json. The tcb levels are stored in the same allocation as the
+ * structure.
+ */
+typedef struct _oe_compiled_qe_identity_info
+{
+    //! The parsed fields, with info_start set to NULL.
+    oe_parsed_qe_identity_info_t info;
+
+    //! Offset of the identity object in the json string.
+    size_t info_offset;
+
+    size_t num_tcb_levels;
+    oe_qe_identity_info_tcb_level_t* tcb_levels;
+} oe_compiled_qe_identity_info_t;
+
+/*!
+ * Parse a QE or QVE identity json string into a compiled identity.
+ *
+ * @param[in] info_json The json string to parse.
+ * @param[in] info_json_size The string length of info_json
+ * @param[out] compiled The compiled identity, to be freed with
+ * oe_free_compiled_qe_identity_info().
+ */
+oe_result_t oe_compile_qe_identity_info_json(
+    const uint8_t* info_json,
+    size_t info_json_size,
+    oe_compiled_qe_identity_info_t** compiled);
+
+void oe_free_compiled_qe_identity_info(
+    oe_compiled_qe_identity_info_t* compiled);
+
+/*!
+ * Determine the status of the platform_tcb_level against a compiled QE or
+ * QVE identity, as oe_parse_qe_identity_info_json() does, and populate the
+ * parsed_info structure.
+ *
+ * @param[in] compiled The compiled identity.
+ * @param[in] info_json The json string the identity was compiled from.
+ * parsed_info->info_start points into it.
+ * @param[in,out] platform_tcb_level The platform tcb level. Required for V2.
+ * @param[out] parsed_info The parsed results.
+ */
+oe_result_t oe_match_compiled_qe_identity_info(
+    const oe_compiled_qe_identity_info_t* compiled,
+    const uint8_t* info_json,
+    oe_qe_identity_info_tcb_level_t* platform_tcb_level,
+    oe_parsed_qe_identity_info_t* parsed_info);
+
 /*!
  * Parse an advisoryIDs field json string.
  *
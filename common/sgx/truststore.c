@@ -0,0 +1,407 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "truststore.h"
+#include <openenclave/internal/pem.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/trace.h>
+#include <openenclave/internal/utils.h>
+#include "../common.h"
+
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/internal/thread.h>
+#else
+#include "../../host/hostthread.h"
+typedef oe_mutex oe_mutex_t;
+#define OE_MUTEX_INITIALIZER OE_H_MUTEX_INITIALIZER
+#endif
+
+/* Number of hash buckets of each table (a power of two) */
+#define TRUST_STORE_BUCKETS 64
+
+typedef enum _trust_store_entry_type
+{
+    TRUST_STORE_CERT_CHAIN,
+    TRUST_STORE_CRL
+} trust_store_entry_type_t;
+
+typedef struct _trust_store_entry
+{
+    /* First, so that the entry can be found from the object returned */
+    union {
+        oe_cert_chain_t chain;
+        oe_crl_t crl;
+    } u;
+
+    trust_store_entry_type_t type;
+
+    /* The PEM data the object was read from, and its hash */
+    uint8_t* data;
+    size_t size;
+    uint64_t hash;
+
+    /* Next entry of the same bucket */
+    struct _trust_store_entry* next;
+
+    /* Number of callers using the object */
+    uint64_t refs;
+
+    /* Whether the entry is in its table; entries dropped from the table are
+     * freed once no longer used */
+    bool stored;
+    uint64_t last_used;
+} trust_store_entry_t;
+
+typedef struct _trust_store_table
+{
+    trust_store_entry_t* buckets[TRUST_STORE_BUCKETS];
+    size_t num_entries;
+} trust_store_table_t;
+
+static trust_store_table_t _chains;
+static trust_store_table_t _crls;
+static uint64_t _trust_store_clock;
+static uint64_t _trust_store_hits;
+static uint64_t _trust_store_misses;
+static uint64_t _trust_store_evictions;
+static oe_mutex_t _trust_store_mutex = OE_MUTEX_INITIALIZER;
+
+/* FNV-1a */
+static uint64_t _hash(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+static void _free_entry(trust_store_entry_t* entry)
+{
+    if (entry->type == TRUST_STORE_CERT_CHAIN)
+        oe_cert_chain_free(&entry->u.chain);
+    else
+        oe_crl_free(&entry->u.crl);
+
+    oe_free(entry->data);
+    oe_free(entry);
+}
+
+// Must be called with _trust_store_mutex held.
+static trust_store_entry_t* _find_entry(
+    trust_store_table_t* table,
+    const uint8_t* data,
+    size_t size,
+    uint64_t hash)
+{
+    trust_store_entry_t* entry = table->buckets[hash % TRUST_STORE_BUCKETS];
+
+    for (; entry; entry = entry->next)
+    {
+        if (entry->hash == hash && entry->size == size &&
+            memcmp(entry->data, data, size) == 0)
+        {
+            entry->refs++;
+            entry->last_used = ++_trust_store_clock;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+// Must be called with _trust_store_mutex held. Returns the entry to free, if
+// any.
+static trust_store_entry_t* _remove_lru_entry(trust_store_table_t* table)
+{
+    trust_store_entry_t** lru = NULL;
+    trust_store_entry_t* entry = NULL;
+
+    for (size_t i = 0; i < TRUST_STORE_BUCKETS; i++)
+    {
+        for (trust_store_entry_t** p = &table->buckets[i]; *p; p = &(*p)->next)
+        {
+            if (!lru || (*p)->last_used < (*lru)->last_used)
+                lru = p;
+        }
+    }
+
+    if (!lru)
+        return NULL;
+
+    entry = *lru;
+    *lru = entry->next;
+    entry->next = NULL;
+    entry->stored = false;
+    table->num_entries--;
+    _trust_store_evictions++;
+
+    return entry->refs ? NULL : entry;
+}
+
+/**
+ * Store a new entry, referenced by the caller, and return the entry to use.
+ * If another thread stored the same data first, its entry is returned and the
+ * new one is freed.
+ */
+static trust_store_entry_t* _store_entry(
+    trust_store_table_t* table,
+    trust_store_entry_t* entry)
+{
+    trust_store_entry_t* stored = NULL;
+    trust_store_entry_t* to_free = NULL;
+
+    oe_mutex_lock(&_trust_store_mutex);
+
+    if ((stored = _find_entry(table, entry->data, entry->size, entry->hash)))
+    {
+        to_free = entry;
+    }
+    else
+    {
+        if (table->num_entries == OE_SGX_TRUST_STORE_MAX_ENTRIES)
+            to_free = _remove_lru_entry(table);
+
+        entry->next = table->buckets[entry->hash % TRUST_STORE_BUCKETS];
+        table->buckets[entry->hash % TRUST_STORE_BUCKETS] = entry;
+        entry->stored = true;
+        entry->last_used = ++_trust_store_clock;
+        table->num_entries++;
+        stored = entry;
+    }
+
+    oe_mutex_unlock(&_trust_store_mutex);
+
+    if (to_free)
+        _free_entry(to_free);
+
+    return stored;
+}
+
+static void _release_entry(trust_store_entry_t* entry)
+{
+    bool unused = false;
+
+    oe_mutex_lock(&_trust_store_mutex);
+    unused = --entry->refs == 0 && !entry->stored;
+    oe_mutex_unlock(&_trust_store_mutex);
+
+    if (unused)
+        _free_entry(entry);
+}
+
+static oe_result_t _get_entry(
+    trust_store_table_t* table,
+    trust_store_entry_type_t type,
+    const uint8_t* pem_data,
+    size_t pem_size,
+    trust_store_entry_t** entry_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t hash = 0;
+    trust_store_entry_t* entry = NULL;
+
+    if (!pem_data || !pem_size || !entry_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    hash = _hash(pem_data, pem_size);
+
+    oe_mutex_lock(&_trust_store_mutex);
+
+    if ((entry = _find_entry(table, pem_data, pem_size, hash)))
+        _trust_store_hits++;
+    else
+        _trust_store_misses++;
+
+    oe_mutex_unlock(&_trust_store_mutex);
+
+    if (!entry)
+    {
+        // Read the object without holding the lock.
+        if (!(entry = (trust_store_entry_t*)oe_calloc(1, sizeof(*entry))) ||
+            !(entry->data = (uint8_t*)oe_malloc(pem_size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        memcpy(entry->data, pem_data, pem_size);
+        entry->size = pem_size;
+        entry->hash = hash;
+        entry->type = type;
+        entry->refs = 1;
+
+        if (type == TRUST_STORE_CERT_CHAIN)
+            OE_CHECK(
+                oe_cert_chain_read_pem(&entry->u.chain, pem_data, pem_size));
+        else
+            OE_CHECK(oe_crl_read_pem(&entry->u.crl, pem_data, pem_size));
+
+        entry = _store_entry(table, entry);
+    }
+
+    *entry_out = entry;
+    entry = NULL;
+    result = OE_OK;
+
+done:
+    if (entry)
+    {
+        oe_free(entry->data);
+        oe_free(entry);
+    }
+
+    return result;
+}
+
+oe_result_t oe_sgx_trust_store_get_cert_chain(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_cert_chain_t** chain)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    trust_store_entry_t* entry = NULL;
+
+    if (!chain)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_entry(
+        &_chains, TRUST_STORE_CERT_CHAIN, pem_data, pem_size, &entry));
+    *chain = &entry->u.chain;
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+void oe_sgx_trust_store_release_cert_chain(oe_cert_chain_t* chain)
+{
+    if (chain)
+        _release_entry((trust_store_entry_t*)chain);
+}
+
+oe_result_t oe_sgx_trust_store_get_crl(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_crl_t** crl)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    trust_store_entry_t* entry = NULL;
+
+    if (!crl)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_entry(&_crls, TRUST_STORE_CRL, pem_data, pem_size, &entry));
+    *crl = &entry->u.crl;
+
+    result = OE_OK;
+done:
+    return result;
+}
+
+void oe_sgx_trust_store_release_crl(oe_crl_t* crl)
+{
+    if (crl)
+        _release_entry((trust_store_entry_t*)crl);
+}
+
+oe_result_t oe_sgx_trust_store_get_stats(oe_sgx_trust_store_stats_t* stats)
+{
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    oe_mutex_lock(&_trust_store_mutex);
+    stats->hits = _trust_store_hits;
+    stats->misses = _trust_store_misses;
+    stats->evictions = _trust_store_evictions;
+    stats->chains = _chains.num_entries;
+    stats->crls = _crls.num_entries;
+    oe_mutex_unlock(&_trust_store_mutex);
+
+    return OE_OK;
+}
+
+/* Find the end of the first certificate of the PEM data */
+static const uint8_t* _find_end_of_first_cert(
+    const uint8_t* pem_data,
+    size_t pem_size)
+{
+    const uint8_t* end = pem_data + pem_size;
+
+    for (const uint8_t* p = pem_data;
+         (size_t)(end - p) >= OE_PEM_END_CERTIFICATE_LEN;
+         p++)
+    {
+        if (memcmp(p, OE_PEM_END_CERTIFICATE, OE_PEM_END_CERTIFICATE_LEN) == 0)
+            return p + OE_PEM_END_CERTIFICATE_LEN;
+    }
+
+    return NULL;
+}
+
+oe_result_t oe_sgx_trust_store_read_pck_cert_chain(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_cert_t* pck_cert,
+    oe_cert_chain_t** issuer_chain)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint8_t* end = NULL;
+    const uint8_t* issuers = NULL;
+    size_t pck_cert_size = 0;
+    char* pck_cert_pem = NULL;
+    oe_cert_t cert = {0};
+    oe_cert_chain_t* chain = NULL;
+
+    if (!pem_data || !pem_size || !pck_cert || !issuer_chain)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(end = _find_end_of_first_cert(pem_data, pem_size)))
+        OE_RAISE_MSG(OE_INVALID_PARAMETER, "No certificate in PEM data", NULL);
+
+    pck_cert_size = (size_t)(end - pem_data);
+
+    // The issuers follow the PCK certificate.
+    for (issuers = end; issuers < pem_data + pem_size; issuers++)
+    {
+        if (*issuers != ' ' && *issuers != '\t' && *issuers != '\r' &&
+            *issuers != '\n')
+            break;
+    }
+
+    if (issuers == pem_data + pem_size || *issuers == '\0')
+        OE_RAISE_MSG(
+            OE_VERIFY_FAILED, "PCK certificate chain has no issuers", NULL);
+
+    // Read the PCK certificate from a zero-terminated copy.
+    if (!(pck_cert_pem = (char*)oe_malloc(pck_cert_size + 1)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memcpy(pck_cert_pem, pem_data, pck_cert_size);
+    pck_cert_pem[pck_cert_size] = '\0';
+
+    OE_CHECK(oe_cert_read_pem(&cert, pck_cert_pem, pck_cert_size + 1));
+
+    OE_CHECK(oe_sgx_trust_store_get_cert_chain(
+        issuers, (size_t)(pem_data + pem_size - issuers), &chain));
+
+    OE_CHECK_MSG(
+        oe_cert_verify(&cert, chain, NULL, 0),
+        "Failed to verify the PCK certificate against its issuers. %s",
+        oe_result_str(result));
+
+    *pck_cert = cert;
+    memset(&cert, 0, sizeof(cert));
+    *issuer_chain = chain;
+    chain = NULL;
+    result = OE_OK;
+
+done:
+    oe_sgx_trust_store_release_cert_chain(chain);
+    oe_cert_free(&cert);
+    oe_free(pck_cert_pem);
+
+    return result;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_COMMON_SGX_TRUSTSTORE_H
+#define _OE_COMMON_SGX_TRUSTSTORE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/crypto/cert.h>
+#include <openenclave/internal/crypto/crl.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** The SGX trust store:
+**
+**     Shares the certificate chains and CRLs of the SGX quote verification
+**     collateral between the verifications that use them, once parsed and
+**     verified. They are looked up by their contents in hash tables, so that
+**     verifying a quote only parses the PCK certificate of the platform; the
+**     Intel root and intermediate CA certificates and the CRLs are parsed
+**     once. The least recently used entries are dropped once a table is full.
+**
+**     The store does not decide which roots are trusted: callers still check
+**     the root of the chains they get.
+**
+**     The chains and CRLs returned are shared with other threads, so they
+**     must not be modified, and must be released instead of freed.
+**
+**==============================================================================
+*/
+
+/* Maximum number of chains and of CRLs kept in the store */
+#define OE_SGX_TRUST_STORE_MAX_ENTRIES 32
+
+typedef struct _oe_sgx_trust_store_stats
+{
+    /* Number of lookups of chains and CRLs found in the store */
+    uint64_t hits;
+
+    /* Number of lookups that read the chain or CRL */
+    uint64_t misses;
+
+    /* Number of entries dropped to make room for new ones */
+    uint64_t evictions;
+
+    /* Number of chains and of CRLs currently in the store */
+    uint64_t chains;
+    uint64_t crls;
+} oe_sgx_trust_store_stats_t;
+
+/* Get the statistics of the store of the host process or enclave. */
+oe_result_t oe_sgx_trust_store_get_stats(oe_sgx_trust_store_stats_t* stats);
+
+/* Get the chain read from the PEM data, verified up to its root. */
+oe_result_t oe_sgx_trust_store_get_cert_chain(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_cert_chain_t** chain);
+
+void oe_sgx_trust_store_release_cert_chain(oe_cert_chain_t* chain);
+
+/* Get the CRL read from the PEM data. */
+oe_result_t oe_sgx_trust_store_get_crl(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_crl_t** crl);
+
+void oe_sgx_trust_store_release_crl(oe_crl_t* crl);
+
+/* Read a PCK certificate chain, which starts with the PCK certificate followed
+ * by its issuers. The PCK certificate is read into pck_cert and verified
+ * against the chain of its issuers, which is taken from the store. */
+oe_result_t oe_sgx_trust_store_read_pck_cert_chain(
+    const uint8_t* pem_data,
+    size_t pem_size,
+    oe_cert_t* pck_cert,
+    oe_cert_chain_t** issuer_chain);
+
+OE_EXTERNC_END
+
+#endif /* _OE_COMMON_SGX_TRUSTSTORE_H */
@@ -53,23 +53,15 @@ static oe_result_t _on_unregister(oe_attestation_role_t* context)
     return OE_OK;
 }
 
-static void _free_claim(oe_claim_t* claim)
-{
-    oe_free(claim->name);
-    oe_free(claim->value);
-}
-
 static oe_result_t _free_claims(
     oe_verifier_t* context,
     oe_claim_t* claims,
     size_t claims_length)
 {
     OE_UNUSED(context);
-    if (!claims)
-        return OE_OK;
+    OE_UNUSED(claims_length);
 
-    for (size_t i = 0; i < claims_length; i++)
-        _free_claim(&claims[i]);
+    // The claims, their names and their values take a single allocation.
     oe_free(claims);
     return OE_OK;
 }
@@ -153,168 +145,112 @@ done:
     return result;
 }
 
-static oe_result_t _add_claim(
-    oe_claim_t* claim,
-    const void* name,
-    size_t name_size,
+/* The known claims of a piece of evidence, before they are copied to its
+ * claims list. The claims point to the values of the structure. */
+typedef struct _known_claims
+{
+    oe_report_t parsed_report;
+    oe_datetime_t valid_from;
+    oe_datetime_t valid_until;
+    oe_claim_t claims[OE_REQUIRED_CLAIMS_COUNT + OE_OPTIONAL_CLAIMS_COUNT];
+    size_t claims_length;
+} known_claims_t;
+
+static void _add_known_claim(
+    known_claims_t* known,
+    const char* name,
     const void* value,
     size_t value_size)
 {
-    if (*((uint8_t*)name + name_size - 1) != '\0')
-        return OE_CONSTRAINT_FAILED;
-
-    claim->name = (char*)oe_malloc(name_size);
-    if (claim->name == NULL)
-        return OE_OUT_OF_MEMORY;
-    memcpy(claim->name, name, name_size);
+    oe_claim_t* claim = &known->claims[known->claims_length++];
 
-    claim->value = (uint8_t*)oe_malloc(value_size);
-    if (claim->value == NULL)
-    {
-        oe_free(claim->name);
-        claim->name = NULL;
-        return OE_OUT_OF_MEMORY;
-    }
-    memcpy(claim->value, value, value_size);
+    claim->name = (char*)name;
+    claim->value = (uint8_t*)value;
     claim->value_size = value_size;
-
-    return OE_OK;
 }
 
-static oe_result_t _fill_with_known_claims(
+static oe_result_t _get_known_claims(
     const oe_uuid_t* format_id,
     const uint8_t* report,
     size_t report_size,
     const oe_sgx_endorsements_t* sgx_endorsements,
-    oe_claim_t* claims,
-    size_t claims_length,
-    size_t* claims_added)
+    const oe_datetime_t* quote_valid_from,
+    const oe_datetime_t* quote_valid_until,
+    known_claims_t* known)
 {
     oe_result_t result = OE_UNEXPECTED;
-    oe_report_t parsed_report = {0};
-    oe_identity_t* id = &parsed_report.identity;
-    size_t claims_index = 0;
+    oe_identity_t* id = &known->parsed_report.identity;
     oe_report_header_t* header = (oe_report_header_t*)report;
-    oe_datetime_t valid_from = {0};
-    oe_datetime_t valid_until = {0};
 
-    if (claims_length < OE_REQUIRED_CLAIMS_COUNT)
-        OE_RAISE(OE_INVALID_PARAMETER);
+    known->claims_length = 0;
 
-    OE_CHECK(oe_parse_report(report, report_size, &parsed_report));
+    OE_CHECK(oe_parse_report(report, report_size, &known->parsed_report));
 
-    if (header->report_type == OE_REPORT_TYPE_SGX_REMOTE &&
-        claims_length < OE_REQUIRED_CLAIMS_COUNT + OE_OPTIONAL_CLAIMS_COUNT)
-        OE_RAISE(OE_INVALID_PARAMETER);
-
-    // ID version.
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_ID_VERSION,
-        sizeof(OE_CLAIM_ID_VERSION),
-        &id->id_version,
-        sizeof(id->id_version)));
-
-    // Security version.
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
+    _add_known_claim(
+        known, OE_CLAIM_ID_VERSION, &id->id_version, sizeof(id->id_version));
+    _add_known_claim(
+        known,
         OE_CLAIM_SECURITY_VERSION,
-        sizeof(OE_CLAIM_SECURITY_VERSION),
         &id->security_version,
-        sizeof(id->security_version)));
-
-    // Attributes.
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_ATTRIBUTES,
-        sizeof(OE_CLAIM_ATTRIBUTES),
-        &id->attributes,
-        sizeof(id->attributes)));
-
-    // Unique ID
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_UNIQUE_ID,
-        sizeof(OE_CLAIM_UNIQUE_ID),
-        &id->unique_id,
-        sizeof(id->unique_id)));
-
-    // Signer ID
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_SIGNER_ID,
-        sizeof(OE_CLAIM_SIGNER_ID),
-        &id->signer_id,
-        sizeof(id->signer_id)));
-
-    // Product ID
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_PRODUCT_ID,
-        sizeof(OE_CLAIM_PRODUCT_ID),
-        &id->product_id,
-        sizeof(id->product_id)));
-
-    // Plugin UUID
-    OE_CHECK(_add_claim(
-        &claims[claims_index++],
-        OE_CLAIM_FORMAT_UUID,
-        sizeof(OE_CLAIM_FORMAT_UUID),
-        format_id,
-        sizeof(*format_id)));
+        sizeof(id->security_version));
+    _add_known_claim(
+        known, OE_CLAIM_ATTRIBUTES, &id->attributes, sizeof(id->attributes));
+    _add_known_claim(
+        known, OE_CLAIM_UNIQUE_ID, &id->unique_id, sizeof(id->unique_id));
+    _add_known_claim(
+        known, OE_CLAIM_SIGNER_ID, &id->signer_id, sizeof(id->signer_id));
+    _add_known_claim(
+        known, OE_CLAIM_PRODUCT_ID, &id->product_id, sizeof(id->product_id));
+    _add_known_claim(
+        known, OE_CLAIM_FORMAT_UUID, format_id, sizeof(*format_id));
 
     if (header->report_type == OE_REPORT_TYPE_SGX_REMOTE)
     {
-        // Get quote validity periods to get validity from and until claims.
-        OE_CHECK(oe_get_sgx_quote_validity(
-            header->report,
-            header->report_size,
-            sgx_endorsements,
-            &valid_from,
-            &valid_until));
-
-        // Validity from.
-        OE_CHECK(_add_claim(
-            &claims[claims_index++],
-            OE_CLAIM_VALIDITY_FROM,
-            sizeof(OE_CLAIM_VALIDITY_FROM),
-            &valid_from,
-            sizeof(valid_from)));
+        // Get quote validity periods to get validity from and until claims,
+        // unless the caller verified the quote and has them already.
+        if (quote_valid_from && quote_valid_until)
+        {
+            known->valid_from = *quote_valid_from;
+            known->valid_until = *quote_valid_until;
+        }
+        else
+        {
+            OE_CHECK(oe_get_sgx_quote_validity(
+                header->report,
+                header->report_size,
+                sgx_endorsements,
+                &known->valid_from,
+                &known->valid_until));
+        }
 
-        // Validity to.
-        OE_CHECK(_add_claim(
-            &claims[claims_index++],
+        _add_known_claim(
+            known,
+            OE_CLAIM_VALIDITY_FROM,
+            &known->valid_from,
+            sizeof(known->valid_from));
+        _add_known_claim(
+            known,
             OE_CLAIM_VALIDITY_UNTIL,
-            sizeof(OE_CLAIM_VALIDITY_UNTIL),
-            &valid_until,
-            sizeof(valid_until)));
+            &known->valid_until,
+            sizeof(known->valid_until));
     }
 
-    *claims_added = claims_index;
     result = OE_OK;
 
 done:
-    if (result != OE_OK)
-    {
-        for (size_t i = 0; i < claims_index; i++)
-            _free_claim(&claims[i]);
-    }
     return result;
 }
 
-static oe_result_t _fill_with_custom_claims(
+/* Check the serialized custom claims, and add the size their names and values
+ * take in a claims buffer to *size. */
+static oe_result_t _get_custom_claims_size(
     const uint8_t* claims_buf,
     size_t claims_buf_size,
-    oe_claim_t* claims,
-    size_t claims_length)
+    size_t* size)
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_sgx_plugin_claims_header_t* header =
         (oe_sgx_plugin_claims_header_t*)claims_buf;
-    size_t claims_index = 0;
-
-    if (claims_length < header->num_claims)
-        OE_RAISE(OE_INVALID_PARAMETER);
 
     claims_buf += sizeof(*header);
     claims_buf_size -= sizeof(*header);
@@ -322,47 +258,74 @@ static oe_result_t _fill_with_custom_claims(
     {
         oe_sgx_plugin_claims_entry_t* entry =
             (oe_sgx_plugin_claims_entry_t*)claims_buf;
-        uint64_t size;
+        uint64_t entry_size;
 
         // Sanity check sizes.
         if (claims_buf_size < sizeof(*entry))
             OE_RAISE(OE_CONSTRAINT_FAILED);
 
-        OE_CHECK(oe_safe_add_u64(sizeof(*entry), entry->name_size, &size));
-        OE_CHECK(oe_safe_add_u64(size, entry->value_size, &size));
+        OE_CHECK(
+            oe_safe_add_u64(sizeof(*entry), entry->name_size, &entry_size));
+        OE_CHECK(oe_safe_add_u64(entry_size, entry->value_size, &entry_size));
 
-        if (claims_buf_size < size)
+        if (claims_buf_size < entry_size)
             OE_RAISE(OE_CONSTRAINT_FAILED);
 
-        // Finally, add the claim.
-        OE_CHECK(_add_claim(
-            &claims[claims_index++],
-            entry->name,
-            entry->name_size,
-            entry->name + entry->name_size,
-            entry->value_size));
+        if (entry->name_size == 0 || entry->name[entry->name_size - 1] != '\0')
+            OE_RAISE(OE_CONSTRAINT_FAILED);
+
+        OE_CHECK(oe_add_claim_buffer_size(
+            entry->name_size, entry->value_size, size));
 
         // Go to next entry.
-        claims_buf += size;
-        claims_buf_size -= size;
+        claims_buf += entry_size;
+        claims_buf_size -= entry_size;
     }
 
     result = OE_OK;
 
 done:
-    if (result != OE_OK)
+    return result;
+}
+
+/* Copy the custom claims checked by _get_custom_claims_size(). */
+static void _copy_custom_claims(
+    const uint8_t* claims_buf,
+    oe_claim_t* claims,
+    uint8_t** data)
+{
+    oe_sgx_plugin_claims_header_t* header =
+        (oe_sgx_plugin_claims_header_t*)claims_buf;
+
+    claims_buf += sizeof(*header);
+    for (uint64_t i = 0; i < header->num_claims; i++)
     {
-        for (size_t i = 0; i < claims_index; i++)
-            _free_claim(&claims[i]);
+        oe_sgx_plugin_claims_entry_t* entry =
+            (oe_sgx_plugin_claims_entry_t*)claims_buf;
+
+        oe_copy_claim_to_buffer(
+            &claims[i],
+            (const char*)entry->name,
+            entry->name_size,
+            entry->name + entry->name_size,
+            entry->value_size,
+            data);
+
+        claims_buf += sizeof(*entry) + entry->name_size + entry->value_size;
     }
-    return result;
 }
 
-oe_result_t oe_sgx_extract_claims(
+/* Extract the claims of the evidence into a single allocation, or into the
+ * caller's buffer if claims_buffer_size is not NULL. */
+static oe_result_t _extract_claims(
     const oe_uuid_t* format_id,
     const uint8_t* evidence,
     size_t evidence_size,
     const oe_sgx_endorsements_t* sgx_endorsements,
+    const oe_datetime_t* quote_valid_from,
+    const oe_datetime_t* quote_valid_until,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
     oe_claim_t** claims_out,
     size_t* claims_length_out)
 {
@@ -370,10 +333,12 @@ oe_result_t oe_sgx_extract_claims(
     oe_report_header_t* header = (oe_report_header_t*)evidence;
     oe_sgx_plugin_claims_header_t* claims_header = NULL;
     size_t report_size = sizeof(*header) + header->report_size;
+    known_claims_t known;
     oe_claim_t* claims = NULL;
+    void* allocated = NULL;
     uint64_t claims_length = 0;
-    uint64_t claims_size = 0;
-    size_t claims_added = 0;
+    size_t size = 0;
+    uint8_t* data = NULL;
 
     // Check if the buffer is the proper size.
     if (evidence_size - report_size < sizeof(*claims_header))
@@ -389,51 +354,98 @@ oe_result_t oe_sgx_extract_claims(
 
     claims_header = (oe_sgx_plugin_claims_header_t*)(evidence + report_size);
 
-    // Get the number of claims we need and allocate the claims.
+    OE_CHECK(_get_known_claims(
+        format_id,
+        evidence,
+        report_size,
+        sgx_endorsements,
+        quote_valid_from,
+        quote_valid_until,
+        &known));
+
+    // Get the size of the claims list, followed by the names and values.
     OE_CHECK(oe_safe_add_u64(
-        OE_REQUIRED_CLAIMS_COUNT, claims_header->num_claims, &claims_length));
+        known.claims_length, claims_header->num_claims, &claims_length));
+    OE_CHECK(oe_safe_mul_sizet(claims_length, sizeof(oe_claim_t), &size));
 
-    if (header->report_type == OE_REPORT_TYPE_SGX_REMOTE)
+    for (size_t i = 0; i < known.claims_length; i++)
+        OE_CHECK(oe_add_claim_buffer_size(
+            oe_strlen(known.claims[i].name) + 1,
+            known.claims[i].value_size,
+            &size));
+
+    OE_CHECK(_get_custom_claims_size(
+        evidence + report_size, evidence_size - report_size, &size));
+
+    if (claims_buffer_size)
     {
-        OE_CHECK(oe_safe_add_u64(
-            claims_length, OE_OPTIONAL_CLAIMS_COUNT, &claims_length));
+        if (*claims_buffer_size < size)
+        {
+            *claims_buffer_size = size;
+            OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+        }
+
+        claims = (oe_claim_t*)claims_buffer;
     }
+    else
+    {
+        if (!(allocated = oe_malloc(size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
 
-    OE_CHECK(oe_safe_mul_u64(claims_length, sizeof(oe_claim_t), &claims_size));
+        claims = (oe_claim_t*)allocated;
+    }
 
-    claims = (oe_claim_t*)oe_malloc(claims_size);
-    if (claims == NULL)
-        OE_RAISE(OE_OUT_OF_MEMORY);
+    data = (uint8_t*)(claims + claims_length);
 
-    // Fill the list with the known claims.
-    OE_CHECK(_fill_with_known_claims(
-        format_id,
-        evidence,
-        report_size,
-        sgx_endorsements,
-        claims,
-        claims_length,
-        &claims_added));
+    for (size_t i = 0; i < known.claims_length; i++)
+        oe_copy_claim_to_buffer(
+            &claims[i],
+            known.claims[i].name,
+            oe_strlen(known.claims[i].name) + 1,
+            known.claims[i].value,
+            known.claims[i].value_size,
+            &data);
 
-    // Fill with the custom claims.
-    OE_CHECK(_fill_with_custom_claims(
-        evidence + report_size,
-        evidence_size - report_size,
-        claims + claims_added,
-        claims_length - claims_added));
+    _copy_custom_claims(
+        evidence + report_size, claims + known.claims_length, &data);
+
+    if (claims_buffer_size)
+        *claims_buffer_size = size;
 
     *claims_out = claims;
     *claims_length_out = claims_length;
-    claims = NULL;
+    allocated = NULL;
     result = OE_OK;
 
 done:
-    if (claims)
-        _free_claims(NULL, claims, claims_length);
+    oe_free(allocated);
     return result;
 }
 
-static oe_result_t _verify_evidence(
+oe_result_t oe_sgx_extract_claims(
+    const oe_uuid_t* format_id,
+    const uint8_t* evidence,
+    size_t evidence_size,
+    const oe_sgx_endorsements_t* sgx_endorsements,
+    oe_claim_t** claims_out,
+    size_t* claims_length_out)
+{
+    return _extract_claims(
+        format_id,
+        evidence,
+        evidence_size,
+        sgx_endorsements,
+        NULL,
+        NULL,
+        NULL,
+        NULL,
+        claims_out,
+        claims_length_out);
+}
+
+/* Verify the evidence and extract its claims, into the caller's buffer if
+ * claims_buffer_size is not NULL. */
+static oe_result_t _verify_and_extract_claims(
     oe_verifier_t* context,
     const uint8_t* evidence_buffer,
     size_t evidence_buffer_size,
@@ -441,6 +453,8 @@ static oe_result_t _verify_evidence(
     size_t endorsements_buffer_size,
     const oe_policy_t* policies,
     size_t policies_size,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
     oe_claim_t** claims,
     size_t* claims_length)
 {
@@ -493,11 +507,15 @@ static oe_result_t _verify_evidence(
     }
 
     // Last step is to return the required and custom claims.
-    OE_CHECK(oe_sgx_extract_claims(
+    OE_CHECK_NO_TRACE(_extract_claims(
         &context->base.format_id,
         evidence_buffer,
         evidence_buffer_size,
         &sgx_endorsements,
+        NULL,
+        NULL,
+        claims_buffer,
+        claims_buffer_size,
         claims,
         claims_length));
 
@@ -510,6 +528,226 @@ done:
     return result;
 }
 
+static oe_result_t _verify_evidence(
+    oe_verifier_t* context,
+    const uint8_t* evidence_buffer,
+    size_t evidence_buffer_size,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    oe_claim_t** claims,
+    size_t* claims_length)
+{
+    return _verify_and_extract_claims(
+        context,
+        evidence_buffer,
+        evidence_buffer_size,
+        endorsements_buffer,
+        endorsements_buffer_size,
+        policies,
+        policies_size,
+        NULL,
+        NULL,
+        claims,
+        claims_length);
+}
+
+static oe_result_t _verify_evidence_with_claims_buffer(
+    oe_verifier_t* context,
+    const uint8_t* evidence_buffer,
+    size_t evidence_buffer_size,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
+    oe_claim_t** claims,
+    size_t* claims_length)
+{
+    if (!claims_buffer_size)
+        return OE_INVALID_PARAMETER;
+
+    return _verify_and_extract_claims(
+        context,
+        evidence_buffer,
+        evidence_buffer_size,
+        endorsements_buffer,
+        endorsements_buffer_size,
+        policies,
+        policies_size,
+        claims_buffer,
+        claims_buffer_size,
+        claims,
+        claims_length);
+}
+
+typedef struct _evidence_batch_quote
+{
+    /* Index of the evidence of the quote in the batch */
+    size_t item;
+    uint8_t* local_endorsements_buffer;
+    oe_sgx_endorsements_t sgx_endorsements;
+} evidence_batch_quote_t;
+
+static oe_result_t _verify_evidence_batch(
+    oe_verifier_t* context,
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t* time = NULL;
+    oe_sgx_endorsements_t shared_endorsements;
+    oe_result_t shared_endorsements_result = OE_OK;
+    evidence_batch_quote_t* quotes = NULL;
+    oe_sgx_quote_batch_item_t* quote_items = NULL;
+    size_t num_quotes = 0;
+    size_t size;
+
+    if (!context || !items || !items_length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Check the datetime policy if it exists.
+    OE_CHECK(_get_input_time(policies, policies_size, &time));
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*quotes), &size));
+    if (!(quotes = (evidence_batch_quote_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_safe_mul_sizet(items_length, sizeof(*quote_items), &size));
+    if (!(quote_items = (oe_sgx_quote_batch_item_t*)oe_malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // The endorsements shared by the quotes are parsed once.
+    if (endorsements_buffer)
+        shared_endorsements_result = oe_parse_sgx_endorsements(
+            (oe_endorsements_t*)endorsements_buffer,
+            endorsements_buffer_size,
+            &shared_endorsements);
+
+    for (size_t i = 0; i < items_length; i++)
+    {
+        oe_evidence_batch_item_t* item = &items[i];
+        oe_report_header_t* header = (oe_report_header_t*)item->evidence_buffer;
+        evidence_batch_quote_t* quote = &quotes[num_quotes];
+        size_t local_endorsements_buffer_size = 0;
+
+        item->claims = NULL;
+        item->claims_length = 0;
+
+        if (!item->evidence_buffer ||
+            item->evidence_buffer_size < sizeof(*header) ||
+            item->evidence_buffer_size - sizeof(*header) < header->report_size)
+        {
+            item->result = OE_INVALID_PARAMETER;
+            continue;
+        }
+
+        // Local reports share nothing with the other evidence.
+        if (header->report_type != OE_REPORT_TYPE_SGX_REMOTE)
+        {
+            item->result = _verify_evidence(
+                context,
+                item->evidence_buffer,
+                item->evidence_buffer_size,
+                endorsements_buffer,
+                endorsements_buffer_size,
+                policies,
+                policies_size,
+                &item->claims,
+                &item->claims_length);
+            continue;
+        }
+
+        quote->item = i;
+        quote->local_endorsements_buffer = NULL;
+
+        if (endorsements_buffer)
+        {
+            if ((item->result = shared_endorsements_result) != OE_OK)
+                continue;
+
+            quote_items[num_quotes].sgx_endorsements = &shared_endorsements;
+        }
+        else
+        {
+            // Get the endorsements of the quote, which are cached per
+            // platform.
+            item->result = oe_get_sgx_endorsements(
+                header->report,
+                header->report_size,
+                &quote->local_endorsements_buffer,
+                &local_endorsements_buffer_size);
+
+            if (item->result == OE_OK)
+                item->result = oe_parse_sgx_endorsements(
+                    (oe_endorsements_t*)quote->local_endorsements_buffer,
+                    local_endorsements_buffer_size,
+                    &quote->sgx_endorsements);
+
+            if (item->result != OE_OK)
+            {
+                oe_free_sgx_endorsements(quote->local_endorsements_buffer);
+                continue;
+            }
+
+            quote_items[num_quotes].sgx_endorsements = &quote->sgx_endorsements;
+        }
+
+        quote_items[num_quotes].quote = header->report;
+        quote_items[num_quotes].quote_size = header->report_size;
+        num_quotes++;
+    }
+
+    // Verify the quotes now.
+    OE_CHECK(oe_verify_quotes_with_sgx_endorsements(
+        quote_items, num_quotes, time));
+
+    // Last step is to return the required and custom claims of each verified
+    // quote, with the validity period computed by the verification.
+    for (size_t i = 0; i < num_quotes; i++)
+    {
+        oe_evidence_batch_item_t* item = &items[quotes[i].item];
+
+        if ((item->result = quote_items[i].result) != OE_OK)
+            continue;
+
+        item->result = _extract_claims(
+            &context->base.format_id,
+            item->evidence_buffer,
+            item->evidence_buffer_size,
+            quote_items[i].sgx_endorsements,
+            &quote_items[i].valid_from,
+            &quote_items[i].valid_until,
+            NULL,
+            NULL,
+            &item->claims,
+            &item->claims_length);
+    }
+
+    result = OE_OK;
+
+done:
+    if (quotes)
+    {
+        for (size_t i = 0; i < num_quotes; i++)
+        {
+            if (quotes[i].local_endorsements_buffer)
+                oe_free_sgx_endorsements(quotes[i].local_endorsements_buffer);
+        }
+    }
+
+    oe_free(quote_items);
+    oe_free(quotes);
+
+    return result;
+}
+
 // Gets the optional format settings for the given verifier plugin context.
 // For SGX local attestation, this would be the sgx_target_info_t struct.
 static oe_result_t _get_format_settings(
@@ -645,6 +883,9 @@ static oe_result_t _get_verifier_plugins(
         plugin->verify_evidence = &_verify_evidence;
         plugin->verify_report = &_verify_report;
         plugin->free_claims = &_free_claims;
+        plugin->verify_evidence_batch = &_verify_evidence_batch;
+        plugin->verify_evidence_with_claims_buffer =
+            &_verify_evidence_with_claims_buffer;
     }
     *verifiers_length = uuid_count;
     result = OE_OK;
@@ -20,6 +20,7 @@
  */
 oe_result_t _oe_log_is_supported_ocall();
 oe_result_t _oe_log_ocall(uint32_t log_level, const char* message);
+oe_result_t _oe_log_ring_wake_ocall(oe_log_ring_t* log_ring);
 oe_result_t _oe_write_ocall(int device, const char* str, size_t maxlen);
 
 /**
@@ -43,6 +44,13 @@ oe_result_t _oe_log_ocall(uint32_t log_level, const char* message)
 }
 OE_WEAK_ALIAS(_oe_log_ocall, oe_log_ocall);
 
+oe_result_t _oe_log_ring_wake_ocall(oe_log_ring_t* log_ring)
+{
+    OE_UNUSED(log_ring);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_log_ring_wake_ocall, oe_log_ring_wake_ocall);
+
 oe_result_t _oe_write_ocall(int device, const char* str, size_t maxlen)
 {
     OE_UNUSED(device);
@@ -2,6 +2,8 @@
 // Licensed under the MIT License.
 
 #include "arena.h"
+#include <openenclave/bits/properties.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/common.h>
 #include <openenclave/internal/print.h>
@@ -10,12 +12,34 @@
 #include <openenclave/internal/sgx/td.h>
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
+#include "platform_t.h"
 
 // Default shared memory arena capacity is 1 mb
 static size_t _capacity = 1024 * 1024;
 
 static const size_t _max_capacity = 1 << 30;
 
+// Number of consecutive resets of an arena without using its chained chunks
+// after which the chunks are returned to the host.
+#define OE_ARENA_IDLE_RESET_COUNT 64
+
+/* A chunk of shared memory chained to an arena when its first buffer is
+ * full. Chunk descriptors live in enclave memory so that the host cannot
+ * tamper with the chain. */
+typedef struct _oe_shared_memory_arena_chunk
+{
+    struct _oe_shared_memory_arena_chunk* next;
+    uint8_t* buffer;
+    uint64_t capacity;
+    uint64_t used;
+} oe_shared_memory_arena_chunk_t;
+
+// The arenas of the threads that have used one, for statistics. The thread
+// data of a TCS lives as long as the enclave, so entries are never removed.
+static oe_shared_memory_arena_t* _arenas[OE_SGX_MAX_TCS];
+static size_t _num_arenas;
+static oe_spinlock_t _arenas_lock = OE_SPINLOCK_INITIALIZER;
+
 void* oe_allocate_arena(size_t capacity);
 void oe_deallocate_arena(void* buffer);
 
@@ -25,6 +49,98 @@ static oe_shared_memory_arena_t* _get_arena()
     return &oe_sgx_get_td()->arena;
 }
 
+static void _register_arena(oe_shared_memory_arena_t* arena)
+{
+    oe_spin_lock(&_arenas_lock);
+    {
+        size_t i = 0;
+
+        while (i < _num_arenas && _arenas[i] != arena)
+            i++;
+
+        if (i == _num_arenas && _num_arenas < OE_COUNTOF(_arenas))
+            _arenas[_num_arenas++] = arena;
+    }
+    oe_spin_unlock(&_arenas_lock);
+}
+
+// Total number of bytes in use in the arena.
+static uint64_t _get_total_used(const oe_shared_memory_arena_t* arena)
+{
+    uint64_t total = arena->used;
+
+    for (const oe_shared_memory_arena_chunk_t* chunk = arena->chunks; chunk;
+         chunk = chunk->next)
+        total += chunk->used;
+
+    return total;
+}
+
+static void _release_chunks(oe_shared_memory_arena_t* arena)
+{
+    oe_shared_memory_arena_chunk_t* chunk = arena->chunks;
+
+    while (chunk)
+    {
+        oe_shared_memory_arena_chunk_t* next = chunk->next;
+        arena->chunks_capacity -= chunk->capacity;
+        arena->chunks_released++;
+        oe_deallocate_arena(chunk->buffer);
+        oe_free(chunk);
+        chunk = next;
+    }
+
+    arena->chunks = NULL;
+    arena->idle_count = 0;
+}
+
+// Allocate size bytes (already aligned) from the chained chunks, chaining a
+// new chunk if none of them has enough room left.
+static void* _chunk_malloc(oe_shared_memory_arena_t* arena, size_t size)
+{
+    oe_shared_memory_arena_chunk_t* chunk = NULL;
+    uint64_t capacity = 0;
+    uint64_t total_capacity = 0;
+
+    for (chunk = arena->chunks; chunk; chunk = chunk->next)
+    {
+        if (chunk->capacity - chunk->used >= size)
+        {
+            uint8_t* addr = chunk->buffer + chunk->used;
+            chunk->used += size;
+            return addr;
+        }
+    }
+
+    // Chain a new chunk at least as large as the first buffer, while keeping
+    // the whole arena below the maximum capacity.
+    capacity = size > arena->capacity ? size : arena->capacity;
+    if (oe_safe_add_u64(
+            arena->capacity + arena->chunks_capacity,
+            capacity,
+            &total_capacity) != OE_OK ||
+        total_capacity > _max_capacity)
+        return NULL;
+
+    if (!(chunk = oe_calloc(1, sizeof(*chunk))))
+        return NULL;
+
+    if (!(chunk->buffer = oe_allocate_arena(capacity)))
+    {
+        oe_free(chunk);
+        return NULL;
+    }
+
+    chunk->capacity = capacity;
+    chunk->used = size;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->chunks_capacity += capacity;
+    arena->chunks_allocated++;
+
+    return chunk->buffer;
+}
+
 bool oe_configure_arena_capacity(size_t cap)
 {
     if (cap > _max_capacity)
@@ -41,6 +157,8 @@ void* oe_arena_malloc(size_t size)
     size_t total_size = 0;
     const size_t align = OE_EDGER8R_BUFFER_ALIGNMENT;
     oe_shared_memory_arena_t* arena = _get_arena();
+    uint8_t* addr = NULL;
+    uint64_t total_used = 0;
 
     // Create the arena if it hasn't been created.
     if (arena->buffer == NULL)
@@ -50,10 +168,12 @@ void* oe_arena_malloc(size_t size)
         if (buffer == NULL)
         {
             arena->capacity = 0;
+            arena->failed_allocations++;
             return NULL;
         }
         arena->buffer = (uint8_t*)buffer;
         arena->used = 0;
+        _register_arena(arena);
     }
 
     // Round up to the nearest alignment size.
@@ -61,21 +181,32 @@ void* oe_arena_malloc(size_t size)
 
     // check for overflow
     if (total_size < size)
-        return NULL;
+        OE_RAISE_NO_TRACE(OE_INTEGER_OVERFLOW);
 
     // check for capacity
     size_t used_after;
     OE_CHECK(oe_safe_add_sizet(arena->used, total_size, &used_after));
 
-    // Ok if the incoming malloc puts us below the capacity.
+    // Ok if the incoming malloc puts us below the capacity. Otherwise, fall
+    // back to the chained chunks.
     if (used_after <= arena->capacity)
     {
-        uint8_t* addr = arena->buffer + arena->used;
+        addr = arena->buffer + arena->used;
         arena->used = used_after;
-        return addr;
     }
+    else if (!(addr = _chunk_malloc(arena, total_size)))
+    {
+        OE_RAISE_NO_TRACE(OE_OUT_OF_MEMORY);
+    }
+
+    total_used = _get_total_used(arena);
+    if (total_used > arena->high_water_mark)
+        arena->high_water_mark = total_used;
+
+    return addr;
 
 done:
+    arena->failed_allocations++;
     return NULL;
 }
 
@@ -96,7 +227,26 @@ void* oe_arena_calloc(size_t num, size_t size)
 void oe_arena_free_all()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
+    bool chunks_used = false;
+
     arena->used = 0;
+
+    for (oe_shared_memory_arena_chunk_t* chunk = arena->chunks; chunk;
+         chunk = chunk->next)
+    {
+        chunks_used |= (chunk->used != 0);
+        chunk->used = 0;
+    }
+
+    // Shrink the arena back to its first buffer once the chained chunks have
+    // not been needed for a while.
+    if (arena->chunks)
+    {
+        if (chunks_used)
+            arena->idle_count = 0;
+        else if (++arena->idle_count >= OE_ARENA_IDLE_RESET_COUNT)
+            _release_chunks(arena);
+    }
 }
 
 // Free the arena in the current thread.
@@ -104,7 +254,67 @@ void oe_teardown_arena()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
 
+    _release_chunks(arena);
+
     if (arena->buffer != NULL)
         oe_deallocate_arena(arena->buffer);
-    memset(arena, 0, sizeof(oe_shared_memory_arena_t));
+
+    // Keep the statistics.
+    arena->buffer = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+static void _get_statistics(
+    const oe_shared_memory_arena_t* arena,
+    oe_arena_statistics_t* statistics)
+{
+    statistics->capacity = arena->capacity + arena->chunks_capacity;
+    statistics->high_water_mark = arena->high_water_mark;
+    statistics->chunks_allocated = arena->chunks_allocated;
+    statistics->chunks_released = arena->chunks_released;
+    statistics->failed_allocations = arena->failed_allocations;
+}
+
+oe_result_t oe_get_arena_statistics(oe_arena_statistics_t* statistics)
+{
+    if (!statistics)
+        return OE_INVALID_PARAMETER;
+
+    _get_statistics(_get_arena(), statistics);
+    return OE_OK;
+}
+
+oe_result_t oe_sgx_get_arena_statistics_ecall(
+    oe_arena_statistics_t* statistics,
+    size_t statistics_count,
+    size_t* statistics_count_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!statistics_count_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&_arenas_lock);
+    {
+        *statistics_count_out = _num_arenas;
+
+        if (statistics_count < _num_arenas || (!statistics && _num_arenas))
+        {
+            result = OE_BUFFER_TOO_SMALL;
+        }
+        else
+        {
+            // The counters of other threads are read without synchronization
+            // with their owners, so they are a snapshot.
+            for (size_t i = 0; i < _num_arenas; i++)
+                _get_statistics(_arenas[i], &statistics[i]);
+
+            result = OE_OK;
+        }
+    }
+    oe_spin_unlock(&_arenas_lock);
+
+done:
+    return result;
 }
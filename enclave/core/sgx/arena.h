@@ -5,8 +5,7 @@
 #define _OE_ARENA_H
 
 #include <openenclave/bits/types.h>
-
-bool oe_configure_arena_capacity(size_t cap);
+#include <openenclave/internal/switchless.h>
 
 void* oe_arena_malloc(size_t size);
 
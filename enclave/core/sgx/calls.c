@@ -195,6 +195,115 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** The ECALL buffers:
+**
+**     Each thread marshals the arguments of its ECALLs in a buffer of enclave
+**     memory kept in its thread data, instead of allocating and freeing one on
+**     every ECALL. The buffer grows on demand up to OE_ECALL_BUFFER_MAX_SIZE.
+**     Larger ECALLs, and ECALLs nested in an OCALL made by an ECALL that uses
+**     the buffer, allocate their own buffer. Every
+**     OE_ECALL_BUFFER_TRIM_INTERVAL ECALLs, the buffer is freed if the ECALLs
+**     used less than half of it meanwhile, so that the next ECALL allocates
+**     one that fits.
+**
+**==============================================================================
+*/
+
+#define OE_ECALL_BUFFER_MAX_SIZE (64 * 1024)
+#define OE_ECALL_BUFFER_TRIM_INTERVAL 1024
+
+// The ECALL buffers of the threads that have used one, so that they can be
+// freed when the enclave terminates. The thread data of a TCS lives as long
+// as the enclave, so entries are never removed.
+static oe_ecall_buffer_t* _ecall_buffers[OE_SGX_MAX_TCS];
+static size_t _num_ecall_buffers;
+static oe_spinlock_t _ecall_buffers_lock = OE_SPINLOCK_INITIALIZER;
+
+static void _register_ecall_buffer(oe_ecall_buffer_t* ecall_buffer)
+{
+    oe_spin_lock(&_ecall_buffers_lock);
+    {
+        size_t i = 0;
+
+        while (i < _num_ecall_buffers && _ecall_buffers[i] != ecall_buffer)
+            i++;
+
+        if (i == _num_ecall_buffers &&
+            _num_ecall_buffers < OE_COUNTOF(_ecall_buffers))
+            _ecall_buffers[_num_ecall_buffers++] = ecall_buffer;
+    }
+    oe_spin_unlock(&_ecall_buffers_lock);
+}
+
+static void _release_ecall_buffer(oe_ecall_buffer_t* ecall_buffer)
+{
+    oe_free(ecall_buffer->buffer);
+    ecall_buffer->buffer = NULL;
+    ecall_buffer->capacity = 0;
+}
+
+static uint8_t* _get_ecall_buffer(oe_ecall_buffer_t* ecall_buffer, size_t size)
+{
+    if (ecall_buffer->in_use || size > OE_ECALL_BUFFER_MAX_SIZE)
+        return (uint8_t*)oe_malloc(size);
+
+    if (size > ecall_buffer->capacity)
+    {
+        // The contents need not be preserved.
+        size_t capacity = oe_round_up_to_multiple(size, OE_PAGE_SIZE);
+
+        _release_ecall_buffer(ecall_buffer);
+
+        if (!(ecall_buffer->buffer = (uint8_t*)oe_malloc(capacity)))
+            return NULL;
+
+        ecall_buffer->capacity = capacity;
+        _register_ecall_buffer(ecall_buffer);
+    }
+
+    if (size > ecall_buffer->max_used)
+        ecall_buffer->max_used = size;
+
+    ecall_buffer->in_use = 1;
+    return ecall_buffer->buffer;
+}
+
+static void _put_ecall_buffer(oe_ecall_buffer_t* ecall_buffer, uint8_t* buffer)
+{
+    if (buffer != ecall_buffer->buffer)
+    {
+        oe_free(buffer);
+        return;
+    }
+
+    ecall_buffer->in_use = 0;
+
+    if (++ecall_buffer->num_calls == OE_ECALL_BUFFER_TRIM_INTERVAL)
+    {
+        if (2 * ecall_buffer->max_used < ecall_buffer->capacity)
+            _release_ecall_buffer(ecall_buffer);
+
+        ecall_buffer->num_calls = 0;
+        ecall_buffer->max_used = 0;
+    }
+}
+
+// Free the ECALL buffers of all the threads when the enclave terminates.
+static void _free_ecall_buffers(void)
+{
+    oe_spin_lock(&_ecall_buffers_lock);
+    {
+        for (size_t i = 0; i < _num_ecall_buffers; i++)
+            _release_ecall_buffer(_ecall_buffers[i]);
+
+        _num_ecall_buffers = 0;
+    }
+    oe_spin_unlock(&_ecall_buffers_lock);
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
@@ -203,6 +312,7 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     oe_call_enclave_function_args_t args, *args_ptr;
     oe_result_t result = OE_OK;
     oe_ecall_func_t func = NULL;
+    oe_ecall_buffer_t* ecall_buffer = &oe_sgx_get_td()->ecall_buffer;
     uint8_t* buffer = NULL;
     uint8_t* input_buffer = NULL;
     uint8_t* output_buffer = NULL;
@@ -271,8 +381,8 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     if (func == NULL)
         OE_RAISE(OE_NOT_FOUND);
 
-    // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
+    // Get buffers in enclave memory
+    buffer = input_buffer = _get_ecall_buffer(ecall_buffer, buffer_size);
     if (buffer == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
@@ -281,7 +391,9 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
 
     // Clear out output buffer.
     // This ensures reproducible behavior if say the function is reading from
-    // output buffer.
+    // output buffer. Since the buffer is reused, this also ensures that out
+    // parameters the function does not write do not return the data of an
+    // earlier ECALL to the host.
     output_buffer = buffer + args.input_buffer_size;
     memset(output_buffer, 0, args.output_buffer_size);
 
@@ -310,8 +422,66 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
 
 done:
     if (buffer)
-        oe_free(buffer);
+        _put_ecall_buffer(ecall_buffer, buffer);
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _handle_call_enclave_function_batch()
+**
+**     Call the enclave functions of a batch one after the other, so that the
+**     cost of entering and leaving the enclave is paid once for the batch.
+**     The calls are independent: each one reports its own result and a
+**     failing call does not stop the next ones. The shared memory arena is
+**     reset after each call, as it is at the end of an ECALL, so that a long
+**     batch does not accumulate the allocations of all its calls.
+**
+**==============================================================================
+*/
+
+static oe_result_t _handle_call_enclave_function_batch(uint64_t arg_in)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_batch_args_t batch;
+    oe_call_enclave_function_args_t* calls = NULL;
+    uint64_t size = 0;
+    oe_sgx_td_t* td = oe_sgx_get_td();
+
+    if (!oe_is_outside_enclave(
+            (void*)arg_in, sizeof(oe_call_enclave_function_batch_args_t)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Copy the batch to enclave memory to avoid TOCTOU issues. Each call is
+    // copied by oe_handle_call_enclave_function().
+    batch = *(oe_call_enclave_function_batch_args_t*)arg_in;
+    calls = batch.calls;
+
+    OE_CHECK(oe_safe_mul_u64(batch.num_calls, sizeof(*calls), &size));
+
+    if (!calls || !batch.num_calls || !oe_is_outside_enclave(calls, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (uint64_t i = 0; i < batch.num_calls; i++)
+    {
+        oe_result_t call_result =
+            oe_handle_call_enclave_function((uint64_t)&calls[i]);
 
+        // A successful call sets its own result.
+        if (call_result != OE_OK)
+            calls[i].result = call_result;
+
+        // A batch nested in an OCALL must not reset the arena of the outer
+        // ECALL, which may still be in use.
+        if (td->depth == 1)
+            oe_arena_free_all();
+    }
+
+    result = OE_OK;
+
+done:
     return result;
 }
 
@@ -417,6 +587,11 @@ static void _handle_ecall(
             arg_out = oe_handle_call_enclave_function(arg_in);
             break;
         }
+        case OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH:
+        {
+            arg_out = _handle_call_enclave_function_batch(arg_in);
+            break;
+        }
         case OE_ECALL_DESTRUCTOR:
         {
             /* Call functions installed by oe_cxa_atexit() and oe_atexit() */
@@ -431,6 +606,9 @@ static void _handle_ecall(
             /* Cleanup verifiers */
             oe_verifier_shutdown();
 
+            /* Free the ECALL buffers of all the threads */
+            _free_ecall_buffers();
+
 #if defined(OE_USE_DEBUG_MALLOC)
 
             /* If memory still allocated, print a trace and return an error */
@@ -94,3 +94,27 @@ int oe_emulate_cpuid(uint64_t* rax, uint64_t* rbx, uint64_t* rcx, uint64_t* rdx)
     }
     return -1;
 }
+
+int oe_get_cpuid_leaf(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t regs[OE_CPUID_REG_COUNT])
+{
+    uint64_t rax = leaf;
+    uint64_t rbx = 0;
+    uint64_t rcx = subleaf;
+    uint64_t rdx = 0;
+
+    // The highest basic leaf is 0 until oe_initialize_cpuid() has run.
+    if (!regs || _cpuid_table[0][OE_CPUID_RAX] == 0)
+        return -1;
+
+    if (oe_emulate_cpuid(&rax, &rbx, &rcx, &rdx) != 0)
+        return -1;
+
+    regs[OE_CPUID_RAX] = (uint32_t)rax;
+    regs[OE_CPUID_RBX] = (uint32_t)rbx;
+    regs[OE_CPUID_RCX] = (uint32_t)rcx;
+    regs[OE_CPUID_RDX] = (uint32_t)rdx;
+    return 0;
+}
@@ -50,6 +50,8 @@ void* oe_ecall_context_get_ocall_buffer(uint64_t size)
 // Function used by oeedger8r for allocating ocall buffers.
 void* oe_allocate_ocall_buffer(size_t size)
 {
+    oe_ecall_context_t* ecall_context = NULL;
+
     // Fetch the ecall context's ocall buffer if it is equal to or larger than
     // given size. Use it if available.
     void* buffer = oe_ecall_context_get_ocall_buffer(size);
@@ -58,6 +60,16 @@ void* oe_allocate_ocall_buffer(size_t size)
         return buffer;
     }
 
+    // Let the host know, so that it grows the buffer for the next ECALLs. The
+    // counters are only used by the host.
+    if ((ecall_context = _get_ecall_context()))
+    {
+        ecall_context->ocall_buffer_fallbacks++;
+        ecall_context->ocall_buffer_fallback_bytes += size;
+        if (size > ecall_context->ocall_buffer_wanted_size)
+            ecall_context->ocall_buffer_wanted_size = size;
+    }
+
     // Perform host allocation by making an ocall.
     return oe_host_malloc(size);
 }
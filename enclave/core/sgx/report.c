@@ -13,6 +13,8 @@
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/safemath.h>
 #include <openenclave/internal/sgx/plugin.h>
+#include <openenclave/internal/sgx/quotestats.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "platform_t.h"
 
@@ -36,6 +38,15 @@ oe_result_t _oe_get_quote_ocall(
     void* quote,
     size_t quote_size,
     size_t* quote_size_out);
+oe_result_t _oe_get_quotes_ocall(
+    oe_result_t* _retval,
+    const oe_uuid_t* format_id,
+    const sgx_report_t* reports,
+    size_t report_count,
+    void* quotes,
+    size_t quotes_size,
+    size_t* quote_size_out,
+    oe_result_t* results);
 
 /**
  * Make the following OCALLs weak to support the system EDL opt-in.
@@ -88,8 +99,65 @@ oe_result_t _oe_get_quote_ocall(
 }
 OE_WEAK_ALIAS(_oe_get_quote_ocall, oe_get_quote_ocall);
 
+oe_result_t _oe_get_quotes_ocall(
+    oe_result_t* _retval,
+    const oe_uuid_t* format_id,
+    const sgx_report_t* reports,
+    size_t report_count,
+    void* quotes,
+    size_t quotes_size,
+    size_t* quote_size_out,
+    oe_result_t* results)
+{
+    OE_UNUSED(format_id);
+    OE_UNUSED(reports);
+    OE_UNUSED(report_count);
+    OE_UNUSED(quotes);
+    OE_UNUSED(quotes_size);
+    OE_UNUSED(quote_size_out);
+    OE_UNUSED(results);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_get_quotes_ocall, oe_get_quotes_ocall);
+
 #endif
 
+/* Maximum number of quotes requested from the host in one OCALL */
+#define MAX_QUOTE_BATCH 16
+
+/* Target info of the QE, cached until a quote made with it fails */
+static sgx_target_info_t _qe_target_info;
+static oe_uuid_t _qe_target_info_format_id;
+static bool _qe_target_info_valid;
+static oe_spinlock_t _qe_target_info_lock = OE_SPINLOCK_INITIALIZER;
+
+/* A quote requested by a thread, until a thread gets it from the host */
+typedef struct _quote_request
+{
+    const oe_uuid_t* format_id;
+    const sgx_report_t* report;
+    uint8_t* quote;
+    size_t* quote_size;
+    oe_result_t result;
+    bool done;
+    struct _quote_request* next;
+} quote_request_t;
+
+/* Quotes requested while another thread is waiting for the host, which are
+ * requested together by the next thread once it returns */
+static quote_request_t* _quote_requests;
+static quote_request_t* _quote_requests_tail;
+static bool _quote_requests_busy;
+static oe_mutex_t _quote_requests_lock = OE_MUTEX_INITIALIZER;
+static oe_cond_t _quote_requests_cond = OE_COND_INITIALIZER;
+
+/* Counters returned by oe_sgx_get_quote_stats() */
+static oe_sgx_quote_stats_t _quote_stats;
+
 OE_STATIC_ASSERT(OE_REPORT_DATA_SIZE == sizeof(sgx_report_data_t));
 
 OE_STATIC_ASSERT(sizeof(oe_identity_t) == 96);
@@ -199,15 +267,52 @@ static oe_result_t _get_sgx_target_info(
     const oe_uuid_t* format_id,
     const void* opt_params,
     size_t opt_params_size,
-    sgx_target_info_t* target_info)
+    bool refresh,
+    sgx_target_info_t* target_info,
+    bool* cached)
 {
     oe_result_t result = OE_UNEXPECTED;
     uint32_t retval;
 
+    *cached = false;
+
+    oe_spin_lock(&_qe_target_info_lock);
+    if (refresh)
+    {
+        _qe_target_info_valid = false;
+    }
+    else if (
+        _qe_target_info_valid &&
+        memcmp(&_qe_target_info_format_id, format_id, sizeof(*format_id)) ==
+            0)
+    {
+        *target_info = _qe_target_info;
+        *cached = true;
+    }
+    oe_spin_unlock(&_qe_target_info_lock);
+
+    if (*cached)
+    {
+        __atomic_add_fetch(
+            &_quote_stats.target_info_hits, 1, __ATOMIC_RELAXED);
+        result = OE_OK;
+        goto done;
+    }
+
+    __atomic_add_fetch(&_quote_stats.target_info_fetches, 1, __ATOMIC_RELAXED);
     OE_CHECK(oe_get_qetarget_info_ocall(
         &retval, format_id, opt_params, opt_params_size, target_info));
     result = (oe_result_t)retval;
 
+    if (result == OE_OK)
+    {
+        oe_spin_lock(&_qe_target_info_lock);
+        _qe_target_info = *target_info;
+        _qe_target_info_format_id = *format_id;
+        _qe_target_info_valid = true;
+        oe_spin_unlock(&_qe_target_info_lock);
+    }
+
 done:
     if (result == OE_UNSUPPORTED)
         OE_TRACE_WARNING(
@@ -234,6 +339,11 @@ static oe_result_t _get_quote(
     // as OE_BUFFER_TOO_SMALL.
     if (quote == NULL)
         *quote_size = 0;
+    else
+    {
+        __atomic_add_fetch(&_quote_stats.quote_calls, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&_quote_stats.quotes, 1, __ATOMIC_RELAXED);
+    }
 
     OE_CHECK(oe_get_quote_ocall(
         &retval,
@@ -256,6 +366,208 @@ done:
     return result;
 }
 
+/* Get the quotes of several requests with the same format in one OCALL */
+static void _get_quotes(quote_request_t** requests, size_t count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint32_t retval;
+    sgx_report_t* reports = NULL;
+    uint8_t* quotes = NULL;
+    oe_result_t* results = NULL;
+    size_t slot_size = 0;
+    size_t quotes_size = 0;
+    size_t quote_size = 0;
+    size_t total_size = 0;
+
+    if (count == 1)
+    {
+        requests[0]->result = _get_quote(
+            requests[0]->format_id,
+            NULL,
+            0,
+            requests[0]->report,
+            requests[0]->quote,
+            requests[0]->quote_size);
+        return;
+    }
+
+    /* Each quote gets a slot as large as the largest buffer supplied */
+    for (size_t i = 0; i < count; i++)
+    {
+        if (*requests[i]->quote_size > slot_size)
+            slot_size = *requests[i]->quote_size;
+    }
+
+    if (slot_size > OE_MAX_REPORT_SIZE)
+        slot_size = OE_MAX_REPORT_SIZE;
+
+    OE_CHECK(oe_safe_mul_sizet(count, slot_size, &quotes_size));
+
+    if (!(reports = oe_calloc(count, sizeof(*reports))) ||
+        !(quotes = oe_calloc(1, quotes_size)) ||
+        !(results = oe_calloc(count, sizeof(*results))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < count; i++)
+        reports[i] = *requests[i]->report;
+
+    __atomic_add_fetch(&_quote_stats.quote_calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&_quote_stats.quotes, count, __ATOMIC_RELAXED);
+
+    OE_CHECK(oe_get_quotes_ocall(
+        &retval,
+        requests[0]->format_id,
+        reports,
+        count,
+        quotes,
+        quotes_size,
+        &quote_size,
+        results));
+    result = (oe_result_t)retval;
+
+    if (result != OE_OK && result != OE_BUFFER_TOO_SMALL)
+        OE_RAISE(result);
+
+    /* The host packs the quotes one after the other, with the size it
+     * returns. Make sure that they lie within the buffer before reading
+     * them. */
+    if (result == OE_OK)
+    {
+        if (quote_size > slot_size)
+            OE_RAISE(OE_UNEXPECTED);
+
+        OE_CHECK(oe_safe_mul_sizet(count, quote_size, &total_size));
+        if (total_size > quotes_size)
+            OE_RAISE(OE_UNEXPECTED);
+    }
+
+    /* The host returns OE_BUFFER_TOO_SMALL when the quotes are larger than
+     * every buffer supplied */
+    for (size_t i = 0; i < count; i++)
+    {
+        quote_request_t* request = requests[i];
+
+        if (result == OE_BUFFER_TOO_SMALL || *request->quote_size < quote_size)
+        {
+            request->result = OE_BUFFER_TOO_SMALL;
+        }
+        else if ((request->result = results[i]) == OE_OK)
+        {
+            memcpy(request->quote, quotes + i * quote_size, quote_size);
+        }
+
+        *request->quote_size = quote_size;
+    }
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK)
+    {
+        for (size_t i = 0; i < count; i++)
+            requests[i]->result = result;
+    }
+
+    oe_free(results);
+    oe_free(quotes);
+    oe_free(reports);
+}
+
+/**
+ * Get the quote of a report. The quotes requested by other threads while the
+ * host is busy getting the quote of a thread are requested together, once it
+ * returns, in a single OCALL.
+ */
+static oe_result_t _get_quote_batched(
+    const oe_uuid_t* format_id,
+    const sgx_report_t* sgx_report,
+    uint8_t* quote,
+    size_t* quote_size)
+{
+    quote_request_t request = {0};
+    quote_request_t* batch[MAX_QUOTE_BATCH];
+    quote_request_t** p;
+    const oe_uuid_t* batch_format_id;
+    size_t count;
+
+    request.format_id = format_id;
+    request.report = sgx_report;
+    request.quote = quote;
+    request.quote_size = quote_size;
+    request.result = OE_UNEXPECTED;
+
+    oe_mutex_lock(&_quote_requests_lock);
+
+    if (_quote_requests_tail)
+        _quote_requests_tail->next = &request;
+    else
+        _quote_requests = &request;
+    _quote_requests_tail = &request;
+
+    while (!request.done)
+    {
+        if (_quote_requests_busy)
+        {
+            oe_cond_wait(&_quote_requests_cond, &_quote_requests_lock);
+            continue;
+        }
+
+        /* Take the oldest requests with the same format */
+        count = 0;
+        batch_format_id = _quote_requests->format_id;
+        _quote_requests_tail = NULL;
+
+        for (p = &_quote_requests; *p;)
+        {
+            if (count < MAX_QUOTE_BATCH &&
+                memcmp((*p)->format_id, batch_format_id, sizeof(oe_uuid_t)) ==
+                    0)
+            {
+                batch[count++] = *p;
+                *p = (*p)->next;
+            }
+            else
+            {
+                _quote_requests_tail = *p;
+                p = &(*p)->next;
+            }
+        }
+
+        _quote_requests_busy = true;
+        oe_mutex_unlock(&_quote_requests_lock);
+
+        _get_quotes(batch, count);
+
+        oe_mutex_lock(&_quote_requests_lock);
+        _quote_requests_busy = false;
+
+        for (size_t i = 0; i < count; i++)
+            batch[i]->done = true;
+
+        oe_cond_broadcast(&_quote_requests_cond);
+    }
+
+    oe_mutex_unlock(&_quote_requests_lock);
+
+    return request.result;
+}
+
+oe_result_t oe_sgx_get_quote_stats(oe_sgx_quote_stats_t* stats)
+{
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    stats->target_info_fetches =
+        __atomic_load_n(&_quote_stats.target_info_fetches, __ATOMIC_RELAXED);
+    stats->target_info_hits =
+        __atomic_load_n(&_quote_stats.target_info_hits, __ATOMIC_RELAXED);
+    stats->quote_calls =
+        __atomic_load_n(&_quote_stats.quote_calls, __ATOMIC_RELAXED);
+    stats->quotes = __atomic_load_n(&_quote_stats.quotes, __ATOMIC_RELAXED);
+
+    return OE_OK;
+}
+
 oe_result_t oe_get_remote_report(
     const oe_uuid_t* format_id,
     const uint8_t* report_data,
@@ -270,6 +582,8 @@ oe_result_t oe_get_remote_report(
     sgx_report_t sgx_report = {{{0}}};
     size_t sgx_report_size = sizeof(sgx_report);
     sgx_quote_t* sgx_quote = NULL;
+    bool cached = false;
+    bool refresh = false;
 
     // For remote attestation, the Quoting Enclave's target info is used.
     // opt_params must not be supplied.
@@ -277,36 +591,70 @@ oe_result_t oe_get_remote_report(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /*
-     * OCall: Get target info from Quoting Enclave.
-     * This involves a call to host. The target provided by targetinfo does not
-     * need to be trusted because returning a report is not an operation that
-     * requires privacy. The trust decision is one of integrity verification
-     * on the part of the report recipient.
+     * Without a buffer, only the size of the quote is returned, which does
+     * not depend on the report.
      */
-    OE_CHECK(_get_sgx_target_info(
-        format_id, opt_params, opt_params_size, &sgx_target_info));
+    if (report_buffer == NULL)
+    {
+        result = _get_quote(
+            format_id,
+            opt_params,
+            opt_params_size,
+            &sgx_report,
+            NULL,
+            report_buffer_size);
+        if (result == OE_BUFFER_TOO_SMALL)
+            OE_RAISE_NO_TRACE(result);
 
-    /*
-     * Get enclave's local report passing in the quoting enclave's target info.
-     */
-    OE_CHECK(_get_local_report(
-        report_data,
-        report_data_size,
-        &sgx_target_info,
-        sizeof(sgx_target_info),
-        &sgx_report,
-        &sgx_report_size));
+        OE_RAISE(result == OE_OK ? OE_UNEXPECTED : result);
+    }
+
+    for (;;)
+    {
+        /*
+         * OCall: Get target info from Quoting Enclave, unless it is cached.
+         * This involves a call to host. The target provided by targetinfo
+         * does not need to be trusted because returning a report is not an
+         * operation that requires privacy. The trust decision is one of
+         * integrity verification on the part of the report recipient.
+         */
+        OE_CHECK(_get_sgx_target_info(
+            format_id,
+            opt_params,
+            opt_params_size,
+            refresh,
+            &sgx_target_info,
+            &cached));
+
+        /*
+         * Get enclave's local report passing in the quoting enclave's target
+         * info.
+         */
+        OE_CHECK(_get_local_report(
+            report_data,
+            report_data_size,
+            &sgx_target_info,
+            sizeof(sgx_target_info),
+            &sgx_report,
+            &sgx_report_size));
+
+        /*
+         * OCall: Get the quote for the local report, along with the quotes
+         * requested by other threads in the meantime.
+         */
+        result = _get_quote_batched(
+            format_id, &sgx_report, report_buffer, report_buffer_size);
+
+        /*
+         * The QE may have changed since its target info was cached, in which
+         * case the quote is retried once with its current target info.
+         */
+        if (result == OE_OK || result == OE_BUFFER_TOO_SMALL || !cached)
+            break;
+
+        refresh = true;
+    }
 
-    /*
-     * OCall: Get the quote for the local report.
-     */
-    result = _get_quote(
-        format_id,
-        opt_params,
-        opt_params_size,
-        &sgx_report,
-        report_buffer,
-        report_buffer_size);
     if (result == OE_BUFFER_TOO_SMALL)
         OE_CHECK_NO_TRACE(result);
     else
@@ -28,4 +28,13 @@ oe_result_t oe_get_report_v2_internal(
     uint8_t** report_buffer,
     size_t* report_buffer_size);
 
+oe_result_t oe_get_remote_report(
+    const oe_uuid_t* format_id,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    uint8_t* report_buffer,
+    size_t* report_buffer_size);
+
 #endif /* _OE_ENCLAVE_CORE_REPORT_H */
@@ -7,6 +7,7 @@
 #include <openenclave/internal/atomic.h>
 #include <openenclave/internal/defs.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
 #include <openenclave/internal/utils.h>
 #include "arena.h"
 #include "handle_ecall.h"
@@ -18,6 +19,13 @@ static size_t _host_worker_count = 0;
 // The array of host worker contexts. Initialized by host through ECALL
 static oe_host_worker_context_t* _host_worker_contexts = NULL;
 
+// The queue of switchless ocalls shared by all host workers. The slot array
+// and its capacity are stashed in enclave memory at initialization so that
+// the host cannot redirect the enclave's writes by tampering with the header.
+static oe_switchless_ocall_queue_t* _ocall_queue = NULL;
+static oe_switchless_ocall_slot_t* _ocall_queue_slots = NULL;
+static uint64_t _ocall_queue_mask = 0;
+
 // Flag to denote if switchless calls have already been initialized.
 static bool _is_switchless_initialized = false;
 
@@ -101,10 +109,14 @@ bool oe_is_switchless_initialized()
 */
 oe_result_t oe_sgx_init_context_switchless_ecall(
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers)
+    uint64_t num_host_workers,
+    oe_switchless_ocall_queue_t* ocall_queue)
 {
     oe_result_t result = OE_UNEXPECTED;
     uint64_t contexts_size = 0;
+    oe_switchless_ocall_slot_t* slots = NULL;
+    uint64_t capacity = 0;
+    uint64_t slots_size = 0;
 
     if (!oe_atomic_compare_and_swap(
             &_switchless_init_in_progress, (int64_t) false, (int64_t) true))
@@ -126,12 +138,32 @@ oe_result_t oe_sgx_init_context_switchless_ecall(
         OE_RAISE(OE_INVALID_PARAMETER);
     }
 
+    // Ensure the queue header is outside of enclave.
+    if (!oe_is_outside_enclave(ocall_queue, sizeof(*ocall_queue)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Read the slot array and capacity exactly once.
+    slots = *(oe_switchless_ocall_slot_t* volatile*)&ocall_queue->slots;
+    capacity = *(volatile uint64_t*)&ocall_queue->capacity;
+
+    // The capacity must be a non-zero power of two and the slots must lie
+    // outside of enclave.
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_u64(capacity, sizeof(*slots), &slots_size));
+    if (!oe_is_outside_enclave(slots, slots_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
     /* lfence after checks. */
     oe_lfence();
 
     // Stash host worker information in enclave memory.
     _host_worker_count = num_host_workers;
     _host_worker_contexts = host_worker_contexts;
+    _ocall_queue = ocall_queue;
+    _ocall_queue_slots = slots;
+    _ocall_queue_mask = capacity - 1;
 
     __atomic_store_n(&_is_switchless_initialized, true, __ATOMIC_SEQ_CST);
 
@@ -146,80 +178,161 @@ done:
 /*
 **==============================================================================
 **
-** oe_post_switchless_ocall()
+** _enqueue_switchless_ocall()
 **
-**  Post the function call (wrapped in args) to a free host worker thread
-**  by writing to its context.
+**  Append the function call to the queue shared by the host workers and
+**  return its position in the queue. Returns false if the queue is full.
+**  See _dequeue_switchless_ocall in host/sgx/switchless.c for the meaning of
+**  the slot sequence numbers.
 **
 **==============================================================================
 */
-oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
+static bool _enqueue_switchless_ocall(
+    oe_call_host_function_args_t* args,
+    uint64_t* pos_out)
 {
-    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_ocall_slot_t* slot = NULL;
+    uint64_t pos =
+        __atomic_load_n(&_ocall_queue->enqueue_pos, __ATOMIC_RELAXED);
 
-    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
-    args->result = __OE_RESULT_MAX; // Means the call hasn't been processed.
+    while (true)
+    {
+        // Index with the enclave's copy of the mask so that a tampered
+        // position can never address memory outside the slot array.
+        slot = &_ocall_queue_slots[pos & _ocall_queue_mask];
+        int64_t diff =
+            (int64_t)__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) -
+            (int64_t)pos;
+
+        if (diff == 0)
+        {
+            // The slot is free. Try to claim it.
+            bool weak = true;
+            if (__atomic_compare_exchange_n(
+                    &_ocall_queue->enqueue_pos,
+                    &pos,
+                    pos + 1,
+                    weak,
+                    __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The slot has not been consumed yet. Queue is full.
+            return false;
+        }
+        else
+        {
+            // Another thread claimed the slot. Reload the position.
+            pos = __atomic_load_n(&_ocall_queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->call_arg = args;
 
-    // Cycle through the worker contexts until we find a free worker.
-    size_t tries = _host_worker_count;
-    while (tries--)
+    // Publish the call to the host workers. A full barrier is needed so that
+    // the subsequent reads of the worker events are not reordered before it.
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_SEQ_CST);
+
+    *pos_out = pos;
+    return true;
+}
+
+/*
+**==============================================================================
+**
+** _wake_switchless_worker()
+**
+**  Make sure that enough host workers are idle to service the calls that are
+**  pending in the queue, up to and including the call posted at pos.
+**
+**==============================================================================
+*/
+static void _wake_switchless_worker(uint64_t pos)
+{
+    uint64_t num_pending =
+        pos + 1 - __atomic_load_n(&_ocall_queue->dequeue_pos, __ATOMIC_SEQ_CST);
+    uint64_t num_idle = 0;
+
+    // If event is 1, the worker is awake and is guaranteed to scan the queue
+    // at least once more before it can go to sleep. A busy worker is not
+    // counted: the call it is handling may block, possibly until one of the
+    // pending calls returns. Since the worker marks itself busy before taking
+    // a call, an idle worker has not taken any call from the queue yet and
+    // will see the call posted at pos when it scans the queue.
+    for (size_t i = 0; i < _host_worker_count; i++)
     {
-        // Check if the worker's slot is free.
-        if (_host_worker_contexts[tries].call_arg == NULL)
+        oe_host_worker_context_t* context = &_host_worker_contexts[i];
+
+        if (__atomic_load_n(&context->event, __ATOMIC_SEQ_CST) &&
+            !__atomic_load_n(&context->is_busy, __ATOMIC_SEQ_CST))
+            num_idle++;
+    }
+
+    if (num_idle >= num_pending)
+        return;
+
+    // Wake one of the sleeping workers.
+    //
+    // If event is 0, it means that it has gone to sleep. Wake it by
+    // making an ocall (oe_sgx_wake_switchless_worker_ocall).
+    // Note: it is important to use an atomic cas operation to set
+    // the value to 1 before making the ocall. Setting the value to
+    // 1 prevents the host worker from simulataneously going to
+    // sleep. If instead, just a compare operation is used to
+    // determine if the host thread is sleeping or not, the host
+    // thread could go to sleep after the enclave has determined
+    // that the host is not sleeping, causing a deadlock.
+    //
+    // If event is 1, that indicates a pending wake notification.
+    for (size_t i = 0; i < _host_worker_count; i++)
+    {
+        int32_t oldval = 0;
+        int32_t newval = 1;
+        // Weak operation could sporadically fail.
+        // We need a strong operation.
+        bool weak = false;
+        if (__atomic_compare_exchange_n(
+                &_host_worker_contexts[i].event,
+                &oldval,
+                newval,
+                weak,
+                __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE))
         {
-            // Try to atomically grab the slot by placing args in the slot.
-            // If the atomic operation was successful, then the worker thread
-            // will execute this switchless ocall. If the atomic operation
-            // failed, this means that the slot was grabbed by another
-            // switchless ocall and therefore, we must scan for another worker
-            // thread with a free slot.
-            if (oe_atomic_compare_and_swap_ptr(
-                    (void* volatile*)&_host_worker_contexts[tries].call_arg,
-                    NULL,
-                    args))
-            {
-                // The worker thread has been marked to execute this switchless
-                // call. Determine if it needs to be woken up or not.
-                //
-                // If event is 0, it means that it has gone to sleep. Wake it by
-                // making an ocall (oe_sgx_wake_switchless_worker_ocall).
-                // Note: it is important to use an atomic cas operation to set
-                // the value to 1 before making the ocall. Setting the value to
-                // 1 prevents the host worker from simulataneously going to
-                // sleep. If instead, just a compare operation is used to
-                // determine if the host thread is sleeping or not, the host
-                // thread could go to sleep after the enclave has determined
-                // that the host is not sleeping, causing a deadlock.
-                //
-                // If event is 1, that indicates a pending wake notification.
-                int32_t oldval = 0;
-                int32_t newval = 1;
-                // Weak operation could sporadically fail.
-                // We need a strong operation.
-                bool weak = false;
-                if (__atomic_compare_exchange_n(
-                        &_host_worker_contexts[tries].event,
-                        &oldval,
-                        newval,
-                        weak,
-                        __ATOMIC_ACQ_REL,
-                        __ATOMIC_ACQUIRE))
-                {
-                    // The pevious value of the event was 0 which means that the
-                    // worker was previously sleeping.
-                    // Wake it via an ocall.
-                    oe_sgx_wake_switchless_worker_ocall(
-                        &_host_worker_contexts[tries]);
-                }
-
-                return OE_OK;
-            }
+            // The pevious value of the event was 0 which means that the
+            // worker was previously sleeping.
+            // Wake it via an ocall.
+            oe_sgx_wake_switchless_worker_ocall(&_host_worker_contexts[i]);
+            break;
         }
     }
+}
 
-    result = OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+/*
+**==============================================================================
+**
+** oe_post_switchless_ocall()
+**
+**  Post the function call (wrapped in args) to the queue shared by the host
+**  worker threads.
+**
+**==============================================================================
+*/
+oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
+{
+    uint64_t pos = 0;
 
-    return result;
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    args->result = __OE_RESULT_MAX; // Means the call hasn't been processed.
+
+    if (!_enqueue_switchless_ocall(args, &pos))
+        return OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
+
+    _wake_switchless_worker(pos);
+
+    return OE_OK;
 }
 
 /*
@@ -259,7 +372,8 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
     // Prevent speculative execution.
     oe_lfence();
 
-    const uint64_t spin_count_threshold = context->spin_count_threshold;
+    // The host adapts the threshold while the worker sleeps.
+    uint64_t spin_count_threshold = context->spin_count_threshold;
     while (!context->is_stopping)
     {
         volatile oe_call_enclave_function_args_t* local_call_arg = NULL;
@@ -275,6 +389,7 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
             // as free by clearing the slot.
             OE_ATOMIC_MEMORY_BARRIER_RELEASE();
             context->call_arg = NULL;
+            context->total_call_count++;
 
             // Reset spin count for next message.
             context->total_spin_count += context->spin_count;
@@ -292,6 +407,7 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
 
                 // Make an ocall to sleep until messages arrive.
                 oe_sgx_sleep_switchless_worker_ocall(context);
+                spin_count_threshold = context->spin_count_threshold;
             }
 
             // In Release builds, the following pause has been observed to be
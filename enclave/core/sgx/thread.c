@@ -9,6 +9,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
 #include "platform_t.h"
 #include "td.h"
 
@@ -56,6 +57,84 @@ done:
     return ret;
 }
 
+/* Maximum number of threads woken by a single ocall */
+#define OE_THREAD_WAKE_BATCH_SIZE 32
+
+/* Wake the threads on the list that starts with front. Waking more than one
+ * thread is done with a single ocall per batch instead of one per thread. */
+static void _thread_wake_list(oe_sgx_td_t* front)
+{
+    uint64_t tcs[OE_THREAD_WAKE_BATCH_SIZE];
+    size_t count = 0;
+    oe_sgx_td_t* next;
+
+    if (front && !front->next)
+    {
+        _thread_wake(front);
+        return;
+    }
+
+    for (oe_sgx_td_t* p = front; p; p = next)
+    {
+        // p could wake up and immediately use a synchronization
+        // primitive that could modify the next field.
+        // Therefore fetch the next thread before waking up p.
+        next = p->next;
+        tcs[count++] = (uint64_t)td_to_tcs(p);
+
+        if (count == OE_COUNTOF(tcs) || !next)
+        {
+            oe_sgx_thread_wake_multiple_ocall(oe_get_enclave(), tcs, count);
+            count = 0;
+        }
+    }
+}
+
+/*
+**==============================================================================
+**
+** Adaptive spinning:
+**
+**     A thread that finds a lock held spins for a while before it parks
+**     itself on the host, since parking and waking each cost an enclave
+**     exit. The number of spins is bounded by twice the number of spins that
+**     the thread needed recently, so threads whose locks are held for long
+**     periods soon stop wasting cycles.
+**
+**==============================================================================
+*/
+
+#define OE_LOCK_MIN_SPINS 100
+#define OE_LOCK_MAX_SPINS 1000
+
+/* Spin until ready(arg) returns true or the spin budget of the thread is
+ * exhausted. Returns the value of the last call to ready(). */
+static bool _spin_until(
+    oe_sgx_td_t* self,
+    bool (*ready)(const void* arg),
+    const void* arg)
+{
+    uint32_t max_spins = 2 * self->lock_spins + OE_LOCK_MIN_SPINS;
+    uint32_t spins = 0;
+    bool result;
+
+    if (max_spins > OE_LOCK_MAX_SPINS)
+        max_spins = OE_LOCK_MAX_SPINS;
+
+    while (!(result = ready(arg)) && spins < max_spins)
+    {
+        OE_CPU_RELAX();
+        spins++;
+    }
+
+    /* Move the estimate an eighth of the way towards this sample */
+    self->lock_spins =
+        (uint32_t)((int32_t)self->lock_spins +
+                   ((int32_t)spins - (int32_t)self->lock_spins) / 8);
+
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -214,10 +293,21 @@ static int _mutex_lock(oe_mutex_impl_t* m, oe_sgx_td_t* self)
     return -1;
 }
 
+/* Whether spinning on the mutex should stop: either it is free or there
+ * are parked threads, which will obtain it first anyway */
+static bool _mutex_spin_ready(const void* arg)
+{
+    const oe_mutex_impl_t* m = (const oe_mutex_impl_t*)arg;
+
+    return __atomic_load_n(&m->owner, __ATOMIC_RELAXED) == NULL ||
+           __atomic_load_n(&m->queue.front, __ATOMIC_RELAXED) != NULL;
+}
+
 oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
 {
     oe_mutex_impl_t* m = (oe_mutex_impl_t*)mutex;
     oe_sgx_td_t* self = oe_sgx_get_td();
+    bool spun = false;
 
     if (!m)
         return OE_INVALID_PARAMETER;
@@ -234,6 +324,16 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
                 return OE_OK;
             }
 
+            /* Spin once before joining the waiters queue, unless other
+             * threads are already parked on it */
+            if (!spun && m->queue.front == NULL)
+            {
+                oe_spin_unlock(&m->lock);
+                spun = true;
+                _spin_until(self, _mutex_spin_ready, m);
+                continue;
+            }
+
             /* If the waiters queue does not contain this thread */
             if (!_queue_contains(&m->queue, self))
             {
@@ -488,15 +588,7 @@ oe_result_t oe_cond_broadcast(oe_cond_t* condition)
     }
     oe_spin_unlock(&cond->lock);
 
-    oe_sgx_td_t* p_next = NULL;
-    for (oe_sgx_td_t* p = waiters.front; p; p = p_next)
-    {
-        // p could wake up and immediately use a synchronization
-        // primitive that could modify the next field.
-        // Therefore fetch the next thread before waking up p.
-        p_next = p->next;
-        _thread_wake(p);
-    }
+    _thread_wake_list(waiters.front);
 
     return OE_OK;
 }
@@ -528,6 +620,21 @@ typedef struct _oe_rwlock_impl
 
 OE_STATIC_ASSERT(sizeof(oe_rwlock_impl_t) <= sizeof(oe_rwlock_t));
 
+static bool _rwlock_spin_ready_for_reader(const void* arg)
+{
+    const oe_rwlock_impl_t* rw_lock = (const oe_rwlock_impl_t*)arg;
+
+    return __atomic_load_n(&rw_lock->writer, __ATOMIC_RELAXED) == NULL;
+}
+
+static bool _rwlock_spin_ready_for_writer(const void* arg)
+{
+    const oe_rwlock_impl_t* rw_lock = (const oe_rwlock_impl_t*)arg;
+
+    return __atomic_load_n(&rw_lock->writer, __ATOMIC_RELAXED) == NULL &&
+           __atomic_load_n(&rw_lock->readers, __ATOMIC_RELAXED) == 0;
+}
+
 oe_result_t oe_rwlock_init(oe_rwlock_t* read_write_lock)
 {
     oe_rwlock_impl_t* rw_lock = (oe_rwlock_impl_t*)read_write_lock;
@@ -554,6 +661,14 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
 
     oe_spin_lock(&rw_lock->lock);
 
+    // Spin for a while before waiting for the writer on the host.
+    if (rw_lock->writer != NULL && rw_lock->writer != self)
+    {
+        oe_spin_unlock(&rw_lock->lock);
+        _spin_until(self, _rwlock_spin_ready_for_reader, rw_lock);
+        oe_spin_lock(&rw_lock->lock);
+    }
+
     // Wait for writer to finish.
     // Multiple readers can concurrently operate.
     while (rw_lock->writer != NULL)
@@ -619,8 +734,7 @@ static oe_result_t _wake_waiters(oe_rwlock_impl_t* rw_lock)
 
     // Wake the waiters in FIFO order. However actual acquisition of the lock
     // will be dependent on OS scheduling of the threads.
-    while ((p = _queue_pop_front(&waiters)))
-        _thread_wake(p);
+    _thread_wake_list(waiters.front);
 
     return OE_OK;
 }
@@ -669,6 +783,14 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
         return OE_BUSY;
     }
 
+    // Spin for a while before waiting for the owners on the host.
+    if (rw_lock->readers > 0 || rw_lock->writer != NULL)
+    {
+        oe_spin_unlock(&rw_lock->lock);
+        _spin_until(self, _rwlock_spin_ready_for_writer, rw_lock);
+        oe_spin_lock(&rw_lock->lock);
+    }
+
     // Wait for all readers and any other writer to finish.
     while (rw_lock->readers > 0 || rw_lock->writer != NULL)
     {
@@ -8,8 +8,10 @@
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
+#include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/calls.h>
+#include <openenclave/internal/logring.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/safemath.h>
@@ -21,6 +23,14 @@ static oe_log_level_t _active_log_level = OE_LOG_LEVEL_ERROR;
 static char _enclave_filename[OE_MAX_FILENAME_LEN];
 static bool _debug_allowed_enclave = false;
 
+// The log ring shared with the host, if any. The entry array and its capacity
+// are stashed in enclave memory at initialization so that the host cannot
+// redirect the enclave's writes by tampering with the header.
+static oe_log_ring_t* _log_ring = NULL;
+static uint32_t _log_ring_claimed = 0;
+static oe_log_ring_entry_t* _log_ring_entries = NULL;
+static uint64_t _log_ring_mask = 0;
+
 const char* get_filename_from_path(const char* path)
 {
     if (path)
@@ -72,12 +82,160 @@ void oe_log_init_ecall(const char* enclave_path, uint32_t log_level)
     _debug_allowed_enclave = is_enclave_debug_allowed();
 }
 
+/*
+**==============================================================================
+**
+** oe_log_init_ring_ecall()
+**
+** Make oe_log() post the messages to the log ring allocated by the host.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_log_init_ring_ecall(oe_log_ring_t* log_ring)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_log_ring_entry_t* entries = NULL;
+    uint64_t capacity = 0;
+    uint64_t entries_size = 0;
+    uint32_t unclaimed = 0;
+    bool claimed = false;
+
+    // Claim the ring before setting the entries and the mask, so that
+    // concurrent calls cannot both set them.
+    if (!__atomic_compare_exchange_n(
+            &_log_ring_claimed,
+            &unclaimed,
+            1,
+            false,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+        OE_RAISE(OE_ALREADY_INITIALIZED);
+
+    claimed = true;
+
+    // Ensure the ring header is outside of enclave.
+    if (!oe_is_outside_enclave(log_ring, sizeof(*log_ring)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Read the entry array and capacity exactly once.
+    entries = *(oe_log_ring_entry_t* volatile*)&log_ring->entries;
+    capacity = *(volatile uint64_t*)&log_ring->capacity;
+
+    // The capacity must be a non-zero power of two and the entries must lie
+    // outside of enclave.
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_u64(capacity, sizeof(*entries), &entries_size));
+    if (!oe_is_outside_enclave(entries, entries_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* lfence after checks. */
+    oe_lfence();
+
+    _log_ring_entries = entries;
+    _log_ring_mask = capacity - 1;
+
+    // Publish the ring last so that oe_log() sees the entries and the mask.
+    __atomic_store_n(&_log_ring, log_ring, __ATOMIC_RELEASE);
+
+    result = OE_OK;
+
+done:
+    // Let a later call set up a valid ring.
+    if (result != OE_OK && claimed)
+        __atomic_store_n(&_log_ring_claimed, 0, __ATOMIC_RELEASE);
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _claim_log_ring_entry()
+**
+**  Claim the entry at the enqueue position of the log ring. Returns NULL if
+**  the ring is full. The sequence number of an entry is its position while it
+**  is free and its position + 1 once it holds a message.
+**
+**==============================================================================
+*/
+static oe_log_ring_entry_t* _claim_log_ring_entry(
+    oe_log_ring_t* ring,
+    uint64_t* pos_out)
+{
+    oe_log_ring_entry_t* entry = NULL;
+    uint64_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+
+    while (true)
+    {
+        // Index with the enclave's copy of the mask so that a tampered
+        // position can never address memory outside the entry array.
+        entry = &_log_ring_entries[pos & _log_ring_mask];
+        int64_t diff =
+            (int64_t)__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) -
+            (int64_t)pos;
+
+        if (diff == 0)
+        {
+            // The entry is free. Try to claim it.
+            bool weak = true;
+            if (__atomic_compare_exchange_n(
+                    &ring->enqueue_pos,
+                    &pos,
+                    pos + 1,
+                    weak,
+                    __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The entry has not been drained yet. The ring is full.
+            return NULL;
+        }
+        else
+        {
+            // Another thread claimed the entry. Reload the position.
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *pos_out = pos;
+    return entry;
+}
+
+// Format the message prefixed with the name of the enclave file into a
+// buffer of OE_LOG_MESSAGE_LEN_MAX bytes.
+static bool _format_message(char* message, const char* fmt, oe_va_list ap)
+{
+    int bytes_written = 0;
+    int n = 0;
+
+    bytes_written =
+        oe_snprintf(message, OE_LOG_MESSAGE_LEN_MAX, "%s:", _enclave_filename);
+
+    if (bytes_written < 0)
+        return false;
+
+    n = oe_vsnprintf(
+        &message[bytes_written],
+        OE_LOG_MESSAGE_LEN_MAX - (size_t)bytes_written,
+        fmt,
+        ap);
+
+    return n >= 0;
+}
+
 oe_result_t oe_log(oe_log_level_t level, const char* fmt, ...)
 {
     oe_result_t result = OE_FAILURE;
     oe_va_list ap;
-    int n = 0;
-    int bytes_written = 0;
+    bool formatted = false;
+    oe_log_ring_t* ring = NULL;
+    oe_log_ring_entry_t* entry = NULL;
+    uint64_t pos = 0;
     char* message = NULL;
 
     // skip logging for non-debug-allowed enclaves
@@ -100,24 +258,65 @@ oe_result_t oe_log(oe_log_level_t level, const char* fmt, ...)
         goto done;
     }
 
-    if (!(message = oe_malloc(OE_LOG_MESSAGE_LEN_MAX)))
-        OE_RAISE(OE_OUT_OF_MEMORY);
+    // Post the message to the log ring if the host set one up. The message
+    // is formatted in place and the host drains it asynchronously.
+    if ((ring = __atomic_load_n(&_log_ring, __ATOMIC_ACQUIRE)))
+    {
+        if (!(entry = _claim_log_ring_entry(ring, &pos)))
+        {
+            // Do not block the enclave thread. The host reports the count.
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            result = OE_OK;
+            goto done;
+        }
 
-    bytes_written =
-        oe_snprintf(message, OE_LOG_MESSAGE_LEN_MAX, "%s:", _enclave_filename);
+        entry->level = (uint32_t)level;
+        entry->timestamp = __atomic_load_n(&ring->clock, __ATOMIC_RELAXED);
+
+        oe_va_start(ap, fmt);
+        formatted = _format_message(entry->message, fmt, ap);
+        oe_va_end(ap);
+
+        // The entry must be published even if formatting failed, since the
+        // host drains the entries in order.
+        if (!formatted)
+            entry->message[0] = '\0';
+
+        // The full barrier orders the publication before the read of the
+        // event of the host thread.
+        __atomic_store_n(&entry->sequence, pos + 1, __ATOMIC_SEQ_CST);
+
+        // If event is 0, the host thread has gone to sleep. Swap it to 1
+        // before waking the thread so that only one enclave thread makes the
+        // OCALL, and so that the host thread cannot go to sleep meanwhile
+        // without draining the message (see host/sgx/logring.c).
+        if (__atomic_load_n(&ring->event, __ATOMIC_SEQ_CST) == 0)
+        {
+            uint32_t sleeping = 0;
+            if (__atomic_compare_exchange_n(
+                    &ring->event,
+                    &sleeping,
+                    1,
+                    false,
+                    __ATOMIC_SEQ_CST,
+                    __ATOMIC_SEQ_CST))
+                oe_log_ring_wake_ocall(ring);
+        }
+
+        if (formatted)
+            result = OE_OK;
 
-    if (bytes_written < 0)
         goto done;
+    }
+
+    if (!(message = oe_malloc(OE_LOG_MESSAGE_LEN_MAX)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
 
     oe_va_start(ap, fmt);
-    n = oe_vsnprintf(
-        &message[bytes_written],
-        OE_LOG_MESSAGE_LEN_MAX - (size_t)bytes_written,
-        fmt,
-        ap);
+    formatted = _format_message(message, fmt, ap);
     oe_va_end(ap);
 
-    if (n < 0)
+    if (!formatted)
         goto done;
 
     if (oe_log_ocall(level, message) != OE_OK)
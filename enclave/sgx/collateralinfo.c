@@ -456,6 +456,14 @@ void oe_free_sgx_quote_verification_collateral_args(
 {
     if (args)
     {
+        /* Collateral copied from the collateral cache is stored in a single
+         * allocation, as on the host side */
+        if (args->host_out_buffer)
+        {
+            free(args->host_out_buffer);
+            return;
+        }
+
         free(args->tcb_info);
         free(args->tcb_info_issuer_chain);
         free(args->pck_crl);
@@ -463,6 +471,5 @@ void oe_free_sgx_quote_verification_collateral_args(
         free(args->pck_crl_issuer_chain);
         free(args->qe_identity);
         free(args->qe_identity_issuer_chain);
-        free(args->host_out_buffer);
     }
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/time.h>
 #include <openenclave/internal/utils.h>
 #include <stdio.h>
 
@@ -177,3 +179,260 @@ void oe_free_attestation_certificate(uint8_t* cert)
         oe_free(cert);
     }
 }
+
+/* A managed certificate is renewed once less than this fraction of its
+ * lifetime remains */
+#define CERTIFICATE_RENEWAL_DIVISOR 4
+
+struct _oe_attestation_certificate_manager
+{
+    unsigned char* subject_name;
+    uint8_t* private_key;
+    size_t private_key_size;
+    uint8_t* public_key;
+    size_t public_key_size;
+    uint64_t lifetime;
+
+    /* The current certificate and the time it was generated at, in
+     * milliseconds since the Epoch */
+    uint8_t* cert;
+    size_t cert_size;
+    uint64_t generated;
+
+    /* Whether a caller is generating the next certificate */
+    bool renewing;
+
+    oe_mutex_t mutex;
+    oe_cond_t cond;
+};
+
+static uint8_t* _copy_buffer(const void* data, size_t size)
+{
+    uint8_t* copy = (uint8_t*)oe_malloc(size);
+
+    if (copy)
+        memcpy(copy, data, size);
+
+    return copy;
+}
+
+oe_result_t oe_create_attestation_certificate_manager(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    uint32_t lifetime_in_seconds,
+    oe_attestation_certificate_manager_t** manager_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_attestation_certificate_manager_t* manager = NULL;
+
+    if (manager_out)
+        *manager_out = NULL;
+
+    if (!private_key || !private_key_size || !public_key ||
+        !public_key_size || !lifetime_in_seconds || !manager_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(manager = (oe_attestation_certificate_manager_t*)oe_calloc(
+              1, sizeof(*manager))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (subject_name &&
+        !(manager->subject_name = (unsigned char*)oe_strdup(
+              (const char*)subject_name)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(manager->private_key = _copy_buffer(private_key, private_key_size)) ||
+        !(manager->public_key = _copy_buffer(public_key, public_key_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    manager->private_key_size = private_key_size;
+    manager->public_key_size = public_key_size;
+    manager->lifetime = (uint64_t)lifetime_in_seconds * 1000;
+
+    OE_CHECK(oe_mutex_init(&manager->mutex));
+    OE_CHECK(oe_cond_init(&manager->cond));
+
+    *manager_out = manager;
+    manager = NULL;
+    result = OE_OK;
+
+done:
+    if (manager)
+    {
+        if (manager->private_key)
+        {
+            oe_secure_zero_fill(manager->private_key, private_key_size);
+            oe_free(manager->private_key);
+        }
+
+        oe_free(manager->public_key);
+        oe_free(manager->subject_name);
+        oe_free(manager);
+    }
+
+    return result;
+}
+
+/* Generate a new certificate and make it the current one. Called without the
+ * mutex held, by the caller which set manager->renewing. */
+static oe_result_t _renew_certificate(
+    oe_attestation_certificate_manager_t* manager)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    uint64_t generated = oe_get_time();
+
+    result = oe_generate_attestation_certificate(
+        manager->subject_name,
+        manager->private_key,
+        manager->private_key_size,
+        manager->public_key,
+        manager->public_key_size,
+        &cert,
+        &cert_size);
+
+    oe_mutex_lock(&manager->mutex);
+
+    if (result == OE_OK)
+    {
+        oe_free(manager->cert);
+        manager->cert = cert;
+        manager->cert_size = cert_size;
+        manager->generated = generated;
+    }
+
+    manager->renewing = false;
+    oe_cond_broadcast(&manager->cond);
+    oe_mutex_unlock(&manager->mutex);
+
+    return result;
+}
+
+/* Whether the current certificate can still be used. A certificate is not
+ * used once its lifetime has passed, or if the time cannot be read. Called
+ * with the mutex held. */
+static bool _is_certificate_valid(
+    oe_attestation_certificate_manager_t* manager,
+    uint64_t now)
+{
+    return manager->cert && now != (uint64_t)-1 &&
+           now < manager->generated + manager->lifetime;
+}
+
+oe_result_t oe_get_managed_attestation_certificate(
+    oe_attestation_certificate_manager_t* manager,
+    uint8_t** output_cert,
+    size_t* output_cert_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* cert = NULL;
+    size_t cert_size = 0;
+    bool locked = false;
+
+    if (!manager || !output_cert || !output_cert_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&manager->mutex);
+    locked = true;
+
+    // Return the current certificate as long as it is valid, even if it is
+    // due for renewal: oe_renew_managed_attestation_certificate() renews it
+    // off the path of the callers.
+    while (!_is_certificate_valid(manager, oe_get_time()))
+    {
+        // Wait for the caller generating the next certificate, or generate
+        // it.
+        if (manager->renewing)
+        {
+            oe_cond_wait(&manager->cond, &manager->mutex);
+            continue;
+        }
+
+        manager->renewing = true;
+        oe_mutex_unlock(&manager->mutex);
+        locked = false;
+
+        OE_CHECK(_renew_certificate(manager));
+
+        oe_mutex_lock(&manager->mutex);
+        locked = true;
+    }
+
+    if (!(cert = _copy_buffer(manager->cert, manager->cert_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    cert_size = manager->cert_size;
+
+    oe_mutex_unlock(&manager->mutex);
+    locked = false;
+
+    *output_cert = cert;
+    *output_cert_size = cert_size;
+    cert = NULL;
+    result = OE_OK;
+
+done:
+    if (locked)
+        oe_mutex_unlock(&manager->mutex);
+
+    oe_free(cert);
+
+    return result;
+}
+
+oe_result_t oe_renew_managed_attestation_certificate(
+    oe_attestation_certificate_manager_t* manager)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t now;
+    bool renew = false;
+
+    if (!manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&manager->mutex);
+
+    // Nothing to do while another caller generates the next certificate, or
+    // while more than a quarter of the lifetime of the current one remains.
+    now = oe_get_time();
+    if (!manager->renewing &&
+        (!_is_certificate_valid(manager, now) ||
+         manager->generated + manager->lifetime - now <
+             manager->lifetime / CERTIFICATE_RENEWAL_DIVISOR))
+    {
+        manager->renewing = true;
+        renew = true;
+    }
+
+    oe_mutex_unlock(&manager->mutex);
+
+    // Callers keep getting the current certificate until the next one is
+    // published.
+    if (renew)
+        OE_CHECK(_renew_certificate(manager));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_free_attestation_certificate_manager(
+    oe_attestation_certificate_manager_t* manager)
+{
+    if (!manager)
+        return;
+
+    oe_secure_zero_fill(manager->private_key, manager->private_key_size);
+    oe_free(manager->private_key);
+    oe_free(manager->public_key);
+    oe_free(manager->subject_name);
+    oe_free(manager->cert);
+    oe_cond_destroy(&manager->cond);
+    oe_mutex_destroy(&manager->mutex);
+    oe_free(manager);
+}
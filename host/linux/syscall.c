@@ -58,6 +58,23 @@ ssize_t oe_syscall_write_ocall(oe_host_fd_t fd, const void* buf, size_t count)
     return write((int)fd, buf, count);
 }
 
+ssize_t oe_syscall_read_shared_ocall(oe_host_fd_t fd, void* buf, size_t count)
+{
+    errno = 0;
+
+    return read((int)fd, buf, count);
+}
+
+ssize_t oe_syscall_write_shared_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    errno = 0;
+
+    return write((int)fd, buf, count);
+}
+
 static void _relocate_iov_bases(
     struct oe_iovec* iov,
     int iovcnt,
@@ -147,6 +164,24 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_readv_shared_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_readv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
+ssize_t oe_syscall_writev_shared_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_writev_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
 oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
 {
     errno = 0;
@@ -197,6 +232,13 @@ int oe_syscall_flock_ocall(oe_host_fd_t fd, int operation)
     return flock((int)fd, operation);
 }
 
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    errno = 0;
+
+    return fsync((int)fd);
+}
+
 oe_host_fd_t oe_syscall_dup_ocall(oe_host_fd_t oldfd)
 {
     errno = 0;
@@ -665,6 +707,24 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_recvv_shared_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_recvv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
+ssize_t oe_syscall_sendv_shared_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_sendv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
 int oe_syscall_shutdown_ocall(oe_host_fd_t sockfd, int how)
 {
     errno = 0;
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <openenclave/internal/trace.h>
+#include "core_u.h"
 
 oe_result_t oe_log(oe_log_level_t level, const char* fmt, ...)
 {
@@ -9,3 +10,9 @@ oe_result_t oe_log(oe_log_level_t level, const char* fmt, ...)
     OE_UNUSED(fmt);
     return OE_UNSUPPORTED;
 }
+
+/* OP-TEE hosts do not set up log rings */
+void oe_log_ring_wake_ocall(oe_log_ring_t* log_ring)
+{
+    OE_UNUSED(log_ring);
+}
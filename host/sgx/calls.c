@@ -34,6 +34,7 @@
 #include "../ocalls.h"
 #include "asmdefs.h"
 #include "enclave.h"
+#include "logring.h"
 #include "ocalls.h"
 
 /*
@@ -319,7 +320,8 @@ static const char* oe_ecall_str(oe_func_t ecall)
         "DESTRUCTOR",
         "INIT_ENCLAVE",
         "CALL_ENCLAVE_FUNCTION",
-        "VIRTUAL_EXCEPTION_HANDLER"
+        "VIRTUAL_EXCEPTION_HANDLER",
+        "CALL_ENCLAVE_FUNCTION_BATCH"
     };
     // clang-format on
 
@@ -471,8 +473,12 @@ int __oe_dispatch_ocall(
 **         - an enclave thread context
 **
 **     If such a binding already exists, the binding's count in incremented.
-**     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     Else, the calling host thread is bound to an available enclave thread
+**     context taken from the enclave's lock-free free list.
+**
+**     Existing bindings of the calling thread are found through the chain of
+**     bindings stored in thread specific data, so re-entrant ECALLs neither
+**     lock nor scan the enclave's bindings.
 **
 **     Returns the address of the thread control structure (TCS) corresponding
 **     to the enclave thread context.
@@ -483,58 +489,43 @@ int __oe_dispatch_ocall(
 static void* _assign_tcs(oe_enclave_t* enclave)
 {
     void* tcs = NULL;
-    size_t i;
-    oe_thread_t thread = oe_thread_self();
+    oe_thread_binding_t* current = oe_get_thread_binding();
+    oe_thread_binding_t* binding;
 
-    oe_mutex_lock(&enclave->lock);
+    /* First attempt to find a busy binding of this enclave owned by this
+     * thread. The chain only holds bindings owned by this thread, so they
+     * cannot change under us. */
+    for (binding = current; binding; binding = binding->previous)
     {
-        /* First attempt to find a busy oe_sgx_td_t owned by this thread */
-        for (i = 0; i < enclave->num_bindings; i++)
+        if (binding->enclave == enclave)
         {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
-            {
-                binding->count++;
-                tcs = (void*)binding->tcs;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_push_thread_binding(
-                        enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                break;
-            }
-        }
+            assert(binding->flags & _OE_THREAD_BUSY);
+            assert(binding->thread == oe_thread_self());
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
-        {
-            for (i = 0; i < enclave->num_bindings; i++)
-            {
-                oe_thread_binding_t* binding = &enclave->bindings[i];
-
-                if (!(binding->flags & _OE_THREAD_BUSY))
-                {
-                    binding->flags |= _OE_THREAD_BUSY;
-                    binding->thread = thread;
-                    binding->count = 1;
-
-                    tcs = (void*)binding->tcs;
-
-                    /* Set into TSD so asynchronous exceptions can get it */
-                    _set_thread_binding(binding);
-                    assert(oe_get_thread_binding() == binding);
-
-                    /* Notify the debugger runtime */
-                    if (enclave->debug && enclave->debug_enclave != NULL)
-                        oe_debug_push_thread_binding(
-                            enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                    break;
-                }
-            }
+            binding->count++;
+            tcs = (void*)binding->tcs;
+            break;
         }
     }
-    oe_mutex_unlock(&enclave->lock);
+
+    /* If binding not found above, take an available binding */
+    if (!tcs && (binding = oe_pop_free_thread_binding(enclave)))
+    {
+        binding->flags |= _OE_THREAD_BUSY;
+        binding->thread = oe_thread_self();
+        binding->count = 1;
+        binding->previous = current;
+
+        tcs = (void*)binding->tcs;
+
+        /* Set into TSD so asynchronous exceptions can get it */
+        _set_thread_binding(binding);
+        assert(oe_get_thread_binding() == binding);
+    }
+
+    /* Notify the debugger runtime */
+    if (tcs && enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_push_thread_binding(enclave->debug_enclave, (sgx_tcs_t*)tcs);
 
     return tcs;
 }
@@ -545,43 +536,75 @@ static void* _assign_tcs(oe_enclave_t* enclave)
 ** _release_tcs()
 **
 **     Decrement the ThreadBinding.count field of the binding associated with
-**     the given TCS. If the field becomes zero, the binding is dissolved.
+**     the given TCS. If the field becomes zero, the binding is dissolved and
+**     returned to the enclave's free list.
 **
 **==============================================================================
 */
 
 static void _release_tcs(oe_enclave_t* enclave, void* tcs)
 {
-    size_t i;
+    oe_thread_binding_t* binding;
 
-    oe_mutex_lock(&enclave->lock);
+    /* The binding is owned by this thread, so it is in the chain */
+    for (binding = oe_get_thread_binding(); binding;
+         binding = binding->previous)
     {
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if ((binding->flags & _OE_THREAD_BUSY) &&
-                (void*)binding->tcs == tcs)
-            {
-                binding->count--;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_pop_thread_binding();
-
-                if (binding->count == 0)
-                {
-                    binding->flags &= (~_OE_THREAD_BUSY);
-                    binding->thread = 0;
-                    memset(&binding->event, 0, sizeof(binding->event));
-                    _set_thread_binding(NULL);
-                    assert(oe_get_thread_binding() == NULL);
-                }
-                break;
-            }
-        }
+        if (binding->enclave == enclave && (void*)binding->tcs == tcs)
+            break;
+    }
+
+    if (!binding)
+        return;
+
+    assert(binding->flags & _OE_THREAD_BUSY);
+    binding->count--;
+
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_pop_thread_binding();
+
+    if (binding->count == 0)
+    {
+        /* The binding being dissolved is the innermost one of this thread */
+        assert(oe_get_thread_binding() == binding);
+
+        _set_thread_binding(binding->previous);
+        binding->flags &= (~_OE_THREAD_BUSY);
+        binding->thread = 0;
+        binding->previous = NULL;
+        memset(&binding->event, 0, sizeof(binding->event));
+        oe_push_free_thread_binding(enclave, binding);
     }
-    oe_mutex_unlock(&enclave->lock);
+}
+
+oe_result_t oe_get_ocall_buffer_statistics(
+    oe_enclave_t* enclave,
+    oe_ocall_buffer_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !statistics)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(statistics, 0, sizeof(*statistics));
+
+    // The counters of a binding are updated by the thread it is assigned to
+    // without synchronization, so the values are a snapshot.
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        const volatile oe_thread_binding_t* binding = &enclave->bindings[i];
+
+        statistics->fallback_allocations += binding->ocall_buffer_fallbacks;
+        statistics->fallback_bytes += binding->ocall_buffer_fallback_bytes;
+        statistics->buffer_grows += binding->ocall_buffer_grows;
+        statistics->buffer_capacity += binding->ocall_buffer_size;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
 }
 
 /*
@@ -645,6 +668,11 @@ oe_result_t oe_ecall(
 
     result = (oe_result_t)result_out;
 
+    /* Drain what the enclave logged before it started to abort, since it
+     * will not get to terminate normally */
+    if (result == OE_ENCLAVE_ABORTING)
+        oe_flush_log_ring(enclave);
+
 done:
 
     if (enclave && tcs)
@@ -657,3 +685,87 @@ done:
 
     return result;
 }
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_functions()
+**
+**     Call the enclave functions of an array of calls, at most batch_size of
+**     them per enclave entry.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_call_enclave_functions(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls,
+    size_t batch_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_enclave_function_args_t* args = NULL;
+    oe_call_enclave_function_batch_args_t batch;
+    size_t start = 0;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || (!calls && num_calls))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (batch_size == 0 || batch_size > num_calls)
+        batch_size = num_calls;
+
+    if (num_calls == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(args = calloc(batch_size, sizeof(oe_call_enclave_function_args_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (start = 0; start < num_calls; start += batch.num_calls)
+    {
+        uint64_t arg_out = 0;
+
+        batch.calls = args;
+        batch.num_calls = num_calls - start;
+        if (batch.num_calls > batch_size)
+            batch.num_calls = batch_size;
+
+        for (size_t i = 0; i < batch.num_calls; i++)
+        {
+            const oe_enclave_function_call_t* call = &calls[start + i];
+
+            args[i].table_id = OE_UINT64_MAX;
+            args[i].function_id = call->function_id;
+            args[i].input_buffer = call->input_buffer;
+            args[i].input_buffer_size = call->input_buffer_size;
+            args[i].output_buffer = call->output_buffer;
+            args[i].output_buffer_size = call->output_buffer_size;
+            args[i].output_bytes_written = 0;
+            args[i].result = OE_UNEXPECTED;
+        }
+
+        OE_CHECK(oe_ecall(
+            enclave,
+            OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH,
+            (uint64_t)&batch,
+            &arg_out));
+        OE_CHECK((oe_result_t)arg_out);
+
+        for (size_t i = 0; i < batch.num_calls; i++)
+        {
+            oe_enclave_function_call_t* call = &calls[start + i];
+
+            call->result = args[i].result;
+            call->output_bytes_written =
+                (args[i].result == OE_OK) ? args[i].output_bytes_written : 0;
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    free(args);
+    return result;
+}
@@ -58,7 +58,10 @@ static char* get_fullpath(const char* path)
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
+#include "logring.h"
+#include "measurecache.h"
 #include "platform_u.h"
+#include "quote.h"
 #include "sgxload.h"
 
 #if !defined(OEHOSTMR)
@@ -89,6 +92,9 @@ static void _initialize_enclave_host()
 }
 #endif // OEHOSTMR
 
+/* Maximum number of filled pages added in a single request */
+#define OE_FILLED_PAGES_BATCH_SIZE 1024
+
 static oe_result_t _add_filled_pages(
     oe_sgx_load_context_t* context,
     uint64_t enclave_addr,
@@ -98,46 +104,59 @@ static oe_result_t _add_filled_pages(
     bool extend)
 {
     oe_result_t result = OE_UNEXPECTED;
-    oe_page_t* page = NULL;
-    size_t i;
-
-    page = oe_memalign(OE_PAGE_SIZE, sizeof(oe_page_t));
-    if (!page)
-        OE_RAISE(OE_OUT_OF_MEMORY);
+    oe_page_t* pages = NULL;
+    size_t batch_size;
 
     /* Reject invalid parameters */
     if (!context || !enclave_addr || !vaddr)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* Fill or clear the page */
+    if (npages == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    /* The pages are added in batches from a buffer of identical pages */
+    batch_size = npages < OE_FILLED_PAGES_BATCH_SIZE
+                     ? npages
+                     : OE_FILLED_PAGES_BATCH_SIZE;
+
+    pages = oe_memalign(OE_PAGE_SIZE, batch_size * sizeof(oe_page_t));
+    if (!pages)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Fill or clear the pages */
     if (filler)
     {
-        size_t n = OE_PAGE_SIZE / sizeof(uint32_t);
-        uint32_t* p = (uint32_t*)page;
+        size_t n = batch_size * OE_PAGE_SIZE / sizeof(uint32_t);
+        uint32_t* p = (uint32_t*)pages;
 
         while (n--)
             *p++ = filler;
     }
     else
-        memset(page, 0, sizeof(*page));
+        memset(pages, 0, batch_size * sizeof(oe_page_t));
 
     /* Add the pages */
-    for (i = 0; i < npages; i++)
+    while (npages)
     {
+        size_t n = npages < batch_size ? npages : batch_size;
         uint64_t addr = enclave_addr + *vaddr;
-        uint64_t src = (uint64_t)page;
+        uint64_t src = (uint64_t)pages;
         uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R | SGX_SECINFO_W;
 
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context, enclave_addr, addr, src, flags, extend));
-        (*vaddr) += OE_PAGE_SIZE;
+        OE_CHECK(oe_sgx_load_enclave_pages(
+            context, enclave_addr, addr, src, n * OE_PAGE_SIZE, flags, extend));
+        (*vaddr) += n * OE_PAGE_SIZE;
+        npages -= n;
     }
 
     result = OE_OK;
 
 done:
-    if (page)
-        oe_memalign_free(page);
+    if (pages)
+        oe_memalign_free(pages);
 
     return result;
 }
@@ -478,6 +497,37 @@ static oe_result_t _configure_enclave(
                     enclave, max_host_workers, max_enclave_workers));
                 break;
             }
+            // Applied while the enclave is built.
+            case OE_ENCLAVE_SETTING_MEASUREMENT_CACHE:
+            {
+                break;
+            }
+            // Load the quote library ahead of the first quote.
+            case OE_ENCLAVE_SETTING_QUOTE_PRELOAD:
+            {
+                const oe_enclave_setting_quote_preload_t* preload =
+                    settings[i].u.quote_preload_setting;
+                oe_result_t preload_result;
+
+                if (!preload)
+                    OE_RAISE(OE_INVALID_PARAMETER);
+
+                if (enclave->simulate)
+                    break;
+
+                preload_result = sgx_preload_quote_library();
+
+                if (preload_result != OE_OK)
+                {
+                    if (preload->required)
+                        OE_RAISE(preload_result);
+
+                    OE_TRACE_WARNING(
+                        "Failed to preload the quote library: %s\n",
+                        oe_result_str(preload_result));
+                }
+                break;
+            }
 #ifdef OE_WITH_EXPERIMENTAL_EEID
             case OE_EXTENDED_ENCLAVE_INITIALIZATION_DATA:
             {
@@ -607,6 +657,7 @@ static oe_result_t _add_eeid_marker_page(
 
         // Record EEID information
         eeid->version = OE_EEID_VERSION;
+        OE_CHECK(oe_sgx_sync_load_measurement(context));
         oe_sha256_context_t* hctx = &context->hash_context;
         oe_sha256_save(hctx, eeid->hash_state.H, eeid->hash_state.N);
         eeid->entry_point = entry_point;
@@ -659,6 +710,7 @@ static oe_result_t _eeid_resign(
         sgx_sigstruct_t* sigstruct = (sgx_sigstruct_t*)properties->sigstruct;
 
         OE_SHA256 ext_mrenclave;
+        OE_CHECK(oe_sgx_sync_load_measurement(context));
         oe_sha256_final(&context->hash_context, &ext_mrenclave);
 
         OE_CHECK(oe_sgx_sign_enclave(
@@ -715,6 +767,34 @@ done:
 }
 #endif
 
+#if !defined(OEHOSTMR)
+/* Whether the SIGSTRUCT of a cached measurement carries the cached MRENCLAVE
+ * and, for a signed enclave, is the SIGSTRUCT of the enclave. EINIT would
+ * reject the measurement otherwise. */
+static bool _is_cached_measurement_consistent(
+    const oe_sgx_enclave_properties_t* properties,
+    const oe_sgx_measurement_t* measurement)
+{
+    const sgx_sigstruct_t* sigstruct =
+        (const sgx_sigstruct_t*)properties->sigstruct;
+
+    if (memcmp(
+            measurement->sigstruct.enclavehash,
+            measurement->mrenclave.buf,
+            sizeof(measurement->mrenclave.buf)) != 0)
+        return false;
+
+    if (memcmp(
+            sigstruct->header,
+            SGX_SIGSTRUCT_HEADER,
+            sizeof(SGX_SIGSTRUCT_HEADER)) == 0 &&
+        memcmp(&measurement->sigstruct, sigstruct, sizeof(*sigstruct)) != 0)
+        return false;
+
+    return true;
+}
+#endif
+
 oe_result_t oe_sgx_build_enclave(
     oe_sgx_load_context_t* context,
     const char* path,
@@ -730,6 +810,7 @@ oe_result_t oe_sgx_build_enclave(
     size_t image_size;
     uint64_t vaddr = 0;
     oe_sgx_enclave_properties_t props;
+    uint64_t start = oe_sgx_get_load_timestamp();
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -807,6 +888,54 @@ oe_result_t oe_sgx_build_enclave(
     OE_CHECK(_calculate_enclave_size(
         image_size, &props, &enclave_end, &enclave_size));
 
+#if !defined(OEHOSTMR)
+    /* Nothing checks the measurement of a simulated enclave, so a stale
+     * cached measurement would go unnoticed */
+    if (oe_sgx_is_simulation_load_context(context))
+        context->use_measurement_cache = false;
+
+    /* Skip the measurement on the host if it is cached */
+    if (context->use_measurement_cache &&
+        context->type == OE_SGX_LOAD_TYPE_CREATE)
+    {
+#ifdef OE_WITH_EXPERIMENTAL_EEID
+        /* EEID needs the intermediate state of the measurement */
+        if (context->eeid)
+            context->use_measurement_cache = false;
+        else
+#endif
+        {
+            OE_CHECK(oe_sgx_get_measurement_cache_key(
+                &oeimage,
+                &props,
+                &context->attributes,
+                &context->measurement_cache_key));
+            context->measurement_cached = oe_sgx_find_cached_measurement(
+                context->measurement_cache_directory,
+                &context->measurement_cache_key,
+                &context->measurement);
+
+            /* Measure the enclave rather than wait for EINIT to reject an
+             * inconsistent entry */
+            if (context->measurement_cached &&
+                !_is_cached_measurement_consistent(
+                    &props, &context->measurement))
+            {
+                OE_TRACE_WARNING(
+                    "The cached measurement of %s does not match its "
+                    "SIGSTRUCT, measuring it\n",
+                    path);
+                oe_sgx_evict_cached_measurement(
+                    context->measurement_cache_directory,
+                    &context->measurement_cache_key);
+                context->measurement_cached = false;
+            }
+        }
+    }
+#endif
+
+    context->timings.image = oe_sgx_get_load_timestamp() - start;
+
     /* Perform the ECREATE operation */
     OE_CHECK(oe_sgx_create_enclave(
         context, enclave_size, enclave_end, &enclave_addr));
@@ -817,7 +946,9 @@ oe_result_t oe_sgx_build_enclave(
     enclave->text = enclave_addr + oeimage.text_rva;
 
     /* Patch image */
+    start = oe_sgx_get_load_timestamp();
     OE_CHECK(oeimage.patch(&oeimage, enclave_size));
+    context->timings.image += oe_sgx_get_load_timestamp() - start;
 
     /* Add image to enclave */
     OE_CHECK(oeimage.add_pages(&oeimage, context, enclave, &vaddr));
@@ -843,6 +974,27 @@ oe_result_t oe_sgx_build_enclave(
     OE_CHECK(oe_sgx_initialize_enclave(
         context, enclave_addr, &props, &enclave->hash));
 
+#if !defined(OEHOSTMR)
+    /* EINIT succeeded, so the measurement is right */
+    if (context->use_measurement_cache && !context->measurement_cached &&
+        context->type == OE_SGX_LOAD_TYPE_CREATE)
+    {
+        oe_sgx_cache_measurement(
+            context->measurement_cache_directory,
+            &context->measurement_cache_key,
+            &context->measurement);
+    }
+#endif
+
+    OE_TRACE_INFO(
+        "enclave creation timings (ms): image=%llu EADD=%llu "
+        "EADD+EEXTEND=%llu measurement=%llu (overlapped) EINIT=%llu\n",
+        OE_LLU(context->timings.image / 1000000),
+        OE_LLU(context->timings.eadd / 1000000),
+        OE_LLU(context->timings.eextend / 1000000),
+        OE_LLU(context->timings.measure / 1000000),
+        OE_LLU(context->timings.einit / 1000000));
+
     /* Save full path of this enclave. When a debugger attaches to the host
      * process, it needs the fullpath so that it can load the image binary and
      * extract the debugging symbols. */
@@ -956,8 +1108,53 @@ oe_result_t oe_create_enclave(
         }
 #endif
 
+    for (size_t i = 0; i < setting_count; i++)
+    {
+        if (settings[i].setting_type == OE_ENCLAVE_SETTING_MEASUREMENT_CACHE)
+        {
+            if (!settings[i].u.measurement_cache_setting)
+                OE_RAISE(OE_INVALID_PARAMETER);
+
+            context.use_measurement_cache = true;
+            context.measurement_cache_directory =
+                settings[i].u.measurement_cache_setting->directory;
+        }
+    }
+
     /* Build the enclave */
-    OE_CHECK(oe_sgx_build_enclave(&context, enclave_path, NULL, enclave));
+    result = oe_sgx_build_enclave(&context, enclave_path, NULL, enclave);
+
+    /* EINIT rejects a cached measurement that does not match the enclave,
+     * for example one stored by another version of the host. Drop it and
+     * build the enclave again, measuring it. */
+    if (result != OE_OK && context.measurement_rejected)
+    {
+        const char* directory = context.measurement_cache_directory;
+
+        OE_TRACE_WARNING(
+            "EINIT rejected the cached measurement of %s, measuring it\n",
+            enclave_path);
+
+        oe_sgx_evict_cached_measurement(
+            context.measurement_cache_directory,
+            &context.measurement_cache_key);
+
+        oe_sgx_delete_enclave(enclave);
+        oe_mutex_destroy(&enclave->lock);
+        oe_sgx_cleanup_load_context(&context);
+
+        OE_CHECK(oe_sgx_initialize_load_context(
+            &context, OE_SGX_LOAD_TYPE_CREATE, flags));
+        context.use_measurement_cache = true;
+        context.measurement_cache_directory = directory;
+
+        result = oe_sgx_build_enclave(&context, enclave_path, NULL, enclave);
+    }
+
+    OE_CHECK(result);
+
+    /* Make all the thread bindings available for ECALLs */
+    oe_init_free_thread_bindings(enclave);
 
     /* Push the new created enclave to the global list. */
     if (oe_push_enclave_instance(enclave) != 0)
@@ -1015,6 +1212,10 @@ oe_result_t oe_create_enclave(
             "from \"openenclave/edl/logging.edl\" import *;\n\n"
             "in the edl file.\n");
     }
+    else if (oe_start_log_ring(enclave) != OE_OK)
+    {
+        OE_TRACE_WARNING("In-enclave logging falls back to OCALLs.\n");
+    }
 
     /* Apply the list of settings to the enclave.
      * This may initialize switchless manager too.
@@ -1034,6 +1235,7 @@ done:
 
     if (result != OE_OK && enclave)
     {
+        oe_stop_log_ring(enclave);
         free(enclave);
     }
 
@@ -1053,8 +1255,19 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     /* Shut down the switchless manager */
     OE_CHECK(oe_stop_switchless_manager(enclave));
 
-    /* Call the enclave destructor */
-    OE_CHECK(oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL));
+    /* Call the enclave destructor, and drain what the enclave logged whether
+     * the destructor succeeded or not. If it failed, the enclave is left in
+     * place and may still post to its log ring, so only the drain thread is
+     * stopped. */
+    result = oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL);
+    if (result != OE_OK)
+    {
+        oe_stop_log_ring_thread(enclave);
+        OE_RAISE(result);
+    }
+
+    /* The enclave cannot log anymore */
+    oe_stop_log_ring(enclave);
 
     if (enclave->debug_enclave)
     {
@@ -1078,18 +1291,21 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
          * Track failures reported by the platform, but do not exit early */
         result = oe_sgx_delete_enclave(enclave);
 
-#if defined(_WIN32)
-
-        /* Release Windows events created during enclave creation */
         for (size_t i = 0; i < enclave->num_bindings; i++)
         {
             oe_thread_binding_t* binding = &enclave->bindings[i];
+
+#if defined(_WIN32)
+            /* Release Windows events created during enclave creation */
             CloseHandle(binding->event.handle);
+#endif
+
+            /* Release the OCALL buffer, which may have grown */
             free(binding->ocall_buffer);
+            binding->ocall_buffer = NULL;
+            binding->ocall_buffer_size = 0;
         }
 
-#endif
-
         /* Free the path name of the enclave image file */
         free(enclave->path);
     }
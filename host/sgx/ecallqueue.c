@@ -0,0 +1,508 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "ecallqueue.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/switchless.h>
+#include <openenclave/internal/utils.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../calls.h"
+#include "../hostthread.h"
+#include "enclave.h"
+
+/*
+**==============================================================================
+**
+** ECALL queues:
+**
+**     Callers submit ECALLs to the submission ring of a queue, a pool of host
+**     threads executes them and posts their results to the completion ring,
+**     and callers poll the completions, typically when the completion event
+**     is signaled. The number of ECALLs submitted and not polled yet is
+**     bounded by the capacity of the rings. A ring may still look full to a
+**     producer while a consumer that claimed the slot the producer wraps
+**     around to has not released it yet, so the producers wait for the slot
+**     instead of failing.
+**
+**     Both rings are bounded multi-producer/multi-consumer rings where the
+**     sequence number of each slot tells whether the slot is ready, as in the
+**     queue of switchless OCALLs:
+**
+**         sequence == pos      : the slot is free for the producer at pos.
+**         sequence == pos + 1  : the slot holds the entry posted at pos.
+**
+**==============================================================================
+*/
+
+#define OE_ECALL_QUEUE_MAGIC 0x6ecb0a3e5d1c4f27
+
+typedef struct _ecall_ring
+{
+    volatile uint64_t* sequences;
+    uint64_t mask;
+    volatile uint64_t enqueue_pos;
+    volatile uint64_t dequeue_pos;
+} ecall_ring_t;
+
+typedef struct _ecall_request
+{
+    uint32_t function_id;
+    const void* input_buffer;
+    size_t input_buffer_size;
+    void* output_buffer;
+    size_t output_buffer_size;
+    void* context;
+} ecall_request_t;
+
+struct _oe_ecall_queue
+{
+    uint64_t magic;
+    oe_enclave_t* enclave;
+    uint64_t capacity;
+
+    ecall_ring_t submissions;
+    ecall_request_t* requests;
+
+    ecall_ring_t completions;
+    oe_ecall_completion_t* completed;
+
+    /* Number of ECALLs submitted whose completions were not polled */
+    volatile uint64_t in_flight;
+
+    /* Incremented on every submission. The threads sleep on it. */
+    volatile uint32_t submit_sequence;
+    volatile uint64_t num_sleeping;
+
+    /* Whether the event was signaled since the last poll */
+    volatile uint32_t notify_pending;
+    intptr_t event;
+    bool has_event;
+
+    volatile bool is_stopping;
+    oe_thread_t* threads;
+    size_t num_threads;
+};
+
+static oe_result_t _init_ring(ecall_ring_t* ring, uint64_t capacity)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!(ring->sequences = calloc(capacity, sizeof(uint64_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (uint64_t i = 0; i < capacity; i++)
+        ring->sequences[i] = i;
+
+    ring->mask = capacity - 1;
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Claim the slot of the next entry to post. Returns false if it is full. */
+static bool _claim_enqueue(ecall_ring_t* ring, uint64_t* pos_out)
+{
+    uint64_t pos = oe_atomic_load(&ring->enqueue_pos);
+
+    while (true)
+    {
+        int64_t diff =
+            (int64_t)oe_atomic_load(&ring->sequences[pos & ring->mask]) -
+            (int64_t)pos;
+
+        if (diff == 0)
+        {
+            if (oe_atomic_compare_and_swap(
+                    (volatile int64_t*)&ring->enqueue_pos,
+                    (int64_t)pos,
+                    (int64_t)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+
+        pos = oe_atomic_load(&ring->enqueue_pos);
+    }
+
+    *pos_out = pos;
+    return true;
+}
+
+/* Claim the slot of the next entry to post to a ring that cannot hold more
+ * entries than its capacity. The slot may not be released yet by the
+ * consumer that read it, which does so right after copying the entry. */
+static uint64_t _claim_enqueue_bounded(ecall_ring_t* ring)
+{
+    uint64_t pos;
+
+    while (!_claim_enqueue(ring, &pos))
+        oe_yield_cpu();
+
+    return pos;
+}
+
+/* Hand the entry written in the claimed slot over to the consumers */
+static void _publish(ecall_ring_t* ring, uint64_t pos)
+{
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    ring->sequences[pos & ring->mask] = pos + 1;
+}
+
+/* Claim the slot of the oldest entry. Returns false if it is empty. */
+static bool _claim_dequeue(ecall_ring_t* ring, uint64_t* pos_out)
+{
+    uint64_t pos = oe_atomic_load(&ring->dequeue_pos);
+
+    while (true)
+    {
+        int64_t diff =
+            (int64_t)oe_atomic_load(&ring->sequences[pos & ring->mask]) -
+            (int64_t)(pos + 1);
+
+        if (diff == 0)
+        {
+            if (oe_atomic_compare_and_swap(
+                    (volatile int64_t*)&ring->dequeue_pos,
+                    (int64_t)pos,
+                    (int64_t)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+
+        pos = oe_atomic_load(&ring->dequeue_pos);
+    }
+
+    *pos_out = pos;
+    return true;
+}
+
+/* Release the slot read by a consumer to the producer that wraps around */
+static void _release(ecall_ring_t* ring, uint64_t pos)
+{
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    ring->sequences[pos & ring->mask] = pos + ring->mask + 1;
+}
+
+static bool _is_empty(ecall_ring_t* ring)
+{
+    uint64_t pos = oe_atomic_load(&ring->dequeue_pos);
+
+    return oe_atomic_load(&ring->sequences[pos & ring->mask]) != pos + 1;
+}
+
+/* Signal the event unless it was signaled since the last poll */
+static void _notify(oe_ecall_queue_t* queue)
+{
+    if (oe_atomic_compare_and_swap_32(&queue->notify_pending, 0, 1))
+        oe_ecall_queue_signal_event(queue->event);
+}
+
+/* Wake the threads sleeping for new submissions */
+static void _wake_threads(oe_ecall_queue_t* queue, bool all)
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = queue->submit_sequence;
+    } while (!oe_atomic_compare_and_swap_32(
+        &queue->submit_sequence, sequence, sequence + 1));
+
+    if (all || oe_atomic_load(&queue->num_sleeping) > 0)
+        oe_ecall_queue_wake(&queue->submit_sequence, all);
+}
+
+static bool _execute_next_ecall(oe_ecall_queue_t* queue)
+{
+    oe_enclave_t* enclave = queue->enclave;
+    oe_switchless_call_manager_t* manager = enclave->switchless_manager;
+    ecall_request_t request;
+    oe_ecall_completion_t completion;
+    uint64_t pos;
+
+    if (!_claim_dequeue(&queue->submissions, &pos))
+        return false;
+
+    request = queue->requests[pos & queue->submissions.mask];
+    _release(&queue->submissions, pos);
+
+    completion.context = request.context;
+    completion.output_bytes_written = 0;
+
+    if (manager && manager->num_enclave_workers > 0)
+    {
+        completion.result = oe_switchless_call_enclave_function(
+            enclave,
+            request.function_id,
+            request.input_buffer,
+            request.input_buffer_size,
+            request.output_buffer,
+            request.output_buffer_size,
+            &completion.output_bytes_written);
+    }
+    else
+    {
+        completion.result = oe_call_enclave_function(
+            enclave,
+            request.function_id,
+            request.input_buffer,
+            request.input_buffer_size,
+            request.output_buffer,
+            request.output_buffer_size,
+            &completion.output_bytes_written);
+    }
+
+    // The completion ring holds as many entries as there are ECALLs in
+    // flight, so its next slot is free or about to be released.
+    pos = _claim_enqueue_bounded(&queue->completions);
+    queue->completed[pos & queue->completions.mask] = completion;
+    _publish(&queue->completions, pos);
+    _notify(queue);
+
+    return true;
+}
+
+static void* _ecall_queue_thread(void* arg)
+{
+    oe_ecall_queue_t* queue = (oe_ecall_queue_t*)arg;
+
+    while (true)
+    {
+        // Read the sequence before looking for a submission, so that a
+        // submission posted after the ring was found empty makes the wait
+        // below return immediately.
+        uint32_t sequence = queue->submit_sequence;
+
+        if (_execute_next_ecall(queue))
+            continue;
+
+        // Submitted ECALLs are drained before the thread stops.
+        if (queue->is_stopping)
+            break;
+
+        oe_atomic_increment(&queue->num_sleeping);
+        oe_ecall_queue_wait(&queue->submit_sequence, sequence);
+        oe_atomic_decrement(&queue->num_sleeping);
+    }
+
+    return NULL;
+}
+
+static void _stop_threads(oe_ecall_queue_t* queue)
+{
+    queue->is_stopping = true;
+    _wake_threads(queue, true);
+
+    for (size_t i = 0; i < queue->num_threads; i++)
+        oe_thread_join(queue->threads[i]);
+
+    queue->num_threads = 0;
+}
+
+static void _free_ecall_queue(oe_ecall_queue_t* queue)
+{
+    if (queue->has_event)
+        oe_ecall_queue_close_event(queue->event);
+
+    free((void*)queue->submissions.sequences);
+    free((void*)queue->completions.sequences);
+    free(queue->requests);
+    free(queue->completed);
+    free(queue->threads);
+    free(queue);
+}
+
+oe_result_t oe_create_ecall_queue(
+    oe_enclave_t* enclave,
+    size_t num_threads,
+    size_t capacity,
+    oe_ecall_queue_t** queue_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_ecall_queue_t* queue = NULL;
+    uint64_t ring_capacity = 1;
+
+    if (queue_out)
+        *queue_out = NULL;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !num_threads ||
+        !capacity || capacity > OE_UINT32_MAX || !queue_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Each thread keeps an enclave thread busy while it executes an ECALL.
+    if (num_threads > enclave->num_bindings)
+        num_threads = enclave->num_bindings;
+
+    while (ring_capacity < capacity)
+        ring_capacity <<= 1;
+
+    if (!(queue = calloc(1, sizeof(oe_ecall_queue_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    queue->enclave = enclave;
+    queue->capacity = ring_capacity;
+
+    OE_CHECK(_init_ring(&queue->submissions, ring_capacity));
+    OE_CHECK(_init_ring(&queue->completions, ring_capacity));
+
+    if (!(queue->requests = calloc(ring_capacity, sizeof(ecall_request_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(queue->completed =
+              calloc(ring_capacity, sizeof(oe_ecall_completion_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_ecall_queue_open_event(&queue->event));
+    queue->has_event = true;
+
+    if (!(queue->threads = calloc(num_threads, sizeof(oe_thread_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        if (oe_thread_create(&queue->threads[i], _ecall_queue_thread, queue))
+            OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+        queue->num_threads++;
+    }
+
+    queue->magic = OE_ECALL_QUEUE_MAGIC;
+    *queue_out = queue;
+    queue = NULL;
+    result = OE_OK;
+
+done:
+    if (queue)
+    {
+        _stop_threads(queue);
+        _free_ecall_queue(queue);
+    }
+
+    return result;
+}
+
+oe_result_t oe_submit_ecall(
+    oe_ecall_queue_t* queue,
+    uint32_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    void* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    ecall_request_t* request;
+    uint64_t pos;
+
+    if (!queue || queue->magic != OE_ECALL_QUEUE_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_atomic_increment(&queue->in_flight) > queue->capacity)
+    {
+        oe_atomic_decrement(&queue->in_flight);
+        OE_RAISE_NO_TRACE(OE_BUSY);
+    }
+
+    // The ECALL in flight has a slot, free or about to be released.
+    pos = _claim_enqueue_bounded(&queue->submissions);
+    request = &queue->requests[pos & queue->submissions.mask];
+    request->function_id = function_id;
+    request->input_buffer = input_buffer;
+    request->input_buffer_size = input_buffer_size;
+    request->output_buffer = output_buffer;
+    request->output_buffer_size = output_buffer_size;
+    request->context = context;
+    _publish(&queue->submissions, pos);
+
+    _wake_threads(queue, false);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_poll_ecall_completions(
+    oe_ecall_queue_t* queue,
+    oe_ecall_completion_t* completions,
+    size_t* completions_count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t count = 0;
+    uint64_t pos;
+
+    if (!queue || queue->magic != OE_ECALL_QUEUE_MAGIC || !completions_count ||
+        (!completions && *completions_count))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Reset the event before clearing the flag. A completion posted while
+    // the flag is still set is found by the loop below, and one posted after
+    // it is cleared signals the event again.
+    if (queue->notify_pending)
+    {
+        oe_ecall_queue_reset_event(queue->event);
+        oe_atomic_compare_and_swap_32(&queue->notify_pending, 1, 0);
+    }
+
+    while (count < *completions_count &&
+           _claim_dequeue(&queue->completions, &pos))
+    {
+        completions[count++] =
+            queue->completed[pos & queue->completions.mask];
+        _release(&queue->completions, pos);
+        oe_atomic_decrement(&queue->in_flight);
+    }
+
+    // Keep the event signaled for the completions that did not fit.
+    if (count == *completions_count && !_is_empty(&queue->completions))
+        _notify(queue);
+
+    *completions_count = count;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_ecall_queue_event(oe_ecall_queue_t* queue, intptr_t* event)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!queue || queue->magic != OE_ECALL_QUEUE_MAGIC || !event)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *event = queue->event;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_delete_ecall_queue(oe_ecall_queue_t* queue)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!queue || queue->magic != OE_ECALL_QUEUE_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    _stop_threads(queue);
+    queue->magic = 0;
+    _free_ecall_queue(queue);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_ECALLQUEUE_H
+#define _OE_HOST_SGX_ECALLQUEUE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Platform specific parts of the ECALL queues (see ecallqueue.c):
+**
+**     The threads of a queue sleep on a 32-bit word while no ECALL is
+**     submitted, and the completion event of the queue is an eventfd on
+**     Linux and a manual-reset event on Windows.
+**
+**==============================================================================
+*/
+
+/* Block while *address equals value. May return spuriously. */
+void oe_ecall_queue_wait(volatile uint32_t* address, uint32_t value);
+
+/* Wake one or all of the threads blocked on address */
+void oe_ecall_queue_wake(volatile uint32_t* address, bool all);
+
+oe_result_t oe_ecall_queue_open_event(intptr_t* event);
+
+void oe_ecall_queue_signal_event(intptr_t event);
+
+/* Clear the event without blocking */
+void oe_ecall_queue_reset_event(intptr_t event);
+
+void oe_ecall_queue_close_event(intptr_t event);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_ECALLQUEUE_H */
@@ -4,6 +4,7 @@
 #include "enclave.h"
 #include <assert.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 
 /* Get the event object from the enclave for the given TCS */
 EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs)
@@ -13,22 +14,78 @@ EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs)
     if (!enclave)
         return NULL;
 
-    oe_mutex_lock(&enclave->lock);
+    /* The TCS addresses of the bindings do not change after the enclave has
+     * been created, so no lock is needed to look them up. */
+    for (size_t i = 0; i < enclave->num_bindings; i++)
     {
-        size_t i;
+        oe_thread_binding_t* binding = &enclave->bindings[i];
 
-        for (i = 0; i < enclave->num_bindings; i++)
+        if (binding->tcs == tcs)
         {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if (binding->tcs == tcs)
-            {
-                event = &binding->event;
-                break;
-            }
+            event = &binding->event;
+            break;
         }
     }
-    oe_mutex_unlock(&enclave->lock);
 
     return event;
 }
+
+void oe_init_free_thread_bindings(oe_enclave_t* enclave)
+{
+    enclave->free_bindings = 0;
+
+    /* Push in reverse order so that the first binding is assigned first */
+    for (size_t i = enclave->num_bindings; i > 0; i--)
+        oe_push_free_thread_binding(enclave, &enclave->bindings[i - 1]);
+}
+
+oe_thread_binding_t* oe_pop_free_thread_binding(oe_enclave_t* enclave)
+{
+    uint64_t head;
+    uint64_t next;
+    uint64_t index;
+
+    do
+    {
+        head = oe_atomic_load(&enclave->free_bindings);
+        index = head & _OE_FREE_BINDINGS_INDEX_MASK;
+
+        if (index == 0)
+            return NULL;
+
+        /* The tag in the upper bits makes the CAS fail if another thread
+         * popped and pushed back this binding in the meantime, in which case
+         * next_free may be stale. */
+        next = (((head >> _OE_FREE_BINDINGS_INDEX_BITS) + 1)
+                << _OE_FREE_BINDINGS_INDEX_BITS) |
+               enclave->bindings[index - 1].next_free;
+    } while (!oe_atomic_compare_and_swap(
+        (volatile int64_t*)&enclave->free_bindings,
+        (int64_t)head,
+        (int64_t)next));
+
+    return &enclave->bindings[index - 1];
+}
+
+void oe_push_free_thread_binding(
+    oe_enclave_t* enclave,
+    oe_thread_binding_t* binding)
+{
+    const uint64_t index = (uint64_t)(binding - enclave->bindings) + 1;
+    uint64_t head;
+    uint64_t next;
+
+    assert(index <= enclave->num_bindings);
+
+    do
+    {
+        head = oe_atomic_load(&enclave->free_bindings);
+        binding->next_free = head & _OE_FREE_BINDINGS_INDEX_MASK;
+        next = (((head >> _OE_FREE_BINDINGS_INDEX_BITS) + 1)
+                << _OE_FREE_BINDINGS_INDEX_BITS) |
+               index;
+    } while (!oe_atomic_compare_and_swap(
+        (volatile int64_t*)&enclave->free_bindings,
+        (int64_t)head,
+        (int64_t)next));
+}
@@ -75,6 +75,20 @@ typedef struct _thread_binding
     /* Buffer used for ocall parameters */
     void* ocall_buffer;
     uint64_t ocall_buffer_size;
+
+    /* Counters of the ocalls that did not fit in the buffer above, and of
+     * the times it was grown (see host/sgx/enter.c) */
+    uint64_t ocall_buffer_fallbacks;
+    uint64_t ocall_buffer_fallback_bytes;
+    uint64_t ocall_buffer_grows;
+
+    /* Index + 1 of the next binding in the enclave's free list (0 if none) */
+    uint64_t next_free;
+
+    /* The binding that was current for this thread when this binding was
+     * assigned. Nested ECALLs (possibly into other enclaves) form a chain of
+     * bindings headed by the one stored in thread specific data. */
+    struct _thread_binding* previous;
 } oe_thread_binding_t;
 
 /* Whether this binding is busy */
@@ -86,6 +100,12 @@ typedef struct _thread_binding
 /* Get thread data from thread-specific data (TSD) */
 oe_thread_binding_t* oe_get_thread_binding(void);
 
+/* Number of bits of the free list head holding the binding index + 1. The
+ * remaining bits hold a tag that is incremented on every update to avoid the
+ * ABA problem. */
+#define _OE_FREE_BINDINGS_INDEX_BITS 32
+#define _OE_FREE_BINDINGS_INDEX_MASK 0xffffffffUL
+
 /**
  * Host-side representation of properties associated with each
  * enclave instance.
@@ -112,6 +132,10 @@ typedef struct _oe_enclave
     size_t num_bindings;
     oe_mutex lock;
 
+    /* Lock-free stack of the bindings that are not busy. See
+     * _OE_FREE_BINDINGS_INDEX_BITS for the layout. */
+    volatile uint64_t free_bindings;
+
     /* Hash of enclave (MRENCLAVE) */
     OE_SHA256 hash;
 
@@ -130,9 +154,23 @@ typedef struct _oe_enclave
 
     /* Manager for switchless calls */
     oe_switchless_call_manager_t* switchless_manager;
+
+    /* Host side of the log ring of the enclave (see logring.c) */
+    struct _oe_log_ring_manager* log_ring_manager;
 } oe_enclave_t;
 
 /* Get the event for the given TCS */
 EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs);
 
+/* Put all the thread bindings of the enclave on its free list */
+void oe_init_free_thread_bindings(oe_enclave_t* enclave);
+
+/* Take a binding from the free list. Returns NULL if all bindings are busy */
+oe_thread_binding_t* oe_pop_free_thread_binding(oe_enclave_t* enclave);
+
+/* Return a binding to the free list */
+void oe_push_free_thread_binding(
+    oe_enclave_t* enclave,
+    oe_thread_binding_t* binding);
+
 #endif /* _OE_HOST_ENCLAVE_H */
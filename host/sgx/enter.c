@@ -99,10 +99,13 @@ int __oe_host_stack_bridge(
 /**
  * Size of ocall buffers passed in ecall_contexts. Large enough for most ocalls.
  * If an ocall requires more than this size, then the enclave will make an
- * ocall to allocate the buffer instead of using the ecall_context's buffer.
+ * ocall to allocate the buffer instead of using the ecall_context's buffer,
+ * and the buffer is grown for the next ECALLs, in powers of two, up to
+ * OE_MAX_OCALL_BUFFER_SIZE.
  * Note: Currently, quotes are about 10KB.
  */
 #define OE_DEFAULT_OCALL_BUFFER_SIZE (16 * 1024)
+#define OE_MAX_OCALL_BUFFER_SIZE (1024 * 1024)
 
 /**
  * Setup the ecall_context.
@@ -121,6 +124,45 @@ OE_INLINE void _setup_ecall_context(oe_ecall_context_t* ecall_context)
     ecall_context->ocall_buffer_size = binding->ocall_buffer_size;
 }
 
+/**
+ * Account for the ocalls of the ECALL whose buffer did not fit in the
+ * ecall_context's buffer, and grow the buffer for the next ECALLs. The buffer
+ * is only replaced when the outermost ECALL of the thread into the enclave
+ * returns, since until then the enclave may still use it for an ocall that
+ * the ECALL is nested in.
+ */
+OE_INLINE void _update_ocall_buffer(const oe_ecall_context_t* ecall_context)
+{
+    oe_thread_binding_t* binding = oe_get_thread_binding();
+    uint64_t wanted_size = ecall_context->ocall_buffer_wanted_size;
+    uint64_t size = binding->ocall_buffer_size;
+    void* buffer = NULL;
+
+    if (ecall_context->ocall_buffer_fallbacks == 0)
+        return;
+
+    binding->ocall_buffer_fallbacks += ecall_context->ocall_buffer_fallbacks;
+    binding->ocall_buffer_fallback_bytes +=
+        ecall_context->ocall_buffer_fallback_bytes;
+
+    if (binding->count != 1 || wanted_size > OE_MAX_OCALL_BUFFER_SIZE)
+        return;
+
+    if (size == 0)
+        size = OE_DEFAULT_OCALL_BUFFER_SIZE;
+
+    while (size < wanted_size)
+        size *= 2;
+
+    if (size > binding->ocall_buffer_size && (buffer = malloc(size)))
+    {
+        free(binding->ocall_buffer);
+        binding->ocall_buffer = buffer;
+        binding->ocall_buffer_size = size;
+        binding->ocall_buffer_grows++;
+    }
+}
+
 /**
  * oe_enter Executes the ENCLU instruction and transfers control to the enclave.
  *
@@ -202,6 +244,8 @@ void oe_enter(
             break;
     }
 
+    _update_ocall_buffer(&ecall_context);
+
     *arg3 = arg1;
     *arg4 = arg2;
 }
@@ -293,6 +337,8 @@ void oe_enter_sim(
             break;
     }
 
+    _update_ocall_buffer(&ecall_context);
+
     *arg3 = arg1;
     *arg4 = arg2;
 }
@@ -0,0 +1,72 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "../ecallqueue.h"
+#include <openenclave/internal/raise.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+void oe_ecall_queue_wait(volatile uint32_t* address, uint32_t value)
+{
+    // Error codes are ignored since the caller checks the condition it waits
+    // for again.
+    syscall(
+        __NR_futex, address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+void oe_ecall_queue_wake(volatile uint32_t* address, bool all)
+{
+    syscall(
+        __NR_futex,
+        address,
+        FUTEX_WAKE_PRIVATE,
+        all ? INT_MAX : 1,
+        NULL,
+        NULL,
+        0);
+}
+
+oe_result_t oe_ecall_queue_open_event(intptr_t* event)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (fd == -1)
+        OE_RAISE_MSG(OE_FAILURE, "eventfd() failed: errno=%d", errno);
+
+    *event = fd;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_ecall_queue_signal_event(intptr_t event)
+{
+    uint64_t value = 1;
+
+    // The counter cannot overflow since it is reset by every poll.
+    if (write((int)event, &value, sizeof(value)) != sizeof(value))
+        OE_TRACE_WARNING("Failed to signal ECALL completions: errno=%d", errno);
+}
+
+void oe_ecall_queue_reset_event(intptr_t event)
+{
+    uint64_t value;
+
+    // The eventfd is non-blocking, so this fails with EAGAIN if the counter
+    // is already zero.
+    if (read((int)event, &value, sizeof(value)) == -1 && errno != EAGAIN)
+        OE_TRACE_WARNING("Failed to reset ECALL completions: errno=%d", errno);
+}
+
+void oe_ecall_queue_close_event(intptr_t event)
+{
+    close((int)event);
+}
@@ -5,9 +5,10 @@
 
 #include <linux/futex.h>
 #include <sys/syscall.h>
+#include <time.h>
 #include <unistd.h>
 
-static void _worker_wait(volatile int* event)
+static bool _worker_wait(volatile int* event)
 {
     // If event is 1, it means that there a pending wake notification from
     // enclave. Consume it by setting event to 0. Don't wait.
@@ -34,7 +35,11 @@ static void _worker_wait(volatile int* event)
             // Since FUTEX_WAIT uses atomic instructions to load event->value,
             // it is safe to use a non-atomic operation here.
         } while (*event == 0);
+
+        return true;
     }
+
+    return false;
 }
 
 static void _worker_wake(volatile int* event)
@@ -50,22 +55,34 @@ static void _worker_wake(volatile int* event)
         0);
 }
 
-void oe_host_worker_wait(oe_host_worker_context_t* context)
+bool oe_host_worker_wait(oe_host_worker_context_t* context)
 {
-    _worker_wait(&context->event);
+    return _worker_wait(&context->event);
 }
 
 void oe_host_worker_wake(oe_host_worker_context_t* context)
 {
+    __atomic_add_fetch(&context->total_wakeup_count, 1, __ATOMIC_RELAXED);
     _worker_wake(&context->event);
 }
 
-void oe_enclave_worker_wait(oe_enclave_worker_context_t* context)
+bool oe_enclave_worker_wait(oe_enclave_worker_context_t* context)
 {
-    _worker_wait(&context->event);
+    return _worker_wait(&context->event);
 }
 
 void oe_enclave_worker_wake(oe_enclave_worker_context_t* context)
 {
+    __atomic_add_fetch(&context->total_wakeup_count, 1, __ATOMIC_RELAXED);
     _worker_wake(&context->event);
 }
+
+uint64_t oe_switchless_get_timestamp(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,311 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "logring.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/logring.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hostthread.h"
+#include "core_u.h"
+#include "enclave.h"
+
+/*
+**==============================================================================
+**
+** Enclave log ring:
+**
+**     Enclave threads format their log messages into the entries of a ring in
+**     host memory instead of making an OCALL per message, and a host thread
+**     drains the ring into oe_log_message_at(). The thread publishes the
+**     current time in the ring before each drain, which the enclave uses to
+**     timestamp the messages.
+**
+**     The thread sleeps while the ring is empty. Its event in the ring works
+**     as the event of a switchless worker: the thread swaps it from 1 to 0
+**     and drains the ring once more before sleeping, and the enclave thread
+**     that swaps it back from 0 to 1 after posting a message wakes the host
+**     with oe_log_ring_wake_ocall(). Messages posted while the thread slept
+**     carry a stale clock and are stamped with the time it woke instead.
+**     Hence an enclave that logs rarely makes an OCALL per message, and one
+**     that logs in bursts makes an OCALL per burst.
+**
+**     The ring is a bounded multi-producer queue where the sequence number of
+**     each entry tells whether the entry is ready, as in the queue of
+**     switchless OCALLs:
+**
+**         sequence == pos      : the entry is free for the producer at pos.
+**         sequence == pos + 1  : the entry holds the message posted at pos.
+**
+**     Enclave threads never wait for the host: a message that finds the ring
+**     full is dropped and counted, and the host reports the count.
+**
+**==============================================================================
+*/
+
+/**
+ * Number of entries of the log ring of an enclave.
+ */
+#define OE_LOG_RING_CAPACITY (128U)
+
+struct _oe_log_ring_manager
+{
+    oe_log_ring_t* ring;
+
+    // Host copies of the entry array and the capacity of the ring.
+    oe_log_ring_entry_t* entries;
+    uint64_t capacity;
+    uint64_t mask;
+
+    // Serializes the drains of the thread and of oe_flush_log_ring().
+    oe_mutex lock;
+    uint64_t dequeue_pos;
+    uint64_t dropped_reported;
+    char message[OE_LOG_MESSAGE_LEN_MAX];
+
+    const char* enclave_path;
+    oe_thread_t thread;
+    bool has_thread;
+    volatile uint32_t is_stopping;
+};
+
+/* Returns the number of messages drained. The messages are known to have been
+ * posted no earlier than posted_after, in microseconds since the epoch. */
+static size_t _drain_log_ring(
+    oe_log_ring_manager_t* manager,
+    uint64_t posted_after)
+{
+    oe_log_ring_t* ring = manager->ring;
+    size_t count = 0;
+    uint64_t dropped;
+
+    oe_mutex_lock(&manager->lock);
+
+    *(volatile uint64_t*)&ring->clock = oe_log_ring_get_time();
+
+    while (true)
+    {
+        uint64_t pos = manager->dequeue_pos;
+        oe_log_ring_entry_t* entry = &manager->entries[pos & manager->mask];
+        uint32_t level;
+        uint64_t timestamp;
+        size_t length;
+
+        if (oe_atomic_load(&entry->sequence) != pos + 1)
+            break;
+
+        // Copy the message out so that the entry can be released before the
+        // message is written, and so that it is terminated whatever the
+        // enclave wrote.
+        level = entry->level;
+        timestamp = entry->timestamp;
+        if (timestamp < posted_after)
+            timestamp = posted_after;
+        length = strnlen(entry->message, sizeof(manager->message) - 1);
+        memcpy(manager->message, entry->message, length);
+        manager->message[length] = '\0';
+
+        // Free the entry for the producer that wraps around to it, once the
+        // message has been copied out.
+        oe_atomic_thread_fence();
+        *(volatile uint64_t*)&entry->sequence = pos + manager->capacity;
+        manager->dequeue_pos = pos + 1;
+        count++;
+
+        if (level < OE_LOG_LEVEL_MAX && length)
+        {
+            oe_log_message_at(
+                true, (oe_log_level_t)level, manager->message, timestamp);
+        }
+    }
+
+    *(volatile uint64_t*)&ring->dequeue_pos = manager->dequeue_pos;
+
+    dropped = oe_atomic_load(&ring->dropped);
+
+    if (dropped != manager->dropped_reported)
+    {
+        snprintf(
+            manager->message,
+            sizeof(manager->message),
+            "%s: dropped %llu log messages since the log ring was full\n",
+            manager->enclave_path,
+            (unsigned long long)(dropped - manager->dropped_reported));
+        oe_log_message(false, OE_LOG_LEVEL_WARNING, manager->message);
+        manager->dropped_reported = dropped;
+    }
+
+    oe_mutex_unlock(&manager->lock);
+
+    return count;
+}
+
+/* Returns true if the thread slept */
+static bool _wait_for_log_messages(oe_log_ring_t* ring)
+{
+    // If event is 1, the thread was awake or the enclave has a pending wake.
+    // Consume it by setting event to 0 and drain the ring once more: a
+    // message posted before the swap may not have been drained yet, and the
+    // enclave wakes the thread for any message posted after it.
+    if (oe_atomic_compare_and_swap_32(&ring->event, 1, 0))
+        return false;
+
+    // If event is still 0 after a wake, the wake was spurious.
+    do
+    {
+        oe_log_ring_wait(&ring->event, 0);
+    } while (*(volatile uint32_t*)&ring->event == 0);
+
+    return true;
+}
+
+static void* _log_ring_thread(void* arg)
+{
+    oe_log_ring_manager_t* manager = (oe_log_ring_manager_t*)arg;
+    uint64_t woken_at = 0;
+
+    while (!manager->is_stopping)
+    {
+        // Keep draining while the enclave keeps posting messages.
+        if (_drain_log_ring(manager, woken_at))
+            continue;
+
+        woken_at = 0;
+        if (_wait_for_log_messages(manager->ring))
+            woken_at = oe_log_ring_get_time();
+    }
+
+    return NULL;
+}
+
+static void _stop_log_ring_thread(oe_log_ring_manager_t* manager)
+{
+    if (manager->has_thread)
+    {
+        manager->is_stopping = 1;
+        *(volatile uint32_t*)&manager->ring->event = 1;
+        oe_log_ring_wake(&manager->ring->event);
+        oe_thread_join(manager->thread);
+        manager->has_thread = false;
+    }
+}
+
+static void _free_log_ring(oe_log_ring_manager_t* manager)
+{
+    _stop_log_ring_thread(manager);
+    oe_mutex_destroy(&manager->lock);
+    free(manager->entries);
+    free(manager->ring);
+    free(manager);
+}
+
+oe_result_t oe_start_log_ring(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    oe_log_ring_manager_t* manager = NULL;
+
+    if (!enclave || enclave->log_ring_manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Only debug enclaves log, and the thread is not worth it unless they log
+    // often or the user asked for the ring.
+    if (!enclave->debug || !oe_log_ring_is_enabled())
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(manager = calloc(1, sizeof(oe_log_ring_manager_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (oe_mutex_init(&manager->lock))
+    {
+        free(manager);
+        manager = NULL;
+        OE_RAISE(OE_FAILURE);
+    }
+
+    manager->capacity = OE_LOG_RING_CAPACITY;
+    manager->mask = OE_LOG_RING_CAPACITY - 1;
+    manager->enclave_path = enclave->path;
+
+    if (!(manager->ring = calloc(1, sizeof(oe_log_ring_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(manager->entries =
+              calloc(manager->capacity, sizeof(oe_log_ring_entry_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (uint64_t i = 0; i < manager->capacity; i++)
+        manager->entries[i].sequence = i;
+
+    manager->ring->entries = manager->entries;
+    manager->ring->capacity = manager->capacity;
+    manager->ring->clock = oe_log_ring_get_time();
+    manager->ring->event = 1;
+
+    // Start the thread first since the enclave uses the ring as soon as it
+    // accepts it.
+    if (oe_thread_create(&manager->thread, _log_ring_thread, manager))
+        OE_RAISE(OE_THREAD_CREATE_ERROR);
+
+    manager->has_thread = true;
+
+    OE_CHECK(oe_log_init_ring_ecall(enclave, &retval, manager->ring));
+    OE_CHECK(retval);
+
+    enclave->log_ring_manager = manager;
+    manager = NULL;
+    result = OE_OK;
+
+done:
+    if (manager)
+        _free_log_ring(manager);
+
+    return result;
+}
+
+void oe_flush_log_ring(oe_enclave_t* enclave)
+{
+    if (enclave && enclave->log_ring_manager)
+        _drain_log_ring(enclave->log_ring_manager, 0);
+}
+
+void oe_stop_log_ring_thread(oe_enclave_t* enclave)
+{
+    oe_log_ring_manager_t* manager;
+
+    if (!enclave || !(manager = enclave->log_ring_manager))
+        return;
+
+    _stop_log_ring_thread(manager);
+    _drain_log_ring(manager, 0);
+}
+
+void oe_stop_log_ring(oe_enclave_t* enclave)
+{
+    oe_log_ring_manager_t* manager;
+
+    if (!enclave || !(manager = enclave->log_ring_manager))
+        return;
+
+    enclave->log_ring_manager = NULL;
+
+    // Stop the thread before the last drain so that no message is left behind.
+    _stop_log_ring_thread(manager);
+    _drain_log_ring(manager, 0);
+    _free_log_ring(manager);
+}
+
+void oe_log_ring_wake_ocall(oe_log_ring_t* log_ring)
+{
+    // Waking an address that no thread waits on is harmless, so the pointer
+    // from the enclave is not validated.
+    if (log_ring)
+        oe_log_ring_wake(&log_ring->event);
+}
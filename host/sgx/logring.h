@@ -0,0 +1,52 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_LOGRING_H
+#define _OE_HOST_SGX_LOGRING_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+typedef struct _oe_log_ring_manager oe_log_ring_manager_t;
+
+/* Make the enclave post its log messages to a ring drained by a host thread.
+ * Does nothing unless in-enclave logging is enabled for the enclave. */
+oe_result_t oe_start_log_ring(oe_enclave_t* enclave);
+
+/* Drain the messages posted to the log ring of the enclave so far */
+void oe_flush_log_ring(oe_enclave_t* enclave);
+
+/* Stop the thread draining the log ring of the enclave, then drain it. The
+ * ring stays attached to the enclave, which may still post to it, until
+ * oe_stop_log_ring(). */
+void oe_stop_log_ring_thread(oe_enclave_t* enclave);
+
+/* Drain the log ring of the enclave and release it */
+void oe_stop_log_ring(oe_enclave_t* enclave);
+
+/*
+**==============================================================================
+**
+** Platform specific parts of the log ring (see logring.c):
+**
+**     The drain thread sleeps on a 32-bit word while the ring is empty and
+**     reads the wall clock to timestamp the messages of the enclave.
+**
+**==============================================================================
+*/
+
+/* Block while *address equals value. May return spuriously. */
+void oe_log_ring_wait(volatile uint32_t* address, uint32_t value);
+
+/* Wake the thread blocked on address */
+void oe_log_ring_wake(volatile uint32_t* address);
+
+/* Microseconds since the epoch */
+uint64_t oe_log_ring_get_time(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_LOGRING_H */
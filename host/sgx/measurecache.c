@@ -0,0 +1,395 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "measurecache.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../hostthread.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#endif
+
+/* Maximum number of measurements cached in process memory */
+#define MAX_CACHED_MEASUREMENTS 64
+
+/* Identifies the files of the on-disk cache, and their format */
+#define MEASUREMENT_FILE_MAGIC 0x4f454d43
+#define MEASUREMENT_FILE_VERSION 1
+
+/* Version of the layout of the enclave memory by the host. Increment it when
+ * the pages added for the same image and properties change, so that the
+ * measurements cached by older hosts are not used. The key also includes the
+ * version of the SDK, which catches the changes that were not flagged. */
+#define MEASUREMENT_LAYOUT_VERSION 1
+
+#if !defined(OE_SDK_VERSION)
+#define OE_SDK_VERSION ""
+#endif
+
+#if !defined(OE_REPO_LAST_COMMIT)
+#define OE_REPO_LAST_COMMIT ""
+#endif
+
+typedef struct _measurement_entry
+{
+    OE_SHA256 key;
+    oe_sgx_measurement_t measurement;
+} measurement_entry_t;
+
+typedef struct _measurement_file
+{
+    uint32_t magic;
+    uint32_t version;
+    measurement_entry_t entry;
+} measurement_file_t;
+
+static measurement_entry_t _entries[MAX_CACHED_MEASUREMENTS];
+static size_t _num_entries;
+
+/* Index of the entry replaced by the next new entry once the cache is full */
+static size_t _next_entry;
+
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+
+/* Counters returned by oe_get_measurement_cache_statistics() */
+static volatile uint64_t _hits;
+static volatile uint64_t _misses;
+static volatile uint64_t _evictions;
+
+oe_result_t oe_sgx_get_measurement_cache_key(
+    const oe_enclave_image_t* image,
+    const oe_sgx_enclave_properties_t* properties,
+    const sgx_attributes_t* attributes,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+    const uint32_t version = MEASUREMENT_LAYOUT_VERSION;
+    static const char sdk_version[] = OE_SDK_VERSION "/" OE_REPO_LAST_COMMIT;
+
+    if (!image || !properties || !attributes || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (image->type != OE_IMAGE_TYPE_ELF)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, &version, sizeof(version)));
+    OE_CHECK(oe_sha256_update(&context, sdk_version, sizeof(sdk_version)));
+
+    /* The pages of the image and their layout. Only the fields of the
+     * segments are hashed, not the pointer to their data in the image. */
+    OE_CHECK(oe_sha256_update(&context, image->image_base, image->image_size));
+
+    for (size_t i = 0; i < image->u.elf.num_segments; i++)
+    {
+        const oe_elf_segment_t* segment = &image->u.elf.segments[i];
+        const uint64_t fields[] = {segment->filesz,
+                                   segment->memsz,
+                                   segment->offset,
+                                   segment->vaddr,
+                                   segment->flags};
+
+        OE_CHECK(oe_sha256_update(&context, fields, sizeof(fields)));
+    }
+
+    if (image->reloc_size)
+        OE_CHECK(oe_sha256_update(
+            &context, image->u.elf.reloc_data, image->reloc_size));
+
+    /* The fields of the image used to lay out the data pages */
+    OE_CHECK(oe_sha256_update(
+        &context, &image->entry_rva, sizeof(image->entry_rva)));
+    OE_CHECK(oe_sha256_update(
+        &context, &image->tdata_rva, sizeof(image->tdata_rva)));
+    OE_CHECK(oe_sha256_update(
+        &context, &image->tdata_size, sizeof(image->tdata_size)));
+    OE_CHECK(oe_sha256_update(
+        &context, &image->tdata_align, sizeof(image->tdata_align)));
+    OE_CHECK(oe_sha256_update(
+        &context, &image->tbss_size, sizeof(image->tbss_size)));
+    OE_CHECK(oe_sha256_update(
+        &context, &image->tbss_align, sizeof(image->tbss_align)));
+
+    /* The sizes, attributes and signature of the enclave */
+    OE_CHECK(oe_sha256_update(&context, properties, sizeof(*properties)));
+    OE_CHECK(oe_sha256_update(&context, attributes, sizeof(*attributes)));
+
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Format the path of the file of the key in the directory */
+static char* _get_measurement_file_path(
+    const char* directory,
+    const OE_SHA256* key)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t length = strlen(directory) + 1 + 2 * sizeof(key->buf) + 8;
+    char* path;
+    char* p;
+
+    if (!(path = malloc(length)))
+        return NULL;
+
+    p = path + snprintf(path, length, "%s/", directory);
+
+    for (size_t i = 0; i < sizeof(key->buf); i++)
+    {
+        *p++ = hex[key->buf[i] >> 4];
+        *p++ = hex[key->buf[i] & 0xf];
+    }
+
+    memcpy(p, ".mrencl", 8);
+
+    return path;
+}
+
+static FILE* _open_file(const char* path, const char* mode)
+{
+#if defined(__linux__)
+    return fopen(path, mode);
+#elif defined(_MSC_VER)
+    FILE* file;
+
+    if (fopen_s(&file, path, mode) != 0)
+        return NULL;
+
+    return file;
+#endif
+}
+
+static bool _read_measurement_file(
+    const char* directory,
+    const OE_SHA256* key,
+    oe_sgx_measurement_t* measurement)
+{
+    bool found = false;
+    char* path = NULL;
+    FILE* file = NULL;
+    measurement_file_t contents;
+
+    if (!(path = _get_measurement_file_path(directory, key)))
+        goto done;
+
+    /* A missing file is a cache miss */
+    if (!(file = _open_file(path, "rb")))
+        goto done;
+
+    if (fread(&contents, sizeof(contents), 1, file) != 1)
+        goto done;
+
+    if (contents.magic != MEASUREMENT_FILE_MAGIC ||
+        contents.version != MEASUREMENT_FILE_VERSION ||
+        memcmp(&contents.entry.key, key, sizeof(*key)) != 0)
+    {
+        OE_TRACE_WARNING("ignoring invalid measurement cache file %s\n", path);
+        goto done;
+    }
+
+    *measurement = contents.entry.measurement;
+    found = true;
+
+done:
+    if (file)
+        fclose(file);
+
+    free(path);
+
+    return found;
+}
+
+static void _write_measurement_file(
+    const char* directory,
+    const measurement_entry_t* entry)
+{
+    char* path = NULL;
+    char* tmp_path = NULL;
+    size_t tmp_path_length;
+    FILE* file = NULL;
+    measurement_file_t contents;
+    bool written = false;
+
+    if (!(path = _get_measurement_file_path(directory, &entry->key)))
+        goto done;
+
+    /* Write a temporary file then rename it, so that other processes never
+     * read a partially written file */
+    tmp_path_length = strlen(path) + 32;
+
+    if (!(tmp_path = malloc(tmp_path_length)))
+        goto done;
+
+#if defined(_WIN32)
+    snprintf(tmp_path, tmp_path_length, "%s.%d", path, _getpid());
+#else
+    snprintf(tmp_path, tmp_path_length, "%s.%d", path, (int)getpid());
+#endif
+
+    if (!(file = _open_file(tmp_path, "wb")))
+        goto done;
+
+    memset(&contents, 0, sizeof(contents));
+    contents.magic = MEASUREMENT_FILE_MAGIC;
+    contents.version = MEASUREMENT_FILE_VERSION;
+    contents.entry = *entry;
+
+    written = fwrite(&contents, sizeof(contents), 1, file) == 1;
+
+    if (fclose(file) != 0)
+        written = false;
+
+    file = NULL;
+
+    /* Renaming fails on Windows if another process stored the file first */
+    if (!written || rename(tmp_path, path) != 0)
+    {
+        OE_TRACE_WARNING("failed to store measurement cache file %s\n", path);
+        remove(tmp_path);
+    }
+
+done:
+    free(tmp_path);
+    free(path);
+}
+
+bool oe_sgx_find_cached_measurement(
+    const char* directory,
+    const OE_SHA256* key,
+    oe_sgx_measurement_t* measurement)
+{
+    bool found = false;
+
+    if (!key || !measurement)
+        return false;
+
+    oe_mutex_lock(&_lock);
+    {
+        for (size_t i = 0; i < _num_entries; i++)
+        {
+            if (memcmp(&_entries[i].key, key, sizeof(*key)) == 0)
+            {
+                *measurement = _entries[i].measurement;
+                found = true;
+                break;
+            }
+        }
+    }
+    oe_mutex_unlock(&_lock);
+
+    if (!found && directory)
+    {
+        if ((found = _read_measurement_file(directory, key, measurement)))
+            oe_sgx_cache_measurement(NULL, key, measurement);
+    }
+
+    oe_atomic_increment(found ? &_hits : &_misses);
+
+    return found;
+}
+
+void oe_sgx_evict_cached_measurement(
+    const char* directory,
+    const OE_SHA256* key)
+{
+    char* path = NULL;
+
+    if (!key)
+        return;
+
+    oe_mutex_lock(&_lock);
+    {
+        for (size_t i = 0; i < _num_entries; i++)
+        {
+            if (memcmp(&_entries[i].key, key, sizeof(*key)) == 0)
+            {
+                /* Move the last entry into the hole */
+                _entries[i] = _entries[--_num_entries];
+
+                if (_next_entry >= _num_entries)
+                    _next_entry = 0;
+
+                break;
+            }
+        }
+    }
+    oe_mutex_unlock(&_lock);
+
+    /* Another process may be reading the file, or have removed it already */
+    if (directory && (path = _get_measurement_file_path(directory, key)))
+    {
+        remove(path);
+        free(path);
+    }
+
+    oe_atomic_increment(&_evictions);
+}
+
+void oe_sgx_cache_measurement(
+    const char* directory,
+    const OE_SHA256* key,
+    const oe_sgx_measurement_t* measurement)
+{
+    measurement_entry_t* entry = NULL;
+
+    if (!key || !measurement)
+        return;
+
+    oe_mutex_lock(&_lock);
+    {
+        /* Another thread may have stored the same measurement */
+        for (size_t i = 0; i < _num_entries && !entry; i++)
+        {
+            if (memcmp(&_entries[i].key, key, sizeof(*key)) == 0)
+                entry = &_entries[i];
+        }
+
+        if (!entry)
+        {
+            if (_num_entries < MAX_CACHED_MEASUREMENTS)
+            {
+                entry = &_entries[_num_entries++];
+            }
+            else
+            {
+                entry = &_entries[_next_entry];
+                _next_entry = (_next_entry + 1) % MAX_CACHED_MEASUREMENTS;
+            }
+        }
+
+        entry->key = *key;
+        entry->measurement = *measurement;
+    }
+    oe_mutex_unlock(&_lock);
+
+    if (directory)
+    {
+        measurement_entry_t copy = {*key, *measurement};
+        _write_measurement_file(directory, &copy);
+    }
+}
+
+oe_result_t oe_get_measurement_cache_statistics(
+    oe_measurement_cache_statistics_t* statistics)
+{
+    if (!statistics)
+        return OE_INVALID_PARAMETER;
+
+    statistics->hits = oe_atomic_load(&_hits);
+    statistics->misses = oe_atomic_load(&_misses);
+    statistics->evictions = oe_atomic_load(&_evictions);
+
+    return OE_OK;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_MEASURECACHE_H
+#define _OE_HOST_SGX_MEASURECACHE_H
+
+#include <openenclave/internal/crypto/sha.h>
+#include <openenclave/internal/load.h>
+#include <openenclave/internal/properties.h>
+#include <openenclave/internal/sgxcreate.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** The measurement cache:
+**
+**     Maps a digest of everything that determines the measurement of an
+**     enclave (its loaded image, its properties and the attributes of the
+**     load context) to the MRENCLAVE computed by the host and the SIGSTRUCT
+**     passed to EINIT. The cache lives in process memory and, optionally, in
+**     files of a directory shared by several processes.
+**
+**     An entry whose SIGSTRUCT does not carry its MRENCLAVE, or differs from
+**     the SIGSTRUCT of a signed enclave, is evicted before use. Any other
+**     wrong entry cannot make an enclave run with unexpected contents either,
+**     since EINIT checks the SIGSTRUCT against the measurement computed by
+**     the platform. Such an entry is evicted and the enclave is created again
+**     with a full measurement. Since nothing checks the measurement of a
+**     simulated enclave, the cache is not used in simulation mode.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_get_measurement_cache_key(
+    const oe_enclave_image_t* image,
+    const oe_sgx_enclave_properties_t* properties,
+    const sgx_attributes_t* attributes,
+    OE_SHA256* key);
+
+/* Look the key up in process memory, then in the directory if not NULL. */
+bool oe_sgx_find_cached_measurement(
+    const char* directory,
+    const OE_SHA256* key,
+    oe_sgx_measurement_t* measurement);
+
+/* Drop the measurement from process memory, and from the directory if not
+ * NULL, after EINIT rejected it. */
+void oe_sgx_evict_cached_measurement(
+    const char* directory,
+    const OE_SHA256* key);
+
+/* Store the measurement in process memory, and in the directory if not
+ * NULL. Failing to store it is not an error. */
+void oe_sgx_cache_measurement(
+    const char* directory,
+    const OE_SHA256* key,
+    const oe_sgx_measurement_t* measurement);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_MEASURECACHE_H */
@@ -98,6 +98,21 @@ void oe_sgx_thread_wake_wait_ocall(
     HandleThreadWait(enclave, self_tcs);
 }
 
+void oe_sgx_thread_wake_multiple_ocall(
+    oe_enclave_t* enclave,
+    const uint64_t* tcs,
+    size_t tcs_count)
+{
+    if (!tcs)
+        return;
+
+    for (size_t i = 0; i < tcs_count; i++)
+    {
+        if (tcs[i])
+            HandleThreadWake(enclave, tcs[i]);
+    }
+}
+
 oe_result_t oe_get_quote_ocall(
     const oe_uuid_t* format_id,
     const void* opt_params,
@@ -118,6 +133,25 @@ oe_result_t oe_get_quote_ocall(
     return result;
 }
 
+oe_result_t oe_get_quotes_ocall(
+    const oe_uuid_t* format_id,
+    const sgx_report_t* reports,
+    size_t report_count,
+    void* quotes,
+    size_t quotes_size,
+    size_t* quote_size_out,
+    oe_result_t* results)
+{
+    return sgx_get_quotes(
+        format_id,
+        reports,
+        report_count,
+        (uint8_t*)quotes,
+        quotes_size,
+        quote_size_out,
+        results);
+}
+
 #if defined(OE_LINK_SGX_DCAP_QL)
 
 /* Copy the source array to an output buffer. */
@@ -8,6 +8,7 @@
 #include <openenclave/host.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/safemath.h>
 #include <openenclave/internal/utils.h>
 
 #if defined(OE_LINK_SGX_DCAP_QL)
@@ -15,6 +16,22 @@
 #include "sgxquoteprovider.h"
 #endif
 
+oe_result_t sgx_preload_quote_library(void)
+{
+#if defined(OE_LINK_SGX_DCAP_QL)
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(oe_initialize_quote_provider());
+    OE_CHECK(oe_sgx_qe_preload());
+
+    result = OE_OK;
+done:
+    return result;
+#else
+    return OE_UNSUPPORTED;
+#endif
+}
+
 oe_result_t sgx_get_qetarget_info(
     const oe_uuid_t* format_id,
     const void* opt_params,
@@ -64,6 +81,8 @@ oe_result_t sgx_get_quote_size(
         OE_RAISE(OE_INVALID_PARAMETER);
 
 #if defined(OE_LINK_SGX_DCAP_QL)
+    // Enclaves may query the size of quotes before getting the target info.
+    OE_CHECK(oe_initialize_quote_provider());
     result = oe_sgx_qe_get_quote_size(
         format_id, opt_params, opt_params_size, quote_size);
 #else
@@ -129,6 +148,51 @@ done:
     return result;
 }
 
+oe_result_t sgx_get_quotes(
+    const oe_uuid_t* format_id,
+    const sgx_report_t* reports,
+    size_t report_count,
+    uint8_t* quotes,
+    size_t quotes_size,
+    size_t* quote_size,
+    oe_result_t* results)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t size = 0;
+    size_t total_size = 0;
+
+    if (!format_id || !reports || !report_count || !quote_size || !results)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    *quote_size = 0;
+
+    /* The quotes are written one after the other, all with the same size */
+    OE_CHECK(sgx_get_quote_size(format_id, NULL, 0, &size));
+    OE_CHECK(oe_safe_mul_sizet(size, report_count, &total_size));
+
+    *quote_size = size;
+
+    if (!quotes || quotes_size < total_size)
+        OE_CHECK_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+    memset(quotes, 0, total_size);
+
+    for (size_t i = 0; i < report_count; i++)
+    {
+#if defined(OE_LINK_SGX_DCAP_QL)
+        results[i] = oe_sgx_qe_get_quote(
+            format_id, NULL, 0, (uint8_t*)&reports[i], size, quotes + i * size);
+#else
+        results[i] = OE_UNSUPPORTED;
+#endif
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t sgx_get_supported_attester_format_ids(
     void* format_ids,
     size_t* format_ids_size)
@@ -54,6 +54,38 @@ oe_result_t sgx_get_quote(
     uint8_t* quote,
     size_t* quote_size);
 
+/*
+**==============================================================================
+**
+** sgx_get_quotes()
+**
+**     Get the quotes of several reports in one pass. The quotes all have the
+**     same size, returned in quote_size, and are written one after the other
+**     in the quotes buffer. The result of each quote is returned in results.
+**
+**==============================================================================
+*/
+oe_result_t sgx_get_quotes(
+    const oe_uuid_t* format_id,
+    const sgx_report_t* reports,
+    size_t report_count,
+    uint8_t* quotes,
+    size_t quotes_size,
+    size_t* quote_size,
+    oe_result_t* results);
+
+/*
+**==============================================================================
+**
+** sgx_preload_quote_library()
+**
+**     Load the quote library and quote provider, and fetch the target info of
+**     the Quoting Enclave, ahead of the first quote.
+**
+**==============================================================================
+*/
+oe_result_t sgx_preload_quote_library(void);
+
 /*
 **==============================================================================
 **
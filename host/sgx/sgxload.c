@@ -7,6 +7,7 @@
 #endif // OEHOSTMR
 #if defined(__linux__)
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 #elif defined(_WIN32)
 #include <Windows.h>
@@ -23,6 +24,7 @@
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../common/sgx/sgxmeasure.h"
+#include "../hostthread.h"
 #include "../memalign.h"
 #include "../signkey.h"
 #include "enclave.h"
@@ -365,6 +367,416 @@ done:
 }
 #endif // OEHOSTMR
 
+uint64_t oe_sgx_get_load_timestamp(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+#elif defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion to avoid overflowing the multiplication.
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL /
+               (uint64_t)frequency.QuadPart;
+#endif
+}
+
+/*
+**==============================================================================
+**
+** The measurement pipeline:
+**
+**     When an enclave is created, the host computes MRENCLAVE in software
+**     alongside the platform, since it needs it to sign a debug SIGSTRUCT
+**     before EINIT. Rather than hashing each page before adding it, the page
+**     adds are recorded in a batch (with a copy of the measured pages, which
+**     runs of identical pages share), and full batches are queued to a worker
+**     thread that hashes them while the next batches of pages are added. The
+**     worker lives as long as the pipeline and hashes the batches in order.
+**
+**     The queue is a ring of batches: the batch being filled is the one at
+**     the submitted count, and the worker hashes the batches from the
+**     measured count up to the submitted count. The loader waits for the
+**     worker only when all the batches are queued.
+**
+**==============================================================================
+*/
+
+/* Maximum number of page adds and of measured pages in a batch */
+#define OE_SGX_MEASURE_BATCH_RECORDS 4096
+#define OE_SGX_MEASURE_BATCH_PAGES 256
+
+/* Number of batches of the queue, including the one being filled */
+#define OE_SGX_MEASURE_QUEUE_BATCHES 3
+
+typedef struct _oe_sgx_measure_record
+{
+    uint64_t vaddr;
+    uint64_t flags;
+
+    /* Index of the copy of the page in the batch if it is measured, or
+     * OE_SGX_MEASURE_BATCH_PAGES otherwise */
+    uint64_t page;
+} oe_sgx_measure_record_t;
+
+typedef struct _oe_sgx_measure_batch
+{
+    /* Base address of the enclave, which is not known until it is created */
+    uint64_t base;
+
+    oe_sgx_measure_record_t* records;
+    size_t num_records;
+    oe_page_t* pages;
+    size_t num_pages;
+} oe_sgx_measure_batch_t;
+
+struct _oe_sgx_measure_pipeline
+{
+    oe_sha256_context_t* hash_context;
+
+    oe_sgx_measure_batch_t batches[OE_SGX_MEASURE_QUEUE_BATCHES];
+
+    /* Number of batches handed to the worker and hashed by it. Updated with
+     * the lock held once the worker is running. */
+    size_t submitted;
+    size_t measured;
+    bool stopping;
+
+    /* The first error of the worker */
+    oe_result_t worker_result;
+
+    oe_thread_t worker;
+    bool has_worker;
+
+    /* Signaled when a batch is submitted, hashed, or the worker must stop */
+#if defined(__linux__)
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#elif defined(_WIN32)
+    SRWLOCK lock;
+    CONDITION_VARIABLE cond;
+#endif
+
+    /* Time spent hashing, updated by the thread hashing */
+    uint64_t measure_time;
+};
+
+static void _lock_measure_pipeline(oe_sgx_measure_pipeline_t* pipeline)
+{
+#if defined(__linux__)
+    pthread_mutex_lock(&pipeline->lock);
+#elif defined(_WIN32)
+    AcquireSRWLockExclusive(&pipeline->lock);
+#endif
+}
+
+static void _unlock_measure_pipeline(oe_sgx_measure_pipeline_t* pipeline)
+{
+#if defined(__linux__)
+    pthread_mutex_unlock(&pipeline->lock);
+#elif defined(_WIN32)
+    ReleaseSRWLockExclusive(&pipeline->lock);
+#endif
+}
+
+/* Wait for a change of the pipeline. Called with the lock held. */
+static void _wait_measure_pipeline(oe_sgx_measure_pipeline_t* pipeline)
+{
+#if defined(__linux__)
+    pthread_cond_wait(&pipeline->cond, &pipeline->lock);
+#elif defined(_WIN32)
+    SleepConditionVariableSRW(&pipeline->cond, &pipeline->lock, INFINITE, 0);
+#endif
+}
+
+static void _wake_measure_pipeline(oe_sgx_measure_pipeline_t* pipeline)
+{
+#if defined(__linux__)
+    pthread_cond_broadcast(&pipeline->cond);
+#elif defined(_WIN32)
+    WakeAllConditionVariable(&pipeline->cond);
+#endif
+}
+
+static oe_result_t _measure_batch(
+    oe_sgx_measure_pipeline_t* pipeline,
+    oe_sgx_measure_batch_t* batch)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t start = oe_sgx_get_load_timestamp();
+
+    for (size_t i = 0; i < batch->num_records; i++)
+    {
+        const oe_sgx_measure_record_t* record = &batch->records[i];
+        bool extend = record->page < OE_SGX_MEASURE_BATCH_PAGES;
+
+        /* The source of an unmeasured page is not read, but must be set */
+        OE_CHECK(oe_sgx_measure_load_enclave_data(
+            pipeline->hash_context,
+            batch->base,
+            batch->base + record->vaddr,
+            (uint64_t)(extend ? &batch->pages[record->page] : batch->pages),
+            record->flags,
+            extend));
+    }
+
+    result = OE_OK;
+
+done:
+    batch->num_records = 0;
+    batch->num_pages = 0;
+    pipeline->measure_time += oe_sgx_get_load_timestamp() - start;
+    return result;
+}
+
+static void* _measure_worker_thread(void* arg)
+{
+    oe_sgx_measure_pipeline_t* pipeline = (oe_sgx_measure_pipeline_t*)arg;
+
+    _lock_measure_pipeline(pipeline);
+
+    for (;;)
+    {
+        oe_sgx_measure_batch_t* batch;
+        size_t index;
+        oe_result_t result;
+
+        while (pipeline->measured == pipeline->submitted &&
+               !pipeline->stopping)
+            _wait_measure_pipeline(pipeline);
+
+        if (pipeline->stopping)
+            break;
+
+        index = pipeline->measured % OE_SGX_MEASURE_QUEUE_BATCHES;
+        batch = &pipeline->batches[index];
+
+        /* Hash the batch while the loader fills the next ones */
+        _unlock_measure_pipeline(pipeline);
+        result = _measure_batch(pipeline, batch);
+        _lock_measure_pipeline(pipeline);
+
+        if (pipeline->worker_result == OE_OK)
+            pipeline->worker_result = result;
+
+        pipeline->measured++;
+        _wake_measure_pipeline(pipeline);
+    }
+
+    _unlock_measure_pipeline(pipeline);
+
+    return NULL;
+}
+
+static oe_sgx_measure_batch_t* _current_measure_batch(
+    oe_sgx_measure_pipeline_t* pipeline)
+{
+    size_t index = pipeline->submitted % OE_SGX_MEASURE_QUEUE_BATCHES;
+
+    return &pipeline->batches[index];
+}
+
+/* Queue the current batch to the worker and start filling the next one. If
+ * wait_all is set, also wait for the worker to hash all the queued batches;
+ * otherwise wait only until the next batch is free. */
+static oe_result_t _submit_measure_batch(
+    oe_sgx_measure_pipeline_t* pipeline,
+    bool wait_all)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    /* Hash the batch on this thread if the worker could not be created */
+    if (!pipeline->has_worker)
+        return _measure_batch(pipeline, _current_measure_batch(pipeline));
+
+    _lock_measure_pipeline(pipeline);
+
+    if (_current_measure_batch(pipeline)->num_records)
+    {
+        pipeline->submitted++;
+        _wake_measure_pipeline(pipeline);
+    }
+
+    while (pipeline->submitted - pipeline->measured ==
+               OE_SGX_MEASURE_QUEUE_BATCHES ||
+           (wait_all && pipeline->measured != pipeline->submitted))
+        _wait_measure_pipeline(pipeline);
+
+    result = pipeline->worker_result;
+
+    _unlock_measure_pipeline(pipeline);
+
+    return result;
+}
+
+static oe_result_t _queue_measurement(
+    oe_sgx_measure_pipeline_t* pipeline,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_measure_batch_t* batch = _current_measure_batch(pipeline);
+    oe_sgx_measure_record_t* record;
+
+    if (batch->num_records == OE_SGX_MEASURE_BATCH_RECORDS ||
+        (extend && batch->num_pages == OE_SGX_MEASURE_BATCH_PAGES))
+    {
+        OE_CHECK(_submit_measure_batch(pipeline, false));
+        batch = _current_measure_batch(pipeline);
+    }
+
+    batch->base = base;
+
+    record = &batch->records[batch->num_records++];
+    record->vaddr = addr - base;
+    record->flags = flags;
+    record->page = OE_SGX_MEASURE_BATCH_PAGES;
+
+    if (extend)
+    {
+        const oe_page_t* last =
+            batch->num_pages ? &batch->pages[batch->num_pages - 1] : NULL;
+
+        /* Runs of identical pages, such as the zero-filled SSA and TLS pages
+         * or the stack pages, share the copy of the first page of the run */
+        if (last && memcmp(last, (const void*)src, OE_PAGE_SIZE) == 0)
+        {
+            record->page = batch->num_pages - 1;
+        }
+        else
+        {
+            record->page = batch->num_pages++;
+            memcpy(
+                &batch->pages[record->page], (const void*)src, OE_PAGE_SIZE);
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _delete_measure_pipeline(oe_sgx_measure_pipeline_t* pipeline)
+{
+    if (pipeline->has_worker)
+    {
+        _lock_measure_pipeline(pipeline);
+        pipeline->stopping = true;
+        _wake_measure_pipeline(pipeline);
+        _unlock_measure_pipeline(pipeline);
+
+        /* The worker may still use the pipeline if it cannot be joined */
+        if (oe_thread_join(pipeline->worker) != 0)
+        {
+            OE_TRACE_ERROR("Failed to join the measurement worker thread");
+            return;
+        }
+    }
+
+#if defined(__linux__)
+    pthread_cond_destroy(&pipeline->cond);
+    pthread_mutex_destroy(&pipeline->lock);
+#endif
+
+    for (size_t i = 0; i < OE_COUNTOF(pipeline->batches); i++)
+    {
+        free(pipeline->batches[i].records);
+
+        if (pipeline->batches[i].pages)
+            oe_memalign_free(pipeline->batches[i].pages);
+    }
+
+    free(pipeline);
+}
+
+static oe_result_t _new_measure_pipeline(
+    oe_sha256_context_t* hash_context,
+    oe_sgx_measure_pipeline_t** pipeline_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_measure_pipeline_t* pipeline = NULL;
+
+    if (!(pipeline = calloc(1, sizeof(oe_sgx_measure_pipeline_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    pipeline->hash_context = hash_context;
+    pipeline->worker_result = OE_OK;
+
+#if defined(__linux__)
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->cond, NULL);
+#elif defined(_WIN32)
+    InitializeSRWLock(&pipeline->lock);
+    InitializeConditionVariable(&pipeline->cond);
+#endif
+
+    for (size_t i = 0; i < OE_COUNTOF(pipeline->batches); i++)
+    {
+        oe_sgx_measure_batch_t* batch = &pipeline->batches[i];
+
+        if (!(batch->records = calloc(
+                  OE_SGX_MEASURE_BATCH_RECORDS,
+                  sizeof(oe_sgx_measure_record_t))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        if (!(batch->pages = oe_memalign(
+                  OE_PAGE_SIZE,
+                  OE_SGX_MEASURE_BATCH_PAGES * sizeof(oe_page_t))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    /* Hash the batches on the loading thread if the worker cannot be
+     * created */
+    if (oe_thread_create(&pipeline->worker, _measure_worker_thread, pipeline) ==
+        0)
+        pipeline->has_worker = true;
+
+    *pipeline_out = pipeline;
+    pipeline = NULL;
+    result = OE_OK;
+
+done:
+    if (pipeline)
+        _delete_measure_pipeline(pipeline);
+
+    return result;
+}
+
+oe_result_t oe_sgx_sync_load_measurement(oe_sgx_load_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_measure_pipeline_t* pipeline;
+
+    if (!context)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((pipeline = context->measure_pipeline))
+    {
+        OE_CHECK(_submit_measure_batch(pipeline, true));
+        context->timings.measure = pipeline->measure_time;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_sgx_initialize_load_context(
     oe_sgx_load_context_t* context,
     oe_sgx_load_type_t type,
@@ -393,6 +805,9 @@ done:
 
 void oe_sgx_cleanup_load_context(oe_sgx_load_context_t* context)
 {
+    if (context->measure_pipeline)
+        _delete_measure_pipeline(context->measure_pipeline);
+
     /* Clear all fields, this also sets state to undefined */
     memset(context, 0, sizeof(oe_sgx_load_context_t));
 }
@@ -446,8 +861,16 @@ oe_result_t oe_sgx_create_enclave(
     if (!(secs = _new_secs((uint64_t)base, enclave_size, context)))
         OE_RAISE(OE_OUT_OF_MEMORY);
 
-    /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_create_enclave(&context->hash_context, secs));
+    /* Measure this operation, unless the measurement was cached */
+    if (!context->measurement_cached)
+    {
+        OE_CHECK(oe_sgx_measure_create_enclave(&context->hash_context, secs));
+
+        /* Measure the pages on a worker thread as they are added */
+        if (context->type == OE_SGX_LOAD_TYPE_CREATE)
+            OE_CHECK(_new_measure_pipeline(
+                &context->hash_context, &context->measure_pipeline));
+    }
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -607,35 +1030,55 @@ static void _dump_load_enclave_data(
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
-oe_result_t oe_sgx_load_enclave_data(
+oe_result_t oe_sgx_load_enclave_pages(
     oe_sgx_load_context_t* context,
     uint64_t base,
     uint64_t addr,
     uint64_t src,
+    size_t size,
     uint64_t flags,
     bool extend)
 {
     oe_result_t result = OE_UNEXPECTED;
 
-    if (!context || !base || !addr || !src || !flags)
+    if (!context || !base || !addr || !src || !size || !flags)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* addr and src must both be page aligned */
-    if (addr % OE_PAGE_SIZE || src % OE_PAGE_SIZE)
+    /* addr, src and size must all be page aligned */
+    if (addr % OE_PAGE_SIZE || src % OE_PAGE_SIZE || size % OE_PAGE_SIZE)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    /* Measure this operation, one page at a time like the platform */
+    for (size_t offset = 0; offset < size && !context->measurement_cached;
+         offset += OE_PAGE_SIZE)
+    {
 #if defined(OE_TRACE_MEASURE)
 
-    _dump_load_enclave_data(addr - base, flags, src, extend);
+        _dump_load_enclave_data(
+            addr + offset - base, flags, src + offset, extend);
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
-    /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_load_enclave_data(
-        &context->hash_context, base, addr, src, flags, extend));
+        if (context->measure_pipeline)
+            OE_CHECK(_queue_measurement(
+                context->measure_pipeline,
+                base,
+                addr + offset,
+                src + offset,
+                flags,
+                extend));
+        else
+            OE_CHECK(oe_sgx_measure_load_enclave_data(
+                &context->hash_context,
+                base,
+                addr + offset,
+                src + offset,
+                flags,
+                extend));
+    }
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -647,16 +1090,16 @@ oe_result_t oe_sgx_load_enclave_data(
     else if (oe_sgx_is_simulation_load_context(context))
     {
         /* Simulate enclave add page */
-        /* Verify that page is within enclave boundaries */
+        /* Verify that the pages are within enclave boundaries */
         if ((void*)addr < context->sim.addr ||
+            size > context->sim.size ||
             (uint8_t*)addr >
-                (uint8_t*)context->sim.addr + context->sim.size - OE_PAGE_SIZE)
+                (uint8_t*)context->sim.addr + context->sim.size - size)
             OE_RAISE_MSG(
                 OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
 
         /* Copy page contents onto memory-mapped region */
-        OE_CHECK(oe_memcpy_s(
-            (uint8_t*)addr, OE_PAGE_SIZE, (uint8_t*)src, OE_PAGE_SIZE));
+        OE_CHECK(oe_memcpy_s((uint8_t*)addr, size, (uint8_t*)src, size));
 
         /* Set page access permissions */
         {
@@ -667,7 +1110,7 @@ oe_result_t oe_sgx_load_enclave_data(
                     OE_FAILURE, "Unexpected page protections: %#x", prot);
 
 #if defined(__linux__)
-            if (mprotect((void*)addr, OE_PAGE_SIZE, prot) != 0)
+            if (mprotect((void*)addr, size, prot) != 0)
                 OE_RAISE_MSG(
                     OE_FAILURE,
                     "mprotect failed (addr=%#x, prot=%#x)",
@@ -675,7 +1118,7 @@ oe_result_t oe_sgx_load_enclave_data(
                     prot);
 #elif defined(_WIN32)
             DWORD old;
-            if (!VirtualProtect((LPVOID)addr, OE_PAGE_SIZE, prot, &old))
+            if (!VirtualProtect((LPVOID)addr, size, prot, &old))
                 OE_RAISE_MSG(
                     OE_FAILURE,
                     "VirtualProtect failed (addr=%#x, prot=%#x)",
@@ -687,22 +1130,32 @@ oe_result_t oe_sgx_load_enclave_data(
     else
     {
         int protect = _make_memory_protect_param(flags, false /*not simulate*/);
+        uint64_t start = oe_sgx_get_load_timestamp();
+
         if (!extend)
             protect |= ENCLAVE_PAGE_UNVALIDATED;
 
+        /* The platform adds (and extends) all the pages in a single request */
         uint32_t enclave_error;
         if (oe_sgx_enclave_load_data(
                 (void*)addr,
-                OE_PAGE_SIZE,
+                size,
                 (const void*)src,
                 (uint32_t)protect,
-                &enclave_error) != OE_PAGE_SIZE)
+                &enclave_error) != size)
             OE_RAISE_MSG(
                 OE_PLATFORM_ERROR,
-                "enclave_load_data failed (addr=%#x, prot=%#x, err=%#x)",
+                "enclave_load_data failed (addr=%#x, size=%#x, prot=%#x, "
+                "err=%#x)",
                 addr,
+                size,
                 protect,
                 enclave_error);
+
+        if (extend)
+            context->timings.eextend += oe_sgx_get_load_timestamp() - start;
+        else
+            context->timings.eadd += oe_sgx_get_load_timestamp() - start;
     }
 #endif // OEHOSTMR
 
@@ -712,6 +1165,18 @@ done:
     return result;
 }
 
+oe_result_t oe_sgx_load_enclave_data(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    return oe_sgx_load_enclave_pages(
+        context, base, addr, src, OE_PAGE_SIZE, flags, extend);
+}
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -729,28 +1194,45 @@ oe_result_t oe_sgx_initialize_enclave(
     if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* Measure this operation */
-    OE_CHECK(
-        oe_sgx_measure_initialize_enclave(&context->hash_context, mrenclave));
+    /* Measure this operation, unless the measurement was cached */
+    if (context->measurement_cached)
+    {
+        *mrenclave = context->measurement.mrenclave;
+    }
+    else
+    {
+        OE_CHECK(oe_sgx_sync_load_measurement(context));
+        OE_CHECK(oe_sgx_measure_initialize_enclave(
+            &context->hash_context, mrenclave));
+        context->measurement.mrenclave = *mrenclave;
+    }
 #if !defined(OEHOSTMR)
     /* EINIT has no further action in measurement/simulation mode */
     if (context->type == OE_SGX_LOAD_TYPE_CREATE &&
         !oe_sgx_is_simulation_load_context(context))
     {
+        uint64_t start = oe_sgx_get_load_timestamp();
+        sgx_sigstruct_t* sigstruct = &context->measurement.sigstruct;
+
         /* Get a debug sigstruct for MRENCLAVE if necessary */
-        sgx_sigstruct_t sigstruct;
-        OE_CHECK(_get_sig_struct(properties, mrenclave, &sigstruct));
+        if (!context->measurement_cached)
+            OE_CHECK(_get_sig_struct(properties, mrenclave, sigstruct));
 
         uint32_t enclave_error = 0;
         if (!oe_sgx_enclave_initialize(
                 (void*)addr,
-                (const void*)&sigstruct,
+                (const void*)sigstruct,
                 sizeof(sgx_sigstruct_t),
                 &enclave_error))
+        {
+            context->measurement_rejected = context->measurement_cached;
             OE_RAISE_MSG(
                 OE_PLATFORM_ERROR,
                 "enclave_initialize failed (err=%#x)",
                 enclave_error);
+        }
+
+        context->timings.einit = oe_sgx_get_load_timestamp() - start;
     }
 #endif // OEHOSTMR
     context->state = OE_SGX_LOAD_STATE_ENCLAVE_INITIALIZED;
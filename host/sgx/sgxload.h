@@ -38,6 +38,24 @@ oe_result_t oe_sgx_load_enclave_data(
     uint64_t flags,
     bool extend);
 
+/* Add the pages in the size bytes at src, which all have the same flags, in
+ * a single request to the platform. */
+oe_result_t oe_sgx_load_enclave_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    size_t size,
+    uint64_t flags,
+    bool extend);
+
+/* Wait until all the pages added so far are measured in
+ * context->hash_context. */
+oe_result_t oe_sgx_sync_load_measurement(oe_sgx_load_context_t* context);
+
+/* Get a monotonic timestamp in nanoseconds for context->timings */
+uint64_t oe_sgx_get_load_timestamp(void);
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
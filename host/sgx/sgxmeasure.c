@@ -7,24 +7,26 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/trace.h>
 
-static void _measure_zeros(oe_sha256_context_t* context, size_t size)
+/*
+ * Each EADD and EEXTEND operation is measured as a 64-byte record, which is
+ * exactly one SHA-256 block. Since the measurement only ever hashes whole
+ * blocks, each record is hashed with a single update from a block built on the
+ * stack, and the 256-byte chunks of the measured pages are hashed straight
+ * from the pages, without being buffered by the SHA-256 context.
+ */
+#define MEASURE_RECORD_SIZE 64
+#define MEASURE_CHUNK_SIZE 256
+
+typedef struct _measure_record
 {
-    char zeros[128] = {0};
+    union {
+        uint8_t bytes[MEASURE_RECORD_SIZE];
+        uint64_t words[MEASURE_RECORD_SIZE / sizeof(uint64_t)];
+    } u;
+} measure_record_t;
 
-    while (size)
-    {
-        if (size < sizeof(zeros))
-        {
-            oe_sha256_update(context, zeros, size);
-            size -= size;
-        }
-        else
-        {
-            oe_sha256_update(context, zeros, sizeof(zeros));
-            size -= sizeof(zeros);
-        }
-    }
-}
+OE_STATIC_ASSERT(sizeof(measure_record_t) == MEASURE_RECORD_SIZE);
+OE_STATIC_ASSERT(OE_PAGE_SIZE % MEASURE_CHUNK_SIZE == 0);
 
 static void _measure_eextend(
     oe_sha256_context_t* context,
@@ -33,18 +35,19 @@ static void _measure_eextend(
     const void* page)
 {
     uint64_t pgoff = 0;
-    const uint64_t CHUNK_SIZE = 256;
+    measure_record_t record = {{{0}}};
     OE_UNUSED(flags);
 
+    memcpy(record.u.bytes, "EEXTEND", 8);
+
     /* Write this page one chunk at a time */
-    for (pgoff = 0; pgoff < OE_PAGE_SIZE; pgoff += CHUNK_SIZE)
+    for (pgoff = 0; pgoff < OE_PAGE_SIZE; pgoff += MEASURE_CHUNK_SIZE)
     {
-        const uint64_t moffset = vaddr + pgoff;
+        record.u.words[1] = vaddr + pgoff;
 
-        oe_sha256_update(context, "EEXTEND", 8);
-        oe_sha256_update(context, &moffset, sizeof(moffset));
-        _measure_zeros(context, 48);
-        oe_sha256_update(context, (const uint8_t*)page + pgoff, CHUNK_SIZE);
+        oe_sha256_update(context, &record, sizeof(record));
+        oe_sha256_update(
+            context, (const uint8_t*)page + pgoff, MEASURE_CHUNK_SIZE);
     }
 }
 
@@ -61,10 +64,14 @@ oe_result_t oe_sgx_measure_create_enclave(
     oe_sha256_init(context);
 
     /* Measure ECREATE */
-    oe_sha256_update(context, "ECREATE", 8);
-    oe_sha256_update(context, &secs->ssaframesize, sizeof(uint32_t));
-    oe_sha256_update(context, &secs->size, sizeof(uint64_t));
-    _measure_zeros(context, 44);
+    {
+        measure_record_t record = {{{0}}};
+
+        memcpy(record.u.bytes, "ECREATE", 8);
+        memcpy(record.u.bytes + 8, &secs->ssaframesize, sizeof(uint32_t));
+        memcpy(record.u.bytes + 12, &secs->size, sizeof(uint64_t));
+        oe_sha256_update(context, &record, sizeof(record));
+    }
 
     result = OE_OK;
 
@@ -87,10 +94,14 @@ oe_result_t oe_sgx_measure_load_enclave_data(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Measure EADD */
-    oe_sha256_update(context, "EADD\0\0\0", 8);
-    oe_sha256_update(context, &vaddr, sizeof(vaddr));
-    oe_sha256_update(context, &flags, sizeof(flags));
-    _measure_zeros(context, 40);
+    {
+        measure_record_t record = {{{0}}};
+
+        memcpy(record.u.bytes, "EADD\0\0\0", 8);
+        record.u.words[1] = vaddr;
+        record.u.words[2] = flags;
+        oe_sha256_update(context, &record, sizeof(record));
+    }
 
     /* Measure EEXTEND if requested */
     if (extend)
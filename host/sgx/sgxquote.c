@@ -3,9 +3,11 @@
 #if defined(OE_LINK_SGX_DCAP_QL)
 
 #include "sgxquote.h"
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/defs.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgx/plugin.h>
+#include <openenclave/internal/sgx/quotestats.h>
 #include <openenclave/internal/trace.h>
 #include <sgx_dcap_ql_wrapper.h>
 #include <stdlib.h>
@@ -60,6 +62,14 @@ static quote3_error_t (*_sgx_qe_get_quote)(
 
 static void* _module;
 
+/* Target info of the QE, fetched once and dropped when the QE fails */
+static sgx_target_info_t _qe_target_info;
+static bool _qe_target_info_valid;
+static oe_mutex _qe_target_info_lock = OE_H_MUTEX_INITIALIZER;
+
+/* Counters returned by oe_sgx_get_quote_stats() */
+static oe_sgx_quote_stats_t _quote_stats;
+
 static void _unload_sgx_dcap_ql(void)
 {
     if (_module)
@@ -110,6 +120,19 @@ static void _load_sgx_dcap_ql_impl(void)
 
 done:
     if (result != OE_OK)
+        _unload_sgx_dcap_ql();
+}
+
+static bool _load_sgx_dcap_ql(void)
+{
+    static oe_once_type _once;
+    oe_once(&_once, _load_sgx_dcap_ql_impl);
+    return (_module != NULL);
+}
+
+static void _require_sgx_dcap_ql(void)
+{
+    if (!_load_sgx_dcap_ql())
     {
         // It is a catastrophic error if sgx_dcap_ql library cannot be
         // successfully loaded.
@@ -118,11 +141,29 @@ done:
     }
 }
 
-static bool _load_sgx_dcap_ql(void)
+/* Drop the cached target info after the QE failed, as it may have been
+ * reloaded with a different identity */
+static void _invalidate_qe_target_info(void)
 {
-    static oe_once_type _once;
-    oe_once(&_once, _load_sgx_dcap_ql_impl);
-    return (_module != NULL);
+    oe_mutex_lock(&_qe_target_info_lock);
+    _qe_target_info_valid = false;
+    oe_mutex_unlock(&_qe_target_info_lock);
+}
+
+oe_result_t oe_sgx_qe_preload(void)
+{
+    oe_result_t result = OE_FAILURE;
+    sgx_target_info_t target_info;
+
+    if (!_load_sgx_dcap_ql())
+        OE_RAISE_MSG(
+            OE_PLATFORM_ERROR, "Failed to load %s", LIBRARY_NAME);
+
+    OE_CHECK(oe_sgx_qe_get_target_info(NULL, NULL, 0, (uint8_t*)&target_info));
+
+    result = OE_OK;
+done:
+    return result;
 }
 
 oe_result_t oe_sgx_qe_get_target_info(
@@ -137,12 +178,33 @@ oe_result_t oe_sgx_qe_get_target_info(
     OE_UNUSED(format_id);
     OE_UNUSED(opt_params);
     OE_UNUSED(opt_params_size);
-    _load_sgx_dcap_ql();
+
+    oe_mutex_lock(&_qe_target_info_lock);
+    if (_qe_target_info_valid)
+    {
+        memcpy(target_info, &_qe_target_info, sizeof(_qe_target_info));
+        result = OE_OK;
+    }
+    oe_mutex_unlock(&_qe_target_info_lock);
+
+    if (result == OE_OK)
+    {
+        oe_atomic_increment(&_quote_stats.target_info_hits);
+        goto done;
+    }
+
+    oe_atomic_increment(&_quote_stats.target_info_fetches);
+    _require_sgx_dcap_ql();
     err = _sgx_qe_get_target_info((sgx_target_info_t*)target_info);
 
     if (err != SGX_QL_SUCCESS)
         OE_RAISE_MSG(OE_PLATFORM_ERROR, "quote3_error_t=0x%x\n", err);
 
+    oe_mutex_lock(&_qe_target_info_lock);
+    memcpy(&_qe_target_info, target_info, sizeof(_qe_target_info));
+    _qe_target_info_valid = true;
+    oe_mutex_unlock(&_qe_target_info_lock);
+
     result = OE_OK;
 done:
     return result;
@@ -161,7 +223,7 @@ oe_result_t oe_sgx_qe_get_quote_size(
     OE_UNUSED(format_id);
     OE_UNUSED(opt_params);
     OE_UNUSED(opt_params_size);
-    _load_sgx_dcap_ql();
+    _require_sgx_dcap_ql();
     err = _sgx_qe_get_quote_size(local_quote_size);
 
     if (err != SGX_QL_SUCCESS)
@@ -192,11 +254,17 @@ oe_result_t oe_sgx_qe_get_quote(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     local_quote_size = (uint32_t)quote_size;
-    _load_sgx_dcap_ql();
+    _require_sgx_dcap_ql();
+
+    oe_atomic_increment(&_quote_stats.quote_calls);
+    oe_atomic_increment(&_quote_stats.quotes);
 
     err = _sgx_qe_get_quote((sgx_report_t*)report, local_quote_size, quote);
     if (err != SGX_QL_SUCCESS)
+    {
+        _invalidate_qe_target_info();
         OE_RAISE_MSG(OE_PLATFORM_ERROR, "quote3_error_t=0x%x\n", err);
+    }
     OE_TRACE_INFO("quote_size=%d", local_quote_size);
 
     result = OE_OK;
@@ -204,6 +272,20 @@ done:
     return result;
 }
 
+oe_result_t oe_sgx_get_quote_stats(oe_sgx_quote_stats_t* stats)
+{
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    stats->target_info_fetches =
+        oe_atomic_load(&_quote_stats.target_info_fetches);
+    stats->target_info_hits = oe_atomic_load(&_quote_stats.target_info_hits);
+    stats->quote_calls = oe_atomic_load(&_quote_stats.quote_calls);
+    stats->quotes = oe_atomic_load(&_quote_stats.quotes);
+
+    return OE_OK;
+}
+
 oe_result_t oe_sgx_get_supported_attester_format_ids(
     void* format_ids,
     size_t* format_ids_size)
@@ -10,6 +10,11 @@
 
 #define OE_MAX_UINT32 0xFFFFFFFF
 
+/* Load the SGX DCAP quote library and fetch the target info of the QE, which
+ * is cached until the QE fails to produce a quote. Unlike the functions below,
+ * this does not terminate the process if the library cannot be loaded. */
+oe_result_t oe_sgx_qe_preload(void);
+
 oe_result_t oe_sgx_qe_get_target_info(
     const oe_uuid_t* format_id,
     const void* opt_params,
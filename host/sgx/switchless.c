@@ -15,15 +15,40 @@
 #include "platform_u.h"
 
 /**
- * Number of iterations an ocall worker thread would spin before going to sleep
+ * Initial number of iterations an ocall worker thread would spin before going
+ * to sleep. The threshold is adapted after each sleep.
  */
 #define OE_HOST_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
 /**
- * Number of iterations an ecall worker thread would spin before going to sleep
+ * Initial number of iterations an ecall worker thread would spin before going
+ * to sleep. The threshold is adapted after each sleep.
  */
 #define OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
+/**
+ * Bounds of the adaptive spin count thresholds.
+ */
+#define OE_SWITCHLESS_MIN_SPIN_COUNT_THRESHOLD (256U)
+#define OE_SWITCHLESS_MAX_SPIN_COUNT_THRESHOLD (65536U)
+
+/**
+ * A worker that sleeps this many times longer than it spun before sleeping is
+ * considered idle, and its spin count threshold is reduced.
+ */
+#define OE_SWITCHLESS_IDLE_SLEEP_FACTOR (16U)
+
+/**
+ * Number of spins timed to estimate the cost of a single spin.
+ */
+#define OE_SWITCHLESS_SPIN_CALIBRATION_COUNT (16384U)
+
+/**
+ * Maximum number of switchless ocalls a host worker drains from the queue
+ * before updating its statistics and checking whether it must stop.
+ */
+#define OE_SWITCHLESS_OCALL_BATCH_SIZE (32U)
+
 #if !defined(OE_USE_BUILTIN_EDL)
 /**
  * Declare the prototypes of the following functions to avoid missing-prototypes
@@ -33,10 +58,17 @@ OE_UNUSED_FUNC oe_result_t _oe_sgx_init_context_switchless_ecall(
     oe_enclave_t* enclave,
     oe_result_t* _retval,
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers);
+    uint64_t num_host_workers,
+    oe_switchless_ocall_queue_t* ocall_queue);
 OE_UNUSED_FUNC oe_result_t _oe_sgx_switchless_enclave_worker_thread_ecall(
     oe_enclave_t* enclave,
     oe_enclave_worker_context_t* context);
+OE_UNUSED_FUNC oe_result_t _oe_sgx_get_arena_statistics_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    oe_arena_statistics_t* statistics,
+    size_t statistics_count,
+    size_t* statistics_count_out);
 
 /**
  * Make the following ECALLs weak to support the system EDL opt-in.
@@ -50,11 +82,13 @@ oe_result_t _oe_sgx_init_context_switchless_ecall(
     oe_enclave_t* enclave,
     oe_result_t* _retval,
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers)
+    uint64_t num_host_workers,
+    oe_switchless_ocall_queue_t* ocall_queue)
 {
     OE_UNUSED(enclave);
     OE_UNUSED(host_worker_contexts);
     OE_UNUSED(num_host_workers);
+    OE_UNUSED(ocall_queue);
 
     if (_retval)
         *_retval = OE_UNSUPPORTED;
@@ -77,8 +111,165 @@ OE_WEAK_ALIAS(
     _oe_sgx_switchless_enclave_worker_thread_ecall,
     oe_sgx_switchless_enclave_worker_thread_ecall);
 
+oe_result_t _oe_sgx_get_arena_statistics_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    oe_arena_statistics_t* statistics,
+    size_t statistics_count,
+    size_t* statistics_count_out)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(statistics);
+    OE_UNUSED(statistics_count);
+    OE_UNUSED(statistics_count_out);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_sgx_get_arena_statistics_ecall,
+    oe_sgx_get_arena_statistics_ecall);
+
 #endif
 
+// Estimated duration of 1024 spins in nanoseconds.
+static uint64_t _spin_duration_ns_per_1k = 0;
+static oe_once_type _spin_calibration_once = OE_H_ONCE_INITIALIZER;
+
+static void _calibrate_spin_duration(void)
+{
+    uint64_t start = oe_switchless_get_timestamp();
+
+    for (uint32_t i = 0; i < OE_SWITCHLESS_SPIN_CALIBRATION_COUNT; i++)
+        oe_yield_cpu();
+
+    _spin_duration_ns_per_1k = (oe_switchless_get_timestamp() - start) * 1024 /
+                               OE_SWITCHLESS_SPIN_CALIBRATION_COUNT;
+
+    if (_spin_duration_ns_per_1k == 0)
+        _spin_duration_ns_per_1k = 1;
+}
+
+/*
+** Adapt the spin count threshold of a worker that has just been woken up after
+** sleeping for sleep_ns nanoseconds. Before sleeping, a worker spins for twice
+** its threshold (once to consume any pending wake notification and once more
+** before blocking).
+**
+** If the sleep was shorter than the spinning that preceded it, a call arrived
+** shortly after the worker gave up, and spinning longer would have avoided the
+** sleep and wake latency. The threshold is doubled. If the sleep was much
+** longer, the worker is idle and burns CPU for nothing while spinning. The
+** threshold is halved.
+*/
+static uint64_t _adapt_spin_count_threshold(
+    uint64_t threshold,
+    uint64_t sleep_ns)
+{
+    uint64_t spin_ns = 2 * threshold * _spin_duration_ns_per_1k / 1024;
+
+    if (sleep_ns < spin_ns)
+    {
+        threshold *= 2;
+        if (threshold > OE_SWITCHLESS_MAX_SPIN_COUNT_THRESHOLD)
+            threshold = OE_SWITCHLESS_MAX_SPIN_COUNT_THRESHOLD;
+    }
+    else if (sleep_ns / OE_SWITCHLESS_IDLE_SLEEP_FACTOR > spin_ns)
+    {
+        threshold /= 2;
+        if (threshold < OE_SWITCHLESS_MIN_SPIN_COUNT_THRESHOLD)
+            threshold = OE_SWITCHLESS_MIN_SPIN_COUNT_THRESHOLD;
+    }
+
+    return threshold;
+}
+
+static void _host_worker_sleep(oe_host_worker_context_t* context)
+{
+    uint64_t start = oe_switchless_get_timestamp();
+
+    if (oe_host_worker_wait(context))
+    {
+        context->total_sleep_count++;
+        context->spin_count_threshold = _adapt_spin_count_threshold(
+            context->spin_count_threshold,
+            oe_switchless_get_timestamp() - start);
+    }
+}
+
+/*
+** Mark whether the worker takes calls from the queue. The enclave reads the
+** flag after posting a call (see _wake_switchless_worker), so the flag must be
+** set before the worker reads the queue again.
+*/
+static void _set_host_worker_busy(
+    oe_host_worker_context_t* context,
+    bool is_busy)
+{
+    *(volatile bool*)&context->is_busy = is_busy;
+    oe_atomic_thread_fence();
+}
+
+/*
+** Remove the oldest switchless ocall from the queue. Returns NULL if the queue
+** is empty. The queue is a bounded multi-producer/multi-consumer ring where the
+** sequence number of each slot tells whether the slot is ready to be consumed:
+**
+**     sequence == pos      : the slot is free for the producer at pos.
+**     sequence == pos + 1  : the slot holds the call posted at pos.
+**
+*/
+static oe_call_host_function_args_t* _dequeue_switchless_ocall(
+    oe_host_worker_context_t* context)
+{
+    oe_switchless_ocall_queue_t* queue = context->queue;
+    const uint64_t mask = queue->capacity - 1;
+    oe_switchless_ocall_slot_t* slot = NULL;
+    uint64_t pos = oe_atomic_load(&queue->dequeue_pos);
+    void* call_arg = NULL;
+
+    while (true)
+    {
+        slot = &queue->slots[pos & mask];
+        int64_t diff =
+            (int64_t)oe_atomic_load(&slot->sequence) - (int64_t)(pos + 1);
+
+        if (diff == 0)
+        {
+            // The slot holds a call. Mark the worker busy before claiming it
+            // so that the enclave does not count on this worker for the calls
+            // it posts from now on (see _wake_switchless_worker).
+            _set_host_worker_busy(context, true);
+
+            // Try to claim the call.
+            if (oe_atomic_compare_and_swap(
+                    (volatile int64_t*)&queue->dequeue_pos,
+                    (int64_t)pos,
+                    (int64_t)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The producer has not filled this slot yet. Queue is empty.
+            _set_host_worker_busy(context, false);
+            return NULL;
+        }
+
+        // Another worker claimed the slot. Reload the position.
+        pos = oe_atomic_load(&queue->dequeue_pos);
+    }
+
+    call_arg = slot->call_arg;
+
+    // Release the slot to the producer that will wrap around to it.
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    *(volatile uint64_t*)&slot->sequence = pos + mask + 1;
+
+    return (oe_call_host_function_args_t*)call_arg;
+}
+
 /*
 ** The thread function that handles switchless ocalls
 **
@@ -89,21 +280,27 @@ static void* _switchless_ocall_worker(void* arg)
 
     while (!context->is_stopping)
     {
-        volatile oe_call_host_function_args_t* local_call_arg = NULL;
-        if ((local_call_arg = context->call_arg) != NULL)
+        oe_call_host_function_args_t* local_call_arg = NULL;
+        size_t num_calls = 0;
+
+        // Drain the shared queue in batches. Calls are removed one at a time
+        // so that other workers can pick up the remaining calls in parallel
+        // while this worker is busy with a slow one.
+        while (num_calls < OE_SWITCHLESS_OCALL_BATCH_SIZE &&
+               (local_call_arg = _dequeue_switchless_ocall(context)) != NULL)
         {
-            // Handle the switchless call, but do not clear the slot yet. Since
-            // the slot is not empty, any new incoming switchless call request
-            // will be scheduled in another available work thread and get
-            // handled immediately.
             oe_handle_call_host_function(
                 (uint64_t)local_call_arg, context->enc);
+            num_calls++;
+        }
 
-            // After handling the switchless call, mark this worker thread
-            // as free by clearing the slot.
-            context->call_arg = NULL;
+        if (num_calls > 0)
+        {
+            // The worker is idle again when the batch ended at its limit.
+            _set_host_worker_busy(context, false);
 
-            // Reset spin count for next message.
+            // Reset spin count for next batch.
+            context->total_call_count += num_calls;
             context->total_spin_count += context->spin_count;
             context->spin_count = 0;
         }
@@ -111,12 +308,12 @@ static void* _switchless_ocall_worker(void* arg)
         {
             // If there is no message, increment spin count until threshold is
             // reached.
-            if (++context->spin_count >= OE_HOST_WORKER_SPIN_COUNT_THRESHOLD)
+            if (++context->spin_count >= context->spin_count_threshold)
             {
                 // Reset spin count and go to sleep until event is fired.
                 context->total_spin_count += context->spin_count;
                 context->spin_count = 0;
-                oe_host_worker_wait(context);
+                _host_worker_sleep(context);
             }
 
             /* Yield CPU */
@@ -128,8 +325,17 @@ static void* _switchless_ocall_worker(void* arg)
 
 void oe_sgx_sleep_switchless_worker_ocall(oe_enclave_worker_context_t* context)
 {
+    uint64_t start = oe_switchless_get_timestamp();
+
     // Wait for messages.
-    oe_enclave_worker_wait(context);
+    if (oe_enclave_worker_wait(context))
+    {
+        // The enclave worker picks up the new threshold when it returns.
+        context->total_sleep_count++;
+        context->spin_count_threshold = _adapt_spin_count_threshold(
+            context->spin_count_threshold,
+            oe_switchless_get_timestamp() - start);
+    }
 }
 
 /*
@@ -159,9 +365,12 @@ static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
         oe_host_worker_wake(&manager->host_worker_contexts[i]);
 
         OE_TRACE_INFO(
-            "Switchless host worker thread %d spun for %lu times",
+            "Switchless host worker thread %d served %lu calls, spun for %lu "
+            "times and slept %lu times",
             (int)i,
-            manager->host_worker_contexts[i].total_spin_count);
+            manager->host_worker_contexts[i].total_call_count,
+            manager->host_worker_contexts[i].total_spin_count,
+            manager->host_worker_contexts[i].total_sleep_count);
     }
     for (size_t i = 0; i < manager->num_enclave_workers; i++)
     {
@@ -200,6 +409,9 @@ oe_result_t oe_start_switchless_manager(
     oe_thread_t* host_threads = NULL;
     oe_enclave_worker_context_t* enclave_contexts = NULL;
     oe_thread_t* enclave_threads = NULL;
+    oe_switchless_ocall_queue_t* ocall_queue = NULL;
+    oe_switchless_ocall_slot_t* ocall_queue_slots = NULL;
+    size_t ocall_queue_capacity = 1;
 
     if (enclave == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -220,6 +432,9 @@ oe_result_t oe_start_switchless_manager(
     if (num_enclave_workers > enclave->num_bindings)
         num_enclave_workers = (uint32_t)enclave->num_bindings;
 
+    // Estimate the cost of a spin once for the adaptive spin policy.
+    oe_once(&_spin_calibration_once, _calibrate_spin_duration);
+
     // Allocate memory for the manager and its arrays
     manager = calloc(1, sizeof(oe_switchless_call_manager_t));
     if (manager == NULL)
@@ -242,18 +457,44 @@ oe_result_t oe_start_switchless_manager(
     if (enclave_threads == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    // Each enclave thread has at most one switchless ocall in flight. Sizing
+    // the queue to the number of thread bindings therefore guarantees that
+    // posting a switchless ocall never finds the queue full.
+    while (ocall_queue_capacity < enclave->num_bindings)
+        ocall_queue_capacity <<= 1;
+
+    ocall_queue = calloc(1, sizeof(oe_switchless_ocall_queue_t));
+    if (ocall_queue == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    ocall_queue_slots =
+        calloc(ocall_queue_capacity, sizeof(oe_switchless_ocall_slot_t));
+    if (ocall_queue_slots == NULL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < ocall_queue_capacity; i++)
+        ocall_queue_slots[i].sequence = i;
+
+    ocall_queue->slots = ocall_queue_slots;
+    ocall_queue->capacity = ocall_queue_capacity;
+
     manager->num_host_workers = num_host_workers;
     manager->host_worker_contexts = host_contexts;
     manager->host_worker_threads = host_threads;
     manager->num_enclave_workers = num_enclave_workers;
     manager->enclave_worker_contexts = enclave_contexts;
     manager->enclave_worker_threads = enclave_threads;
+    manager->ocall_queue = ocall_queue;
+    manager->ocall_queue_slots = ocall_queue_slots;
 
     // Start the host worker threads, and assign each one a private context.
     for (size_t i = 0; i < num_host_workers; i++)
     {
         OE_TRACE_INFO("Creating switchless host worker thread %d\n", (int)i);
         manager->host_worker_contexts[i].enc = enclave;
+        manager->host_worker_contexts[i].queue = manager->ocall_queue;
+        manager->host_worker_contexts[i].spin_count_threshold =
+            OE_HOST_WORKER_SPIN_COUNT_THRESHOLD;
         if (oe_thread_create(
                 &manager->host_worker_threads[i],
                 _switchless_ocall_worker,
@@ -270,7 +511,8 @@ oe_result_t oe_start_switchless_manager(
             enclave,
             &result_out,
             manager->host_worker_contexts,
-            manager->num_host_workers));
+            manager->num_host_workers,
+            manager->ocall_queue));
         OE_CHECK(result_out);
     }
 
@@ -342,6 +584,10 @@ oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave)
             free(manager->enclave_worker_contexts);
         if (manager->enclave_worker_threads != NULL)
             free(manager->enclave_worker_threads);
+        if (manager->ocall_queue_slots != NULL)
+            free(manager->ocall_queue_slots);
+        if (manager->ocall_queue != NULL)
+            free(manager->ocall_queue);
         free(manager);
     }
     result = OE_OK;
@@ -349,6 +595,72 @@ done:
     return result;
 }
 
+oe_result_t oe_get_switchless_worker_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    oe_switchless_worker_statistics_t* statistics,
+    size_t* statistics_count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+    size_t num_workers = 0;
+
+    if (enclave == NULL || statistics_count == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (type != OE_SWITCHLESS_WORKER_HOST &&
+        type != OE_SWITCHLESS_WORKER_ENCLAVE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    manager = enclave->switchless_manager;
+    if (manager != NULL)
+    {
+        num_workers = (type == OE_SWITCHLESS_WORKER_HOST)
+                          ? manager->num_host_workers
+                          : manager->num_enclave_workers;
+    }
+
+    if (statistics == NULL || *statistics_count < num_workers)
+    {
+        *statistics_count = num_workers;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    // The counters are updated by the workers without synchronization, so
+    // the values are a snapshot and may be slightly stale.
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        oe_switchless_worker_statistics_t* s = &statistics[i];
+
+        if (type == OE_SWITCHLESS_WORKER_HOST)
+        {
+            volatile oe_host_worker_context_t* context =
+                &manager->host_worker_contexts[i];
+            s->calls = context->total_call_count;
+            s->spins = context->total_spin_count + context->spin_count;
+            s->sleeps = context->total_sleep_count;
+            s->wakeups = context->total_wakeup_count;
+            s->spin_count_threshold = context->spin_count_threshold;
+        }
+        else
+        {
+            volatile oe_enclave_worker_context_t* context =
+                &manager->enclave_worker_contexts[i];
+            s->calls = context->total_call_count;
+            s->spins = context->total_spin_count + context->spin_count;
+            s->sleeps = context->total_sleep_count;
+            s->wakeups = context->total_wakeup_count;
+            s->spin_count_threshold = context->spin_count_threshold;
+        }
+    }
+
+    *statistics_count = num_workers;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 void oe_sgx_wake_switchless_worker_ocall(oe_host_worker_context_t* context)
 {
     oe_host_worker_wake(context);
@@ -496,3 +808,35 @@ oe_result_t oe_switchless_call_enclave_function(
         output_buffer_size,
         output_bytes_written);
 }
+
+oe_result_t oe_sgx_get_arena_statistics(
+    oe_enclave_t* enclave,
+    oe_arena_statistics_t* statistics,
+    size_t* statistics_count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    size_t count = 0;
+
+    if (enclave == NULL || statistics_count == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_sgx_get_arena_statistics_ecall(
+        enclave,
+        &retval,
+        statistics,
+        statistics ? *statistics_count : 0,
+        &count));
+
+    *statistics_count = count;
+
+    if (retval == OE_BUFFER_TOO_SMALL)
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+    OE_CHECK(retval);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
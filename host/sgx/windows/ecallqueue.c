@@ -0,0 +1,51 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <Windows.h>
+
+#include "../ecallqueue.h"
+#include <openenclave/internal/raise.h>
+
+void oe_ecall_queue_wait(volatile uint32_t* address, uint32_t value)
+{
+    WaitOnAddress(address, &value, sizeof(value), INFINITE);
+}
+
+void oe_ecall_queue_wake(volatile uint32_t* address, bool all)
+{
+    if (all)
+        WakeByAddressAll((void*)address);
+    else
+        WakeByAddressSingle((void*)address);
+}
+
+oe_result_t oe_ecall_queue_open_event(intptr_t* event)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    HANDLE handle = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    if (handle == NULL)
+        OE_RAISE_MSG(
+            OE_FAILURE, "CreateEventW() failed: error=%#x", GetLastError());
+
+    *event = (intptr_t)handle;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_ecall_queue_signal_event(intptr_t event)
+{
+    SetEvent((HANDLE)event);
+}
+
+void oe_ecall_queue_reset_event(intptr_t event)
+{
+    ResetEvent((HANDLE)event);
+}
+
+void oe_ecall_queue_close_event(intptr_t event)
+{
+    CloseHandle((HANDLE)event);
+}
@@ -0,0 +1,31 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <Windows.h>
+
+#include "../logring.h"
+
+/* Number of 100-nanosecond intervals between 1601-01-01 and 1970-01-01 */
+#define _FILETIME_EPOCH_OFFSET 116444736000000000ULL
+
+void oe_log_ring_wait(volatile uint32_t* address, uint32_t value)
+{
+    WaitOnAddress(address, &value, sizeof(value), INFINITE);
+}
+
+void oe_log_ring_wake(volatile uint32_t* address)
+{
+    WakeByAddressSingle((void*)address);
+}
+
+uint64_t oe_log_ring_get_time(void)
+{
+    FILETIME ft;
+    ULARGE_INTEGER time;
+
+    GetSystemTimePreciseAsFileTime(&ft);
+    time.LowPart = ft.dwLowDateTime;
+    time.HighPart = ft.dwHighDateTime;
+
+    return (time.QuadPart - _FILETIME_EPOCH_OFFSET) / 10;
+}
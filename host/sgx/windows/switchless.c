@@ -4,7 +4,7 @@
 #include <Windows.h>
 #include <openenclave/internal/switchless.h>
 
-static void _worker_wait(volatile long* event)
+static bool _worker_wait(volatile long* event)
 {
     // If event is 1, it means that there a pending wake notification from
     // enclave. Consume it by setting event to 0. Don't wait.
@@ -18,7 +18,10 @@ static void _worker_wait(volatile long* event)
         // If the previous value was zero, then wait while value is zero.
         uint32_t zero = 0;
         WaitOnAddress(event, &zero, sizeof(*event), INFINITE);
+        return true;
     }
+
+    return false;
 }
 
 static void _worker_wake(volatile long* event)
@@ -28,22 +31,40 @@ static void _worker_wake(volatile long* event)
     WakeByAddressSingle((void*)event);
 }
 
-void oe_host_worker_wait(oe_host_worker_context_t* context)
+bool oe_host_worker_wait(oe_host_worker_context_t* context)
 {
-    _worker_wait(&context->event);
+    return _worker_wait(&context->event);
 }
 
 void oe_host_worker_wake(oe_host_worker_context_t* context)
 {
+    _InterlockedIncrement64((__int64*)&context->total_wakeup_count);
     _worker_wake(&context->event);
 }
 
-void oe_enclave_worker_wait(oe_enclave_worker_context_t* context)
+bool oe_enclave_worker_wait(oe_enclave_worker_context_t* context)
 {
-    _worker_wait((long*)&context->event);
+    return _worker_wait((long*)&context->event);
 }
 
 void oe_enclave_worker_wake(oe_enclave_worker_context_t* context)
 {
+    _InterlockedIncrement64((__int64*)&context->total_wakeup_count);
     _worker_wake(&context->event);
 }
+
+uint64_t oe_switchless_get_timestamp(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion to avoid overflowing the multiplication.
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL /
+               (uint64_t)frequency.QuadPart;
+}
@@ -35,6 +35,7 @@ static bool _use_log_file = false;
 static bool _use_custom_log_format = false;
 static bool _log_all_streams = false;
 static bool _log_escape = false;
+static bool _log_ring_requested = false;
 static const size_t MAX_ESCAPED_CHAR_LEN = 5; // e.g. u2605
 static const size_t MAX_ESCAPED_MSG_MULTIPLIER =
     7; // MAX_ESCAPED_CHAR_LEN + sizeof("\\\\")
@@ -89,6 +90,7 @@ void initialize_log_config()
     char* env_log_format = NULL;
     char* env_log_all_streams = NULL;
     char* env_log_escape = NULL;
+    char* env_log_ring = NULL;
 
     if (!_initialized)
     {
@@ -98,6 +100,7 @@ void initialize_log_config()
         env_log_format = oe_dupenv("OE_LOG_FORMAT");
         env_log_all_streams = oe_dupenv("OE_LOG_ALL_STREAMS");
         env_log_escape = oe_dupenv("OE_LOG_JSON_ESCAPE");
+        env_log_ring = oe_dupenv("OE_LOG_RING");
 
         if (env_log_format)
         {
@@ -150,6 +153,12 @@ done:
         free(env_log_escape);
     }
 
+    if (env_log_ring)
+    {
+        _log_ring_requested = true;
+        free(env_log_ring);
+    }
+
     if (!_initialized || ret != OE_OK)
     {
         fprintf(stderr, "%s\n", "[ERROR] Could not initialize logging.");
@@ -157,6 +166,11 @@ done:
     }
 }
 
+bool oe_log_ring_is_enabled(void)
+{
+    return _log_ring_requested || _log_level >= OE_LOG_LEVEL_INFO;
+}
+
 static bool _escape_characters(
     const char* log_msg,
     char* log_msg_escaped,
@@ -334,15 +348,25 @@ oe_result_t oe_log_set_callback(void* context, oe_log_callback_t callback)
 // This is an expensive operation, it involves acquiring lock
 // and file operation.
 void oe_log_message(bool is_enclave, oe_log_level_t level, const char* message)
+{
+    oe_log_message_at(
+        is_enclave, level, message, (uint64_t)time(NULL) * 1000000);
+}
+
+void oe_log_message_at(
+    bool is_enclave,
+    oe_log_level_t level,
+    const char* message,
+    uint64_t timestamp)
 {
     // get timestamp for log
     struct tm t;
-    time_t lt = time(NULL);
+    time_t lt = (time_t)(timestamp / 1000000);
     gmtime_r(&lt, &t);
 
     char time[20];
     strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S", &t);
-    long int usecs = 0;
+    long int usecs = (long int)(timestamp % 1000000);
 
     if (!_initialized)
     {
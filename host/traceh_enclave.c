@@ -20,19 +20,23 @@
 
 #if !defined(OE_USE_BUILTIN_EDL)
 /**
- * Declare the prototype of the following function to avoid the
+ * Declare the prototypes of the following functions to avoid the
  * missing-prototypes warning.
  */
 oe_result_t _oe_log_init_ecall(
     oe_enclave_t* enclave,
     const char* enclave_path,
     uint32_t log_level);
+oe_result_t _oe_log_init_ring_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    oe_log_ring_t* log_ring);
 
 /**
- * Make the following ECALL weak to support the system EDL opt-in.
+ * Make the following ECALLs weak to support the system EDL opt-in.
  * When the user does not opt into (import) the EDL, the linker will pick
- * the following default implementation. If the user opts into the EDL,
- * the implemention (which is also weak) in the oeedger8r-generated code will
+ * the following default implementations. If the user opts into the EDL,
+ * the implementions (which are also weak) in the oeedger8r-generated code will
  * be used. This behavior is guaranteed by the linker; i.e., the linker will
  * pick the symbols defined in the object before those in the library.
  */
@@ -48,6 +52,21 @@ oe_result_t _oe_log_init_ecall(
 }
 OE_WEAK_ALIAS(_oe_log_init_ecall, oe_log_init_ecall);
 
+oe_result_t _oe_log_init_ring_ecall(
+    oe_enclave_t* enclave,
+    oe_result_t* _retval,
+    oe_log_ring_t* log_ring)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(log_ring);
+
+    if (_retval)
+        *_retval = OE_UNSUPPORTED;
+
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_log_init_ring_ecall, oe_log_init_ring_ecall);
+
 #endif
 
 /*
@@ -1243,6 +1243,19 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_read_shared_ocall(oe_host_fd_t fd, void* buf, size_t count)
+{
+    return oe_syscall_read_ocall(fd, buf, count);
+}
+
+ssize_t oe_syscall_write_shared_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    return oe_syscall_write_ocall(fd, buf, count);
+}
+
 // oe_syscall_readv_ocall does not yet support socket.
 ssize_t oe_syscall_readv_ocall(
     oe_host_fd_t fd,
@@ -1327,6 +1340,24 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_readv_shared_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_readv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
+ssize_t oe_syscall_writev_shared_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_writev_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
 // oe_syscall_lseek_ocall does not yet support socket.
 oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
 {
@@ -1367,13 +1398,59 @@ done:
     return ret;
 }
 
+// ReadFile() and WriteFile() given an offset still move the file pointer of a
+// handle opened without FILE_FLAG_OVERLAPPED, so oe_syscall_pread_ocall() and
+// oe_syscall_pwrite_ocall() save it and restore it after the call, leaving it
+// unchanged as POSIX requires.
+static BOOL _get_file_pointer(HANDLE handle, LARGE_INTEGER* position)
+{
+    LARGE_INTEGER const origin_pos = {0};
+    return SetFilePointerEx(handle, origin_pos, position, FILE_CURRENT);
+}
+
+static void _set_file_pointer(HANDLE handle, LARGE_INTEGER position)
+{
+    SetFilePointerEx(handle, position, NULL, FILE_BEGIN);
+}
+
 ssize_t oe_syscall_pread_ocall(
     oe_host_fd_t fd,
     void* buf,
     size_t count,
     oe_off_t offset)
 {
-    PANIC;
+    ssize_t ret = -1;
+    DWORD bytes_returned = 0;
+    OVERLAPPED overlapped = {0};
+    LARGE_INTEGER saved_pos;
+    DWORD error = ERROR_SUCCESS;
+
+    if (!_get_file_pointer((HANDLE)fd, &saved_pos))
+    {
+        _set_errno(_winerr_to_errno(GetLastError()));
+        goto done;
+    }
+
+    overlapped.Offset = (DWORD)((uint64_t)offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+
+    if (!ReadFile(
+            (HANDLE)fd, buf, (DWORD)count, &bytes_returned, &overlapped))
+        error = GetLastError();
+
+    _set_file_pointer((HANDLE)fd, saved_pos);
+
+    // Reading at or past the end of the file is not an error.
+    if (error != ERROR_SUCCESS && error != ERROR_HANDLE_EOF)
+    {
+        _set_errno(_winerr_to_errno(error));
+        goto done;
+    }
+
+    ret = (ssize_t)bytes_returned;
+
+done:
+    return ret;
 }
 
 ssize_t oe_syscall_pwrite_ocall(
@@ -1382,7 +1459,37 @@ ssize_t oe_syscall_pwrite_ocall(
     size_t count,
     oe_off_t offset)
 {
-    PANIC;
+    ssize_t ret = -1;
+    DWORD bytes_written = 0;
+    OVERLAPPED overlapped = {0};
+    LARGE_INTEGER saved_pos;
+    DWORD error = ERROR_SUCCESS;
+
+    if (!_get_file_pointer((HANDLE)fd, &saved_pos))
+    {
+        _set_errno(_winerr_to_errno(GetLastError()));
+        goto done;
+    }
+
+    overlapped.Offset = (DWORD)((uint64_t)offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+
+    if (!WriteFile(
+            (HANDLE)fd, buf, (DWORD)count, &bytes_written, &overlapped))
+        error = GetLastError();
+
+    _set_file_pointer((HANDLE)fd, saved_pos);
+
+    if (error != ERROR_SUCCESS)
+    {
+        _set_errno(_winerr_to_errno(error));
+        goto done;
+    }
+
+    ret = (ssize_t)bytes_written;
+
+done:
+    return ret;
 }
 
 int oe_syscall_close_ocall(oe_host_fd_t fd)
@@ -1434,6 +1541,22 @@ int oe_syscall_flock_ocall(oe_host_fd_t fd, int operation)
     return 0;
 }
 
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    int ret = -1;
+
+    if (!FlushFileBuffers((HANDLE)fd))
+    {
+        _set_errno(_winerr_to_errno(GetLastError()));
+        goto done;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
 static oe_host_fd_t _dup_socket(oe_host_fd_t);
 
 oe_host_fd_t oe_syscall_dup_ocall(oe_host_fd_t fd)
@@ -2390,6 +2513,24 @@ ssize_t oe_syscall_sendv_ocall(
     PANIC;
 }
 
+ssize_t oe_syscall_recvv_shared_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_recvv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
+ssize_t oe_syscall_sendv_shared_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    return oe_syscall_sendv_ocall(fd, iov_buf, iovcnt, iov_buf_size);
+}
+
 int oe_syscall_shutdown_ocall(oe_host_fd_t sockfd, int how)
 {
     int ret = shutdown(_get_socket(sockfd), how);
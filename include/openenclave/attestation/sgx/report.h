@@ -34,6 +34,109 @@ oe_result_t oe_sgx_get_signer_id_from_public_key(
     uint8_t* signer_id,
     size_t* signer_id_size);
 
+/**
+ * Statistics of the SGX quote verification collateral cache.
+ *
+ * The TCB info, QE identity and CRLs needed to verify SGX quotes are cached
+ * per platform FMSPC and PCK CA type, until the earliest **nextUpdate** date
+ * among them.
+ */
+typedef struct _oe_sgx_collateral_cache_stats
+{
+    /** Number of lookups served from the cache. */
+    uint64_t hits;
+
+    /** Number of lookups that fetched the collateral. */
+    uint64_t misses;
+
+    /** Number of entries dropped because their nextUpdate date passed. */
+    uint64_t expirations;
+
+    /** Number of entries currently in the cache. */
+    uint64_t entries;
+} oe_sgx_collateral_cache_stats_t;
+
+/**
+ * Get the statistics of the SGX quote verification collateral cache of the
+ * calling host process or enclave.
+ *
+ * @param[out] stats The statistics of the cache.
+ *
+ * @retval OE_OK upon success
+ * @retval OE_INVALID_PARAMETER **stats** is NULL.
+ */
+oe_result_t oe_sgx_get_collateral_cache_stats(
+    oe_sgx_collateral_cache_stats_t* stats);
+
+/**
+ * Drop all the entries of the SGX quote verification collateral cache of the
+ * calling host process or enclave, so that the next verification of each
+ * platform fetches its collateral again. The hit and miss counters are not
+ * reset.
+ *
+ * @retval OE_OK upon success
+ */
+oe_result_t oe_sgx_invalidate_collateral_cache(void);
+
+/**
+ * Statistics of the SGX verified quote cache.
+ *
+ * When enabled with oe_sgx_set_verified_quote_cache_size(), the validity
+ * period computed for a successfully verified quote and its endorsements is
+ * cached until the end of that period, so verifying the same quote with the
+ * same endorsements again only compares the validation time against it.
+ */
+typedef struct _oe_sgx_verified_quote_cache_stats
+{
+    /** Number of verifications served from the cache. */
+    uint64_t hits;
+
+    /** Number of verifications that verified the quote. */
+    uint64_t misses;
+
+    /** Number of entries dropped because their validity period ended. */
+    uint64_t expirations;
+
+    /** Number of entries currently in the cache. */
+    uint64_t entries;
+} oe_sgx_verified_quote_cache_stats_t;
+
+/**
+ * Set the maximum number of entries of the SGX verified quote cache of the
+ * calling host process or enclave. The cache is disabled by default. Once
+ * the cache is full, the least recently used entry is replaced.
+ *
+ * Changing the size drops all the entries of the cache.
+ *
+ * @param[in] max_entries The maximum number of verified quotes to cache, or
+ * 0 to disable the cache.
+ *
+ * @retval OE_OK upon success
+ * @retval OE_INVALID_PARAMETER **max_entries** is too large.
+ * @retval OE_OUT_OF_MEMORY The cache could not be allocated.
+ */
+oe_result_t oe_sgx_set_verified_quote_cache_size(size_t max_entries);
+
+/**
+ * Get the statistics of the SGX verified quote cache of the calling host
+ * process or enclave.
+ *
+ * @param[out] stats The statistics of the cache.
+ *
+ * @retval OE_OK upon success
+ * @retval OE_INVALID_PARAMETER **stats** is NULL.
+ */
+oe_result_t oe_sgx_get_verified_quote_cache_stats(
+    oe_sgx_verified_quote_cache_stats_t* stats);
+
+/**
+ * Drop all the entries of the SGX verified quote cache of the calling host
+ * process or enclave. The hit and miss counters are not reset.
+ *
+ * @retval OE_OK upon success
+ */
+oe_result_t oe_sgx_invalidate_verified_quote_cache(void);
+
 OE_EXTERNC_END
 
 #endif /* _OE_ATTESTATION_SGX_REPORT_H */
@@ -158,6 +158,106 @@ oe_result_t oe_verify_evidence(
     oe_claim_t** claims,
     size_t* claims_length);
 
+/**
+ * A piece of evidence verified by oe_verify_evidence_batch(), with the result
+ * of its verification.
+ */
+typedef struct _oe_evidence_batch_item
+{
+    /** The evidence buffer. */
+    const uint8_t* evidence_buffer;
+
+    /** The size of evidence_buffer in bytes. */
+    size_t evidence_buffer_size;
+
+    /** The result of the verification of the evidence. */
+    oe_result_t result;
+
+    /** The list of claims of the evidence if it was verified successfully, to
+     * be freed with oe_free_claims(). */
+    oe_claim_t* claims;
+
+    /** The length of the claims list. */
+    size_t claims_length;
+} oe_evidence_batch_item_t;
+
+/**
+ * oe_verify_evidence_batch
+ *
+ * Verifies a batch of attestation evidence as oe_verify_evidence() does for
+ * each of them, and returns the result and claims of each piece of evidence.
+ * This is available in the enclave and host.
+ *
+ * The checks that the evidence shares are done once for the batch. For SGX
+ * ECDSA evidence, the PCK certificate chain, the quoting enclave report and
+ * the validity of the endorsements are verified once per platform, and the
+ * quote signatures are verified on several threads on the host.
+ *
+ * @experimental
+ *
+ * @param[in,out] items The evidence to verify. The result, claims and
+ * claims_length fields of each item are set on return.
+ * @param[in] items_length The number of items.
+ * @param[in] endorsements_buffer The optional endorsements buffer, shared by
+ * all the evidence. All the evidence must then have its format.
+ * @param[in] endorsements_buffer_size The size of endorsements_buffer in bytes.
+ * @param[in] policies An optional list of policies to use for all the evidence.
+ * @param[in] policies_size The size of the policy list.
+ * @retval OE_OK The evidence was verified, and the result of each item is set.
+ * @retval OE_INVALID_PARAMETER At least one of the parameters is invalid.
+ * @retval other appropriate error code.
+ */
+oe_result_t oe_verify_evidence_batch(
+    oe_evidence_batch_item_t* items,
+    size_t items_length,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size);
+
+/**
+ * oe_verify_evidence_with_claims_buffer
+ *
+ * Verifies attestation evidence as oe_verify_evidence() does, but lays out
+ * the claims in a buffer provided by the caller instead of allocating them.
+ * This is available in the enclave and host.
+ *
+ * The buffer holds the list of claims followed by their names and values. If
+ * it is too small, OE_BUFFER_TOO_SMALL is returned after the evidence was
+ * verified, and **claims_buffer_size** is set to the size needed.
+ *
+ * @experimental
+ *
+ * @param[in] evidence_buffer The evidence buffer.
+ * @param[in] evidence_buffer_size The size of evidence_buffer in bytes.
+ * @param[in] endorsements_buffer The optional endorsements buffer.
+ * @param[in] endorsements_buffer_size The size of endorsements_buffer in bytes.
+ * @param[in] policies An optional list of policies to use.
+ * @param[in] policies_size The size of the policy list.
+ * @param[out] claims_buffer The buffer to lay out the claims in, aligned on 8
+ * bytes.
+ * @param[in,out] claims_buffer_size The size of claims_buffer on input; the
+ * size used or needed on output.
+ * @param[out] claims The list of claims, which points into claims_buffer and
+ * must not be passed to oe_free_claims().
+ * @param[out] claims_length The length of the claims list.
+ * @retval OE_OK The evidence was verified and its claims are in the buffer.
+ * @retval OE_INVALID_PARAMETER At least one of the parameters is invalid.
+ * @retval OE_BUFFER_TOO_SMALL **claims_buffer** is too small.
+ * @retval other appropriate error code.
+ */
+oe_result_t oe_verify_evidence_with_claims_buffer(
+    const uint8_t* evidence_buffer,
+    size_t evidence_buffer_size,
+    const uint8_t* endorsements_buffer,
+    size_t endorsements_buffer_size,
+    const oe_policy_t* policies,
+    size_t policies_size,
+    void* claims_buffer,
+    size_t* claims_buffer_size,
+    oe_claim_t** claims,
+    size_t* claims_length);
+
 /**
  * oe_free_claims
  *
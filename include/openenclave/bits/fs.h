@@ -25,6 +25,92 @@ OE_EXTERNC_BEGIN
  */
 #define OE_HOST_FILE_SYSTEM "oe_host_file_system"
 
+/**
+ * Maximum number of I/O buffers that can be registered with a host file
+ * system mount.
+ */
+#define OE_HOST_FILE_SYSTEM_MAX_IO_BUFFERS 64
+
+/**
+ * Maximum number of pages in the page cache of a host file system mount.
+ */
+#define OE_HOST_FILE_SYSTEM_MAX_CACHE_PAGES (64 * 1024)
+
+/**
+ * Size of the pages of the page cache of a host file system mount.
+ */
+#define OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE 4096
+
+/**
+ * Optional mount data for the host file system (passed to **mount()** as the
+ * **data** parameter). Zero-initialized fields disable the matching feature.
+ *
+ * When **io_buffer_count** is not zero, the host file system allocates a pool
+ * of **io_buffer_count** buffers of **io_buffer_size** bytes in host memory
+ * for the lifetime of the mount. **read()** and **write()** on files of the
+ * mount let the host fill or drain these buffers directly, so that the file
+ * data is copied once between the enclave and the host instead of being
+ * marshalled through the OCALL buffer. Calls fall back to the regular path
+ * when all the buffers are in use.
+ *
+ * When **cache_page_count** is not zero, regular files of the mount are
+ * cached in a page cache of **cache_page_count** pages in enclave memory.
+ * Reads are served from the cache and read ahead up to
+ * **cache_read_ahead_pages** pages on sequential access. Writes stay in the
+ * cache until **fsync()**, the last **close()** of the file or the eviction
+ * of the page. The cache assumes that the host does not modify the files
+ * while they are open in the enclave.
+ */
+typedef struct _oe_host_file_system_mount_data
+{
+    /** Number of I/O buffers, up to OE_HOST_FILE_SYSTEM_MAX_IO_BUFFERS. */
+    size_t io_buffer_count;
+
+    /** Size of each I/O buffer in bytes (not zero if there are buffers). */
+    size_t io_buffer_size;
+
+    /** Number of cache pages, up to OE_HOST_FILE_SYSTEM_MAX_CACHE_PAGES. */
+    size_t cache_page_count;
+
+    /** Maximum number of pages read ahead, up to half the cache. */
+    size_t cache_read_ahead_pages;
+} oe_host_file_system_mount_data_t;
+
+/**
+ * Counters of the page cache of a host file system mount.
+ */
+typedef struct _oe_host_file_system_cache_statistics
+{
+    /** Number of page lookups served from the cache. */
+    uint64_t hits;
+
+    /** Number of page lookups that had to read the page from the host. */
+    uint64_t misses;
+
+    /** Number of pages read from the host ahead of their use. */
+    uint64_t read_ahead_pages;
+
+    /** Number of pages evicted to make room for other pages. */
+    uint64_t evictions;
+
+    /** Number of dirty pages written back to the host. */
+    uint64_t write_backs;
+} oe_host_file_system_cache_statistics_t;
+
+/**
+ * Get the counters of the page cache of the host file system mount that
+ * contains **path**.
+ *
+ * @param path A path on a host file system mount with a page cache.
+ * @param statistics The counters on return.
+ *
+ * @returns 0 on success, or -1 with errno set to OE_EINVAL if the path is not
+ * on a host file system mount with a page cache.
+ */
+int oe_host_file_system_get_cache_statistics(
+    const char* path,
+    oe_host_file_system_cache_statistics_t* statistics);
+
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_FS_H */
@@ -642,6 +642,93 @@ oe_result_t oe_generate_attestation_certificate(
  */
 void oe_free_attestation_certificate(uint8_t* cert);
 
+/**
+ * Manages an attestation certificate reused across TLS connections.
+ */
+typedef struct _oe_attestation_certificate_manager
+    oe_attestation_certificate_manager_t;
+
+/**
+ * Create a manager of the attestation certificates of a key pair.
+ *
+ * The manager generates a certificate with
+ * oe_generate_attestation_certificate() on first use, then returns copies of
+ * it until it is **lifetime_in_seconds** old, so that establishing a TLS
+ * connection does not get a quote each time. Call
+ * oe_renew_managed_attestation_certificate() periodically to generate the
+ * next certificate before the current one expires, off the path of the
+ * callers of oe_get_managed_attestation_certificate().
+ *
+ * @param[in] subject_name The X.509 distinguished name of the certificates,
+ * or NULL for the default name of oe_generate_attestation_certificate().
+ * @param[in] private_key The private key used to sign the certificates.
+ * @param[in] private_key_size The size of the private_key buffer.
+ * @param[in] public_key The public key used as the certificates' subject key.
+ * @param[in] public_key_size The size of the public_key buffer.
+ * @param[in] lifetime_in_seconds How long a certificate is used for.
+ * @param[out] manager The new manager, to free with
+ * oe_free_attestation_certificate_manager().
+ *
+ * @retval OE_OK The manager was created.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ */
+oe_result_t oe_create_attestation_certificate_manager(
+    const unsigned char* subject_name,
+    const uint8_t* private_key,
+    size_t private_key_size,
+    const uint8_t* public_key,
+    size_t public_key_size,
+    uint32_t lifetime_in_seconds,
+    oe_attestation_certificate_manager_t** manager);
+
+/**
+ * Get the current attestation certificate of a manager, generating it if
+ * there is none or if its lifetime has passed. A certificate that is due for
+ * renewal is still returned without delay.
+ *
+ * @param[in] manager The manager.
+ * @param[out] output_cert A copy of the certificate in DER format, to free
+ * with oe_free_attestation_certificate().
+ * @param[out] output_cert_size The size of the certificate.
+ *
+ * @retval OE_OK The certificate was returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @return Any error of oe_generate_attestation_certificate().
+ */
+oe_result_t oe_get_managed_attestation_certificate(
+    oe_attestation_certificate_manager_t* manager,
+    uint8_t** output_cert,
+    size_t* output_cert_size);
+
+/**
+ * Renew the attestation certificate of a manager if less than a quarter of
+ * its lifetime remains, or if there is none.
+ *
+ * This is meant to be called periodically, e.g. from an ECALL made by a host
+ * timer thread, so that the threads serving TLS connections do not wait for
+ * a quote. oe_get_managed_attestation_certificate() keeps returning the
+ * current certificate until the next one is generated. Does nothing if
+ * another thread is renewing the certificate.
+ *
+ * @param[in] manager The manager.
+ *
+ * @retval OE_OK The certificate was renewed or did not need renewal.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @return Any error of oe_generate_attestation_certificate().
+ */
+oe_result_t oe_renew_managed_attestation_certificate(
+    oe_attestation_certificate_manager_t* manager);
+
+/**
+ * Free an attestation certificate manager.
+ *
+ * @param[in] manager If not NULL, the manager to free.
+ */
+void oe_free_attestation_certificate_manager(
+    oe_attestation_certificate_manager_t* manager);
+
 /**
  * identity validation callback type
  * @param[in] identity a pointer to an enclave's identity information
@@ -91,6 +91,8 @@ typedef void (*oe_ocall_func_t)(
 typedef enum _oe_enclave_setting_type
 {
     OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS = 0xdc73a628,
+    OE_ENCLAVE_SETTING_MEASUREMENT_CACHE = 0x5e2b0c41,
+    OE_ENCLAVE_SETTING_QUOTE_PRELOAD = 0x8c1f37d2,
 #ifdef OE_WITH_EXPERIMENTAL_EEID
     OE_EXTENDED_ENCLAVE_INITIALIZATION_DATA = 0x976a8f66,
 #endif
@@ -114,6 +116,144 @@ typedef struct _oe_enclave_setting_context_switchless
     size_t max_enclave_workers;
 } oe_enclave_setting_context_switchless_t;
 
+/**
+ * The setting for the measurement cache.
+ *
+ * Creating an enclave computes its measurement (MRENCLAVE) on the host in
+ * addition to the platform, and signs it with a debug key if the enclave is
+ * not signed. With this setting, the measurement and the signature are cached
+ * for each combination of enclave image, properties and creation flags, so
+ * that creating the same enclave again only leaves the checks made by the
+ * platform. A measurement rejected by the platform is dropped from the cache
+ * and the enclave is measured again. The setting is ignored in simulation
+ * mode, where the platform does not check the measurement.
+ */
+typedef struct _oe_enclave_setting_measurement_cache
+{
+    /**
+     * The directory where the measurements are stored, so that they are shared
+     * by all the processes using the same directory, or NULL to cache them in
+     * process memory only. The directory must exist.
+     */
+    const char* directory;
+} oe_enclave_setting_measurement_cache_t;
+
+/**
+ * The setting for preloading the SGX quote library.
+ *
+ * The first SGX quote of a host process loads the quote library and quote
+ * provider and fetches the target info of the Quoting Enclave. With this
+ * setting, this is done while the enclave is created, so that the first call
+ * to oe_get_evidence() or oe_get_report() does not pay for it. The setting is
+ * ignored in simulation mode.
+ */
+typedef struct _oe_enclave_setting_quote_preload
+{
+    /**
+     * Whether creating the enclave fails if the quote library cannot be
+     * loaded. Otherwise a warning is traced.
+     */
+    bool required;
+} oe_enclave_setting_quote_preload_t;
+
+/**
+ * Types of context-switchless worker threads.
+ */
+typedef enum _oe_switchless_worker_type
+{
+    /**
+     * Host threads that service context-switchless ocalls.
+     */
+    OE_SWITCHLESS_WORKER_HOST = 1,
+    /**
+     * Enclave threads that service context-switchless ecalls.
+     */
+    OE_SWITCHLESS_WORKER_ENCLAVE = 2,
+    /**
+     * Unused.
+     */
+    __OE_SWITCHLESS_WORKER_TYPE_MAX = OE_ENUM_MAX,
+} oe_switchless_worker_type_t;
+
+/**
+ * Counters of a context-switchless worker thread.
+ */
+typedef struct _oe_switchless_worker_statistics
+{
+    /**
+     * The number of switchless calls serviced by the worker.
+     */
+    uint64_t calls;
+    /**
+     * The number of iterations the worker spun without finding a call.
+     */
+    uint64_t spins;
+    /**
+     * The number of times the worker went to sleep.
+     */
+    uint64_t sleeps;
+    /**
+     * The number of times a caller woke the worker up.
+     */
+    uint64_t wakeups;
+    /**
+     * The current number of iterations the worker spins before it sleeps.
+     * The threshold is adapted to the arrival rate of the calls.
+     */
+    uint64_t spin_count_threshold;
+} oe_switchless_worker_statistics_t;
+
+/**
+ * Counters of the buffers used to marshal the parameters of the OCALLs of an
+ * enclave.
+ *
+ * Each enclave thread marshals the parameters of its OCALLs in a buffer that
+ * the host passes on every ECALL. The parameters of an OCALL that does not fit
+ * are marshalled in host memory allocated and freed with two extra OCALLs
+ * instead, and the host grows the buffer of the thread for its next ECALLs.
+ */
+typedef struct _oe_ocall_buffer_statistics
+{
+    /**
+     * The number of OCALLs whose parameters did not fit in the buffer of
+     * their thread.
+     */
+    uint64_t fallback_allocations;
+    /**
+     * The total size of the host memory allocated for these OCALLs.
+     */
+    uint64_t fallback_bytes;
+    /**
+     * The number of times the buffer of a thread was grown.
+     */
+    uint64_t buffer_grows;
+    /**
+     * The total size of the buffers of the enclave threads.
+     */
+    uint64_t buffer_capacity;
+} oe_ocall_buffer_statistics_t;
+
+/**
+ * The counters of the measurement cache of the calling process (see
+ * **oe_enclave_setting_measurement_cache_t**).
+ */
+typedef struct _oe_measurement_cache_statistics
+{
+    /**
+     * The number of enclaves created with a cached measurement.
+     */
+    uint64_t hits;
+    /**
+     * The number of enclaves measured since their measurement was not cached.
+     */
+    uint64_t misses;
+    /**
+     * The number of cached measurements dropped since the platform rejected
+     * them.
+     */
+    uint64_t evictions;
+} oe_measurement_cache_statistics_t;
+
 /**
  * The uniform structure type containing a specific type of enclave
  * setting.
@@ -131,6 +271,9 @@ typedef struct _oe_enclave_setting
     union {
         const oe_enclave_setting_context_switchless_t*
             context_switchless_setting;
+        const oe_enclave_setting_measurement_cache_t*
+            measurement_cache_setting;
+        const oe_enclave_setting_quote_preload_t* quote_preload_setting;
 #ifdef OE_WITH_EXPERIMENTAL_EEID
         oe_eeid_t* eeid;
 #endif
@@ -196,6 +339,270 @@ oe_result_t oe_create_enclave(
  */
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave);
 
+/**
+ * Get the counters of the context-switchless worker threads of an enclave.
+ *
+ * The counters are updated by the workers without synchronization, so the
+ * returned values are a snapshot. This function must not be called
+ * concurrently with **oe_terminate_enclave()**.
+ *
+ * @param[in] enclave The enclave that owns the worker threads.
+ * @param[in] type The type of worker threads to query.
+ * @param[out] statistics The array that receives the counters of each worker.
+ * @param[in,out] statistics_count On input, the number of elements in
+ * **statistics**. On output, the number of worker threads of the given type.
+ *
+ * @retval OE_OK The counters were successfully retrieved.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_BUFFER_TOO_SMALL **statistics** is NULL or too small. The
+ * required number of elements is returned in **statistics_count**.
+ *
+ */
+oe_result_t oe_get_switchless_worker_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    oe_switchless_worker_statistics_t* statistics,
+    size_t* statistics_count);
+
+/**
+ * Get the counters of the buffers used to marshal the parameters of the
+ * OCALLs of an enclave, summed over its threads.
+ *
+ * The counters are updated by the threads calling into the enclave without
+ * synchronization, so the returned values are a snapshot. This function must
+ * not be called concurrently with **oe_terminate_enclave()**.
+ *
+ * @param[in] enclave The enclave to query.
+ * @param[out] statistics The counters of the enclave.
+ *
+ * @retval OE_OK The counters were successfully retrieved.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_get_ocall_buffer_statistics(
+    oe_enclave_t* enclave,
+    oe_ocall_buffer_statistics_t* statistics);
+
+/**
+ * Get the counters of the measurement cache of the calling process, which
+ * are updated by the creation of enclaves with
+ * **OE_ENCLAVE_SETTING_MEASUREMENT_CACHE**.
+ *
+ * @param[out] statistics The counters of the cache.
+ *
+ * @retval OE_OK The counters were successfully retrieved.
+ * @retval OE_INVALID_PARAMETER **statistics** is NULL.
+ *
+ */
+oe_result_t oe_get_measurement_cache_statistics(
+    oe_measurement_cache_statistics_t* statistics);
+
+/**
+ * An enclave function call of a batch passed to
+ * **oe_call_enclave_functions()**.
+ */
+typedef struct _oe_enclave_function_call
+{
+    /**
+     * The id of the enclave function to call.
+     */
+    uint32_t function_id;
+    /**
+     * The buffer holding the input parameters, laid out as for
+     * **oe_call_enclave_function()**.
+     */
+    const void* input_buffer;
+    /**
+     * The size of **input_buffer**.
+     */
+    size_t input_buffer_size;
+    /**
+     * The buffer that receives the output parameters.
+     */
+    void* output_buffer;
+    /**
+     * The size of **output_buffer**.
+     */
+    size_t output_buffer_size;
+    /**
+     * Set to the number of bytes the enclave function wrote in the output
+     * buffer.
+     */
+    size_t output_bytes_written;
+    /**
+     * Set to the result of the call, as returned by
+     * **oe_call_enclave_function()**.
+     */
+    oe_result_t result;
+} oe_enclave_function_call_t;
+
+/**
+ * Call several enclave functions with few enclave entries.
+ *
+ * The calls are split into batches of at most **batch_size** calls, and the
+ * enclave functions of each batch are called one after the other in a single
+ * enclave entry, so that the cost of entering and leaving the enclave is paid
+ * once per batch. The calls are independent: each one reports its own result
+ * and a failing call does not stop the next ones. Larger batches save more
+ * enclave transitions but keep the enclave thread busy for longer.
+ *
+ * @param[in] enclave The enclave to call into.
+ * @param[in,out] calls The array of calls. The result of each call is set in
+ * its element.
+ * @param[in] num_calls The number of elements in **calls**.
+ * @param[in] batch_size The maximum number of calls per enclave entry, or 0 to
+ * make all the calls in a single enclave entry.
+ *
+ * @retval OE_OK All the calls were made. Check the result of each call.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_OUT_OF_THREADS No enclave thread is available.
+ *
+ */
+oe_result_t oe_call_enclave_functions(
+    oe_enclave_t* enclave,
+    oe_enclave_function_call_t* calls,
+    size_t num_calls,
+    size_t batch_size);
+
+/**
+ * A queue of asynchronous ECALLs into an enclave.
+ */
+typedef struct _oe_ecall_queue oe_ecall_queue_t;
+
+/**
+ * The completion of an ECALL submitted with **oe_submit_ecall()**.
+ */
+typedef struct _oe_ecall_completion
+{
+    /**
+     * The context passed to **oe_submit_ecall()**.
+     */
+    void* context;
+    /**
+     * The result of the ECALL, as returned by **oe_call_enclave_function()**.
+     */
+    oe_result_t result;
+    /**
+     * The number of bytes the enclave function wrote in the output buffer.
+     */
+    size_t output_bytes_written;
+} oe_ecall_completion_t;
+
+/**
+ * Create a queue of asynchronous ECALLs into an enclave.
+ *
+ * The ECALLs submitted to the queue are executed by a pool of host threads
+ * that each call into the enclave on their own enclave thread. If the enclave
+ * was created with context-switchless enclave workers, the ECALLs are posted
+ * to the workers instead, and only fall back to regular ECALLs while all the
+ * workers are busy.
+ *
+ * The queue must be deleted before the enclave is terminated.
+ *
+ * @param[in] enclave The enclave to call into.
+ * @param[in] num_threads The number of ECALLs executed concurrently. It is
+ * limited to the number of enclave threads (TCS).
+ * @param[in] capacity The maximum number of ECALLs submitted and whose
+ * completions have not been polled yet. It is rounded up to a power of two.
+ * @param[out] queue This points to the queue upon success.
+ *
+ * @retval OE_OK The queue was successfully created.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY Failed to allocate memory.
+ * @retval OE_THREAD_CREATE_ERROR Failed to create the threads of the queue.
+ *
+ */
+oe_result_t oe_create_ecall_queue(
+    oe_enclave_t* enclave,
+    size_t num_threads,
+    size_t capacity,
+    oe_ecall_queue_t** queue);
+
+/**
+ * Submit an ECALL to a queue without waiting for it to complete.
+ *
+ * The buffers are laid out as for **oe_call_enclave_function()**: the input
+ * buffer starts with the marshalling structure of the enclave function
+ * generated by oeedger8r, followed by its marshalled input parameters. The
+ * buffers must remain valid until the completion of the ECALL is polled.
+ *
+ * This function may be called by several threads concurrently.
+ *
+ * @param[in] queue The queue to submit the ECALL to.
+ * @param[in] function_id The id of the enclave function to call.
+ * @param[in] input_buffer The buffer holding the input parameters.
+ * @param[in] input_buffer_size The size of **input_buffer**.
+ * @param[out] output_buffer The buffer that receives the output parameters.
+ * @param[in] output_buffer_size The size of **output_buffer**.
+ * @param[in] context A value returned in the completion of the ECALL.
+ *
+ * @retval OE_OK The ECALL was successfully submitted.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_BUSY The queue holds **capacity** ECALLs already. Poll
+ * completions before submitting more ECALLs.
+ *
+ */
+oe_result_t oe_submit_ecall(
+    oe_ecall_queue_t* queue,
+    uint32_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    void* context);
+
+/**
+ * Remove the completions of ECALLs from a queue without blocking.
+ *
+ * ECALLs may complete in a different order than they were submitted.
+ *
+ * @param[in] queue The queue to poll.
+ * @param[out] completions The array that receives the completions.
+ * @param[in,out] completions_count On input, the number of elements in
+ * **completions**. On output, the number of completions removed.
+ *
+ * @retval OE_OK The completions were successfully polled.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_poll_ecall_completions(
+    oe_ecall_queue_t* queue,
+    oe_ecall_completion_t* completions,
+    size_t* completions_count);
+
+/**
+ * Get the event signaled when ECALLs submitted to a queue complete.
+ *
+ * On Linux, the event is an eventfd file descriptor that becomes readable. On
+ * Windows, it is the HANDLE of a manual-reset event. Event loops wait for the
+ * event and then call **oe_poll_ecall_completions()**, which resets it. The
+ * event remains owned by the queue.
+ *
+ * @param[in] queue The queue to query.
+ * @param[out] event The event of the queue.
+ *
+ * @retval OE_OK The event was successfully retrieved.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ *
+ */
+oe_result_t oe_get_ecall_queue_event(oe_ecall_queue_t* queue, intptr_t* event);
+
+/**
+ * Delete a queue of asynchronous ECALLs.
+ *
+ * This function waits for the submitted ECALLs to complete and discards the
+ * completions that were not polled. It must not be called concurrently with
+ * other functions on the queue.
+ *
+ * @param[in] queue The queue to delete.
+ *
+ * @retval OE_OK The queue was successfully deleted.
+ * @retval OE_INVALID_PARAMETER **queue** is invalid.
+ *
+ */
+oe_result_t oe_delete_ecall_queue(oe_ecall_queue_t* queue);
+
 #if (OE_API_VERSION < 2)
 #error "Only OE_API_VERSION of 2 is supported"
 #else
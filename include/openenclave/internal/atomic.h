@@ -17,6 +17,7 @@ OE_EXTERNC_BEGIN
 #pragma intrinsic(_InterlockedCompareExchange64)
 #pragma intrinsic(_InterlockedCompareExchangePointer)
 #pragma intrinsic(_mm_pause)
+#pragma intrinsic(_mm_mfence)
 __int64 _InterlockedOr64(__int64 volatile* value, __int64 mask);
 __int64 _InterlockedIncrement64(__int64* lpAddend);
 __int64 _InterlockedDecrement64(__int64* lpAddend);
@@ -30,6 +31,7 @@ void* _InterlockedCompareExchangePointer(
     void* newptr,
     void* old);
 void _mm_pause(void);
+void _mm_mfence(void);
 #endif
 
 /* Atomically fetch the value of given variable */
@@ -119,6 +121,19 @@ bool oe_atomic_compare_and_swap_ptr(
 #endif
 }
 
+/* Order the loads and stores before the fence with those after it */
+OE_INLINE
+void oe_atomic_thread_fence(void)
+{
+#if defined(__GNUC__)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _mm_mfence();
+#else
+#error "unsupported"
+#endif
+}
+
 OE_INLINE
 void oe_yield_cpu(void)
 {
@@ -75,6 +75,7 @@ typedef enum _oe_func
     OE_ECALL_INIT_ENCLAVE,
     OE_ECALL_CALL_ENCLAVE_FUNCTION,
     OE_ECALL_VIRTUAL_EXCEPTION_HANDLER,
+    OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH,
     /* Caution: always add new ECALL function numbers here */
     OE_ECALL_MAX,
 
@@ -194,6 +195,24 @@ typedef struct _oe_call_enclave_function_args
     oe_result_t result;
 } oe_call_enclave_function_args_t;
 
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_batch_args_t
+**
+**     The argument of OE_ECALL_CALL_ENCLAVE_FUNCTION_BATCH, which calls the
+**     enclave functions of an array of calls one after the other in a single
+**     enclave entry. The result of each call is set in its own element.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_enclave_function_batch_args
+{
+    oe_call_enclave_function_args_t* calls;
+    uint64_t num_calls;
+} oe_call_enclave_function_batch_args_t;
+
 /*
 **==============================================================================
 **
@@ -5,6 +5,7 @@
 #define _OE_CPUID_H
 
 #include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
 
 #define OE_CPUID_OPCODE 0xA20F
 #define OE_CPUID_LEAF_COUNT 8
@@ -19,6 +20,9 @@
 #define OE_CPUID_AESNI_FEATURE 0x02000000u  /* Leaf 1, subleaf 0, ECX */
 #define OE_CPUID_RDRAND_FEATURE 0x40000000u /* Leaf 1, subleaf 0, ECX */
 #define OE_CPUID_RDSEED_FEATURE 0x00040000u /* Leaf 7, subleaf 0, EBX */
+#define OE_CPUID_SSSE3_FEATURE 0x00000200u  /* Leaf 1, subleaf 0, ECX */
+#define OE_CPUID_SSE4_1_FEATURE 0x00080000u /* Leaf 1, subleaf 0, ECX */
+#define OE_CPUID_SHA_FEATURE 0x20000000u    /* Leaf 7, subleaf 0, EBX */
 
 /**
  * The list of cpuid leafs that are emulated.
@@ -33,4 +37,25 @@ OE_INLINE bool oe_is_emulated_cpuid_leaf(uint32_t leaf)
     return (leaf == 0) || (leaf == 1) || (leaf == 4) || (leaf == 7);
 }
 
+#if defined(OE_BUILD_ENCLAVE) && defined(__x86_64__)
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Get the registers of an emulated CPUID leaf from the values cached when the
+ * enclave was created, without executing the CPUID instruction, which traps in
+ * SGX enclaves.
+ *
+ * Returns 0 if the leaf (and subleaf) is available, -1 otherwise, including
+ * before the values are cached.
+ */
+int oe_get_cpuid_leaf(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t regs[OE_CPUID_REG_COUNT]);
+
+OE_EXTERNC_END
+
+#endif
+
 #endif /* _OE_CPUID_H */
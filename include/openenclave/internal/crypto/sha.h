@@ -116,6 +116,21 @@ oe_result_t oe_sha256_restore(
     const uint32_t* num_hashed);
 #endif
 
+#ifdef OE_BUILD_ENCLAVE
+/**
+ * Selects how the enclave computes SHA-256
+ *
+ * SHA-256 uses the SHA extensions of the CPU by default, when the CPU has
+ * them, and portable code otherwise. This function lets tests and benchmarks
+ * compare both.
+ *
+ * @param enable whether to use the SHA extensions of the CPU if it has them
+ *
+ * @return true if SHA-256 now uses the SHA extensions of the CPU
+ */
+bool oe_sha256_use_cpu_extensions(bool enable);
+#endif
+
 OE_EXTERNC_END
 
 #endif /* _OE_SHA_H */
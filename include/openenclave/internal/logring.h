@@ -0,0 +1,30 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_LOGRING_H
+#define _OE_LOGRING_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/bits/logging.h>
+#include <openenclave/internal/trace.h>
+
+/**
+ * oe_log_ring_t is shared by the host and the enclave.
+ * Lock down the layout and keep the positions on separate cache lines.
+ */
+OE_STATIC_ASSERT(sizeof(oe_log_ring_entry_t) == 24 + OE_LOG_MESSAGE_LEN_MAX);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_entry_t, sequence) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_entry_t, level) == 8);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_entry_t, timestamp) == 16);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_entry_t, message) == 24);
+OE_STATIC_ASSERT(sizeof(oe_log_ring_t) == 192);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, entries) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, capacity) == 8);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, clock) == 16);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, enqueue_pos) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, dropped) == 72);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, dequeue_pos) == 128);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_log_ring_t, event) == 136);
+
+#endif /* _OE_LOGRING_H */
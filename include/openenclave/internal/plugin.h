@@ -327,8 +327,120 @@ struct _oe_verifier
         oe_verifier_t* context,
         oe_claim_t* claims,
         size_t claims_length);
+
+    /**
+     * Verifies a batch of evidence of the plugin format, as verify_evidence
+     * does for each of them. This entry point is optional; when it is NULL,
+     * oe_verify_evidence_batch() calls verify_evidence for each item.
+     *
+     * @experimental
+     *
+     * @param[in] context A pointer to the verifier plugin struct.
+     * @param[in,out] items The evidence to verify, without the attestation
+     * header. The result, claims and claims_length fields of each item are
+     * set on return.
+     * @param[in] items_length The number of items.
+     * @param[in] endorsements_buffer The optional endorsements buffer shared
+     * by all the evidence.
+     * @param[in] endorsements_buffer_size The size of endorsements_buffer in
+     * bytes.
+     * @param[in] policies A list of policies to use.
+     * @param[in] policies_size The size of the policy list.
+     * @retval OE_OK if the result of each item is set.
+     * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+     * @retval An appropriate error code on failure.
+     */
+    oe_result_t (*verify_evidence_batch)(
+        oe_verifier_t* context,
+        oe_evidence_batch_item_t* items,
+        size_t items_length,
+        const uint8_t* endorsements_buffer,
+        size_t endorsements_buffer_size,
+        const oe_policy_t* policies,
+        size_t policies_size);
+
+    /**
+     * Verifies evidence as verify_evidence does, but lays out its claims in
+     * a buffer given by the caller, as oe_copy_claim_to_buffer() does. This
+     * entry point is optional; when it is NULL,
+     * oe_verify_evidence_with_claims_buffer() copies the claims returned by
+     * verify_evidence to the buffer.
+     *
+     * @experimental
+     *
+     * @param[in] context A pointer to the verifier plugin struct.
+     * @param[in] evidence_buffer The evidence buffer.
+     * @param[in] evidence_buffer_size The size of evidence_buffer in bytes.
+     * @param[in] endorsements_buffer The endorsements buffer.
+     * @param[in] endorsements_buffer_size The size of endorsements_buffer in
+     * bytes.
+     * @param[in] policies A list of policies to use.
+     * @param[in] policies_size The size of the policy list.
+     * @param[out] claims_buffer The buffer to lay out the claims in, aligned
+     * on OE_CLAIMS_BUFFER_ALIGNMENT bytes.
+     * @param[in,out] claims_buffer_size The size of claims_buffer on input;
+     * the size used or needed on output.
+     * @param[out] claims The list of claims, in claims_buffer.
+     * @param[out] claims_length The length of the claims list.
+     * @retval OE_OK on success.
+     * @retval OE_BUFFER_TOO_SMALL claims_buffer is too small.
+     * @retval An appropriate error code on failure.
+     */
+    oe_result_t (*verify_evidence_with_claims_buffer)(
+        oe_verifier_t* context,
+        const uint8_t* evidence_buffer,
+        size_t evidence_buffer_size,
+        const uint8_t* endorsements_buffer,
+        size_t endorsements_buffer_size,
+        const oe_policy_t* policies,
+        size_t policies_size,
+        void* claims_buffer,
+        size_t* claims_buffer_size,
+        oe_claim_t** claims,
+        size_t* claims_length);
 };
 
+/**
+ * A claims buffer holds a list of claims, followed by their names and values,
+ * each aligned on OE_CLAIMS_BUFFER_ALIGNMENT bytes. Such a list takes a single
+ * allocation.
+ */
+#define OE_CLAIMS_BUFFER_ALIGNMENT 8
+
+/**
+ * Add the size that the name and value of a claim take in a claims buffer
+ * to **size**.
+ *
+ * @param[in] name_size The size of the name, including the zero-terminator.
+ * @param[in] value_size The size of the value.
+ * @param[in,out] size The size to add to.
+ * @retval OE_OK on success.
+ * @retval OE_INTEGER_OVERFLOW The size overflows.
+ */
+oe_result_t oe_add_claim_buffer_size(
+    size_t name_size,
+    size_t value_size,
+    size_t* size);
+
+/**
+ * Copy the name and value of a claim to the data of a claims buffer, and set
+ * the claim to point to them. **data** is advanced past the copy.
+ *
+ * @param[out] claim The claim to set.
+ * @param[in] name The name of the claim.
+ * @param[in] name_size The size of the name, including the zero-terminator.
+ * @param[in] value The value of the claim.
+ * @param[in] value_size The size of the value.
+ * @param[in,out] data The data of the claims buffer to copy to.
+ */
+void oe_copy_claim_to_buffer(
+    oe_claim_t* claim,
+    const char* name,
+    size_t name_size,
+    const void* value,
+    size_t value_size,
+    uint8_t** data);
+
 #ifdef OE_BUILD_ENCLAVE
 
 /**
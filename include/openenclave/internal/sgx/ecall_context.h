@@ -21,6 +21,14 @@ typedef struct _oe_ecall_context
     uint64_t debug_eexit_rip;
     uint64_t debug_eexit_rbp;
     uint64_t debug_eexit_rsp;
+
+    // Set by the enclave when an ocall buffer does not fit in ocall_buffer and
+    // is allocated in host memory instead: the number and total size of these
+    // allocations, and the largest size requested. The host grows the buffer
+    // for the next ECALLs accordingly.
+    uint64_t ocall_buffer_fallbacks;
+    uint64_t ocall_buffer_fallback_bytes;
+    uint64_t ocall_buffer_wanted_size;
 } oe_ecall_context_t;
 
 /**
@@ -0,0 +1,35 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SGX_QUOTESTATS_H
+#define _OE_SGX_QUOTESTATS_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** oe_sgx_quote_stats_t
+**
+**     Counters of the requests for SGX quotes made by the calling enclave
+**     (OCALLs to the host) or host process (calls to the quote library).
+**
+**==============================================================================
+*/
+typedef struct _oe_sgx_quote_stats
+{
+    uint64_t target_info_fetches; /* QE target info requests not cached */
+    uint64_t target_info_hits;    /* QE target info requests cached */
+    uint64_t quote_calls;         /* Requests for one or more quotes */
+    uint64_t quotes;              /* Quotes requested */
+} oe_sgx_quote_stats_t;
+
+oe_result_t oe_sgx_get_quote_stats(oe_sgx_quote_stats_t* stats);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SGX_QUOTESTATS_H */
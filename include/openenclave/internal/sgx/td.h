@@ -81,7 +81,7 @@ oe_thread_data_t* oe_get_thread_data(void);
  * Due to the inability to use OE_OFFSETOF on a struct while defining its
  * members, this value is computed and hard-coded.
  */
-#define OE_THREAD_SPECIFIC_DATA_SIZE (3744)
+#define OE_THREAD_SPECIFIC_DATA_SIZE (3648)
 
 typedef struct _callsite Callsite;
 
@@ -101,9 +101,42 @@ typedef struct _oe_shared_memory_arena_t
     uint8_t* buffer;
     uint64_t capacity;
     uint64_t used;
+
+    /* Chunks chained on demand when the buffer above is full */
+    struct _oe_shared_memory_arena_chunk* chunks;
+    uint64_t chunks_capacity;
+
+    /* Number of consecutive resets during which no chunk was used */
+    uint64_t idle_count;
+
+    /* Statistics. These survive the teardown of the arena. */
+    uint64_t high_water_mark;
+    uint64_t chunks_allocated;
+    uint64_t chunks_released;
+    uint64_t failed_allocations;
 } oe_shared_memory_arena_t;
 
-OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 24);
+OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 80);
+
+/* This structure holds the enclave memory used to marshal the arguments of
+ * the ECALLs of a thread, which is reused from one ECALL to the next. It is
+ * used in enclave/core/sgx/calls.c.
+ */
+typedef struct _oe_ecall_buffer
+{
+    uint8_t* buffer;
+    uint64_t capacity;
+
+    /* Non-zero while an ECALL of this thread uses the buffer */
+    uint64_t in_use;
+
+    /* Largest size used, and number of ECALLs, since the buffer was last
+     * trimmed */
+    uint64_t max_used;
+    uint64_t num_calls;
+} oe_ecall_buffer_t;
+
+OE_CHECK_SIZE(sizeof(oe_ecall_buffer_t), 40);
 
 OE_PACK_BEGIN
 typedef struct _td
@@ -154,11 +187,17 @@ typedef struct _td
 
     /* POSIX errno (renamed to prevent clash with errno macro) */
     int32_t errnum;
-    int32_t padding2;
+
+    /* Adaptive estimate of the spins needed to acquire a contended lock
+     * (see enclave/core/sgx/thread.c) */
+    uint32_t lock_spins;
 
     /* Thread-specific shared memory pool (see enclave/core/arena.c) */
     oe_shared_memory_arena_t arena;
 
+    /* Reusable ECALL marshalling buffer (see enclave/core/sgx/calls.c) */
+    oe_ecall_buffer_t ecall_buffer;
+
     /* TLS atexit functions (see enclave/core/sgx/threadlocal.c) */
     oe_tls_atexit_t* tls_atexit_functions;
     uint64_t num_tls_atexit_functions;
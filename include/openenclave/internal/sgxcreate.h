@@ -37,6 +37,37 @@ OE_STATIC_ASSERT(sizeof(oe_sgx_load_state_t) == sizeof(unsigned int));
 
 typedef struct _oe_sgx_load_context oe_sgx_load_context_t;
 
+typedef struct _oe_sgx_measure_pipeline oe_sgx_measure_pipeline_t;
+
+/* Measurement of an enclave computed by the host */
+typedef struct _oe_sgx_measurement
+{
+    OE_SHA256 mrenclave;
+
+    /* The SIGSTRUCT passed to EINIT (debug-signed if the enclave is not
+     * signed); only set when creating a hardware enclave */
+    sgx_sigstruct_t sigstruct;
+} oe_sgx_measurement_t;
+
+/* Time spent in each step of the enclave creation, in nanoseconds */
+typedef struct _oe_sgx_load_timings
+{
+    /* Loading, parsing and patching the enclave image */
+    uint64_t image;
+
+    /* Adding pages that are not measured (EADD) */
+    uint64_t eadd;
+
+    /* Adding pages that are measured (EADD and EEXTEND) */
+    uint64_t eextend;
+
+    /* Measuring the pages on the host, which overlaps with the above */
+    uint64_t measure;
+
+    /* Initializing the enclave (EINIT) */
+    uint64_t einit;
+} oe_sgx_load_timings_t;
+
 struct _oe_sgx_load_context
 {
     oe_sgx_load_type_t type;
@@ -64,6 +95,26 @@ struct _oe_sgx_load_context
     /* Hash context used to measure enclave as it is loaded */
     oe_sha256_context_t hash_context;
 
+    /* Measures the pages on a worker thread while they are being added
+     * (only when creating an enclave) */
+    oe_sgx_measure_pipeline_t* measure_pipeline;
+
+    oe_sgx_load_timings_t timings;
+
+    /* Whether to look the measurement up in the measurement cache, and the
+     * directory of the on-disk cache (may be null) */
+    bool use_measurement_cache;
+    const char* measurement_cache_directory;
+    OE_SHA256 measurement_cache_key;
+
+    /* Set if the measurement below was found in the cache, in which case the
+     * pages are not measured on the host */
+    bool measurement_cached;
+    oe_sgx_measurement_t measurement;
+
+    /* Set if EINIT failed with the cached measurement */
+    bool measurement_rejected;
+
 #ifdef OE_WITH_EXPERIMENTAL_EEID
     /* EEID data needed during enclave creation */
     oe_eeid_t* eeid;
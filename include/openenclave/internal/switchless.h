@@ -14,19 +14,38 @@
  * oe_host_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 40);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, call_arg) == 0);
+OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 72);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, queue) == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, enc) == 8);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_stopping) == 16);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_busy) == 17);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, event) == 20);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_count) == 24);
-OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 32);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, spin_count_threshold) == 32);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 40);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_call_count) == 48);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, total_sleep_count) == 56);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, total_wakeup_count) == 64);
+
+/**
+ * oe_switchless_ocall_queue_t is shared by the host and the enclave.
+ * Lock down the layout and keep the positions on separate cache lines.
+ */
+OE_STATIC_ASSERT(sizeof(oe_switchless_ocall_slot_t) == 16);
+OE_STATIC_ASSERT(sizeof(oe_switchless_ocall_queue_t) == 192);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_ocall_queue_t, slots) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_ocall_queue_t, capacity) == 8);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_ocall_queue_t, enqueue_pos) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_ocall_queue_t, dequeue_pos) == 128);
 
 /**
  * oe_enclave_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 48);
+OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 72);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, call_arg) == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, enc) == 8);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, is_stopping) == 16);
@@ -36,6 +55,12 @@ OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, spin_count_threshold) == 32);
 OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, total_spin_count) == 40);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, total_call_count) == 48);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, total_sleep_count) == 56);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, total_wakeup_count) == 64);
 
 typedef struct _oe_switchless_call_manager
 {
@@ -43,6 +68,10 @@ typedef struct _oe_switchless_call_manager
     oe_thread_t* host_worker_threads;
     size_t num_host_workers;
 
+    // Queue of switchless ocalls shared by all host workers.
+    oe_switchless_ocall_queue_t* ocall_queue;
+    oe_switchless_ocall_slot_t* ocall_queue_slots;
+
     oe_enclave_worker_context_t* enclave_worker_contexts;
     oe_thread_t* enclave_worker_threads;
     size_t num_enclave_workers;
@@ -55,12 +84,49 @@ oe_result_t oe_start_switchless_manager(
 
 oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave);
 
-void oe_host_worker_wait(oe_host_worker_context_t* context);
+/**
+ * Wait until the worker is woken up. Returns false without blocking if there
+ * is a pending wake notification, and true if the worker actually slept.
+ */
+bool oe_host_worker_wait(oe_host_worker_context_t* context);
 
 void oe_host_worker_wake(oe_host_worker_context_t* context);
 
-void oe_enclave_worker_wait(oe_enclave_worker_context_t* context);
+bool oe_enclave_worker_wait(oe_enclave_worker_context_t* context);
 
 void oe_enclave_worker_wake(oe_enclave_worker_context_t* context);
 
+/**
+ * Return a monotonic timestamp in nanoseconds. Used to measure how long the
+ * workers sleep in order to adapt their spin count thresholds.
+ */
+uint64_t oe_switchless_get_timestamp(void);
+
+/**
+ * Get a snapshot of the shared memory arena counters of every enclave thread
+ * that has used its arena. On input, *statistics_count is the number of
+ * elements in statistics. On output, it is the number of arenas. Returns
+ * OE_BUFFER_TOO_SMALL if statistics is NULL or too small.
+ */
+oe_result_t oe_sgx_get_arena_statistics(
+    oe_enclave_t* enclave,
+    oe_arena_statistics_t* statistics,
+    size_t* statistics_count);
+
+#ifdef OE_BUILD_ENCLAVE
+
+/**
+ * Set the capacity of the first buffer of the shared memory arenas created
+ * from now on. An arena is created by the first switchless OCALL of an ECALL.
+ * Returns false if the capacity exceeds the maximum capacity of an arena.
+ */
+bool oe_configure_arena_capacity(size_t cap);
+
+/**
+ * Get the shared memory arena counters of the calling enclave thread.
+ */
+oe_result_t oe_get_arena_statistics(oe_arena_statistics_t* statistics);
+
+#endif /* OE_BUILD_ENCLAVE */
+
 #endif /* _OE_SWITCHLESS_H */
@@ -62,6 +62,9 @@ typedef struct _oe_file_ops
         *pwrite)(oe_fd_t* desc, const void* buf, size_t count, oe_off_t offset);
 
     int (*getdents64)(oe_fd_t* file, struct oe_dirent* dirp, uint32_t count);
+
+    /* Optional: null if the file cannot be synchronized. */
+    int (*fsync)(oe_fd_t* file);
 } oe_file_ops_t;
 
 /* Socket operations .*/
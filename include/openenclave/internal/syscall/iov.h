@@ -23,6 +23,28 @@ int oe_iov_sync(
     const void* buf_,
     size_t buf_size);
 
+/* Lay out the IO vector in host memory in the format of oe_iov_pack(), so
+ * that the host can pass it to readv() or writev() without another copy. The
+ * data is copied only if copy_data is true. The buffer may be reused by the
+ * next call on the same thread and is released by oe_iov_free_host(). */
+int oe_iov_pack_host(
+    const struct oe_iovec* iov,
+    int iovcnt,
+    bool copy_data,
+    void** buf_out,
+    size_t* buf_size_out);
+
+/* Copy the first count bytes of the data of a buffer created by
+ * oe_iov_pack_host() into the IO vector. */
+int oe_iov_unpack_host(
+    const struct oe_iovec* iov,
+    int iovcnt,
+    const void* buf,
+    size_t buf_size,
+    size_t count);
+
+void oe_iov_free_host(void* buf);
+
 OE_EXTERNC_END
 
 #endif // _OE_SYSCALL_IOV_H
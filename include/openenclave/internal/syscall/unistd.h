@@ -82,6 +82,8 @@ int oe_nanosleep(struct oe_timespec* req, struct oe_timespec* rem);
 
 int oe_flock(int fd, int operation);
 
+int oe_fsync(int fd);
+
 int oe_dup(int fd);
 
 int oe_dup2(int fd, int newfd);
@@ -40,7 +40,20 @@ extern void* oe_log_context;
 extern oe_log_callback_t oe_log_callback;
 
 oe_result_t oe_log_enclave_init(oe_enclave_t* enclave);
+
+/* Whether debug enclaves post their log messages to a ring drained by a host
+ * thread: the log level is INFO or VERBOSE, or OE_LOG_RING is set. At lower
+ * levels, enclaves log too rarely to pay for the thread. */
+bool oe_log_ring_is_enabled(void);
 void oe_log_message(bool is_enclave, oe_log_level_t level, const char* message);
+
+/* Same as oe_log_message() for a message logged at the given time, in
+ * microseconds since the epoch. */
+void oe_log_message_at(
+    bool is_enclave,
+    oe_log_level_t level,
+    const char* message,
+    uint64_t timestamp);
 #endif
 
 oe_result_t oe_log(oe_log_level_t level, const char* fmt, ...);
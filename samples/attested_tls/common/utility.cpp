@@ -5,6 +5,14 @@
 #include <openenclave/attestation/sgx/report.h>
 #include <stdio.h>
 
+// How long the attestation certificate of the enclave is reused for
+#define CERTIFICATE_LIFETIME_IN_SECONDS 3600
+
+// The TLS connections of the enclave share its attestation certificate until
+// it is CERTIFICATE_LIFETIME_IN_SECONDS old, so that they do not each get a
+// quote
+static oe_attestation_certificate_manager_t* certificate_manager;
+
 // input: input_data and input_data_len
 // output: key, key_size
 oe_result_t generate_key_pair(
@@ -89,14 +97,25 @@ oe_result_t generate_certificate_and_pkey(
     printf("public key used:\n[%s]", public_key_buf);
 
     // both ec key such ASYMMETRIC_KEY_EC_SECP256P1 or RSA key work
-    result = oe_generate_attestation_certificate(
-        (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
-        private_key_buf,
-        private_key_buf_size,
-        public_key_buf,
-        public_key_buf_size,
-        &output_cert,
-        &output_cert_size);
+    if (!certificate_manager)
+    {
+        result = oe_create_attestation_certificate_manager(
+            (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US",
+            private_key_buf,
+            private_key_buf_size,
+            public_key_buf,
+            public_key_buf_size,
+            CERTIFICATE_LIFETIME_IN_SECONDS,
+            &certificate_manager);
+        if (result != OE_OK)
+        {
+            printf(" failed with %s\n", oe_result_str(result));
+            goto exit;
+        }
+    }
+
+    result = oe_get_managed_attestation_certificate(
+        certificate_manager, &output_cert, &output_cert_size);
     if (result != OE_OK)
     {
         printf(" failed with %s\n", oe_result_str(result));
@@ -11,6 +11,7 @@
 #include <mbedtls/rsa.h>
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/x509.h>
 #include <openenclave/enclave.h>
 #include <stdlib.h>
@@ -35,6 +36,9 @@ int cert_verify_callback(
 
 #define SERVER_IP "0.0.0.0"
 
+// How long clients may resume their sessions with a session ticket
+#define TICKET_LIFETIME_IN_SECONDS 86400
+
 #define HTTP_RESPONSE                                    \
     "HTTP/1.0 200 OK\r\nContent-Type: text/html\r\n\r\n" \
     "<h2>mbed TLS Test Server</h2>\r\n"                  \
@@ -58,6 +62,7 @@ int configure_server_ssl(
     mbedtls_ssl_context* ssl,
     mbedtls_ssl_config* conf,
     mbedtls_ssl_cache_context* cache,
+    mbedtls_ssl_ticket_context* ticket,
     mbedtls_ctr_drbg_context* ctr_drbg,
     mbedtls_x509_crt* server_cert,
     mbedtls_pk_context* pkey)
@@ -92,6 +97,23 @@ int configure_server_ssl(
     mbedtls_ssl_conf_session_cache(
         conf, cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
 
+    // Session tickets let clients resume their sessions without a full
+    // handshake, which would verify the attestation certificates again
+    if ((ret = mbedtls_ssl_ticket_setup(
+             ticket,
+             mbedtls_ctr_drbg_random,
+             ctr_drbg,
+             MBEDTLS_CIPHER_AES_256_GCM,
+             TICKET_LIFETIME_IN_SECONDS)) != 0)
+    {
+        printf(
+            TLS_SERVER "failed\n  ! mbedtls_ssl_ticket_setup returned %d\n",
+            ret);
+        goto exit;
+    }
+    mbedtls_ssl_conf_session_tickets_cb(
+        conf, mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse, ticket);
+
     // need to set authmode mode to OPTIONAL for requesting client certificate
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
     mbedtls_ssl_conf_verify(conf, cert_verify_callback, NULL);
@@ -287,6 +309,7 @@ int setup_tls_server(char* server_port)
     mbedtls_x509_crt server_cert;
     mbedtls_pk_context pkey;
     mbedtls_ssl_cache_context cache;
+    mbedtls_ssl_ticket_context ticket;
     mbedtls_net_context listen_fd, client_fd;
     const char* pers = "tls_server";
 
@@ -312,6 +335,7 @@ int setup_tls_server(char* server_port)
     mbedtls_ssl_init(&ssl);
     mbedtls_ssl_config_init(&conf);
     mbedtls_ssl_cache_init(&cache);
+    mbedtls_ssl_ticket_init(&ticket);
     mbedtls_x509_crt_init(&server_cert);
     mbedtls_pk_init(&pkey);
     mbedtls_entropy_init(&entropy);
@@ -348,7 +372,7 @@ int setup_tls_server(char* server_port)
 
     // Configure server SSL settings
     ret = configure_server_ssl(
-        &ssl, &conf, &cache, &ctr_drbg, &server_cert, &pkey);
+        &ssl, &conf, &cache, &ticket, &ctr_drbg, &server_cert, &pkey);
     if (ret != 0)
     {
         printf(TLS_SERVER "failed\n  ! mbedtls_net_connect returned %d\n", ret);
@@ -380,6 +404,7 @@ exit:
     mbedtls_ssl_free(&ssl);
     mbedtls_ssl_config_free(&conf);
     mbedtls_ssl_cache_free(&cache);
+    mbedtls_ssl_ticket_free(&ticket);
     mbedtls_ctr_drbg_free(&ctr_drbg);
     mbedtls_entropy_free(&entropy);
     fflush(stdout);
@@ -0,0 +1,1338 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/safemath.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/thread.h>
+
+#include "cache.h"
+#include "syscall_t.h"
+
+#define PAGE_SIZE OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE
+
+/* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
+#define ACCESS_MODE_MASK 000000003
+
+typedef struct _hostfs_inode hostfs_inode_t;
+
+static size_t _min(size_t x, size_t y)
+{
+    return x < y ? x : y;
+}
+
+typedef struct _page
+{
+    /* Least recently used list: the head is the most recently used page. */
+    struct _page* lru_prev;
+    struct _page* lru_next;
+
+    /* Hash bucket chain, or free list if the page is not in use. */
+    struct _page* hash_next;
+
+    /* Dirty pages of the inode. */
+    struct _page* dirty_prev;
+    struct _page* dirty_next;
+
+    /* The file and the index of this page in the file. */
+    hostfs_inode_t* inode;
+    uint64_t index;
+
+    bool dirty;
+
+    /* Set while a thread transfers the page from or to the host without
+     * holding the lock of the cache. A busy page is not evicted, and other
+     * threads wait for the transfer to complete before using it. */
+    bool busy;
+
+    uint8_t* data;
+} page_t;
+
+/* A host file that has cached pages. */
+struct _hostfs_inode
+{
+    hostfs_inode_t* next;
+
+    /* Number of cached files open on this inode. */
+    size_t refs;
+
+    uint64_t dev;
+    uint64_t ino;
+
+    /* The size of the file including the writes not yet written back. */
+    oe_off_t size;
+
+    /* A writable host file descriptor used to write back the dirty pages,
+     * or -1 if there are no dirty pages. */
+    oe_host_fd_t write_fd;
+
+    page_t* dirty_head;
+
+    /* The page index a sequential read would access next and the number of
+     * pages to read ahead on the next miss of a sequential read. */
+    uint64_t next_index;
+    size_t read_ahead;
+
+    /* Number of transfers of pages of the inode in progress. */
+    size_t io_count;
+};
+
+struct _hostfs_cache
+{
+    oe_mutex_t lock;
+
+    /* Signaled when a transfer completes or a page is freed. */
+    oe_cond_t io_done;
+
+    /* Number of references from the mount and from the cached files. */
+    size_t refs;
+
+    page_t* pages;
+    size_t page_count;
+    uint8_t* data;
+    page_t* free_pages;
+
+    page_t** buckets;
+    size_t bucket_mask;
+
+    /* Sentinel of the least recently used list. */
+    page_t lru;
+
+    hostfs_inode_t* inodes;
+
+    /* Buffer for reading ahead and writing back runs of pages. */
+    uint8_t* io_buf;
+    size_t io_buf_pages;
+    bool io_buf_busy;
+    size_t max_read_ahead;
+
+    oe_host_file_system_cache_statistics_t statistics;
+};
+
+struct _hostfs_cached_file
+{
+    hostfs_cache_t* cache;
+
+    /* Number of descriptors sharing this file. */
+    size_t refs;
+
+    hostfs_inode_t* inode;
+    oe_host_fd_t host_fd;
+
+    /* The access mode and O_APPEND flag requested by open(). */
+    int flags;
+
+    oe_off_t offset;
+};
+
+/*
+**==============================================================================
+**
+** Pages:
+**
+**==============================================================================
+*/
+
+static size_t _hash(const hostfs_inode_t* inode, uint64_t index)
+{
+    uint64_t h = ((uint64_t)(uintptr_t)inode >> 4) ^ index;
+
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (size_t)(h >> 32);
+}
+
+static page_t* _lookup(
+    hostfs_cache_t* cache,
+    const hostfs_inode_t* inode,
+    uint64_t index)
+{
+    page_t* page = cache->buckets[_hash(inode, index) & cache->bucket_mask];
+
+    while (page && !(page->inode == inode && page->index == index))
+        page = page->hash_next;
+
+    return page;
+}
+
+static void _hash_insert(hostfs_cache_t* cache, page_t* page)
+{
+    page_t** bucket =
+        &cache->buckets[_hash(page->inode, page->index) & cache->bucket_mask];
+
+    page->hash_next = *bucket;
+    *bucket = page;
+}
+
+static void _hash_remove(hostfs_cache_t* cache, page_t* page)
+{
+    page_t** p =
+        &cache->buckets[_hash(page->inode, page->index) & cache->bucket_mask];
+
+    while (*p != page)
+        p = &(*p)->hash_next;
+
+    *p = page->hash_next;
+    page->hash_next = NULL;
+}
+
+static void _lru_remove(page_t* page)
+{
+    page->lru_prev->lru_next = page->lru_next;
+    page->lru_next->lru_prev = page->lru_prev;
+    page->lru_prev = page->lru_next = NULL;
+}
+
+static void _lru_push_front(hostfs_cache_t* cache, page_t* page)
+{
+    page->lru_prev = &cache->lru;
+    page->lru_next = cache->lru.lru_next;
+    cache->lru.lru_next->lru_prev = page;
+    cache->lru.lru_next = page;
+}
+
+static void _touch(hostfs_cache_t* cache, page_t* page)
+{
+    _lru_remove(page);
+    _lru_push_front(cache, page);
+}
+
+static void _set_dirty(page_t* page, oe_host_fd_t host_fd)
+{
+    hostfs_inode_t* inode = page->inode;
+
+    if (page->dirty)
+        return;
+
+    page->dirty = true;
+    page->dirty_prev = NULL;
+    page->dirty_next = inode->dirty_head;
+
+    if (inode->dirty_head)
+        inode->dirty_head->dirty_prev = page;
+
+    inode->dirty_head = page;
+
+    if (inode->write_fd == -1)
+        inode->write_fd = host_fd;
+}
+
+static void _clear_dirty(page_t* page)
+{
+    hostfs_inode_t* inode = page->inode;
+
+    if (!page->dirty)
+        return;
+
+    if (page->dirty_prev)
+        page->dirty_prev->dirty_next = page->dirty_next;
+    else
+        inode->dirty_head = page->dirty_next;
+
+    if (page->dirty_next)
+        page->dirty_next->dirty_prev = page->dirty_prev;
+
+    page->dirty = false;
+    page->dirty_prev = page->dirty_next = NULL;
+
+    if (!inode->dirty_head)
+        inode->write_fd = -1;
+}
+
+/* Return a page that is no longer cached to the free list. */
+static void _free_page(hostfs_cache_t* cache, page_t* page)
+{
+    _clear_dirty(page);
+    _hash_remove(cache, page);
+    _lru_remove(page);
+    page->inode = NULL;
+    page->hash_next = cache->free_pages;
+    cache->free_pages = page;
+    oe_cond_broadcast(&cache->io_done);
+}
+
+/* Return a page taken by _alloc_page() but not cached to the free list. */
+static void _release_page(hostfs_cache_t* cache, page_t* page)
+{
+    page->inode = NULL;
+    page->hash_next = cache->free_pages;
+    cache->free_pages = page;
+    oe_cond_broadcast(&cache->io_done);
+}
+
+/* Look up the page at index, waiting until no other thread transfers it. */
+static page_t* _lookup_ready(
+    hostfs_cache_t* cache,
+    const hostfs_inode_t* inode,
+    uint64_t index)
+{
+    page_t* page;
+
+    while ((page = _lookup(cache, inode, index)) && page->busy)
+        oe_cond_wait(&cache->io_done, &cache->lock);
+
+    return page;
+}
+
+/* Wait until no thread transfers pages of inode. */
+static void _wait_for_io(hostfs_cache_t* cache, hostfs_inode_t* inode)
+{
+    while (inode->io_count)
+        oe_cond_wait(&cache->io_done, &cache->lock);
+}
+
+/* The buffer of the cache is used by one transfer at a time, and the others
+ * allocate their own. */
+static uint8_t* _acquire_io_buf(hostfs_cache_t* cache)
+{
+    if (!cache->io_buf_busy)
+    {
+        cache->io_buf_busy = true;
+        return cache->io_buf;
+    }
+
+    return oe_malloc(cache->io_buf_pages * PAGE_SIZE);
+}
+
+static void _release_io_buf(hostfs_cache_t* cache, uint8_t* buf)
+{
+    if (buf == cache->io_buf)
+        cache->io_buf_busy = false;
+    else
+        oe_free(buf);
+}
+
+/* Write size bytes of buf at offset in the host file. */
+static int _write_host(
+    oe_host_fd_t host_fd,
+    const uint8_t* buf,
+    size_t size,
+    oe_off_t offset)
+{
+    int ret = -1;
+    size_t written = 0;
+
+    while (written < size)
+    {
+        ssize_t retval = -1;
+
+        if (oe_syscall_pwrite_ocall(
+                &retval,
+                host_fd,
+                buf + written,
+                size - written,
+                offset + (oe_off_t)written) != OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval == -1)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (retval == 0 || (size_t)retval > size - written)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        written += (size_t)retval;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Read up to size bytes at offset in the host file into buf, stopping at the
+ * end of the file. Returns the number of bytes read. */
+static ssize_t _read_host(
+    oe_host_fd_t host_fd,
+    uint8_t* buf,
+    size_t size,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    while (total < size)
+    {
+        ssize_t retval = -1;
+
+        if (oe_syscall_pread_ocall(
+                &retval,
+                host_fd,
+                buf + total,
+                size - total,
+                offset + (oe_off_t)total) != OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval == -1)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if ((size_t)retval > size - total)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        if (retval == 0)
+            break;
+
+        total += (size_t)retval;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+/* Write back the run of consecutive dirty pages that contains page, with a
+ * single host call. The lock is released during the call, while the pages
+ * of the run are busy. */
+static int _write_back_run(hostfs_cache_t* cache, page_t* page)
+{
+    int ret = -1;
+    hostfs_inode_t* inode = page->inode;
+    const oe_host_fd_t host_fd = inode->write_fd;
+    uint64_t first = page->index;
+    size_t count = 1;
+    oe_off_t offset;
+    size_t size;
+    uint8_t* buf = NULL;
+    int retval;
+
+    /* Extend the run backward, then forward. */
+    while (count < cache->io_buf_pages && first > 0)
+    {
+        page_t* p = _lookup(cache, inode, first - 1);
+
+        if (!p || !p->dirty || p->busy)
+            break;
+
+        first--;
+        count++;
+    }
+
+    while (count < cache->io_buf_pages)
+    {
+        page_t* p = _lookup(cache, inode, first + count);
+
+        if (!p || !p->dirty || p->busy)
+            break;
+
+        count++;
+    }
+
+    /* Do not extend the file past its size with the tail of the last page. */
+    offset = (oe_off_t)(first * PAGE_SIZE);
+    size = count * PAGE_SIZE;
+
+    if (offset >= inode->size)
+        size = 0;
+    else if ((uint64_t)(inode->size - offset) < size)
+        size = (size_t)(inode->size - offset);
+
+    if (!(buf = _acquire_io_buf(cache)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        page_t* p = _lookup(cache, inode, first + i);
+        memcpy(buf + i * PAGE_SIZE, p->data, PAGE_SIZE);
+        p->busy = true;
+    }
+
+    inode->io_count++;
+    oe_mutex_unlock(&cache->lock);
+    retval = _write_host(host_fd, buf, size, offset);
+    oe_mutex_lock(&cache->lock);
+    inode->io_count--;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        page_t* p = _lookup(cache, inode, first + i);
+
+        p->busy = false;
+
+        if (retval == 0)
+            _clear_dirty(p);
+    }
+
+    _release_io_buf(cache, buf);
+    oe_cond_broadcast(&cache->io_done);
+
+    if (retval != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    cache->statistics.write_backs += count;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Write back all the dirty pages of inode, once the transfers of the other
+ * threads on it complete. */
+static int _flush(hostfs_cache_t* cache, hostfs_inode_t* inode)
+{
+    int ret = -1;
+
+    while (inode->io_count || inode->dirty_head)
+    {
+        if (inode->io_count)
+            _wait_for_io(cache, inode);
+        else if (_write_back_run(cache, inode->dirty_head) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Take a page from the free list or evict the least recently used page that
+ * is not busy. The page is not cached (not in the hash table nor in the least
+ * recently used list) until the caller sets its inode and index and inserts
+ * it. Writing back the evicted page releases the lock. If no page can be
+ * evicted, waits for one unless the caller holds pages already. */
+static page_t* _alloc_page(hostfs_cache_t* cache, bool wait)
+{
+    page_t* page;
+
+    while (!(page = cache->free_pages))
+    {
+        page_t* victim = cache->lru.lru_prev;
+
+        while (victim != &cache->lru && victim->busy)
+            victim = victim->lru_prev;
+
+        if (victim == &cache->lru)
+        {
+            if (!wait)
+            {
+                oe_errno = OE_ENOMEM;
+                return NULL;
+            }
+
+            oe_cond_wait(&cache->io_done, &cache->lock);
+        }
+        else if (victim->dirty)
+        {
+            if (_write_back_run(cache, victim) != 0)
+                return NULL;
+        }
+        else
+        {
+            _free_page(cache, victim);
+            cache->statistics.evictions++;
+        }
+    }
+
+    cache->free_pages = page->hash_next;
+    page->hash_next = NULL;
+    return page;
+}
+
+/* Read the page at index from the host, together with up to read_ahead
+ * following pages that are not cached yet, with a single host call. The pages
+ * are cached as busy and the lock is released during the call. Returns 0
+ * without reading if another thread cached the page at index meanwhile, so
+ * the caller looks it up again. */
+static int _read_pages(
+    hostfs_cache_t* cache,
+    hostfs_inode_t* inode,
+    oe_host_fd_t host_fd,
+    uint64_t index,
+    size_t read_ahead)
+{
+    int ret = -1;
+    const uint64_t end = ((uint64_t)inode->size + PAGE_SIZE - 1) / PAGE_SIZE;
+    size_t count = 0;
+    uint8_t* buf = NULL;
+    ssize_t size = -1;
+
+    inode->io_count++;
+
+    while (count <= read_ahead && (count == 0 || index + count < end))
+    {
+        page_t* page;
+
+        if (_lookup(cache, inode, index + count))
+            break;
+
+        /* Allocating can release the lock, so look up the page again. */
+        if (!(page = _alloc_page(cache, count == 0)))
+        {
+            if (count == 0)
+                OE_RAISE_ERRNO(oe_errno);
+
+            break;
+        }
+
+        if (_lookup(cache, inode, index + count))
+        {
+            _release_page(cache, page);
+            break;
+        }
+
+        page->inode = inode;
+        page->index = index + count;
+        page->dirty = false;
+        page->busy = true;
+        _hash_insert(cache, page);
+        count++;
+    }
+
+    if (count && (buf = _acquire_io_buf(cache)))
+    {
+        oe_mutex_unlock(&cache->lock);
+        size = _read_host(
+            host_fd, buf, count * PAGE_SIZE, (oe_off_t)(index * PAGE_SIZE));
+        oe_mutex_lock(&cache->lock);
+    }
+    else if (count)
+    {
+        oe_errno = OE_ENOMEM;
+    }
+
+    /* Bytes past the end of the host file read as zeros. */
+    if (size >= 0)
+        memset(buf + size, 0, count * PAGE_SIZE - (size_t)size);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        page_t* page = _lookup(cache, inode, index + i);
+
+        page->busy = false;
+
+        if (size >= 0)
+        {
+            memcpy(page->data, buf + i * PAGE_SIZE, PAGE_SIZE);
+            _lru_push_front(cache, page);
+        }
+        else
+        {
+            _hash_remove(cache, page);
+            _release_page(cache, page);
+        }
+    }
+
+    if (buf)
+        _release_io_buf(cache, buf);
+
+    if (count && size < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (count)
+    {
+        cache->statistics.misses++;
+        cache->statistics.read_ahead_pages += count - 1;
+    }
+
+    ret = 0;
+
+done:
+    inode->io_count--;
+    oe_cond_broadcast(&cache->io_done);
+    return ret;
+}
+
+/* Get the page at index for a read, reading ahead if the access is part of a
+ * sequential read. */
+static page_t* _get_page_for_read(
+    hostfs_cache_t* cache,
+    hostfs_cached_file_t* file,
+    uint64_t index)
+{
+    hostfs_inode_t* inode = file->inode;
+    page_t* page;
+    bool missed = false;
+
+    if (index == inode->next_index)
+    {
+        size_t read_ahead = inode->read_ahead ? inode->read_ahead * 2 : 1;
+        inode->read_ahead = _min(read_ahead, cache->max_read_ahead);
+    }
+    else
+    {
+        inode->read_ahead = 0;
+    }
+
+    inode->next_index = index + 1;
+
+    while (!(page = _lookup_ready(cache, inode, index)))
+    {
+        missed = true;
+
+        if (_read_pages(
+                cache, inode, file->host_fd, index, inode->read_ahead) != 0)
+            return NULL;
+    }
+
+    if (!missed)
+        cache->statistics.hits++;
+
+    _touch(cache, page);
+    return page;
+}
+
+/* Get the page at index for a write of size bytes at offset in the page. */
+static page_t* _get_page_for_write(
+    hostfs_cache_t* cache,
+    hostfs_cached_file_t* file,
+    uint64_t index,
+    size_t offset,
+    size_t size)
+{
+    hostfs_inode_t* inode = file->inode;
+    page_t* page;
+    bool missed = false;
+
+    while (!(page = _lookup_ready(cache, inode, index)))
+    {
+        missed = true;
+
+        /* Only read the page from the host if the write leaves some of its
+         * existing bytes unchanged. */
+        if (!(offset == 0 && size == PAGE_SIZE) &&
+            (oe_off_t)(index * PAGE_SIZE) < inode->size)
+        {
+            if (_read_pages(cache, inode, file->host_fd, index, 0) != 0)
+                return NULL;
+
+            continue;
+        }
+
+        if (!(page = _alloc_page(cache, true)))
+            return NULL;
+
+        /* Allocating can release the lock, so look up the page again. */
+        if (_lookup(cache, inode, index))
+        {
+            _release_page(cache, page);
+            continue;
+        }
+
+        memset(page->data, 0, PAGE_SIZE);
+        page->inode = inode;
+        page->index = index;
+        page->dirty = false;
+        _hash_insert(cache, page);
+        _lru_push_front(cache, page);
+
+        cache->statistics.misses++;
+        return page;
+    }
+
+    if (!missed)
+        cache->statistics.hits++;
+
+    _touch(cache, page);
+    return page;
+}
+
+/*
+**==============================================================================
+**
+** Inodes:
+**
+**==============================================================================
+*/
+
+static hostfs_inode_t* _find_inode(
+    hostfs_cache_t* cache,
+    uint64_t dev,
+    uint64_t ino)
+{
+    hostfs_inode_t* inode = cache->inodes;
+
+    while (inode && !(inode->dev == dev && inode->ino == ino))
+        inode = inode->next;
+
+    return inode;
+}
+
+/* Drop the cached pages at or past length and zero the tail of the page that
+ * contains length. */
+static void _truncate(
+    hostfs_cache_t* cache,
+    hostfs_inode_t* inode,
+    oe_off_t length)
+{
+    const uint64_t index = (uint64_t)length / PAGE_SIZE;
+    const size_t offset = (size_t)((uint64_t)length % PAGE_SIZE);
+
+    _wait_for_io(cache, inode);
+
+    for (size_t i = 0; i < cache->page_count; i++)
+    {
+        page_t* page = &cache->pages[i];
+
+        if (page->inode != inode)
+            continue;
+
+        if (page->index > index || (page->index == index && offset == 0))
+            _free_page(cache, page);
+        else if (page->index == index)
+            memset(page->data + offset, 0, PAGE_SIZE - offset);
+    }
+
+    inode->size = length;
+}
+
+static void _release_inode(hostfs_cache_t* cache, hostfs_inode_t* inode)
+{
+    hostfs_inode_t** p = &cache->inodes;
+
+    if (--inode->refs)
+        return;
+
+    for (size_t i = 0; i < cache->page_count; i++)
+    {
+        if (cache->pages[i].inode == inode)
+            _free_page(cache, &cache->pages[i]);
+    }
+
+    while (*p != inode)
+        p = &(*p)->next;
+
+    *p = inode->next;
+    oe_free(inode);
+}
+
+/*
+**==============================================================================
+**
+** Cache:
+**
+**==============================================================================
+*/
+
+hostfs_cache_t* hostfs_cache_new(size_t page_count, size_t read_ahead_pages)
+{
+    hostfs_cache_t* ret = NULL;
+    hostfs_cache_t* cache = NULL;
+    size_t num_buckets = 1;
+
+    if (page_count == 0 || page_count > OE_HOST_FILE_SYSTEM_MAX_CACHE_PAGES ||
+        read_ahead_pages > page_count / 2)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    while (num_buckets < page_count)
+        num_buckets <<= 1;
+
+    if (!(cache = oe_calloc(1, sizeof(hostfs_cache_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    oe_mutex_init(&cache->lock);
+    oe_cond_init(&cache->io_done);
+    cache->refs = 1;
+    cache->page_count = page_count;
+    cache->max_read_ahead = read_ahead_pages;
+    cache->io_buf_pages = read_ahead_pages + 1;
+    cache->bucket_mask = num_buckets - 1;
+    cache->lru.lru_prev = cache->lru.lru_next = &cache->lru;
+
+    if (!(cache->pages = oe_calloc(page_count, sizeof(page_t))) ||
+        !(cache->data = oe_calloc(page_count, PAGE_SIZE)) ||
+        !(cache->buckets = oe_calloc(num_buckets, sizeof(page_t*))) ||
+        !(cache->io_buf = oe_calloc(cache->io_buf_pages, PAGE_SIZE)))
+    {
+        OE_RAISE_ERRNO(OE_ENOMEM);
+    }
+
+    for (size_t i = page_count; i > 0; i--)
+    {
+        page_t* page = &cache->pages[i - 1];
+
+        page->data = cache->data + (i - 1) * PAGE_SIZE;
+        page->hash_next = cache->free_pages;
+        cache->free_pages = page;
+    }
+
+    ret = cache;
+    cache = NULL;
+
+done:
+
+    if (cache)
+    {
+        oe_free(cache->pages);
+        oe_free(cache->data);
+        oe_free(cache->buckets);
+        oe_free(cache->io_buf);
+        oe_free(cache);
+    }
+
+    return ret;
+}
+
+hostfs_cache_t* hostfs_cache_ref(hostfs_cache_t* cache)
+{
+    if (cache)
+    {
+        oe_mutex_lock(&cache->lock);
+        cache->refs++;
+        oe_mutex_unlock(&cache->lock);
+    }
+
+    return cache;
+}
+
+void hostfs_cache_unref(hostfs_cache_t* cache)
+{
+    size_t refs;
+
+    if (!cache)
+        return;
+
+    oe_mutex_lock(&cache->lock);
+    refs = --cache->refs;
+    oe_mutex_unlock(&cache->lock);
+
+    /* The cached files hold references, so there are no inodes left. */
+    if (refs == 0)
+    {
+        oe_mutex_destroy(&cache->lock);
+        oe_cond_destroy(&cache->io_done);
+        oe_free(cache->pages);
+        oe_free(cache->data);
+        oe_free(cache->buckets);
+        oe_free(cache->io_buf);
+        oe_free(cache);
+    }
+}
+
+void hostfs_cache_get_statistics(
+    hostfs_cache_t* cache,
+    oe_host_file_system_cache_statistics_t* statistics)
+{
+    oe_mutex_lock(&cache->lock);
+    *statistics = cache->statistics;
+    oe_mutex_unlock(&cache->lock);
+}
+
+bool hostfs_cache_get_size(
+    hostfs_cache_t* cache,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t* size)
+{
+    hostfs_inode_t* inode;
+
+    oe_mutex_lock(&cache->lock);
+
+    if ((inode = _find_inode(cache, dev, ino)))
+        *size = inode->size;
+
+    oe_mutex_unlock(&cache->lock);
+
+    return inode != NULL;
+}
+
+void hostfs_cache_truncate(
+    hostfs_cache_t* cache,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t length)
+{
+    hostfs_inode_t* inode;
+
+    oe_mutex_lock(&cache->lock);
+
+    if ((inode = _find_inode(cache, dev, ino)))
+        _truncate(cache, inode, length);
+
+    oe_mutex_unlock(&cache->lock);
+}
+
+/*
+**==============================================================================
+**
+** Cached files:
+**
+**==============================================================================
+*/
+
+hostfs_cached_file_t* hostfs_cache_open(
+    hostfs_cache_t* cache,
+    oe_host_fd_t host_fd,
+    int flags,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t size)
+{
+    hostfs_cached_file_t* ret = NULL;
+    hostfs_cached_file_t* file = NULL;
+    hostfs_inode_t* inode = NULL;
+    bool locked = false;
+
+    if (!(file = oe_calloc(1, sizeof(hostfs_cached_file_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    oe_mutex_lock(&cache->lock);
+    locked = true;
+
+    if ((inode = _find_inode(cache, dev, ino)))
+    {
+        /* The enclave's view of the file is newer than the host's, unless
+         * the host truncated the file when it was opened. */
+        if ((flags & OE_O_TRUNC))
+            _truncate(cache, inode, size);
+    }
+    else
+    {
+        if (!(inode = oe_calloc(1, sizeof(hostfs_inode_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        inode->dev = dev;
+        inode->ino = ino;
+        inode->size = size;
+        inode->write_fd = -1;
+        inode->next = cache->inodes;
+        cache->inodes = inode;
+    }
+
+    inode->refs++;
+    cache->refs++;
+
+    file->cache = cache;
+    file->refs = 1;
+    file->inode = inode;
+    file->host_fd = host_fd;
+    file->flags = flags & (ACCESS_MODE_MASK | OE_O_APPEND);
+
+    ret = file;
+    file = NULL;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&cache->lock);
+
+    if (file)
+        oe_free(file);
+
+    return ret;
+}
+
+hostfs_cached_file_t* hostfs_cached_file_ref(hostfs_cached_file_t* file)
+{
+    oe_mutex_lock(&file->cache->lock);
+    file->refs++;
+    oe_mutex_unlock(&file->cache->lock);
+
+    return file;
+}
+
+int hostfs_cached_file_unref(hostfs_cached_file_t* file)
+{
+    int ret = 0;
+    hostfs_cache_t* cache = file->cache;
+    hostfs_inode_t* inode = file->inode;
+    int retval = -1;
+
+    oe_mutex_lock(&cache->lock);
+
+    if (--file->refs)
+    {
+        oe_mutex_unlock(&cache->lock);
+        return 0;
+    }
+
+    /* Write back the dirty pages while their host descriptor is open. If
+     * that fails, the writes are lost as they would be by the host. */
+    if (inode->write_fd == file->host_fd && _flush(cache, inode) != 0)
+    {
+        ret = -1;
+
+        while (inode->dirty_head)
+            _clear_dirty(inode->dirty_head);
+    }
+
+    /* Other threads may still be writing back pages of the inode to evict
+     * them. */
+    _wait_for_io(cache, inode);
+    _release_inode(cache, inode);
+    oe_mutex_unlock(&cache->lock);
+
+    if (oe_syscall_close_ocall(&retval, file->host_fd) != OE_OK)
+    {
+        oe_errno = OE_EINVAL;
+        ret = -1;
+    }
+    else if (retval == -1)
+    {
+        ret = -1;
+    }
+
+    hostfs_cache_unref(cache);
+    oe_free(file);
+
+    return ret;
+}
+
+oe_host_fd_t hostfs_cached_file_get_host_fd(hostfs_cached_file_t* file)
+{
+    return file->host_fd;
+}
+
+static ssize_t _pread(
+    hostfs_cached_file_t* file,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    hostfs_cache_t* cache = file->cache;
+    hostfs_inode_t* inode = file->inode;
+    size_t total = 0;
+
+    if ((file->flags & ACCESS_MODE_MASK) == OE_O_WRONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (offset < 0 || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (offset >= inode->size)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    if ((uint64_t)(inode->size - offset) < count)
+        count = (size_t)(inode->size - offset);
+
+    while (total < count)
+    {
+        const uint64_t position = (uint64_t)offset + total;
+        const size_t page_offset = (size_t)(position % PAGE_SIZE);
+        const size_t n = _min(count - total, PAGE_SIZE - page_offset);
+        page_t* page;
+
+        if (!(page = _get_page_for_read(cache, file, position / PAGE_SIZE)))
+        {
+            /* Report the bytes already read as a short read. */
+            if (total)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        memcpy((uint8_t*)buf + total, page->data + page_offset, n);
+        total += n;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+static ssize_t _pwrite(
+    hostfs_cached_file_t* file,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    hostfs_cache_t* cache = file->cache;
+    hostfs_inode_t* inode = file->inode;
+    size_t total = 0;
+    uint64_t end;
+
+    if ((file->flags & ACCESS_MODE_MASK) == OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (offset < 0 || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_safe_add_u64((uint64_t)offset, count, &end) != OE_OK ||
+        end > OE_INT64_MAX)
+        OE_RAISE_ERRNO(OE_EFBIG);
+
+    while (total < count)
+    {
+        const uint64_t position = (uint64_t)offset + total;
+        const size_t page_offset = (size_t)(position % PAGE_SIZE);
+        const size_t n = _min(count - total, PAGE_SIZE - page_offset);
+        page_t* page;
+
+        if (!(page = _get_page_for_write(
+                  cache, file, position / PAGE_SIZE, page_offset, n)))
+        {
+            /* Report the bytes already written as a short write. */
+            if (total)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        memcpy(page->data + page_offset, (const uint8_t*)buf + total, n);
+        _set_dirty(page, file->host_fd);
+        total += n;
+
+        if ((oe_off_t)(position + n) > inode->size)
+            inode->size = (oe_off_t)(position + n);
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+ssize_t hostfs_cached_file_read(
+    hostfs_cached_file_t* file,
+    void* buf,
+    size_t count)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&file->cache->lock);
+
+    if ((ret = _pread(file, buf, count, file->offset)) > 0)
+        file->offset += ret;
+
+    oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+ssize_t hostfs_cached_file_write(
+    hostfs_cached_file_t* file,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&file->cache->lock);
+
+    if ((file->flags & OE_O_APPEND))
+        file->offset = file->inode->size;
+
+    if ((ret = _pwrite(file, buf, count, file->offset)) > 0)
+        file->offset += ret;
+
+    oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+ssize_t hostfs_cached_file_pread(
+    hostfs_cached_file_t* file,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = _pread(file, buf, count, offset);
+    oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+ssize_t hostfs_cached_file_pwrite(
+    hostfs_cached_file_t* file,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = _pwrite(file, buf, count, offset);
+    oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+oe_off_t hostfs_cached_file_lseek(
+    hostfs_cached_file_t* file,
+    oe_off_t offset,
+    int whence)
+{
+    oe_off_t ret = -1;
+    oe_off_t base;
+    int64_t position;
+
+    oe_mutex_lock(&file->cache->lock);
+
+    switch (whence)
+    {
+        case OE_SEEK_SET:
+            base = 0;
+            break;
+        case OE_SEEK_CUR:
+            base = file->offset;
+            break;
+        case OE_SEEK_END:
+            base = file->inode->size;
+            break;
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (oe_safe_add_s64(base, offset, &position) != OE_OK)
+        OE_RAISE_ERRNO(OE_EOVERFLOW);
+
+    if (position < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    file->offset = position;
+    ret = position;
+
+done:
+    oe_mutex_unlock(&file->cache->lock);
+    return ret;
+}
+
+int hostfs_cached_file_fsync(hostfs_cached_file_t* file)
+{
+    int ret = -1;
+    int retval = -1;
+
+    oe_mutex_lock(&file->cache->lock);
+    retval = _flush(file->cache, file->inode);
+    oe_mutex_unlock(&file->cache->lock);
+
+    if (retval != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (oe_syscall_fsync_ocall(&retval, file->host_fd) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+bool hostfs_cached_file_get_append(hostfs_cached_file_t* file)
+{
+    return (file->flags & OE_O_APPEND) != 0;
+}
+
+void hostfs_cached_file_set_append(hostfs_cached_file_t* file, bool append)
+{
+    oe_mutex_lock(&file->cache->lock);
+
+    if (append)
+        file->flags |= OE_O_APPEND;
+    else
+        file->flags &= ~OE_O_APPEND;
+
+    oe_mutex_unlock(&file->cache->lock);
+}
+
+int hostfs_cached_file_get_access_mode(hostfs_cached_file_t* file)
+{
+    return file->flags & ACCESS_MODE_MASK;
+}
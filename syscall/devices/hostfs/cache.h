@@ -0,0 +1,119 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+#define _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/fs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** The page cache of a hostfs mount:
+**
+**     Regular files opened on a mount with a page cache are represented by a
+**     cached file, which plays the role of the open file description: it owns
+**     the host file descriptor and the file offset, and is shared by the
+**     descriptors returned by dup(). The cached files of the same host file
+**     share the pages of the file, so that they see each other's writes
+**     before they are written back to the host.
+**
+**     Cached files always access the host file with pread() and pwrite(), so
+**     the host file offset is never used.
+**
+**==============================================================================
+*/
+
+typedef struct _hostfs_cache hostfs_cache_t;
+
+typedef struct _hostfs_cached_file hostfs_cached_file_t;
+
+/* Create a cache of page_count pages. */
+hostfs_cache_t* hostfs_cache_new(size_t page_count, size_t read_ahead_pages);
+
+hostfs_cache_t* hostfs_cache_ref(hostfs_cache_t* cache);
+
+void hostfs_cache_unref(hostfs_cache_t* cache);
+
+void hostfs_cache_get_statistics(
+    hostfs_cache_t* cache,
+    oe_host_file_system_cache_statistics_t* statistics);
+
+/* Get the size of the file as seen by the enclave if it is cached. */
+bool hostfs_cache_get_size(
+    hostfs_cache_t* cache,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t* size);
+
+/* Update the cached pages of a file that was truncated on the host. */
+void hostfs_cache_truncate(
+    hostfs_cache_t* cache,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t length);
+
+/* Take ownership of host_fd, which must be open for reading. flags are the
+ * access mode and O_APPEND flag requested by the caller of open(). */
+hostfs_cached_file_t* hostfs_cache_open(
+    hostfs_cache_t* cache,
+    oe_host_fd_t host_fd,
+    int flags,
+    uint64_t dev,
+    uint64_t ino,
+    oe_off_t size);
+
+hostfs_cached_file_t* hostfs_cached_file_ref(hostfs_cached_file_t* file);
+
+/* Drop a reference. The last one writes the dirty pages back and closes the
+ * host file descriptor. Returns -1 if either fails. */
+int hostfs_cached_file_unref(hostfs_cached_file_t* file);
+
+oe_host_fd_t hostfs_cached_file_get_host_fd(hostfs_cached_file_t* file);
+
+ssize_t hostfs_cached_file_read(
+    hostfs_cached_file_t* file,
+    void* buf,
+    size_t count);
+
+ssize_t hostfs_cached_file_write(
+    hostfs_cached_file_t* file,
+    const void* buf,
+    size_t count);
+
+ssize_t hostfs_cached_file_pread(
+    hostfs_cached_file_t* file,
+    void* buf,
+    size_t count,
+    oe_off_t offset);
+
+ssize_t hostfs_cached_file_pwrite(
+    hostfs_cached_file_t* file,
+    const void* buf,
+    size_t count,
+    oe_off_t offset);
+
+oe_off_t hostfs_cached_file_lseek(
+    hostfs_cached_file_t* file,
+    oe_off_t offset,
+    int whence);
+
+/* Write the dirty pages back and synchronize the host file. */
+int hostfs_cached_file_fsync(hostfs_cached_file_t* file);
+
+/* Get or set the O_APPEND flag of the file. */
+bool hostfs_cached_file_get_append(hostfs_cached_file_t* file);
+
+void hostfs_cached_file_set_append(hostfs_cached_file_t* file, bool append);
+
+/* Get the access mode (O_RDONLY, O_WRONLY or O_RDWR) requested by open(). */
+int hostfs_cached_file_get_access_mode(hostfs_cached_file_t* file);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H */
@@ -32,10 +32,14 @@
 #include <openenclave/internal/syscall/sys/ioctl.h>
 #include <openenclave/internal/syscall/raise.h>
 #include <openenclave/internal/syscall/iov.h>
+#include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/safemath.h>
 
+#include "../../mount.h"
+#include "cache.h"
 #include "syscall_t.h"
 
 #define FS_MAGIC 0x5f35f964
@@ -45,6 +49,26 @@
 /* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
 #define ACCESS_MODE_MASK 000000003
 
+/* Pool of host buffers registered with a mount (see
+ * oe_host_file_system_mount_data_t). The pool is shared by the mount and by
+ * the files opened on it, so that it outlives an umount() that happens while
+ * files are still open. */
+typedef struct _io_pool
+{
+    oe_spinlock_t lock;
+
+    /* Number of references from the mount and its open files. */
+    size_t refs;
+
+    /* The buffers: one contiguous block of host memory. */
+    uint8_t* buffers;
+    size_t buffer_size;
+
+    /* Stack of the indices of the free buffers. */
+    size_t free[OE_HOST_FILE_SYSTEM_MAX_IO_BUFFERS];
+    size_t num_free;
+} io_pool_t;
+
 /* The host file system device. */
 typedef struct _device
 {
@@ -56,6 +80,12 @@ typedef struct _device
     /* True if this file system has been mounted. */
     bool is_mounted;
 
+    /* The I/O buffers registered by mount() or null. */
+    io_pool_t* io_pool;
+
+    /* The page cache created by mount() or null. */
+    hostfs_cache_t* cache;
+
     /* The parameters that were passed to the mount() function. */
     struct
     {
@@ -78,6 +108,13 @@ typedef struct _file
 
     /* The file descriptor for an open directory if non-null. */
     oe_fd_t* dir;
+
+    /* The I/O buffers of the mount this file was opened on or null. */
+    io_pool_t* io_pool;
+
+    /* The cached file shared with the duplicates of this file, or null if
+     * the file is not cached. host_fd is the cached file's descriptor. */
+    hostfs_cached_file_t* cached;
 } file_t;
 
 /* Created by opendir(), updated by readdir(), closed by closedir(). */
@@ -155,6 +192,104 @@ done:
     return ret;
 }
 
+static io_pool_t* _io_pool_new(const oe_host_file_system_mount_data_t* data)
+{
+    io_pool_t* ret = NULL;
+    io_pool_t* pool = NULL;
+    size_t size;
+
+    if (data->io_buffer_count == 0 ||
+        data->io_buffer_count > OE_HOST_FILE_SYSTEM_MAX_IO_BUFFERS ||
+        data->io_buffer_size == 0)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (oe_safe_mul_sizet(data->io_buffer_count, data->io_buffer_size, &size) !=
+        OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(pool = oe_calloc(1, sizeof(io_pool_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (!(pool->buffers = oe_host_malloc(size)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    pool->lock = OE_SPINLOCK_INITIALIZER;
+    pool->refs = 1;
+    pool->buffer_size = data->io_buffer_size;
+
+    for (size_t i = 0; i < data->io_buffer_count; i++)
+        pool->free[pool->num_free++] = i;
+
+    ret = pool;
+    pool = NULL;
+
+done:
+
+    if (pool)
+        oe_free(pool);
+
+    return ret;
+}
+
+static io_pool_t* _io_pool_ref(io_pool_t* pool)
+{
+    if (pool)
+    {
+        oe_spin_lock(&pool->lock);
+        pool->refs++;
+        oe_spin_unlock(&pool->lock);
+    }
+
+    return pool;
+}
+
+static void _io_pool_unref(io_pool_t* pool)
+{
+    size_t refs;
+
+    if (!pool)
+        return;
+
+    oe_spin_lock(&pool->lock);
+    refs = --pool->refs;
+    oe_spin_unlock(&pool->lock);
+
+    if (refs == 0)
+    {
+        oe_host_free(pool->buffers);
+        oe_free(pool);
+    }
+}
+
+/* Take a buffer from the pool or return null if they are all in use. */
+static uint8_t* _io_pool_acquire(io_pool_t* pool)
+{
+    uint8_t* buffer = NULL;
+
+    oe_spin_lock(&pool->lock);
+
+    if (pool->num_free)
+    {
+        size_t index = pool->free[--pool->num_free];
+        buffer = pool->buffers + index * pool->buffer_size;
+    }
+
+    oe_spin_unlock(&pool->lock);
+
+    return buffer;
+}
+
+static void _io_pool_release(io_pool_t* pool, uint8_t* buffer)
+{
+    size_t index = (size_t)(buffer - pool->buffers) / pool->buffer_size;
+
+    oe_spin_lock(&pool->lock);
+    pool->free[pool->num_free++] = index;
+    oe_spin_unlock(&pool->lock);
+}
+
 /* Expand an enclave path to a host path. */
 static int _make_host_path(
     const device_t* fs,
@@ -214,10 +349,6 @@ static int _hostfs_mount(
     if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_HOST_FILE_SYSTEM) != 0)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* The data parameter is not supported for host file systems. */
-    if (data)
-        OE_RAISE_ERRNO(OE_EINVAL);
-
     /* Remember whether this is a read-only mount. */
     if ((flags & OE_MS_RDONLY))
         fs->mount.flags = flags;
@@ -237,6 +368,30 @@ static int _hostfs_mount(
     /* Save the target parameter (checked by the umount2() function). */
     oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
 
+    /* The data parameter optionally registers a pool of I/O buffers and
+     * creates a page cache. */
+    if (data)
+    {
+        const oe_host_file_system_mount_data_t* mount_data = data;
+
+        if ((mount_data->io_buffer_count || mount_data->io_buffer_size) &&
+            !(fs->io_pool = _io_pool_new(mount_data)))
+        {
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        if ((mount_data->cache_page_count ||
+             mount_data->cache_read_ahead_pages) &&
+            !(fs->cache = hostfs_cache_new(
+                  mount_data->cache_page_count,
+                  mount_data->cache_read_ahead_pages)))
+        {
+            _io_pool_unref(fs->io_pool);
+            fs->io_pool = NULL;
+            OE_RAISE_ERRNO(oe_errno);
+        }
+    }
+
     /* Set the flag indicating that this file system is mounted. */
     fs->is_mounted = true;
 
@@ -269,6 +424,13 @@ static int _hostfs_umount2(oe_device_t* device, const char* target, int flags)
     /* Clear the cached mount parameters. */
     oe_memset_s(&fs->mount, sizeof(fs->mount), 0, sizeof(fs->mount));
 
+    /* Files that are still open keep their own reference to the pool and
+     * to the cache. */
+    _io_pool_unref(fs->io_pool);
+    fs->io_pool = NULL;
+    hostfs_cache_unref(fs->cache);
+    fs->cache = NULL;
+
     /* Set the flag indicating that this file system is mounted. */
     fs->is_mounted = false;
 
@@ -292,6 +454,8 @@ static int _hostfs_clone(oe_device_t* device, oe_device_t** new_device)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     *new_fs = *fs;
+    new_fs->io_pool = NULL;
+    new_fs->cache = NULL;
     *new_device = &new_fs->base;
 
     ret = 0;
@@ -309,6 +473,8 @@ static int _hostfs_release(oe_device_t* device)
     if (!fs)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    _io_pool_unref(fs->io_pool);
+    hostfs_cache_unref(fs->cache);
     oe_free(fs);
     ret = 0;
 
@@ -316,6 +482,81 @@ done:
     return ret;
 }
 
+/* Open a regular file through the page cache of the mount. On success, set
+ * *cached_out to null if the file is not cached, e.g. because it is not a
+ * regular file or cannot be opened for reading, so that the caller opens it
+ * the regular way. */
+static int _hostfs_open_cached_file(
+    device_t* fs,
+    const char* host_path,
+    int flags,
+    oe_mode_t mode,
+    hostfs_cached_file_t** cached_out)
+{
+    int ret = -1;
+    struct oe_stat_t st;
+    int host_flags = flags & ~OE_O_APPEND;
+    oe_host_fd_t host_fd = -1;
+    int retval = -1;
+
+    *cached_out = NULL;
+
+    /* Leave the other files, and the errors, to the regular path. */
+    if (oe_syscall_stat_ocall(&retval, host_path, &st) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval == 0 ? !OE_S_ISREG(st.st_mode) : !(flags & OE_O_CREAT))
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* Partially written pages are read first, so the host file must be
+     * readable. Appends are done by the cache at the enclave's file size. */
+    if ((flags & ACCESS_MODE_MASK) == OE_O_WRONLY)
+        host_flags = (host_flags & ~ACCESS_MODE_MASK) | OE_O_RDWR;
+
+    if (oe_syscall_open_ocall(&host_fd, host_path, host_flags, mode) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (host_fd < 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* Get the identity of a file that was just created. */
+    if (retval != 0)
+    {
+        if (oe_syscall_stat_ocall(&retval, host_path, &st) != OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    if (!(*cached_out = hostfs_cache_open(
+              fs->cache,
+              host_fd,
+              flags,
+              st.st_dev,
+              st.st_ino,
+              (flags & OE_O_TRUNC) ? 0 : st.st_size)))
+    {
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    host_fd = -1;
+    ret = 0;
+
+done:
+
+    if (host_fd >= 0)
+        oe_syscall_close_ocall(&retval, host_fd);
+
+    return ret;
+}
+
 static oe_fd_t* _hostfs_open_file(
     oe_device_t* device,
     const char* pathname,
@@ -351,15 +592,32 @@ static oe_fd_t* _hostfs_open_file(
         if (_make_host_path(fs, pathname, host_path) != 0)
             OE_RAISE_ERRNO_MSG(oe_errno, "pathname=%s", pathname);
 
-        if (oe_syscall_open_ocall(&retval, host_path, flags, mode) != OE_OK)
-            OE_RAISE_ERRNO(OE_EINVAL);
+        if (fs->cache &&
+            _hostfs_open_cached_file(
+                fs, host_path, flags, mode, &file->cached) != 0)
+        {
+            OE_RAISE_ERRNO(oe_errno);
+        }
 
-        if (retval < 0)
-            goto done;
+        if (file->cached)
+        {
+            file->host_fd = hostfs_cached_file_get_host_fd(file->cached);
+        }
+        else
+        {
+            if (oe_syscall_open_ocall(&retval, host_path, flags, mode) !=
+                OE_OK)
+                OE_RAISE_ERRNO(OE_EINVAL);
+
+            if (retval < 0)
+                goto done;
 
-        file->host_fd = retval;
+            file->host_fd = retval;
+        }
     }
 
+    file->io_pool = _io_pool_ref(fs->io_pool);
+
     ret = &file->base;
     file = NULL;
 
@@ -478,7 +736,14 @@ static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
         new_file->magic = FILE_MAGIC;
     }
 
-    /* Call the host to perform the dup(). */
+    /* The duplicate of a cached file shares its offset and host descriptor,
+     * otherwise call the host to perform the dup(). */
+    if (file->cached)
+    {
+        new_file->cached = hostfs_cached_file_ref(file->cached);
+        new_file->host_fd = file->host_fd;
+    }
+    else
     {
         oe_host_fd_t retval = -1;
 
@@ -491,6 +756,8 @@ static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
         new_file->host_fd = retval;
     }
 
+    new_file->io_pool = _io_pool_ref(file->io_pool);
+
     *new_file_out = &new_file->base;
     new_file = NULL;
     ret = 0;
@@ -503,19 +770,89 @@ done:
     return ret;
 }
 
+/* Read into buf through a host buffer of the I/O pool, one buffer-sized
+ * read() at a time, until count bytes are read or the host returns less. */
+static ssize_t _hostfs_read_shared(
+    file_t* file,
+    uint8_t* io_buf,
+    void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    const size_t buffer_size = file->io_pool->buffer_size;
+    size_t total = 0;
+
+    while (total < count)
+    {
+        const size_t remaining = count - total;
+        const size_t n = remaining < buffer_size ? remaining : buffer_size;
+        ssize_t retval = -1;
+
+        if (oe_syscall_read_shared_ocall(&retval, file->host_fd, io_buf, n) !=
+            OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval < 0)
+        {
+            /* Report the bytes already read, if any, as a short read. */
+            if (total == 0)
+                goto done;
+
+            break;
+        }
+
+        /* The host cannot return more bytes than were requested. */
+        if ((size_t)retval > n)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        if (oe_memcpy_s(
+                (uint8_t*)buf + total, remaining, io_buf, (size_t)retval) !=
+            OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        total += (size_t)retval;
+
+        if ((size_t)retval < n)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
 static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
 {
     ssize_t ret = -1;
     file_t* file = _cast_file(desc);
+    uint8_t* io_buf = NULL;
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_read(file->cached, buf, count);
+        goto done;
+    }
+
+    /* Use a registered host buffer if one is free. */
+    if (file->io_pool && count && (io_buf = _io_pool_acquire(file->io_pool)))
+    {
+        ret = _hostfs_read_shared(file, io_buf, buf, count);
+        goto done;
+    }
+
     /* Call the host to perform the read(). */
     if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
 done:
+
+    if (io_buf)
+        _io_pool_release(file->io_pool, io_buf);
+
     return ret;
 }
 
@@ -563,19 +900,158 @@ done:
     return ret;
 }
 
+/* Write buf through a host buffer of the I/O pool, one buffer-sized write()
+ * at a time, until count bytes are written or the host writes less. */
+static ssize_t _hostfs_write_shared(
+    file_t* file,
+    uint8_t* io_buf,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    const size_t buffer_size = file->io_pool->buffer_size;
+    size_t total = 0;
+
+    while (total < count)
+    {
+        const size_t remaining = count - total;
+        const size_t n = remaining < buffer_size ? remaining : buffer_size;
+        ssize_t retval = -1;
+
+        if (oe_memcpy_s(io_buf, buffer_size, (const uint8_t*)buf + total, n) !=
+            OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (oe_syscall_write_shared_ocall(&retval, file->host_fd, io_buf, n) !=
+            OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval < 0)
+        {
+            /* Report the bytes already written, if any, as a short write. */
+            if (total == 0)
+                goto done;
+
+            break;
+        }
+
+        /* The host cannot write more bytes than were given. */
+        if ((size_t)retval > n)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        total += (size_t)retval;
+
+        if ((size_t)retval < n)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
 static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
 {
     ssize_t ret = -1;
     file_t* file = _cast_file(desc);
+    uint8_t* io_buf = NULL;
 
     /* Check parameters. */
     if (!file || (count && !buf))
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_write(file->cached, buf, count);
+        goto done;
+    }
+
+    /* Use a registered host buffer if one is free. */
+    if (file->io_pool && count && (io_buf = _io_pool_acquire(file->io_pool)))
+    {
+        ret = _hostfs_write_shared(file, io_buf, buf, count);
+        goto done;
+    }
+
     /* Call the host. */
     if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+done:
+
+    if (io_buf)
+        _io_pool_release(file->io_pool, io_buf);
+
+    return ret;
+}
+
+/* Read into each buffer of the IO vector in turn from the page cache. */
+static ssize_t _hostfs_cached_readv(
+    hostfs_cached_file_t* cached,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n =
+            hostfs_cached_file_read(cached, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            /* Report the bytes already read, if any, as a short read. */
+            if (total == 0)
+                goto done;
+
+            break;
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+/* Write each buffer of the IO vector in turn to the page cache. */
+static ssize_t _hostfs_cached_writev(
+    hostfs_cached_file_t* cached,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n =
+            hostfs_cached_file_write(cached, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            /* Report the bytes already written, if any, as a short write. */
+            if (total == 0)
+                goto done;
+
+            break;
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
 done:
     return ret;
 }
@@ -589,32 +1065,40 @@ static ssize_t _hostfs_readv(
     file_t* file = _cast_file(desc);
     void* buf = NULL;
     size_t buf_size = 0;
+    ssize_t retval = -1;
 
     if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Flatten the IO vector into contiguous heap memory. */
-    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+    if (file->cached)
+    {
+        ret = _hostfs_cached_readv(file->cached, iov, iovcnt);
+        goto done;
+    }
+
+    /* Lay out the IO vector in host memory for the host to fill. */
+    if (oe_iov_pack_host(iov, iovcnt, false, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     /* Call the host. */
-    if (oe_syscall_readv_ocall(&ret, file->host_fd, buf, iovcnt, buf_size) !=
-        OE_OK)
+    if (oe_syscall_readv_shared_ocall(
+            &retval, file->host_fd, buf, iovcnt, buf_size) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
-    /* Synchronize data read with IO vector. */
-    if (ret > 0)
+    /* Copy the data read into the IO vector. */
+    if (retval > 0)
     {
-        if (oe_iov_sync(iov, iovcnt, buf, buf_size) != 0)
-            OE_RAISE_ERRNO(OE_EINVAL);
+        if (oe_iov_unpack_host(iov, iovcnt, buf, buf_size, (size_t)retval) !=
+            0)
+            OE_RAISE_ERRNO(OE_EIO);
     }
 
-done:
+    ret = retval;
 
-    if (buf)
-        oe_free(buf);
+done:
+    oe_iov_free_host(buf);
 
     return ret;
 }
@@ -632,21 +1116,25 @@ static ssize_t _hostfs_writev(
     if (!file || !iov || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Flatten the IO vector into contiguous heap memory. */
-    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+    if (file->cached)
+    {
+        ret = _hostfs_cached_writev(file->cached, iov, iovcnt);
+        goto done;
+    }
+
+    /* Copy the IO vector into host memory. */
+    if (oe_iov_pack_host(iov, iovcnt, true, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     /* Call the host. */
-    if (oe_syscall_writev_ocall(&ret, file->host_fd, buf, iovcnt, buf_size) !=
-        OE_OK)
+    if (oe_syscall_writev_shared_ocall(
+            &ret, file->host_fd, buf, iovcnt, buf_size) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
 done:
-
-    if (buf)
-        oe_free(buf);
+    oe_iov_free_host(buf);
 
     return ret;
 }
@@ -659,6 +1147,12 @@ static oe_off_t _hostfs_lseek_file(oe_fd_t* desc, oe_off_t offset, int whence)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_lseek(file->cached, offset, whence);
+        goto done;
+    }
+
     if (oe_syscall_lseek_ocall(&ret, file->host_fd, offset, whence) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -729,6 +1223,12 @@ static ssize_t _hostfs_pread(
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_pread(file->cached, buf, count, offset);
+        goto done;
+    }
+
     if (oe_syscall_pread_ocall(&ret, file->host_fd, buf, count, offset) !=
         OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -749,6 +1249,12 @@ static ssize_t _hostfs_pwrite(
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_pwrite(file->cached, buf, count, offset);
+        goto done;
+    }
+
     if (oe_syscall_pwrite_ocall(&ret, file->host_fd, buf, count, offset) !=
         OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -757,6 +1263,34 @@ done:
     return ret;
 }
 
+static int _hostfs_fsync(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Directories are not opened on the host. */
+    if (file->dir)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    if (file->cached)
+    {
+        ret = hostfs_cached_file_fsync(file->cached);
+        goto done;
+    }
+
+    if (oe_syscall_fsync_ocall(&ret, file->host_fd) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+done:
+    return ret;
+}
+
 static int _hostfs_close_file(oe_fd_t* desc)
 {
     int ret = -1;
@@ -766,12 +1300,28 @@ static int _hostfs_close_file(oe_fd_t* desc)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* The last duplicate of a cached file writes it back and closes it. The
+     * descriptor is released even if that fails, as close() does. */
+    if (file->cached)
+    {
+        retval = hostfs_cached_file_unref(file->cached);
+        _io_pool_unref(file->io_pool);
+        oe_free(file);
+
+        if (retval == -1)
+            OE_RAISE_ERRNO(oe_errno);
+
+        ret = 0;
+        goto done;
+    }
+
     if (oe_syscall_close_ocall(&retval, file->host_fd) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     if (retval == -1)
         OE_RAISE_ERRNO(oe_errno);
 
+    _io_pool_unref(file->io_pool);
     oe_free(file);
 
     ret = retval;
@@ -868,8 +1418,19 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
         case OE_F_GETFD:
         case OE_F_SETFD:
         case OE_F_GETFL:
+            break;
+
         case OE_F_SETFL:
+        {
+            /* The cache appends at the file size seen by the enclave. */
+            if (file->cached)
+            {
+                hostfs_cached_file_set_append(
+                    file->cached, (arg & OE_O_APPEND) != 0);
+                arg &= ~(uint64_t)OE_O_APPEND;
+            }
             break;
+        }
 
         case OE_F_GETLK64:
         case OE_F_OFD_GETLK:
@@ -914,6 +1475,16 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
             &ret, file->host_fd, cmd, arg, argsize, argout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Report the flags requested by open() rather than the host's. */
+    if (cmd == OE_F_GETFL && ret != -1 && file->cached)
+    {
+        ret &= ~(ACCESS_MODE_MASK | OE_O_APPEND);
+        ret |= hostfs_cached_file_get_access_mode(file->cached);
+
+        if (hostfs_cached_file_get_append(file->cached))
+            ret |= OE_O_APPEND;
+    }
+
 done:
     return ret;
 }
@@ -1037,6 +1608,15 @@ static int _hostfs_stat(
     if (oe_syscall_stat_ocall(&retval, host_path, buf) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Include the writes that are not written back yet. */
+    if (retval == 0 && fs->cache)
+    {
+        oe_off_t size;
+
+        if (hostfs_cache_get_size(fs->cache, buf->st_dev, buf->st_ino, &size))
+            buf->st_size = size;
+    }
+
     ret = retval;
 
 done:
@@ -1184,6 +1764,18 @@ static int _hostfs_truncate(
     if (oe_syscall_truncate_ocall(&retval, host_path, length) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Drop the cached pages past the new end of the file. */
+    if (retval == 0 && fs->cache)
+    {
+        struct oe_stat_t st;
+
+        if (oe_syscall_stat_ocall(&retval, host_path, &st) != OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval == 0)
+            hostfs_cache_truncate(fs->cache, st.st_dev, st.st_ino, length);
+    }
+
     ret = retval;
 
 done:
@@ -1271,6 +1863,7 @@ static oe_file_ops_t _file_ops =
     .lseek = _hostfs_lseek,
     .pread = _hostfs_pread,
     .pwrite = _hostfs_pwrite,
+    .fsync = _hostfs_fsync,
     .getdents64 = _hostfs_getdents64,
 };
 // clang-format on
@@ -1314,6 +1907,31 @@ oe_device_t* oe_get_hostfs_device(void)
     return &_hostfs.base;
 }
 
+int oe_host_file_system_get_cache_statistics(
+    const char* path,
+    oe_host_file_system_cache_statistics_t* statistics)
+{
+    int ret = -1;
+    oe_device_t* device;
+    device_t* fs;
+    char suffix[OE_PATH_MAX];
+
+    if (!path || !statistics)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(device = oe_mount_resolve(path, suffix)))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(fs = _cast_device(device)) || !fs->cache)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    hostfs_cache_get_statistics(fs->cache, statistics);
+    ret = 0;
+
+done:
+    return ret;
+}
+
 oe_result_t oe_load_module_host_file_system(void)
 {
     oe_result_t result = OE_UNEXPECTED;
@@ -835,32 +835,34 @@ static ssize_t _hostsock_readv(
     sock_t* sock = _cast_sock(desc);
     void* buf = NULL;
     size_t buf_size = 0;
+    ssize_t retval = -1;
 
     if (!sock || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Flatten the IO vector into contiguous heap memory. */
-    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+    /* Lay out the IO vector in host memory for the host to fill. */
+    if (oe_iov_pack_host(iov, iovcnt, false, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     /* Call the host. */
-    if (oe_syscall_recvv_ocall(&ret, sock->host_fd, buf, iovcnt, buf_size) !=
-        OE_OK)
+    if (oe_syscall_recvv_shared_ocall(
+            &retval, sock->host_fd, buf, iovcnt, buf_size) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
-    /* Synchronize data read with IO vector. */
-    if (ret > 0)
+    /* Copy the data read into the IO vector. */
+    if (retval > 0)
     {
-        if (oe_iov_sync(iov, iovcnt, buf, buf_size) != 0)
-            OE_RAISE_ERRNO(OE_EINVAL);
+        if (oe_iov_unpack_host(iov, iovcnt, buf, buf_size, (size_t)retval) !=
+            0)
+            OE_RAISE_ERRNO(OE_EIO);
     }
 
-done:
+    ret = retval;
 
-    if (buf)
-        oe_free(buf);
+done:
+    oe_iov_free_host(buf);
 
     return ret;
 }
@@ -878,21 +880,19 @@ static ssize_t _hostsock_writev(
     if (!sock || !iov || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Flatten the IO vector into contiguous heap memory. */
-    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+    /* Copy the IO vector into host memory. */
+    if (oe_iov_pack_host(iov, iovcnt, true, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     /* Call the host. */
-    if (oe_syscall_sendv_ocall(&ret, sock->host_fd, buf, iovcnt, buf_size) !=
-        OE_OK)
+    if (oe_syscall_sendv_shared_ocall(
+            &ret, sock->host_fd, buf, iovcnt, buf_size) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
 done:
-
-    if (buf)
-        oe_free(buf);
+    oe_iov_free_host(buf);
 
     return ret;
 }
@@ -142,6 +142,16 @@ oe_result_t _oe_syscall_write_ocall(
     oe_host_fd_t fd,
     const void* buf,
     size_t count);
+oe_result_t _oe_syscall_read_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count);
+oe_result_t _oe_syscall_write_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count);
 oe_result_t _oe_syscall_readv_ocall(
     ssize_t* _retval,
     oe_host_fd_t fd,
@@ -154,6 +164,18 @@ oe_result_t _oe_syscall_writev_ocall(
     const void* iov_buf,
     int iovcnt,
     size_t iov_buf_size);
+oe_result_t _oe_syscall_readv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size);
+oe_result_t _oe_syscall_writev_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size);
 oe_result_t _oe_syscall_lseek_ocall(
     oe_off_t* _retval,
     oe_host_fd_t fd,
@@ -172,6 +194,7 @@ oe_result_t _oe_syscall_pwrite_ocall(
     size_t count,
     oe_off_t offset);
 oe_result_t _oe_syscall_close_ocall(int* _retval, oe_host_fd_t fd);
+oe_result_t _oe_syscall_fsync_ocall(int* _retval, oe_host_fd_t fd);
 oe_result_t _oe_syscall_dup_ocall(oe_host_fd_t* _retval, oe_host_fd_t oldfd);
 oe_result_t _oe_syscall_opendir_ocall(uint64_t* _retval, const char* name);
 oe_result_t _oe_syscall_readdir_ocall(
@@ -260,6 +283,34 @@ oe_result_t _oe_syscall_write_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_write_ocall, oe_syscall_write_ocall);
 
+oe_result_t _oe_syscall_read_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_read_shared_ocall, oe_syscall_read_shared_ocall);
+
+oe_result_t _oe_syscall_write_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_write_shared_ocall, oe_syscall_write_shared_ocall);
+
 oe_result_t _oe_syscall_readv_ocall(
     ssize_t* _retval,
     oe_host_fd_t fd,
@@ -292,6 +343,38 @@ oe_result_t _oe_syscall_writev_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_writev_ocall, oe_syscall_writev_ocall);
 
+oe_result_t _oe_syscall_readv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(iov_buf);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(iov_buf_size);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_readv_shared_ocall, oe_syscall_readv_shared_ocall);
+
+oe_result_t _oe_syscall_writev_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(iov_buf);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(iov_buf_size);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_writev_shared_ocall, oe_syscall_writev_shared_ocall);
+
 oe_result_t _oe_syscall_lseek_ocall(
     oe_off_t* _retval,
     oe_host_fd_t fd,
@@ -358,6 +441,14 @@ oe_result_t _oe_syscall_flock_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_flock_ocall, oe_syscall_flock_ocall);
 
+oe_result_t _oe_syscall_fsync_ocall(int* _retval, oe_host_fd_t fd)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_fsync_ocall, oe_syscall_fsync_ocall);
+
 oe_result_t _oe_syscall_dup_ocall(oe_host_fd_t* _retval, oe_host_fd_t oldfd)
 {
     OE_UNUSED(_retval);
@@ -688,6 +779,18 @@ oe_result_t _oe_syscall_sendv_ocall(
     const void* iov_buf,
     int iovcnt,
     size_t iov_buf_size);
+oe_result_t _oe_syscall_recvv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size);
+oe_result_t _oe_syscall_sendv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size);
 oe_result_t _oe_syscall_shutdown_ocall(
     int* _retval,
     oe_host_fd_t sockfd,
@@ -1021,6 +1124,38 @@ oe_result_t _oe_syscall_sendv_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_sendv_ocall, oe_syscall_sendv_ocall);
 
+oe_result_t _oe_syscall_recvv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(iov_buf);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(iov_buf_size);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_recvv_shared_ocall, oe_syscall_recvv_shared_ocall);
+
+oe_result_t _oe_syscall_sendv_shared_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(fd);
+    OE_UNUSED(iov_buf);
+    OE_UNUSED(iovcnt);
+    OE_UNUSED(iov_buf_size);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_sendv_shared_ocall, oe_syscall_sendv_shared_ocall);
+
 oe_result_t _oe_syscall_shutdown_ocall(
     int* _retval,
     oe_host_fd_t sockfd,
@@ -5,12 +5,14 @@
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/safemath.h>
 #include <openenclave/internal/syscall/iov.h>
 #include <openenclave/internal/syscall/sys/uio.h>
 #include <openenclave/internal/syscall/types.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 
 int oe_iov_pack(
@@ -172,3 +174,179 @@ done:
 
     return ret;
 }
+
+/* Host buffers up to this size are kept by the thread for its next call. */
+#define OE_IOV_HOST_BUFFER_CACHE_SIZE (1024 * 1024)
+
+static __thread void* _host_buffer;
+static __thread size_t _host_buffer_size;
+
+/* The thread-local storage of an enclave thread is cleared when it returns
+ * from its outermost ECALL, so the cached buffer is also registered under a
+ * thread-specific key whose destructor releases it at that point. */
+static oe_once_t _host_buffer_once = OE_ONCE_INIT;
+static oe_thread_key_t _host_buffer_key;
+static bool _host_buffer_key_created;
+
+static void _free_host_buffer(void* buffer)
+{
+    oe_host_free(buffer);
+}
+
+static void _create_host_buffer_key(void)
+{
+    if (oe_thread_key_create(&_host_buffer_key, _free_host_buffer) == OE_OK)
+        _host_buffer_key_created = true;
+}
+
+static void* _alloc_host_buffer(size_t size)
+{
+    size_t capacity = 4096;
+
+    if (size > OE_IOV_HOST_BUFFER_CACHE_SIZE)
+        return oe_host_malloc(size);
+
+    if (size <= _host_buffer_size)
+        return _host_buffer;
+
+    oe_once(&_host_buffer_once, _create_host_buffer_key);
+
+    /* Without the key the buffer could not be released, so do not cache it */
+    if (!_host_buffer_key_created)
+        return oe_host_malloc(size);
+
+    while (capacity < size)
+        capacity <<= 1;
+
+    if (_host_buffer)
+        oe_host_free(_host_buffer);
+
+    _host_buffer_size = 0;
+    _host_buffer = oe_host_malloc(capacity);
+    oe_thread_setspecific(_host_buffer_key, _host_buffer);
+
+    if (!_host_buffer)
+        return NULL;
+
+    _host_buffer_size = capacity;
+    return _host_buffer;
+}
+
+int oe_iov_pack_host(
+    const struct oe_iovec* iov,
+    int iovcnt,
+    bool copy_data,
+    void** buf_out,
+    size_t* buf_size_out)
+{
+    int ret = -1;
+    struct oe_iovec* buf = NULL;
+    size_t buf_size = 0;
+    size_t data_size = 0;
+
+    if (buf_out)
+        *buf_out = NULL;
+
+    if (buf_size_out)
+        *buf_size_out = 0;
+
+    /* Reject invalid parameters. */
+    if (iovcnt < 0 || iovcnt > OE_IOV_MAX || (iovcnt > 0 && !iov) ||
+        !buf_out || !buf_size_out)
+        goto done;
+
+    /* The host handles an empty IO vector without a buffer. */
+    if (iovcnt == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* Calculate the total number of data bytes. */
+    for (int i = 0; i < iovcnt; i++)
+    {
+        if (iov[i].iov_len && !iov[i].iov_base)
+            goto done;
+
+        if (oe_safe_add_sizet(data_size, iov[i].iov_len, &data_size) != OE_OK)
+            goto done;
+    }
+
+    if (data_size > OE_SSIZE_MAX)
+        goto done;
+
+    /* Calculate the total size of the resulting buffer. */
+    if (oe_safe_add_sizet(
+            sizeof(struct oe_iovec) * (size_t)iovcnt, data_size, &buf_size) !=
+        OE_OK)
+        goto done;
+
+    if (!(buf = _alloc_host_buffer(buf_size)))
+        goto done;
+
+    /* Initialize the array elements, and the data if it is written. */
+    {
+        size_t offset = sizeof(struct oe_iovec) * (size_t)iovcnt;
+
+        for (int i = 0; i < iovcnt; i++)
+        {
+            const size_t iov_len = iov[i].iov_len;
+
+            buf[i].iov_len = iov_len;
+            buf[i].iov_base = iov_len ? (void*)offset : NULL;
+
+            if (copy_data && iov_len)
+                memcpy((uint8_t*)buf + offset, iov[i].iov_base, iov_len);
+
+            offset += iov_len;
+        }
+    }
+
+    *buf_out = buf;
+    *buf_size_out = buf_size;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+int oe_iov_unpack_host(
+    const struct oe_iovec* iov,
+    int iovcnt,
+    const void* buf,
+    size_t buf_size,
+    size_t count)
+{
+    int ret = -1;
+    size_t offset = sizeof(struct oe_iovec) * (size_t)iovcnt;
+
+    /* Reject invalid parameters. */
+    if (iovcnt < 0 || (iovcnt > 0 && (!iov || !buf)) || offset > buf_size ||
+        count > buf_size - offset)
+        goto done;
+
+    /* The host's copy of the array is not trusted: the data of each element
+     * follows the data of the previous one, as laid out by
+     * oe_iov_pack_host(). */
+    for (int i = 0; i < iovcnt && count; i++)
+    {
+        const size_t n = iov[i].iov_len < count ? iov[i].iov_len : count;
+
+        if (n)
+            memcpy(iov[i].iov_base, (const uint8_t*)buf + offset, n);
+
+        offset += n;
+        count -= n;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+void oe_iov_free_host(void* buf)
+{
+    if (buf && buf != _host_buffer)
+        oe_host_free(buf);
+}
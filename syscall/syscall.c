@@ -190,6 +190,14 @@ static long _syscall(
             ret = oe_flock(fd, operation);
             goto done;
         }
+        case OE_SYS_fsync:
+        case OE_SYS_fdatasync:
+        {
+            int fd = (int)arg1;
+
+            ret = oe_fsync(fd);
+            goto done;
+        }
 #if defined(OE_SYS_dup2)
         case OE_SYS_dup2:
         {
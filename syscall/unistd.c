@@ -302,6 +302,23 @@ done:
     return ret;
 }
 
+int oe_fsync(int fd)
+{
+    int ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!file->ops.file.fsync)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = file->ops.file.fsync(file);
+
+done:
+    return ret;
+}
+
 int oe_dup(int oldfd)
 {
     int ret = -1;
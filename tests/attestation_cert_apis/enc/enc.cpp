@@ -10,9 +10,11 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "tls_t.h"
 
 // This is the identity validation callback. A TLS connecting party (client or
@@ -304,6 +306,200 @@ oe_result_t get_tls_cert_signed_with_rsa_key(
     return get_tls_cert_signed_with_key(MBEDTLS_PK_RSA, cert, cert_size);
 }
 
+static bool _same_certificate(
+    const uint8_t* cert1,
+    size_t cert1_size,
+    const uint8_t* cert2,
+    size_t cert2_size)
+{
+    return cert1_size == cert2_size && memcmp(cert1, cert2, cert1_size) == 0;
+}
+
+// Sleep until oe_get_time() reaches the given time in milliseconds
+static void _sleep_until(uint64_t deadline)
+{
+    uint64_t now;
+
+    while ((now = oe_get_time()) < deadline)
+    {
+        uint64_t duration = deadline - now;
+        timespec req = {(time_t)(duration / 1000),
+                        (long)(duration % 1000) * 1000000};
+        nanosleep(&req, NULL);
+    }
+}
+
+void test_attestation_certificate_manager()
+{
+    // The certificate is renewed once less than a quarter of its lifetime
+    // remains, that is after 9 of its 12 seconds.
+    const uint32_t lifetime = 12;
+    const uint64_t renewal_time = lifetime * 1000 * 3 / 4 + 100;
+    const unsigned char* subject_name =
+        (const unsigned char*)"CN=Open Enclave SDK,O=OESDK TLS,C=US";
+    uint8_t* private_key = NULL;
+    size_t private_key_size = 0;
+    uint8_t* public_key = NULL;
+    size_t public_key_size = 0;
+    oe_attestation_certificate_manager_t* manager = NULL;
+    uint8_t* cert1 = NULL;
+    size_t cert1_size = 0;
+    uint8_t* cert2 = NULL;
+    size_t cert2_size = 0;
+    uint8_t* cert3 = NULL;
+    size_t cert3_size = 0;
+    uint64_t generated;
+
+    OE_TEST(
+        generate_key_pair(
+            MBEDTLS_PK_ECKEY,
+            &public_key,
+            &public_key_size,
+            &private_key,
+            &private_key_size) == OE_OK);
+
+    // Invalid parameters.
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            NULL,
+            private_key_size,
+            public_key,
+            public_key_size,
+            lifetime,
+            &manager) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            0,
+            public_key,
+            public_key_size,
+            lifetime,
+            &manager) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            private_key_size,
+            NULL,
+            public_key_size,
+            lifetime,
+            &manager) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            0,
+            lifetime,
+            &manager) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            0,
+            &manager) == OE_INVALID_PARAMETER);
+    OE_TEST(manager == NULL);
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            lifetime,
+            NULL) == OE_INVALID_PARAMETER);
+
+    OE_TEST(
+        oe_create_attestation_certificate_manager(
+            subject_name,
+            private_key,
+            private_key_size,
+            public_key,
+            public_key_size,
+            lifetime,
+            &manager) == OE_OK);
+
+    OE_TEST(
+        oe_get_managed_attestation_certificate(NULL, &cert1, &cert1_size) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, NULL, &cert1_size) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert1, NULL) ==
+        OE_INVALID_PARAMETER);
+    oe_free_attestation_certificate_manager(NULL);
+
+    // The first call generates the certificate, which is then reused within
+    // its lifetime.
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert1, &cert1_size) ==
+        OE_OK);
+    generated = oe_get_time();
+    OE_TEST(
+        oe_verify_attestation_certificate(
+            cert1, cert1_size, enclave_identity_verifier, NULL) == OE_OK);
+
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert2, &cert2_size) ==
+        OE_OK);
+    OE_TEST(cert2 != cert1);
+    OE_TEST(_same_certificate(cert1, cert1_size, cert2, cert2_size));
+    oe_free_attestation_certificate(cert2);
+    cert2 = NULL;
+
+    // The certificate is not renewed while most of its lifetime remains.
+    OE_TEST(
+        oe_renew_managed_attestation_certificate(NULL) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(oe_renew_managed_attestation_certificate(manager) == OE_OK);
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert2, &cert2_size) ==
+        OE_OK);
+    OE_TEST(_same_certificate(cert1, cert1_size, cert2, cert2_size));
+    oe_free_attestation_certificate(cert2);
+    cert2 = NULL;
+
+    // Once less than a quarter of the lifetime remains, callers still get the
+    // current certificate without renewing it.
+    _sleep_until(generated + renewal_time);
+
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert2, &cert2_size) ==
+        OE_OK);
+    OE_TEST(_same_certificate(cert1, cert1_size, cert2, cert2_size));
+    oe_free_attestation_certificate(cert2);
+    cert2 = NULL;
+
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert2, &cert2_size) ==
+        OE_OK);
+    OE_TEST(_same_certificate(cert1, cert1_size, cert2, cert2_size));
+
+    // Renewing it publishes the next certificate to the next callers.
+    OE_TEST(oe_renew_managed_attestation_certificate(manager) == OE_OK);
+    OE_TEST(
+        oe_get_managed_attestation_certificate(manager, &cert3, &cert3_size) ==
+        OE_OK);
+    OE_TEST(!_same_certificate(cert1, cert1_size, cert3, cert3_size));
+    OE_TEST(
+        oe_verify_attestation_certificate(
+            cert3, cert3_size, enclave_identity_verifier, NULL) == OE_OK);
+
+    oe_free_attestation_certificate(cert1);
+    oe_free_attestation_certificate(cert2);
+    oe_free_attestation_certificate(cert3);
+    oe_free_attestation_certificate_manager(manager);
+    free(private_key);
+    free(public_key);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
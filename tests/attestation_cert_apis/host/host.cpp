@@ -191,6 +191,10 @@ int main(int argc, const char* argv[])
     run_test(enclave, TEST_EC_KEY);
     run_test(enclave, TEST_RSA_KEY);
 
+    OE_TRACE_INFO("Host: test the attestation certificate manager\n");
+    result = test_attestation_certificate_manager(enclave);
+    OE_TEST(result == OE_OK);
+
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
     OE_TRACE_INFO("=== passed all tests (tls)\n");
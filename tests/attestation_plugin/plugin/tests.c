@@ -159,6 +159,48 @@ static void _test_evidence_success(
 
     OE_TEST(_check_claims(claims, claims_length));
 
+    // Verify the evidence in a batch, which falls back to verify_evidence
+    // for plugins that do not verify batches.
+    {
+        oe_evidence_batch_item_t item = {evidence, evidence_size};
+
+        OE_TEST_CODE(
+            oe_verify_evidence_batch(
+                &item, 1, endorsements, endorsements_size, NULL, 0),
+            OE_OK);
+        OE_TEST_CODE(item.result, OE_OK);
+        OE_TEST(item.claims_length == claims_length);
+        OE_TEST(_check_claims(item.claims, item.claims_length));
+        OE_TEST(oe_free_claims(item.claims, item.claims_length) == OE_OK);
+    }
+
+    // Verify the evidence with a claims buffer, which copies the claims
+    // returned by verify_evidence for plugins that do not fill buffers.
+    {
+        uint64_t buffer[512];
+        size_t buffer_size = sizeof(buffer);
+        oe_claim_t* buffer_claims = NULL;
+        size_t buffer_claims_length = 0;
+
+        OE_TEST_CODE(
+            oe_verify_evidence_with_claims_buffer(
+                evidence,
+                evidence_size,
+                endorsements,
+                endorsements_size,
+                NULL,
+                0,
+                buffer,
+                &buffer_size,
+                &buffer_claims,
+                &buffer_claims_length),
+            OE_OK);
+        OE_TEST(buffer_claims == (oe_claim_t*)buffer);
+        OE_TEST(buffer_size <= sizeof(buffer));
+        OE_TEST(buffer_claims_length == claims_length);
+        OE_TEST(_check_claims(buffer_claims, buffer_claims_length));
+    }
+
     OE_TEST(oe_free_evidence(evidence) == OE_OK);
     OE_TEST(oe_free_endorsements(endorsements) == OE_OK);
     OE_TEST(oe_free_claims(claims, claims_length) == OE_OK);
@@ -485,6 +527,142 @@ static void _test_time_policy(
             &claims_size) == OE_VERIFY_FAILED_TO_FIND_VALIDITY_PERIOD);
 }
 
+#define NUM_BATCH_ITEMS 40
+
+static void _test_verify_evidence_batch(
+    const uint8_t* evidence,
+    size_t evidence_size,
+    const uint8_t* endorsements,
+    size_t endorsements_size,
+    const oe_claim_t* claims,
+    size_t claims_size,
+    oe_result_t expected_result)
+{
+    oe_evidence_batch_item_t* items = NULL;
+    const size_t invalid_item = NUM_BATCH_ITEMS / 2;
+
+    printf("====== running _test_verify_evidence_batch\n");
+
+    items = (oe_evidence_batch_item_t*)calloc(NUM_BATCH_ITEMS, sizeof(*items));
+    OE_TEST(items != NULL);
+
+    // Enough copies of the evidence to verify them on several threads on the
+    // host, and an invalid item which must not fail the others.
+    for (size_t i = 0; i < NUM_BATCH_ITEMS; i++)
+    {
+        items[i].evidence_buffer = evidence;
+        items[i].evidence_buffer_size = evidence_size;
+    }
+    items[invalid_item].evidence_buffer = NULL;
+
+    OE_TEST_CODE(
+        oe_verify_evidence_batch(
+            items,
+            NUM_BATCH_ITEMS,
+            endorsements,
+            endorsements_size,
+            NULL,
+            0),
+        OE_OK);
+
+    for (size_t i = 0; i < NUM_BATCH_ITEMS; i++)
+    {
+        if (i == invalid_item)
+        {
+            OE_TEST_CODE(items[i].result, OE_INVALID_PARAMETER);
+            OE_TEST(items[i].claims == NULL);
+            continue;
+        }
+
+        OE_TEST_CODE(items[i].result, expected_result);
+        if (expected_result != OE_OK)
+        {
+            OE_TEST(items[i].claims == NULL);
+            continue;
+        }
+
+        // The claims match those of oe_verify_evidence().
+        OE_TEST(items[i].claims_length == claims_size);
+        for (size_t j = 0; j < claims_size; j++)
+        {
+            void* value =
+                _find_claim(items[i].claims, claims_size, claims[j].name);
+
+            OE_TEST(
+                value != NULL &&
+                memcmp(value, claims[j].value, claims[j].value_size) == 0);
+        }
+
+        OE_TEST(
+            oe_free_claims(items[i].claims, items[i].claims_length) == OE_OK);
+    }
+
+    free(items);
+}
+
+static void _test_verify_evidence_with_claims_buffer(
+    const uint8_t* evidence,
+    size_t evidence_size,
+    const uint8_t* endorsements,
+    size_t endorsements_size,
+    const oe_claim_t* claims,
+    size_t claims_size)
+{
+    uint64_t* buffer = NULL;
+    size_t buffer_size = 0;
+    oe_claim_t* buffer_claims = NULL;
+    size_t buffer_claims_length = 0;
+
+    printf("====== running _test_verify_evidence_with_claims_buffer\n");
+
+    // Get the size of the buffer needed.
+    OE_TEST_CODE(
+        oe_verify_evidence_with_claims_buffer(
+            evidence,
+            evidence_size,
+            endorsements,
+            endorsements_size,
+            NULL,
+            0,
+            NULL,
+            &buffer_size,
+            &buffer_claims,
+            &buffer_claims_length),
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(buffer_size > claims_size * sizeof(oe_claim_t));
+
+    buffer = (uint64_t*)malloc(buffer_size);
+    OE_TEST(buffer != NULL);
+
+    OE_TEST_CODE(
+        oe_verify_evidence_with_claims_buffer(
+            evidence,
+            evidence_size,
+            endorsements,
+            endorsements_size,
+            NULL,
+            0,
+            buffer,
+            &buffer_size,
+            &buffer_claims,
+            &buffer_claims_length),
+        OE_OK);
+    OE_TEST(buffer_claims == (oe_claim_t*)buffer);
+
+    // The claims match those of oe_verify_evidence().
+    OE_TEST(buffer_claims_length == claims_size);
+    for (size_t i = 0; i < claims_size; i++)
+    {
+        void* value = _find_claim(buffer_claims, claims_size, claims[i].name);
+
+        OE_TEST(
+            value != NULL &&
+            memcmp(value, claims[i].value, claims[i].value_size) == 0);
+    }
+
+    free(buffer);
+}
+
 void verify_sgx_evidence(
     const uint8_t* evidence,
     size_t evidence_size,
@@ -615,6 +793,24 @@ void verify_sgx_evidence(
                                      custom_claims[i].value_size) == 0);
         }
     }
+
+    _test_verify_evidence_batch(
+        evidence,
+        evidence_size,
+        endorsements,
+        endorsements_size,
+        claims,
+        claims_size,
+        OE_OK);
+
+    _test_verify_evidence_with_claims_buffer(
+        evidence,
+        evidence_size,
+        endorsements,
+        endorsements_size,
+        claims,
+        claims_size);
+
     OE_TEST(oe_free_claims(claims, claims_size) == OE_OK);
 
     // Test sgx_remote_evidence with tampered claims in evidence
@@ -632,5 +828,14 @@ void verify_sgx_evidence(
             &claims,
             &claims_size) == OE_QUOTE_HASH_MISMATCH);
 
+    _test_verify_evidence_batch(
+        evidence,
+        evidence_size,
+        endorsements,
+        endorsements_size,
+        NULL,
+        0,
+        OE_QUOTE_HASH_MISMATCH);
+
     header->data[header->data_size - 1] ^= 1;
 }
@@ -15,13 +15,23 @@
 #define MAX_SIMULTANEOUS_ENCLAVES 16
 #define MAX_THREADS 8
 
+// The measurement cache used by the enclaves, if any.
+static oe_enclave_setting_measurement_cache_t _measurement_cache_setting;
+static oe_enclave_setting_t _settings[1];
+static uint32_t _setting_count;
+
 static void _launch_enclave(const char* path, uint32_t flags, bool call_enclave)
 {
     oe_result_t result;
     oe_enclave_t* enclave = NULL;
 
     result = oe_create_create_rapid_enclave(
-        path, OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave);
+        path,
+        OE_ENCLAVE_TYPE_SGX,
+        flags,
+        _setting_count ? _settings : NULL,
+        _setting_count,
+        &enclave);
 
     if (result != OE_OK)
         oe_put_err("oe_create_create_rapid_enclave(): result=%u", result);
@@ -140,11 +150,54 @@ static void _test_multithreaded(
         thread.join();
 }
 
+// Check the counters of the measurement cache after num_enclaves enclaves were
+// created with it since previous was read: at most max_misses of them were
+// measured.
+static void _check_measurement_cache(
+    uint32_t flags,
+    const oe_measurement_cache_statistics_t* previous,
+    uint64_t num_enclaves,
+    uint64_t max_misses)
+{
+    oe_measurement_cache_statistics_t statistics;
+    uint64_t hits;
+    uint64_t misses;
+
+    OE_TEST(oe_get_measurement_cache_statistics(&statistics) == OE_OK);
+    hits = statistics.hits - previous->hits;
+    misses = statistics.misses - previous->misses;
+
+    printf(
+        "measurement cache: %llu hits, %llu misses\n",
+        (unsigned long long)hits,
+        (unsigned long long)misses);
+
+    // The cache is not used in simulation mode.
+    if (flags & OE_ENCLAVE_FLAG_SIMULATE)
+    {
+        OE_TEST(hits == 0 && misses == 0);
+        return;
+    }
+
+    OE_TEST(hits + misses == num_enclaves);
+    OE_TEST(misses <= max_misses);
+    OE_TEST(statistics.evictions == previous->evictions);
+}
+
+// Use the measurement cache, in process memory only if directory is NULL.
+static void _use_measurement_cache(const char* directory)
+{
+    _measurement_cache_setting.directory = directory;
+    _settings[0].setting_type = OE_ENCLAVE_SETTING_MEASUREMENT_CACHE;
+    _settings[0].u.measurement_cache_setting = &_measurement_cache_setting;
+    _setting_count = 1;
+}
+
 int main(int argc, const char* argv[])
 {
-    if (argc != 2)
+    if (argc != 3)
     {
-        fprintf(stderr, "Usage: %s ENCLAVE\n", argv[0]);
+        fprintf(stderr, "Usage: %s ENCLAVE MEASUREMENT_CACHE_DIR\n", argv[0]);
         exit(1);
     }
 
@@ -162,5 +215,32 @@ int main(int argc, const char* argv[])
     _test_multithreaded(argv[1], flags, false);
     _test_multithreaded(argv[1], flags, true);
 
+    // Test rapid enclave creation with the measurement cache in memory, then
+    // on disk. Only the first enclave created with the cache, or the first
+    // ones created at once, are measured. The measurement is then found in
+    // process memory.
+    oe_measurement_cache_statistics_t statistics;
+
+    OE_TEST(oe_get_measurement_cache_statistics(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_get_measurement_cache_statistics(&statistics) == OE_OK);
+    OE_TEST(statistics.hits == 0 && statistics.misses == 0);
+
+    _use_measurement_cache(NULL);
+    _test_sequential(argv[1], flags, true);
+    _check_measurement_cache(flags, &statistics, MAX_ENCLAVES, 1);
+
+    OE_TEST(oe_get_measurement_cache_statistics(&statistics) == OE_OK);
+    _test_multithreaded(argv[1], flags, true);
+    _check_measurement_cache(flags, &statistics, MAX_THREADS, 0);
+
+    _use_measurement_cache(argv[2]);
+    OE_TEST(oe_get_measurement_cache_statistics(&statistics) == OE_OK);
+    _test_sequential(argv[1], flags, true);
+    _check_measurement_cache(flags, &statistics, MAX_ENCLAVES, 0);
+
+    OE_TEST(oe_get_measurement_cache_statistics(&statistics) == OE_OK);
+    _test_multithreaded(argv[1], flags, true);
+    _check_measurement_cache(flags, &statistics, MAX_THREADS, 0);
+
     return 0;
 }
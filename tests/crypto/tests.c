@@ -19,4 +19,8 @@ void TestAll()
     TestHMAC();
     TestKDF();
     TestSHA();
+#if defined(OE_BUILD_ENCLAVE) && defined(__x86_64__)
+    // Compare SHA-256 with and without the SHA extensions of the CPU.
+    TestSHAThroughput();
+#endif
 }
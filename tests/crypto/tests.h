@@ -12,6 +12,9 @@ void TestRandom(void);
 void TestCpuEntropy(void);
 void TestRSA(void);
 void TestSHA(void);
+#if defined(OE_BUILD_ENCLAVE) && defined(__x86_64__)
+void TestSHAThroughput(void);
+#endif
 void TestHMAC(void);
 void TestAll();
 
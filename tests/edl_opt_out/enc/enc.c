@@ -11,6 +11,7 @@ void enc_edl_opt_out()
 {
     /* logging.edl */
     OE_TEST(oe_log_ocall(0, NULL) == OE_UNSUPPORTED);
+    OE_TEST(oe_log_ring_wake_ocall(NULL) == OE_UNSUPPORTED);
 
     /* epoll.edl */
     OE_TEST(oe_syscall_epoll_create1_ocall(NULL, 0) == OE_UNSUPPORTED);
@@ -22,8 +23,15 @@ void enc_edl_opt_out()
     /* fcntl.edl */
     OE_TEST(oe_syscall_read_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_write_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_read_shared_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_write_shared_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_readv_shared_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_writev_shared_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pread_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pwrite_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_fsync_ocall(NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_opendir_ocall(NULL, NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_readdir_ocall(NULL, 0, NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_rewinddir_ocall(0) == OE_UNSUPPORTED);
@@ -71,6 +79,10 @@ void enc_edl_opt_out()
         OE_UNSUPPORTED);
     OE_TEST(oe_syscall_recvv_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_sendv_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_recvv_shared_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_sendv_shared_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_shutdown_ocall(NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(
         oe_syscall_setsockopt_ocall(NULL, 0, 0, 0, NULL, 0) == OE_UNSUPPORTED);
@@ -165,6 +177,11 @@ void enc_edl_opt_out()
             oe_get_qetarget_info_ocall(&result, NULL, NULL, 0, NULL) ==
             OE_UNSUPPORTED);
         OE_TEST(result == OE_UNSUPPORTED);
+        result = OE_OK;
+        OE_TEST(
+            oe_get_quotes_ocall(&result, NULL, NULL, 0, NULL, 0, NULL, NULL) ==
+            OE_UNSUPPORTED);
+        OE_TEST(result == OE_UNSUPPORTED);
     }
 #endif
 }
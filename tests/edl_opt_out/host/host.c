@@ -35,6 +35,9 @@ int main(int argc, const char* argv[])
 
     /* logging.edl */
     OE_TEST(oe_log_init_ecall(NULL, NULL, 0) == OE_UNSUPPORTED);
+    result = OE_OK;
+    OE_TEST(oe_log_init_ring_ecall(NULL, &result, NULL) == OE_UNSUPPORTED);
+    OE_TEST(result == OE_UNSUPPORTED);
 
 #if __x86_64__ || _M_X64
 #if defined(_WIN32)
@@ -66,12 +69,17 @@ int main(int argc, const char* argv[])
     /* sgx/switchless.edl */
     result = OE_OK;
     OE_TEST(
-        oe_sgx_init_context_switchless_ecall(NULL, &result, NULL, 0) ==
+        oe_sgx_init_context_switchless_ecall(NULL, &result, NULL, 0, NULL) ==
         OE_UNSUPPORTED);
     OE_TEST(result == OE_UNSUPPORTED);
     OE_TEST(
         oe_sgx_switchless_enclave_worker_thread_ecall(NULL, NULL) ==
         OE_UNSUPPORTED);
+    result = OE_OK;
+    OE_TEST(
+        oe_sgx_get_arena_statistics_ecall(NULL, &result, NULL, 0, NULL) ==
+        OE_UNSUPPORTED);
+    OE_TEST(result == OE_UNSUPPORTED);
 #endif
 
     result = oe_terminate_enclave(enclave);
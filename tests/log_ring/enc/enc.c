@@ -0,0 +1,32 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/trace.h>
+#include "log_ring_t.h"
+
+void enc_log(int count)
+{
+    for (int i = 0; i < count; i++)
+        oe_log(OE_LOG_LEVEL_ERROR, "log ring message %d\n", i);
+}
+
+void enc_log_and_abort(void)
+{
+    oe_log(OE_LOG_LEVEL_ERROR, "log ring before abort\n");
+    oe_abort();
+}
+
+// Logged by the destructor ECALL of oe_terminate_enclave().
+__attribute__((destructor)) static void _log_at_exit(void)
+{
+    oe_log(OE_LOG_LEVEL_ERROR, "log ring at exit\n");
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    1024, /* NumStackPages */
+    2);   /* NumTCS */
@@ -0,0 +1,284 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <openenclave/internal/trace.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "log_ring_u.h"
+
+#define SKIP_RETURN_CODE 2
+
+#define MESSAGE_PREFIX "log ring message "
+
+// Time to wait for the drain thread of the log ring to deliver messages
+static const std::chrono::seconds _timeout(10);
+
+struct log_state_t
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    // Indices of the "log ring message" messages, in the order received
+    std::vector<int> messages;
+
+    // Number of messages the host reported as dropped
+    unsigned long long dropped = 0;
+
+    bool at_exit = false;
+    bool before_abort = false;
+
+    // Whether the callback blocks on the next "log ring message" message,
+    // which stalls the drain thread, and whether it is blocked
+    bool block = false;
+    bool blocked = false;
+};
+
+static log_state_t _state;
+
+static void _log_callback(
+    void* context,
+    bool is_enclave,
+    const char* time,
+    long int usecs,
+    oe_log_level_t level,
+    const char* message)
+{
+    log_state_t* state = (log_state_t*)context;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    const char* p;
+    unsigned long long dropped;
+
+    OE_UNUSED(time);
+    OE_UNUSED(usecs);
+    OE_UNUSED(level);
+
+    if (!is_enclave)
+    {
+        if ((p = strstr(message, "dropped ")) &&
+            sscanf(p, "dropped %llu", &dropped) == 1)
+            state->dropped += dropped;
+    }
+    else if ((p = strstr(message, MESSAGE_PREFIX)))
+    {
+        state->messages.push_back(atoi(p + strlen(MESSAGE_PREFIX)));
+
+        if (state->block)
+        {
+            state->blocked = true;
+            state->cond.notify_all();
+            state->cond.wait(lock, [state] { return !state->block; });
+            state->blocked = false;
+        }
+    }
+    else if (strstr(message, "log ring at exit"))
+    {
+        state->at_exit = true;
+    }
+    else if (strstr(message, "log ring before abort"))
+    {
+        state->before_abort = true;
+    }
+
+    state->cond.notify_all();
+}
+
+static void _reset_state(void)
+{
+    std::lock_guard<std::mutex> lock(_state.mutex);
+
+    _state.messages.clear();
+    _state.dropped = 0;
+}
+
+// Wait until count messages and the given number of dropped messages have
+// been reported
+static bool _wait_for_messages(size_t count, unsigned long long dropped)
+{
+    std::unique_lock<std::mutex> lock(_state.mutex);
+
+    return _state.cond.wait_for(lock, _timeout, [count, dropped] {
+        return _state.messages.size() >= count && _state.dropped >= dropped;
+    });
+}
+
+static void _test_in_order(oe_enclave_t* enclave)
+{
+    _reset_state();
+
+    // A ring that starts empty holds all these messages.
+    OE_TEST(enc_log(enclave, LOG_RING_CAPACITY) == OE_OK);
+    OE_TEST(_wait_for_messages(LOG_RING_CAPACITY, 0));
+
+    std::lock_guard<std::mutex> lock(_state.mutex);
+    OE_TEST(_state.messages.size() == LOG_RING_CAPACITY);
+    OE_TEST(_state.dropped == 0);
+
+    for (int i = 0; i < LOG_RING_CAPACITY; i++)
+        OE_TEST(_state.messages[(size_t)i] == i);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void _test_wake(oe_enclave_t* enclave)
+{
+    // The drain thread goes to sleep once the ring is empty, and the enclave
+    // must wake it for each message logged after that.
+    for (int i = 0; i < 4; i++)
+    {
+        _reset_state();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        OE_TEST(enc_log(enclave, 1) == OE_OK);
+        OE_TEST(_wait_for_messages(1, 0));
+    }
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void _test_dropped(oe_enclave_t* enclave)
+{
+    _reset_state();
+
+    // Stall the drain thread in the callback of a first message. The drain
+    // thread frees the entry of a message before delivering it, so the whole
+    // ring is free for the next messages.
+    {
+        std::unique_lock<std::mutex> lock(_state.mutex);
+        _state.block = true;
+    }
+
+    OE_TEST(enc_log(enclave, 1) == OE_OK);
+
+    {
+        std::unique_lock<std::mutex> lock(_state.mutex);
+        OE_TEST(_state.cond.wait_for(
+            lock, _timeout, [] { return _state.blocked; }));
+    }
+
+    // Fill the ring and overflow it. The enclave does not wait for the host.
+    OE_TEST(enc_log(enclave, LOG_RING_CAPACITY + LOG_RING_OVERFLOW) == OE_OK);
+
+    {
+        std::unique_lock<std::mutex> lock(_state.mutex);
+        _state.block = false;
+        _state.cond.notify_all();
+    }
+
+    OE_TEST(_wait_for_messages(1 + LOG_RING_CAPACITY, LOG_RING_OVERFLOW));
+
+    std::lock_guard<std::mutex> lock(_state.mutex);
+    OE_TEST(_state.messages.size() == 1 + LOG_RING_CAPACITY);
+    OE_TEST(_state.dropped == LOG_RING_OVERFLOW);
+
+    // The messages that found the ring full are the ones dropped.
+    OE_TEST(_state.messages[0] == 0);
+    for (int i = 0; i < LOG_RING_CAPACITY; i++)
+        OE_TEST(_state.messages[1 + (size_t)i] == i);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void _test_flush_on_terminate(oe_enclave_t* enclave)
+{
+    // The destructor of the enclave logs a message, which the host must have
+    // drained by the time oe_terminate_enclave() returns.
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    std::lock_guard<std::mutex> lock(_state.mutex);
+    OE_TEST(_state.at_exit);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void _test_flush_on_abort(oe_enclave_t* enclave)
+{
+    oe_result_t result;
+
+    // The message logged before the enclave aborted must have been drained
+    // by the time the ECALL returns.
+    result = enc_log_and_abort(enclave);
+    OE_TEST(result == OE_ENCLAVE_ABORTING);
+
+    {
+        std::lock_guard<std::mutex> lock(_state.mutex);
+        OE_TEST(_state.before_abort);
+    }
+
+    // There are no guarantees that all memory is freed after the enclave has
+    // been aborted.
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK || result == OE_MEMORY_LEAK);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    // The log ring is only set up for debug enclaves.
+    if ((flags & OE_ENCLAVE_FLAG_DEBUG) == 0)
+        return SKIP_RETURN_CODE;
+
+    // The log ring is only set up by default at the INFO and VERBOSE levels.
+#if defined(_WIN32)
+    OE_TEST(_putenv_s("OE_LOG_RING", "1") == 0);
+#else
+    OE_TEST(setenv("OE_LOG_RING", "1", 1) == 0);
+#endif
+
+    OE_TEST(oe_log_set_callback(&_state, _log_callback) == OE_OK);
+
+    if ((result = oe_create_log_ring_enclave(
+             argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave)) !=
+        OE_OK)
+        oe_put_err("oe_create_log_ring_enclave(): result=%u", result);
+
+    // The enclave does not log messages of the error level below this level.
+    if (oe_get_current_logging_level() < OE_LOG_LEVEL_ERROR)
+    {
+        oe_terminate_enclave(enclave);
+        return SKIP_RETURN_CODE;
+    }
+
+    _test_in_order(enclave);
+    _test_wake(enclave);
+
+    // The drain thread stalls in the callback with the log lock of the host
+    // held, so the host must not log meanwhile.
+    if (oe_get_current_logging_level() <= OE_LOG_LEVEL_WARNING)
+        _test_dropped(enclave);
+
+    _test_flush_on_terminate(enclave);
+
+    if ((result = oe_create_log_ring_enclave(
+             argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave)) !=
+        OE_OK)
+        oe_put_err("oe_create_log_ring_enclave(): result=%u", result);
+
+    _test_flush_on_abort(enclave);
+
+    OE_TEST(oe_log_set_callback(NULL, NULL) == OE_OK);
+
+    printf("=== passed all tests (log_ring)\n");
+
+    return 0;
+}
@@ -90,6 +90,24 @@ uint64_t enc_test_my_ocall()
     return ret_val;
 }
 
+// Make OCALLs whose parameters do not fit in the default OCALL buffer.
+void enc_test_large_ocall(size_t size, size_t count)
+{
+    uint8_t* buffer = (uint8_t*)oe_malloc(size);
+    uint64_t sum = 0;
+
+    OE_TEST(buffer != NULL);
+    memset(buffer, 1, size);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_TEST(host_large_ocall(&sum, buffer, size) == OE_OK);
+        OE_TEST(sum == size);
+    }
+
+    oe_free(buffer);
+}
+
 void enc_test_reentrancy()
 {
     oe_result_t result = host_test_reentrancy();
@@ -22,6 +22,53 @@ void host_func2(const unsigned char*)
     g_func2_ok = true;
 }
 
+uint64_t host_large_ocall(const void* buffer, size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += ((const uint8_t*)buffer)[i];
+
+    return sum;
+}
+
+#define LARGE_OCALL_SIZE (64 * 1024)
+#define LARGE_OCALL_COUNT 4
+
+// The parameters of OCALLs that do not fit in the OCALL buffer of the thread
+// are allocated with extra OCALLs until the host grows the buffer when the
+// ECALL returns.
+static void _test_large_ocalls(oe_enclave_t* enclave)
+{
+    oe_ocall_buffer_statistics_t before = {};
+    oe_ocall_buffer_statistics_t after = {};
+
+    OE_TEST(oe_get_ocall_buffer_statistics(enclave, &before) == OE_OK);
+    OE_TEST(
+        enc_test_large_ocall(enclave, LARGE_OCALL_SIZE, LARGE_OCALL_COUNT) ==
+        OE_OK);
+    OE_TEST(oe_get_ocall_buffer_statistics(enclave, &after) == OE_OK);
+
+    OE_TEST(
+        after.fallback_allocations ==
+        before.fallback_allocations + LARGE_OCALL_COUNT);
+    OE_TEST(after.fallback_bytes > before.fallback_bytes);
+    OE_TEST(after.buffer_grows == before.buffer_grows + 1);
+    OE_TEST(after.buffer_capacity > before.buffer_capacity);
+
+    // The single thread reuses the same TCS, whose buffer now fits.
+    before = after;
+    OE_TEST(
+        enc_test_large_ocall(enclave, LARGE_OCALL_SIZE, LARGE_OCALL_COUNT) ==
+        OE_OK);
+    OE_TEST(oe_get_ocall_buffer_statistics(enclave, &after) == OE_OK);
+    OE_TEST(after.fallback_allocations == before.fallback_allocations);
+    OE_TEST(after.buffer_grows == before.buffer_grows);
+
+    OE_TEST(oe_get_ocall_buffer_statistics(NULL, &after) != OE_OK);
+    OE_TEST(oe_get_ocall_buffer_statistics(enclave, NULL) != OE_OK);
+}
+
 static oe_enclave_t* g_enclave = NULL;
 static bool g_reentrancy_tested = false;
 void host_test_reentrancy()
@@ -116,6 +163,8 @@ int main(int argc, const char* argv[])
         OE_TEST(g_reentrancy_tested);
     }
 
+    _test_large_ocalls(enclave);
+
     oe_terminate_enclave(enclave);
 
     printf("=== passed all tests (%s)\n", argv[0]);
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <openenclave/enclave.h>
+#include <string.h>
 #include "pingpong_t.h"
 
 void Ping(const char* in, char* out, int out_length)
@@ -9,6 +10,11 @@ void Ping(const char* in, char* out, int out_length)
     Pong(in, out, out_length);
 }
 
+void Echo(const void* in, size_t in_size, void* out, size_t out_size)
+{
+    memcpy(out, in, in_size < out_size ? in_size : out_size);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -5,6 +5,7 @@
 #include <openenclave/host.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/types.h>
+#include <chrono>
 #include "pingpong_u.h"
 
 static bool got_pong = false;
@@ -28,6 +29,44 @@ void Pong(const char* in, char* out, int out_length)
 
 static char buf[128];
 
+#define ECHO_BUFFER_SIZE 2048
+#define ECHO_ITERATIONS 100000
+
+// Measure the latency of ECALLs that marshal request and response buffers of
+// a typical size.
+static void _measure_ecall_latency(oe_enclave_t* enclave)
+{
+    static uint8_t request[ECHO_BUFFER_SIZE];
+    static uint8_t response[ECHO_BUFFER_SIZE];
+
+    for (size_t i = 0; i < sizeof(request); i++)
+        request[i] = (uint8_t)i;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < ECHO_ITERATIONS; i++)
+    {
+        OE_TEST(
+            Echo(
+                enclave,
+                request,
+                sizeof(request),
+                response,
+                sizeof(response)) == OE_OK);
+    }
+
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+
+    OE_TEST(memcmp(request, response, sizeof(request)) == 0);
+
+    printf(
+        "ECALL with %d-byte buffers: %.2f us/call, %.0f calls/s\n",
+        ECHO_BUFFER_SIZE,
+        seconds.count() * 1e6 / ECHO_ITERATIONS,
+        ECHO_ITERATIONS / seconds.count());
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -57,6 +96,8 @@ int main(int argc, const char* argv[])
         return 1;
     }
 
+    _measure_ecall_latency(enclave);
+
     oe_terminate_enclave(enclave);
 
     if (!got_pong)
@@ -4,6 +4,7 @@
 #include "../common/tests.h"
 #include <openenclave/attestation/sgx/report.h>
 #include <openenclave/internal/crypto/cmac.h>
+#include <openenclave/internal/pem.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/tests.h>
@@ -16,9 +17,11 @@
 #include "../../../common/sgx/endorsements.h"
 #include "../../../common/sgx/qeidentity.h"
 #include "../../../common/sgx/quote.h"
+#include "../../../common/sgx/truststore.h"
 
 #include <time.h>
 #include <array>
+#include <vector>
 
 using namespace std;
 
@@ -1406,6 +1409,389 @@ void test_verify_report_with_collaterals()
     report_buffer_ptr = NULL;
 }
 
+/* Check that the parts of two SGX endorsements other than their creation
+ * datetime are equal. */
+static bool _equal_endorsements(
+    const uint8_t* endorsements1,
+    size_t endorsements1_size,
+    const uint8_t* endorsements2,
+    size_t endorsements2_size)
+{
+    oe_sgx_endorsements_t sgx_endorsements1;
+    oe_sgx_endorsements_t sgx_endorsements2;
+
+    OE_TEST(
+        oe_parse_sgx_endorsements(
+            (const oe_endorsements_t*)endorsements1,
+            endorsements1_size,
+            &sgx_endorsements1) == OE_OK);
+    OE_TEST(
+        oe_parse_sgx_endorsements(
+            (const oe_endorsements_t*)endorsements2,
+            endorsements2_size,
+            &sgx_endorsements2) == OE_OK);
+
+    for (uint32_t i = 0; i < OE_SGX_ENDORSEMENT_FIELD_CREATION_DATETIME; i++)
+    {
+        if (sgx_endorsements1.items[i].size !=
+                sgx_endorsements2.items[i].size ||
+            memcmp(
+                sgx_endorsements1.items[i].data,
+                sgx_endorsements2.items[i].data,
+                sgx_endorsements1.items[i].size) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+void test_collateral_cache()
+{
+    uint32_t flags = OE_REPORT_FLAGS_REMOTE_ATTESTATION;
+    size_t report_size;
+    uint8_t* report = NULL;
+    uint8_t* collaterals[3] = {NULL};
+    size_t collaterals_size[3] = {0};
+    oe_sgx_collateral_cache_stats_t stats;
+    oe_sgx_collateral_cache_stats_t previous;
+
+    OE_TEST(
+        GetReport_v2(flags, NULL, 0, NULL, 0, &report, &report_size) ==
+        OE_OK);
+
+    OE_TEST(oe_sgx_get_collateral_cache_stats(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_sgx_invalidate_collateral_cache() == OE_OK);
+    OE_TEST(oe_sgx_get_collateral_cache_stats(&previous) == OE_OK);
+    OE_TEST(previous.entries == 0);
+
+    // The first fetch misses the empty cache.
+    if (GetCollaterals(&collaterals[0], &collaterals_size[0]) != OE_OK)
+        goto done;
+
+    OE_TEST(oe_sgx_get_collateral_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.misses == previous.misses + 1);
+    OE_TEST(stats.hits == previous.hits);
+
+    // Collateral that expired already is not cached.
+    if (stats.entries == 1)
+    {
+        // The second fetch is served from the cache.
+        previous = stats;
+        OE_TEST(
+            GetCollaterals(&collaterals[1], &collaterals_size[1]) == OE_OK);
+        OE_TEST(oe_sgx_get_collateral_cache_stats(&stats) == OE_OK);
+        OE_TEST(stats.hits == previous.hits + 1);
+        OE_TEST(stats.misses == previous.misses);
+        OE_TEST(_equal_endorsements(
+            collaterals[0],
+            collaterals_size[0],
+            collaterals[1],
+            collaterals_size[1]));
+
+        OE_TEST(
+            VerifyReportWithCollaterals(
+                report,
+                report_size,
+                collaterals[1],
+                collaterals_size[1],
+                NULL,
+                NULL) == OE_OK);
+    }
+
+    // The fetch after invalidating the cache misses again.
+    OE_TEST(oe_sgx_invalidate_collateral_cache() == OE_OK);
+    OE_TEST(oe_sgx_get_collateral_cache_stats(&previous) == OE_OK);
+    OE_TEST(previous.entries == 0);
+    OE_TEST(GetCollaterals(&collaterals[2], &collaterals_size[2]) == OE_OK);
+    OE_TEST(oe_sgx_get_collateral_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.misses == previous.misses + 1);
+    OE_TEST(_equal_endorsements(
+        collaterals[0],
+        collaterals_size[0],
+        collaterals[2],
+        collaterals_size[2]));
+
+    // Verifying without collaterals fetches them through the cache.
+    OE_TEST(
+        VerifyReportWithCollaterals(report, report_size, NULL, 0, NULL, NULL) ==
+        OE_OK);
+
+done:
+    for (size_t i = 0; i < OE_COUNTOF(collaterals); i++)
+        oe_free_collaterals(collaterals[i]);
+
+    oe_free_report(report);
+}
+
+void test_verified_quote_cache()
+{
+    uint32_t flags = OE_REPORT_FLAGS_REMOTE_ATTESTATION;
+    size_t report_size;
+    uint8_t* report = NULL;
+    uint8_t* collaterals = NULL;
+    size_t collaterals_size = 0;
+    oe_sgx_verified_quote_cache_stats_t stats;
+    oe_sgx_verified_quote_cache_stats_t previous;
+
+    OE_TEST(
+        GetReport_v2(flags, NULL, 0, NULL, 0, &report, &report_size) ==
+        OE_OK);
+
+    OE_TEST(
+        oe_sgx_get_verified_quote_cache_stats(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_sgx_set_verified_quote_cache_size(OE_SIZE_MAX) ==
+        OE_INVALID_PARAMETER);
+
+    // The cache is disabled by default.
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&previous) == OE_OK);
+    OE_TEST(
+        VerifyReportWithCollaterals(report, report_size, NULL, 0, NULL, NULL) ==
+        OE_OK);
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.hits == previous.hits && stats.misses == previous.misses);
+    OE_TEST(stats.entries == 0);
+
+    OE_TEST(oe_sgx_set_verified_quote_cache_size(4) == OE_OK);
+
+    if (GetCollaterals(&collaterals, &collaterals_size) != OE_OK)
+        goto done;
+
+    // The first verification misses the empty cache.
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&previous) == OE_OK);
+    OE_TEST(
+        VerifyReportWithCollaterals(
+            report, report_size, collaterals, collaterals_size, NULL, NULL) ==
+        OE_OK);
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.misses == previous.misses + 1);
+    OE_TEST(stats.hits == previous.hits);
+
+    // A quote whose validity period ended already is not cached.
+    if (stats.entries == 1)
+    {
+        oe_datetime_t valid_from = {0};
+        oe_datetime_t valid_until = {0};
+
+        // The second verification is served from the cache, and still
+        // checks the validation time against the validity period.
+        previous = stats;
+        OE_TEST(
+            VerifyReportWithCollaterals(
+                report,
+                report_size,
+                collaterals,
+                collaterals_size,
+                NULL,
+                NULL) == OE_OK);
+        OE_TEST(
+            GetQuoteValidityWithCollaterals(
+                report,
+                report_size,
+                collaterals,
+                collaterals_size,
+                &valid_from,
+                &valid_until) == OE_OK);
+
+        valid_until.year += 1;
+        OE_TEST(
+            VerifyReportWithCollaterals(
+                report,
+                report_size,
+                collaterals,
+                collaterals_size,
+                &valid_until,
+                NULL) == OE_VERIFY_FAILED_TO_FIND_VALIDITY_PERIOD);
+
+        OE_TEST(oe_sgx_get_verified_quote_cache_stats(&stats) == OE_OK);
+        OE_TEST(stats.hits == previous.hits + 2);
+        OE_TEST(stats.misses == previous.misses);
+    }
+
+    // The verification after invalidating the cache misses again.
+    OE_TEST(oe_sgx_invalidate_verified_quote_cache() == OE_OK);
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&previous) == OE_OK);
+    OE_TEST(previous.entries == 0);
+    OE_TEST(
+        VerifyReportWithCollaterals(
+            report, report_size, collaterals, collaterals_size, NULL, NULL) ==
+        OE_OK);
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.misses == previous.misses + 1);
+
+done:
+    OE_TEST(oe_sgx_set_verified_quote_cache_size(0) == OE_OK);
+    OE_TEST(oe_sgx_get_verified_quote_cache_stats(&stats) == OE_OK);
+    OE_TEST(stats.entries == 0);
+
+    oe_free_collaterals(collaterals);
+    oe_free_report(report);
+}
+
+/* Copy PEM data, which ends with a null character, with count newlines
+ * inserted before the null character. The trust store keys the copy as a
+ * different chain. */
+static vector<uint8_t> _pem_variant(
+    const uint8_t* data,
+    size_t size,
+    size_t count)
+{
+    vector<uint8_t> variant(data, data + size - 1);
+
+    variant.insert(variant.end(), count, '\n');
+    variant.push_back('\0');
+    return variant;
+}
+
+/* Copy PEM data with a character of the signature of its first certificate
+ * changed, so that the certificate no longer verifies against its issuer. */
+static vector<uint8_t> _tampered_pem(const uint8_t* data, size_t size)
+{
+    vector<uint8_t> tampered(data, data + size);
+    const char* end =
+        strstr((const char*)tampered.data(), OE_PEM_END_CERTIFICATE);
+    size_t pos = 0;
+    size_t skipped = 0;
+
+    OE_TEST(end != NULL);
+    pos = (size_t)(end - (const char*)tampered.data());
+
+    // Skip the newlines and padding at the end of the base64 data, and a few
+    // characters that may encode the last bits only.
+    while (skipped < 8)
+    {
+        OE_TEST(pos > 0);
+        pos--;
+
+        if (tampered[pos] != '\n' && tampered[pos] != '\r' &&
+            tampered[pos] != '=')
+            skipped++;
+    }
+
+    tampered[pos] = tampered[pos] == 'A' ? 'B' : 'A';
+    return tampered;
+}
+
+void test_trust_store()
+{
+    uint8_t* collaterals = NULL;
+    size_t collaterals_size = 0;
+    oe_sgx_endorsements_t endorsements;
+    oe_sgx_trust_store_stats_t stats;
+    oe_sgx_trust_store_stats_t previous;
+    oe_cert_chain_t* chains[2] = {NULL};
+    oe_cert_chain_t* chain = NULL;
+    oe_crl_t* crls[2] = {NULL};
+    size_t length = 0;
+
+    OE_TEST(oe_sgx_trust_store_get_stats(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_sgx_trust_store_get_cert_chain(NULL, 0, &chain) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_sgx_trust_store_get_crl(NULL, 0, &crls[0]) == OE_INVALID_PARAMETER);
+
+    if (GetCollaterals(&collaterals, &collaterals_size) != OE_OK)
+        goto done;
+
+    OE_TEST(
+        oe_parse_sgx_endorsements(
+            (const oe_endorsements_t*)collaterals,
+            collaterals_size,
+            &endorsements) == OE_OK);
+
+    {
+        const oe_sgx_endorsement_item& issuer_chain =
+            endorsements.items[OE_SGX_ENDORSEMENT_FIELD_TCB_ISSUER_CHAIN];
+        const oe_sgx_endorsement_item& crl =
+            endorsements.items[OE_SGX_ENDORSEMENT_FIELD_CRL_PCK_CERT];
+        vector<uint8_t> variant =
+            _pem_variant(issuer_chain.data, issuer_chain.size, 1);
+        vector<uint8_t> tampered =
+            _tampered_pem(issuer_chain.data, issuer_chain.size);
+
+        // The first lookup of a chain reads it, and the next ones find the
+        // same chain in the store.
+        OE_TEST(oe_sgx_trust_store_get_stats(&previous) == OE_OK);
+        OE_TEST(
+            oe_sgx_trust_store_get_cert_chain(
+                variant.data(), variant.size(), &chains[0]) == OE_OK);
+        OE_TEST(
+            oe_sgx_trust_store_get_cert_chain(
+                variant.data(), variant.size(), &chains[1]) == OE_OK);
+        OE_TEST(chains[0] == chains[1]);
+        OE_TEST(oe_sgx_trust_store_get_stats(&stats) == OE_OK);
+        OE_TEST(stats.misses == previous.misses + 1);
+        OE_TEST(stats.hits == previous.hits + 1);
+        oe_sgx_trust_store_release_cert_chain(chains[1]);
+        chains[1] = NULL;
+
+        // So do the CRLs.
+        OE_TEST(
+            oe_sgx_trust_store_get_crl(crl.data, crl.size, &crls[0]) == OE_OK);
+        OE_TEST(
+            oe_sgx_trust_store_get_crl(crl.data, crl.size, &crls[1]) == OE_OK);
+        OE_TEST(crls[0] == crls[1]);
+        OE_TEST(oe_sgx_trust_store_get_stats(&stats) == OE_OK);
+        OE_TEST(stats.crls > 0);
+
+        // Once the store is full, adding chains drops the least recently
+        // used ones. A chain dropped while in use stays valid until it is
+        // released.
+        previous = stats;
+
+        for (size_t i = 2; i < OE_SGX_TRUST_STORE_MAX_ENTRIES + 2; i++)
+        {
+            vector<uint8_t> other =
+                _pem_variant(issuer_chain.data, issuer_chain.size, i);
+
+            OE_TEST(
+                oe_sgx_trust_store_get_cert_chain(
+                    other.data(), other.size(), &chain) == OE_OK);
+            oe_sgx_trust_store_release_cert_chain(chain);
+            chain = NULL;
+        }
+
+        OE_TEST(oe_sgx_trust_store_get_stats(&stats) == OE_OK);
+        OE_TEST(stats.chains == OE_SGX_TRUST_STORE_MAX_ENTRIES);
+        OE_TEST(stats.evictions > previous.evictions);
+        OE_TEST(
+            stats.misses == previous.misses + OE_SGX_TRUST_STORE_MAX_ENTRIES);
+        OE_TEST(oe_cert_chain_get_length(chains[0], &length) == OE_OK);
+        OE_TEST(length > 0);
+
+        previous = stats;
+        OE_TEST(
+            oe_sgx_trust_store_get_cert_chain(
+                variant.data(), variant.size(), &chains[1]) == OE_OK);
+        OE_TEST(chains[1] != chains[0]);
+        OE_TEST(oe_sgx_trust_store_get_stats(&stats) == OE_OK);
+        OE_TEST(stats.misses == previous.misses + 1);
+
+        // A chain that does not verify is rejected and not stored.
+        previous = stats;
+        OE_TEST(
+            oe_sgx_trust_store_get_cert_chain(
+                tampered.data(), tampered.size(), &chain) != OE_OK);
+        OE_TEST(
+            oe_sgx_trust_store_get_cert_chain(
+                tampered.data(), tampered.size(), &chain) != OE_OK);
+        OE_TEST(oe_sgx_trust_store_get_stats(&stats) == OE_OK);
+        OE_TEST(stats.misses == previous.misses + 2);
+        OE_TEST(stats.hits == previous.hits);
+        OE_TEST(stats.chains == previous.chains);
+    }
+
+done:
+    for (size_t i = 0; i < OE_COUNTOF(chains); i++)
+        oe_sgx_trust_store_release_cert_chain(chains[i]);
+
+    for (size_t i = 0; i < OE_COUNTOF(crls); i++)
+        oe_sgx_trust_store_release_crl(crls[i]);
+
+    oe_free_collaterals(collaterals);
+}
+
 void test_get_signer_id_from_public_key()
 {
     static const char pem[] =
@@ -26,6 +26,9 @@ void test_parse_report_negative();
 void test_local_verify_report();
 void test_remote_verify_report();
 void test_verify_report_with_collaterals();
+void test_collateral_cache();
+void test_verified_quote_cache();
+void test_trust_store();
 void test_get_signer_id_from_public_key();
 
 #endif
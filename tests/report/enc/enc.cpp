@@ -3,15 +3,34 @@
 #include <openenclave/bits/sgx/sgxtypes.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/sgx/plugin.h>
+#include <openenclave/internal/sgx/quotestats.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/utils.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "../../../common/sgx/quote.h"
 #include "../../../common/sgx/tcbinfo.h"
 #include "../common/tests.h"
 #include "tests_t.h"
 
+#ifdef OE_LINK_SGX_DCAP_QL
+extern "C" oe_result_t oe_get_remote_report(
+    const oe_uuid_t* format_id,
+    const uint8_t* report_data,
+    size_t report_data_size,
+    const void* opt_params,
+    size_t opt_params_size,
+    uint8_t* report_buffer,
+    size_t* report_buffer_size);
+
+static const oe_uuid_t _ecdsa_uuid = {OE_FORMAT_UUID_SGX_ECDSA_P256};
+
+/* Quote stats when enclave_test_quote_batching_begin() was called */
+static oe_sgx_quote_stats_t _batching_stats;
+#endif
+
 oe_result_t test_verify_tcb_info(
     const char* tcb_info,
     oe_tcb_info_tcb_level_t* platform_tcb_level,
@@ -137,15 +156,161 @@ void enclave_test_verify_report_with_collaterals()
     test_verify_report_with_collaterals();
 }
 
+void enclave_test_collateral_cache()
+{
+    test_collateral_cache();
+}
+
+void enclave_test_verified_quote_cache()
+{
+    test_verified_quote_cache();
+}
+
+void enclave_test_trust_store()
+{
+    test_trust_store();
+}
+
 void enclave_test_get_signer_id_from_public_key()
 {
     test_get_signer_id_from_public_key();
 }
 
+void enclave_test_quote_batching_begin()
+{
+#ifdef OE_LINK_SGX_DCAP_QL
+    OE_TEST(oe_sgx_get_quote_stats(&_batching_stats) == OE_OK);
+#endif
+}
+
+/*
+ * Get quotes for distinct report data from several threads at once, so that
+ * they are requested from the host in batches. The threads supply buffers of
+ * different sizes, some larger than the maximum size of a report, which must
+ * not change where each quote is read from in the batch.
+ */
+void enclave_test_quote_batching(uint32_t thread_index, uint32_t iterations)
+{
+#ifdef OE_LINK_SGX_DCAP_QL
+    uint8_t report_data[sizeof(sgx_report_data_t)] = {0};
+    uint8_t* buffer = NULL;
+    size_t buffer_size = 0;
+    size_t quote_size = 0;
+
+    OE_TEST(
+        oe_get_remote_report(
+            &_ecdsa_uuid, NULL, 0, NULL, 0, NULL, &quote_size) ==
+        OE_BUFFER_TOO_SMALL);
+
+    switch (thread_index % 3)
+    {
+        case 0:
+            buffer_size = quote_size;
+            break;
+        case 1:
+            buffer_size = 2 * quote_size;
+            break;
+        default:
+            buffer_size = 2 * OE_MAX_REPORT_SIZE;
+            break;
+    }
+
+    buffer = (uint8_t*)malloc(buffer_size);
+    OE_TEST(buffer != NULL);
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        size_t size = buffer_size;
+        const sgx_quote_t* quote = (const sgx_quote_t*)buffer;
+
+        memcpy(report_data, &thread_index, sizeof(thread_index));
+        memcpy(report_data + sizeof(thread_index), &i, sizeof(i));
+        memset(buffer, 0, buffer_size);
+
+        OE_TEST(
+            oe_get_remote_report(
+                &_ecdsa_uuid,
+                report_data,
+                sizeof(report_data),
+                NULL,
+                0,
+                buffer,
+                &size) == OE_OK);
+        OE_TEST(size == quote_size);
+        OE_TEST(
+            memcmp(
+                &quote->report_body.report_data,
+                report_data,
+                sizeof(report_data)) == 0);
+    }
+
+    free(buffer);
+#else
+    OE_UNUSED(thread_index);
+    OE_UNUSED(iterations);
+#endif
+}
+
+void enclave_test_quote_batching_end(uint32_t quotes)
+{
+#ifdef OE_LINK_SGX_DCAP_QL
+    oe_sgx_quote_stats_t stats;
+
+    OE_TEST(oe_sgx_get_quote_stats(&stats) == OE_OK);
+
+    OE_TEST(stats.quotes - _batching_stats.quotes == quotes);
+    OE_TEST(
+        stats.quote_calls - _batching_stats.quote_calls <=
+        stats.quotes - _batching_stats.quotes);
+
+    printf(
+        "enclave_test_quote_batching: %llu quotes in %llu OCALLs\n",
+        (unsigned long long)(stats.quotes - _batching_stats.quotes),
+        (unsigned long long)(stats.quote_calls - _batching_stats.quote_calls));
+#else
+    OE_UNUSED(quotes);
+#endif
+}
+
+/*
+ * The target info of the QE is fetched from the host once and reused by the
+ * following reports.
+ */
+void enclave_test_qe_target_info_cache()
+{
+#ifdef OE_LINK_SGX_DCAP_QL
+    oe_sgx_quote_stats_t previous;
+    oe_sgx_quote_stats_t stats;
+    uint8_t buffer[OE_MAX_REPORT_SIZE];
+    size_t size = sizeof(buffer);
+
+    OE_TEST(oe_sgx_get_quote_stats(NULL) == OE_INVALID_PARAMETER);
+
+    OE_TEST(oe_sgx_get_quote_stats(&previous) == OE_OK);
+    OE_TEST(
+        oe_get_remote_report(
+            &_ecdsa_uuid, NULL, 0, NULL, 0, buffer, &size) == OE_OK);
+    OE_TEST(oe_sgx_get_quote_stats(&stats) == OE_OK);
+    OE_TEST(
+        stats.target_info_fetches + stats.target_info_hits ==
+        previous.target_info_fetches + previous.target_info_hits + 1);
+    OE_TEST(stats.quote_calls == previous.quote_calls + 1);
+
+    previous = stats;
+    size = sizeof(buffer);
+    OE_TEST(
+        oe_get_remote_report(
+            &_ecdsa_uuid, NULL, 0, NULL, 0, buffer, &size) == OE_OK);
+    OE_TEST(oe_sgx_get_quote_stats(&stats) == OE_OK);
+    OE_TEST(stats.target_info_fetches == previous.target_info_fetches);
+    OE_TEST(stats.target_info_hits == previous.target_info_hits + 1);
+#endif
+}
+
 OE_SET_ENCLAVE_SGX(
     0,    /* ProductID */
     0,    /* SecurityVersion */
     true, /* Debug */
     1024, /* NumHeapPages */
     1024, /* NumStackPages */
-    2);   /* NumTCS */
+    8);   /* NumTCS */
@@ -6,9 +6,11 @@
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/sgx/plugin.h>
+#include <openenclave/internal/sgx/quotestats.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/utils.h>
 #include <ctime>
+#include <thread>
 #include <vector>
 #include "../../../common/sgx/tcbinfo.h"
 #include "../../../host/sgx/quote.h"
@@ -31,6 +33,9 @@ extern void TestVerifyTCBInfoV2(
 extern void TestVerifyTCBInfoV2_AdvisoryIDs(
     oe_enclave_t* enclave,
     const char* test_filename);
+extern void BenchmarkTCBInfoParsing(
+    const char* tcb_info_filename,
+    const char* qe_identity_filename);
 extern int FileToBytes(const char* path, std::vector<uint8_t>* output);
 
 void generate_and_save_report(oe_enclave_t* enclave)
@@ -79,6 +84,84 @@ int load_and_verify_report()
     return 0;
 }
 
+#ifdef OE_LINK_SGX_DCAP_QL
+
+#define QUOTE_BATCHING_THREADS 6
+#define QUOTE_BATCHING_ITERATIONS 8
+
+/* Request quotes from several enclave threads at once */
+static void test_quote_batching(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+
+    OE_TEST(enclave_test_quote_batching_begin(enclave) == OE_OK);
+
+    for (uint32_t i = 0; i < QUOTE_BATCHING_THREADS; i++)
+    {
+        threads.push_back(std::thread([enclave, i]() {
+            OE_TEST(
+                enclave_test_quote_batching(
+                    enclave, i, QUOTE_BATCHING_ITERATIONS) == OE_OK);
+        }));
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    OE_TEST(
+        enclave_test_quote_batching_end(
+            enclave, QUOTE_BATCHING_THREADS * QUOTE_BATCHING_ITERATIONS) ==
+        OE_OK);
+
+    printf("test_quote_batching passed.\n");
+}
+
+/*
+ * Creating an enclave with OE_ENCLAVE_SETTING_QUOTE_PRELOAD fetches the target
+ * info of the QE, so that the first report of the enclave finds it cached.
+ */
+static void test_quote_preload(const char* path, uint32_t flags)
+{
+    oe_enclave_t* enclave = NULL;
+    oe_enclave_setting_t setting;
+    oe_enclave_setting_quote_preload_t preload = {true};
+    oe_sgx_quote_stats_t previous;
+    oe_sgx_quote_stats_t stats;
+
+    setting.setting_type = OE_ENCLAVE_SETTING_QUOTE_PRELOAD;
+    setting.u.quote_preload_setting = NULL;
+    OE_TEST(
+        oe_create_tests_enclave(
+            path, OE_ENCLAVE_TYPE_SGX, flags, &setting, 1, &enclave) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(enclave == NULL);
+
+    OE_TEST(oe_sgx_get_quote_stats(&previous) == OE_OK);
+
+    setting.u.quote_preload_setting = &preload;
+    OE_TEST(
+        oe_create_tests_enclave(
+            path, OE_ENCLAVE_TYPE_SGX, flags, &setting, 1, &enclave) == OE_OK);
+
+    OE_TEST(oe_sgx_get_quote_stats(&stats) == OE_OK);
+    OE_TEST(
+        stats.target_info_fetches + stats.target_info_hits ==
+        previous.target_info_fetches + previous.target_info_hits + 1);
+
+    // The enclave fetches the target info from the host, which has it cached.
+    previous = stats;
+    OE_TEST(enclave_test_qe_target_info_cache(enclave) == OE_OK);
+    OE_TEST(oe_sgx_get_quote_stats(&stats) == OE_OK);
+    OE_TEST(stats.target_info_fetches == previous.target_info_fetches);
+    OE_TEST(stats.target_info_hits == previous.target_info_hits + 1);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("test_quote_preload passed.\n");
+}
+
+#endif
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -180,6 +263,12 @@ int main(int argc, const char* argv[])
 
     test_verify_report_with_collaterals();
 
+    test_collateral_cache();
+
+    test_verified_quote_cache();
+
+    test_trust_store();
+
     OE_TEST(test_iso8601_time(enclave) == OE_OK);
     OE_TEST(test_iso8601_time_negative(enclave) == OE_OK);
 
@@ -197,6 +286,18 @@ int main(int argc, const char* argv[])
 
     OE_TEST_CODE(enclave_test_verify_report_with_collaterals(enclave), OE_OK);
 
+    OE_TEST_CODE(enclave_test_collateral_cache(enclave), OE_OK);
+
+    OE_TEST_CODE(enclave_test_verified_quote_cache(enclave), OE_OK);
+
+    OE_TEST_CODE(enclave_test_trust_store(enclave), OE_OK);
+
+    OE_TEST_CODE(enclave_test_qe_target_info_cache(enclave), OE_OK);
+
+    test_quote_batching(enclave);
+
+    test_quote_preload(argv[1], flags);
+
     TestVerifyTCBInfo(enclave, "./data/tcbInfo.json");
     TestVerifyTCBInfo(enclave, "./data/tcbInfo_with_pceid.json");
 
@@ -204,6 +305,9 @@ int main(int argc, const char* argv[])
     TestVerifyTCBInfoV2(enclave, "./data_v2/tcbInfo_with_pceid.json");
     TestVerifyTCBInfoV2_AdvisoryIDs(
         enclave, "./data_v2/tcbInfoAdvisoryIds.json");
+
+    BenchmarkTCBInfoParsing(
+        "./data_v2/tcbInfo.json", "./data_v2/qe_identity_ok.json");
 #else
     test_local_report(&target_info);
     test_parse_report_negative();
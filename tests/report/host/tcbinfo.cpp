@@ -8,6 +8,7 @@
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/utils.h>
 
+#include <chrono>
 #include <fstream>
 #include <streambuf>
 #include <vector>
@@ -537,4 +538,117 @@ void TestVerifyTCBInfoV2_AdvisoryIDs(
                 advisoryIDs_length[i]) == 0);
     }
     printf("TCB Info V2 positive test, with advisoryIDs. PASSED\n");
-}
\ No newline at end of file
+}
+template <typename F>
+static double MicrosecondsPerIteration(int iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// Compare compiling the TCB info and QE identity on each verification with
+// looking up their cached compiled form, and with only matching the platform
+// against an already compiled form.
+void BenchmarkTCBInfoParsing(
+    const char* tcb_info_filename,
+    const char* qe_identity_filename)
+{
+    const int iterations = 10000;
+    std::vector<uint8_t> tcbInfo;
+    std::vector<uint8_t> qeIdentity;
+    oe_tcb_info_tcb_level_t platform_tcb_level = {
+        {4, 4, 2, 4, 1, 128, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, 8};
+    oe_qe_identity_info_tcb_level_t platform_qe_tcb_level = {{2}};
+    oe_parsed_tcb_info_t parsed_info;
+    oe_parsed_qe_identity_info_t parsed_qe_info;
+    oe_compiled_tcb_info_t* compiled_info = NULL;
+    oe_compiled_qe_identity_info_t* compiled_qe_info = NULL;
+
+    OE_TEST(FileToBytes(tcb_info_filename, &tcbInfo) == 0);
+    OE_TEST(FileToBytes(qe_identity_filename, &qeIdentity) == 0);
+
+    double compile = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_compile_tcb_info_json(
+                &tcbInfo[0], tcbInfo.size(), &compiled_info) == OE_OK);
+        OE_TEST(
+            oe_match_compiled_tcb_info(
+                compiled_info,
+                &tcbInfo[0],
+                &platform_tcb_level,
+                &parsed_info) == OE_OK);
+        oe_free_compiled_tcb_info(compiled_info);
+    });
+    double cached = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_parse_tcb_info_json(
+                &tcbInfo[0],
+                tcbInfo.size(),
+                &platform_tcb_level,
+                &parsed_info) == OE_OK);
+    });
+    OE_TEST(
+        oe_compile_tcb_info_json(
+            &tcbInfo[0], tcbInfo.size(), &compiled_info) == OE_OK);
+    double match = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_match_compiled_tcb_info(
+                compiled_info,
+                &tcbInfo[0],
+                &platform_tcb_level,
+                &parsed_info) == OE_OK);
+    });
+    oe_free_compiled_tcb_info(compiled_info);
+
+    printf(
+        "TCB info %s: compile %.2f us, cached %.2f us, match %.3f us\n",
+        tcb_info_filename,
+        compile,
+        cached,
+        match);
+
+    compile = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_compile_qe_identity_info_json(
+                &qeIdentity[0], qeIdentity.size(), &compiled_qe_info) ==
+            OE_OK);
+        OE_TEST(
+            oe_match_compiled_qe_identity_info(
+                compiled_qe_info,
+                &qeIdentity[0],
+                &platform_qe_tcb_level,
+                &parsed_qe_info) == OE_OK);
+        oe_free_compiled_qe_identity_info(compiled_qe_info);
+    });
+    cached = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_parse_qe_identity_info_json(
+                &qeIdentity[0],
+                qeIdentity.size(),
+                &platform_qe_tcb_level,
+                &parsed_qe_info) == OE_OK);
+    });
+    OE_TEST(
+        oe_compile_qe_identity_info_json(
+            &qeIdentity[0], qeIdentity.size(), &compiled_qe_info) == OE_OK);
+    match = MicrosecondsPerIteration(iterations, [&]() {
+        OE_TEST(
+            oe_match_compiled_qe_identity_info(
+                compiled_qe_info,
+                &qeIdentity[0],
+                &platform_qe_tcb_level,
+                &parsed_qe_info) == OE_OK);
+    });
+    oe_free_compiled_qe_identity_info(compiled_qe_info);
+
+    printf(
+        "QE identity %s: compile %.2f us, cached %.2f us, match %.3f us\n",
+        qe_identity_filename,
+        compile,
+        cached,
+        match);
+}
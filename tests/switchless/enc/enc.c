@@ -4,6 +4,7 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
+#include <openenclave/internal/switchless.h>
 #include <openenclave/internal/tests.h>
 #include <string.h>
 #include "switchless_test_t.h"
@@ -105,6 +106,80 @@ int enc_echo_regular(
     return 0;
 }
 
+uint64_t enc_add(uint64_t a, uint64_t b)
+{
+    return a + b;
+}
+
+int enc_consume_switchless(size_t size)
+{
+    static uint8_t buffer[ARENA_TEST_BUFFER_SIZE];
+    int return_val = -1;
+
+    if (size > sizeof(buffer))
+        return -1;
+
+    OE_TEST(host_consume_switchless(&return_val, buffer, size) == OE_OK);
+
+    return return_val;
+}
+
+int enc_test_arena_chunks(void)
+{
+    static uint8_t buffer[ARENA_TEST_BUFFER_SIZE];
+    oe_arena_statistics_t before;
+    oe_arena_statistics_t statistics;
+    int return_val = -1;
+
+    // The arena of this thread was released when its last ECALL returned,
+    // and the next switchless OCALL creates it with this capacity.
+    OE_TEST(oe_configure_arena_capacity(ARENA_TEST_CAPACITY));
+    OE_TEST(oe_get_arena_statistics(&before) == OE_OK);
+
+    // A small OCALL fits in the first buffer.
+    OE_TEST(host_consume_switchless(&return_val, buffer, 1) == OE_OK);
+    OE_TEST(return_val == 1);
+    OE_TEST(oe_get_arena_statistics(&statistics) == OE_OK);
+    OE_TEST(statistics.capacity == ARENA_TEST_CAPACITY);
+    OE_TEST(statistics.chunks_allocated == before.chunks_allocated);
+
+    // A larger one chains a chunk, which counts in the high-water mark.
+    OE_TEST(
+        host_consume_switchless(&return_val, buffer, sizeof(buffer)) ==
+        OE_OK);
+    OE_TEST(return_val == sizeof(buffer));
+    OE_TEST(oe_get_arena_statistics(&statistics) == OE_OK);
+    OE_TEST(statistics.capacity >= ARENA_TEST_CAPACITY + sizeof(buffer));
+    OE_TEST(statistics.high_water_mark >= sizeof(buffer));
+    OE_TEST(statistics.chunks_allocated == before.chunks_allocated + 1);
+    OE_TEST(statistics.failed_allocations == before.failed_allocations);
+
+    // The next one reuses the chunk.
+    OE_TEST(
+        host_consume_switchless(&return_val, buffer, sizeof(buffer)) ==
+        OE_OK);
+    OE_TEST(oe_get_arena_statistics(&statistics) == OE_OK);
+    OE_TEST(statistics.chunks_allocated == before.chunks_allocated + 1);
+    OE_TEST(statistics.chunks_released == before.chunks_released);
+
+    // The chunk is released once the arena has been reset enough times
+    // without using it.
+    for (int i = 0; i < ARENA_TEST_IDLE_CALLS; i++)
+    {
+        OE_TEST(host_consume_switchless(&return_val, buffer, 1) == OE_OK);
+        OE_TEST(return_val == 1);
+    }
+
+    OE_TEST(oe_get_arena_statistics(&statistics) == OE_OK);
+    OE_TEST(statistics.capacity == ARENA_TEST_CAPACITY);
+    OE_TEST(statistics.chunks_released == before.chunks_released + 1);
+
+    // Restore the default capacity.
+    OE_TEST(oe_configure_arena_capacity(1024 * 1024));
+
+    return 0;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,        /* ProductID */
     1,        /* SecurityVersion */
@@ -6,6 +6,7 @@
 #include <openenclave/host.h>
 #include <openenclave/internal/atomic.h>
 #include <openenclave/internal/error.h>
+#include <openenclave/internal/switchless.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,6 +20,14 @@
 #define NUM_OCALLS (100000)
 #define NUM_ECALLS (100000)
 
+#define NUM_QUEUED_ECALLS (100000)
+#define ECALL_QUEUE_CAPACITY (256)
+#define NUM_ECALL_QUEUE_POLLERS (4)
+#define POLLED_ECALL_QUEUE_CAPACITY (4)
+#define NUM_BATCHED_ECALLS (100000)
+#define ECALL_BATCH_SIZE (64)
+#define NUM_LONG_BATCH_ECALLS (4096)
+
 #define STRING_LEN 100
 #define STRING_HELLO "Hello World"
 #define ENCLAVE_PARAM_STRING "enclave string parameter"
@@ -26,6 +35,8 @@
 
 #if defined(__linux__)
 
+#include <poll.h>
+
 double get_relative_time_in_microseconds()
 {
     struct timespec current_time;
@@ -34,6 +45,12 @@ double get_relative_time_in_microseconds()
            (double)current_time.tv_nsec / 1000.0;
 }
 
+void wait_for_ecall_completions(intptr_t event)
+{
+    struct pollfd fd = {(int)event, POLLIN, 0};
+    OE_TEST(poll(&fd, 1, -1) == 1);
+}
+
 #elif defined(_WIN32)
 
 #include <Windows.h>
@@ -46,6 +63,11 @@ double get_relative_time_in_microseconds()
     return current_time.QuadPart / frequency;
 }
 
+void wait_for_ecall_completions(intptr_t event)
+{
+    OE_TEST(WaitForSingleObject((HANDLE)event, INFINITE) == WAIT_OBJECT_0);
+}
+
 #endif
 
 int host_echo_switchless(
@@ -76,6 +98,12 @@ int host_echo_regular(
     return 0;
 }
 
+int host_consume_switchless(const void* buffer, size_t size)
+{
+    OE_TEST(buffer != NULL);
+    return (int)size;
+}
+
 double make_repeated_switchless_ocalls(oe_enclave_t* enclave)
 {
     char out[STRING_LEN];
@@ -374,6 +402,422 @@ void test_switchless_ecalls(oe_enclave_t* enclave, uint64_t num_host_threads)
         (double)regular_microseconds / switchless_max);
 }
 
+// enc_add() is marshalled by hand as oeedger8r does, since the generated
+// wrappers wait for the ecalls to complete.
+typedef struct _queued_ecall
+{
+    enc_add_args_t in;
+    enc_add_args_t out;
+} queued_ecall_t;
+
+void test_ecall_queue(oe_enclave_t* enclave, size_t num_threads)
+{
+    oe_ecall_queue_t* queue = NULL;
+    oe_ecall_completion_t completions[64];
+    queued_ecall_t* calls = NULL;
+    size_t num_submitted = 0;
+    size_t num_completed = 0;
+    intptr_t event = 0;
+    double start, end;
+
+    calls = (queued_ecall_t*)calloc(NUM_QUEUED_ECALLS, sizeof(*calls));
+    OE_TEST(calls != NULL);
+
+    OE_TEST(
+        oe_create_ecall_queue(
+            enclave, num_threads, ECALL_QUEUE_CAPACITY, &queue) == OE_OK);
+    OE_TEST(oe_get_ecall_queue_event(queue, &event) == OE_OK);
+
+    start = get_relative_time_in_microseconds();
+
+    while (num_completed < NUM_QUEUED_ECALLS)
+    {
+        size_t count = OE_COUNTOF(completions);
+
+        // Keep the queue full.
+        while (num_submitted < NUM_QUEUED_ECALLS)
+        {
+            queued_ecall_t* call = &calls[num_submitted];
+            oe_result_t result;
+
+            call->in.a = num_submitted;
+            call->in.b = 1;
+            result = oe_submit_ecall(
+                queue,
+                switchless_test_fcn_id_enc_add,
+                &call->in,
+                sizeof(call->in),
+                &call->out,
+                sizeof(call->out),
+                call);
+            if (result == OE_BUSY)
+            {
+                OE_TEST(
+                    num_submitted - num_completed == ECALL_QUEUE_CAPACITY);
+                break;
+            }
+
+            OE_TEST(result == OE_OK);
+            num_submitted++;
+        }
+
+        OE_TEST(
+            oe_poll_ecall_completions(queue, completions, &count) == OE_OK);
+
+        if (count == 0)
+            wait_for_ecall_completions(event);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            queued_ecall_t* call = (queued_ecall_t*)completions[i].context;
+
+            OE_TEST(completions[i].result == OE_OK);
+            OE_TEST(completions[i].output_bytes_written == sizeof(call->out));
+            OE_TEST(call->out._result == OE_OK);
+            OE_TEST(call->out._retval == call->in.a + 1);
+        }
+
+        num_completed += count;
+    }
+
+    end = get_relative_time_in_microseconds();
+
+    printf(
+        "%d queued ecalls on %zu threads took %d msecs.\n",
+        NUM_QUEUED_ECALLS,
+        num_threads,
+        (int)((end - start) / 1000.0));
+
+    OE_TEST(oe_delete_ecall_queue(queue) == OE_OK);
+    free(calls);
+}
+
+typedef struct _ecall_queue_poller
+{
+    oe_thread_t thread;
+    oe_ecall_queue_t* queue;
+    queued_ecall_t* calls;
+    size_t num_calls;
+    volatile uint64_t* num_completed;
+} ecall_queue_poller_t;
+
+void* poll_ecall_queue_thread(void* arg)
+{
+    ecall_queue_poller_t* poller = (ecall_queue_poller_t*)arg;
+    oe_ecall_completion_t completions[2];
+    size_t num_submitted = 0;
+    const uint64_t total = (uint64_t)NUM_QUEUED_ECALLS;
+
+    // Each poller submits its own ecalls, but polls the completions of any
+    // of them, until all the ecalls of all the pollers completed.
+    while (oe_atomic_load(poller->num_completed) < total)
+    {
+        size_t count = OE_COUNTOF(completions);
+
+        while (num_submitted < poller->num_calls)
+        {
+            queued_ecall_t* call = &poller->calls[num_submitted];
+            oe_result_t result;
+
+            call->in.a = num_submitted;
+            call->in.b = 1;
+            result = oe_submit_ecall(
+                poller->queue,
+                switchless_test_fcn_id_enc_add,
+                &call->in,
+                sizeof(call->in),
+                &call->out,
+                sizeof(call->out),
+                call);
+            if (result == OE_BUSY)
+                break;
+
+            OE_TEST(result == OE_OK);
+            num_submitted++;
+        }
+
+        OE_TEST(
+            oe_poll_ecall_completions(poller->queue, completions, &count) ==
+            OE_OK);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            queued_ecall_t* call = (queued_ecall_t*)completions[i].context;
+
+            OE_TEST(completions[i].result == OE_OK);
+            OE_TEST(call->out._retval == call->in.a + 1);
+            oe_atomic_increment(poller->num_completed);
+        }
+    }
+
+    return NULL;
+}
+
+// Several threads submit and poll the same small queue, so that the slots of
+// the rings are reused while other threads still hold the ones they claimed.
+// A completion that is lost keeps the pollers waiting forever.
+void test_ecall_queue_pollers(oe_enclave_t* enclave, size_t num_threads)
+{
+    ecall_queue_poller_t pollers[NUM_ECALL_QUEUE_POLLERS];
+    oe_ecall_queue_t* queue = NULL;
+    queued_ecall_t* calls = NULL;
+    volatile uint64_t num_completed = 0;
+    const size_t num_calls = NUM_QUEUED_ECALLS / NUM_ECALL_QUEUE_POLLERS;
+
+    OE_STATIC_ASSERT(NUM_QUEUED_ECALLS % NUM_ECALL_QUEUE_POLLERS == 0);
+
+    calls = (queued_ecall_t*)calloc(NUM_QUEUED_ECALLS, sizeof(*calls));
+    OE_TEST(calls != NULL);
+
+    OE_TEST(
+        oe_create_ecall_queue(
+            enclave, num_threads, POLLED_ECALL_QUEUE_CAPACITY, &queue) ==
+        OE_OK);
+
+    for (size_t i = 0; i < NUM_ECALL_QUEUE_POLLERS; i++)
+    {
+        pollers[i].queue = queue;
+        pollers[i].calls = &calls[i * num_calls];
+        pollers[i].num_calls = num_calls;
+        pollers[i].num_completed = &num_completed;
+        OE_TEST(
+            oe_thread_create(
+                &pollers[i].thread, poll_ecall_queue_thread, &pollers[i]) ==
+            0);
+    }
+
+    for (size_t i = 0; i < NUM_ECALL_QUEUE_POLLERS; i++)
+        OE_TEST(oe_thread_join(pollers[i].thread) == 0);
+
+    OE_TEST(num_completed == NUM_QUEUED_ECALLS);
+
+    printf(
+        "%d queued ecalls polled by %d threads completed.\n",
+        NUM_QUEUED_ECALLS,
+        NUM_ECALL_QUEUE_POLLERS);
+
+    OE_TEST(oe_delete_ecall_queue(queue) == OE_OK);
+    free(calls);
+}
+
+double make_batched_ecalls(
+    oe_enclave_t* enclave,
+    queued_ecall_t* calls,
+    oe_enclave_function_call_t* batch,
+    size_t batch_size)
+{
+    double start, end;
+
+    for (size_t i = 0; i < NUM_BATCHED_ECALLS; i++)
+    {
+        memset(&calls[i].out, 0, sizeof(calls[i].out));
+        batch[i].function_id = switchless_test_fcn_id_enc_add;
+        batch[i].input_buffer = &calls[i].in;
+        batch[i].input_buffer_size = sizeof(calls[i].in);
+        batch[i].output_buffer = &calls[i].out;
+        batch[i].output_buffer_size = sizeof(calls[i].out);
+        batch[i].output_bytes_written = 0;
+        batch[i].result = OE_UNEXPECTED;
+    }
+
+    // A call to a function that does not exist fails on its own.
+    batch[1].function_id = OE_UINT32_MAX;
+
+    start = get_relative_time_in_microseconds();
+    OE_TEST(
+        oe_call_enclave_functions(
+            enclave, batch, NUM_BATCHED_ECALLS, batch_size) == OE_OK);
+    end = get_relative_time_in_microseconds();
+
+    for (size_t i = 0; i < NUM_BATCHED_ECALLS; i++)
+    {
+        if (i == 1)
+        {
+            OE_TEST(batch[i].result == OE_NOT_FOUND);
+            OE_TEST(batch[i].output_bytes_written == 0);
+            continue;
+        }
+
+        OE_TEST(batch[i].result == OE_OK);
+        OE_TEST(batch[i].output_bytes_written == sizeof(calls[i].out));
+        OE_TEST(calls[i].out._result == OE_OK);
+        OE_TEST(calls[i].out._retval == calls[i].in.a + 1);
+    }
+
+    printf(
+        "%d ecalls in batches of %zu took %d msecs.\n",
+        NUM_BATCHED_ECALLS,
+        batch_size,
+        (int)((end - start) / 1000.0));
+
+    return end - start;
+}
+
+void test_ecall_batches(oe_enclave_t* enclave)
+{
+    queued_ecall_t* calls = NULL;
+    oe_enclave_function_call_t* batch = NULL;
+    double single_microseconds, batched_microseconds;
+
+    calls = (queued_ecall_t*)calloc(NUM_BATCHED_ECALLS, sizeof(*calls));
+    OE_TEST(calls != NULL);
+    batch = (oe_enclave_function_call_t*)calloc(
+        NUM_BATCHED_ECALLS, sizeof(*batch));
+    OE_TEST(batch != NULL);
+
+    for (size_t i = 0; i < NUM_BATCHED_ECALLS; i++)
+    {
+        calls[i].in.a = i;
+        calls[i].in.b = 1;
+    }
+
+    single_microseconds = make_batched_ecalls(enclave, calls, batch, 1);
+    batched_microseconds =
+        make_batched_ecalls(enclave, calls, batch, ECALL_BATCH_SIZE);
+
+    printf(
+        "Batched ecalls speedup factor : %.2f\n",
+        single_microseconds / batched_microseconds);
+
+    free(batch);
+    free(calls);
+}
+
+typedef struct _consume_ecall
+{
+    enc_consume_switchless_args_t in;
+    enc_consume_switchless_args_t out;
+} consume_ecall_t;
+
+// Make a single batch of calls that each allocate an OCALL buffer from the
+// shared memory arena. The arena is reset after each call of the batch, so it
+// never holds more than the buffer of one call.
+void test_long_ecall_batch(oe_enclave_t* enclave)
+{
+    consume_ecall_t* calls = NULL;
+    oe_enclave_function_call_t* batch = NULL;
+    oe_arena_statistics_t statistics[NUM_TCS];
+    size_t count = OE_COUNTOF(statistics);
+
+    calls = (consume_ecall_t*)calloc(NUM_LONG_BATCH_ECALLS, sizeof(*calls));
+    OE_TEST(calls != NULL);
+    batch = (oe_enclave_function_call_t*)calloc(
+        NUM_LONG_BATCH_ECALLS, sizeof(*batch));
+    OE_TEST(batch != NULL);
+
+    for (size_t i = 0; i < NUM_LONG_BATCH_ECALLS; i++)
+    {
+        calls[i].in.size = ARENA_TEST_BUFFER_SIZE;
+        batch[i].function_id = switchless_test_fcn_id_enc_consume_switchless;
+        batch[i].input_buffer = &calls[i].in;
+        batch[i].input_buffer_size = sizeof(calls[i].in);
+        batch[i].output_buffer = &calls[i].out;
+        batch[i].output_buffer_size = sizeof(calls[i].out);
+        batch[i].result = OE_UNEXPECTED;
+    }
+
+    OE_TEST(
+        oe_call_enclave_functions(
+            enclave,
+            batch,
+            NUM_LONG_BATCH_ECALLS,
+            NUM_LONG_BATCH_ECALLS) == OE_OK);
+
+    for (size_t i = 0; i < NUM_LONG_BATCH_ECALLS; i++)
+    {
+        OE_TEST(batch[i].result == OE_OK);
+        OE_TEST(calls[i].out._result == OE_OK);
+        OE_TEST(calls[i].out._retval == ARENA_TEST_BUFFER_SIZE);
+    }
+
+    OE_TEST(oe_sgx_get_arena_statistics(enclave, statistics, &count) == OE_OK);
+
+    for (size_t i = 0; i < count; i++)
+        OE_TEST(statistics[i].high_water_mark < 2 * ARENA_TEST_BUFFER_SIZE);
+
+    printf(
+        "%d ecalls making switchless ocalls of %d bytes in a single batch.\n",
+        NUM_LONG_BATCH_ECALLS,
+        ARENA_TEST_BUFFER_SIZE);
+
+    free(batch);
+    free(calls);
+}
+
+void test_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_worker_type_t type,
+    uint64_t num_calls)
+{
+    oe_switchless_worker_statistics_t statistics[NUM_TCS];
+    size_t count = 0;
+    uint64_t total_calls = 0;
+
+    OE_TEST(
+        oe_get_switchless_worker_statistics(enclave, type, NULL, &count) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(count > 0 && count <= NUM_TCS);
+
+    OE_TEST(
+        oe_get_switchless_worker_statistics(
+            enclave, type, statistics, &count) == OE_OK);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        printf(
+            "Switchless worker %zu: calls=%" PRIu64 " spins=%" PRIu64
+            " sleeps=%" PRIu64 " wakeups=%" PRIu64
+            " spin_count_threshold=%" PRIu64 "\n",
+            i,
+            statistics[i].calls,
+            statistics[i].spins,
+            statistics[i].sleeps,
+            statistics[i].wakeups,
+            statistics[i].spin_count_threshold);
+        total_calls += statistics[i].calls;
+    }
+
+    // Switchless ocalls never fall back to regular ocalls. Switchless ecalls
+    // do when all the enclave workers are busy.
+    if (type == OE_SWITCHLESS_WORKER_HOST)
+        OE_TEST(total_calls == num_calls);
+    else
+        OE_TEST(total_calls <= num_calls);
+}
+
+void test_arena_chunks(oe_enclave_t* enclave)
+{
+    oe_arena_statistics_t statistics[NUM_TCS];
+    size_t count = 0;
+    bool found = false;
+    int return_val = -1;
+
+    OE_TEST(enc_test_arena_chunks(enclave, &return_val) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    OE_TEST(
+        oe_sgx_get_arena_statistics(enclave, NULL, &count) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(count > 0 && count <= NUM_TCS);
+    OE_TEST(oe_sgx_get_arena_statistics(enclave, statistics, &count) == OE_OK);
+
+    // The thread that chained a chunk released its arena when the ECALL
+    // returned, but kept its counters.
+    for (size_t i = 0; i < count; i++)
+    {
+        if (statistics[i].chunks_allocated == 0)
+            continue;
+
+        OE_TEST(statistics[i].capacity == 0);
+        OE_TEST(statistics[i].high_water_mark >= ARENA_TEST_BUFFER_SIZE);
+        OE_TEST(
+            statistics[i].chunks_released == statistics[i].chunks_allocated);
+        found = true;
+    }
+
+    OE_TEST(found);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave = NULL;
@@ -450,9 +894,28 @@ int main(int argc, const char* argv[])
         oe_put_err("oe_create_enclave(): result=%u", result);
 
     if (test_ecalls)
+    {
         test_switchless_ecalls(enclave, num_host_threads);
+        test_switchless_statistics(
+            enclave,
+            OE_SWITCHLESS_WORKER_ENCLAVE,
+            (uint64_t)NUM_ECALLS * num_host_threads);
+    }
     else
+    {
         test_switchless_ocalls(enclave, num_enclave_threads);
+        test_switchless_statistics(
+            enclave,
+            OE_SWITCHLESS_WORKER_HOST,
+            (uint64_t)NUM_OCALLS * num_enclave_threads);
+        test_arena_chunks(enclave);
+    }
+
+    // The queued ecalls are posted to the enclave workers if there are any.
+    test_ecall_queue(enclave, num_enclave_threads);
+    test_ecall_queue_pollers(enclave, num_enclave_threads);
+    test_ecall_batches(enclave);
+    test_long_ecall_batch(enclave);
 
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
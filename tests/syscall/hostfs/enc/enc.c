@@ -2,12 +2,18 @@
 // Licensed under the MIT License.
 
 #include <assert.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <openenclave/corelibc/errno.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
 #include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mount.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 void test_hostfs(const char* tmp_dir)
 {
@@ -51,6 +57,227 @@ void test_hostfs(const char* tmp_dir)
     }
 }
 
+/* Mount tmp_dir onto itself with the given mount data, or none. */
+static void _mount(
+    const char* tmp_dir,
+    const oe_host_file_system_mount_data_t* data)
+{
+    OE_TEST(oe_load_module_host_file_system() == OE_OK);
+    OE_TEST(mount(tmp_dir, tmp_dir, OE_HOST_FILE_SYSTEM, 0, data) == 0);
+}
+
+static void _make_path(
+    char path[PATH_MAX],
+    const char* tmp_dir,
+    const char* name)
+{
+    OE_TEST(snprintf(path, PATH_MAX, "%s/%s", tmp_dir, name) < PATH_MAX);
+}
+
+void test_hostfs_io_buffers(const char* tmp_dir)
+{
+    /* Buffers smaller than the data to exercise the chunking. */
+    const size_t buffer_size = 5;
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+    oe_host_file_system_mount_data_t data = {.io_buffer_size = buffer_size};
+    char path[PATH_MAX];
+    char buf[sizeof(alphabet)];
+    int fd;
+    int fd2;
+
+    OE_TEST(oe_load_module_host_file_system() == OE_OK);
+
+    /* Invalid pools are rejected. */
+    OE_TEST(mount(tmp_dir, tmp_dir, OE_HOST_FILE_SYSTEM, 0, &data) != 0);
+    OE_TEST(oe_errno == OE_EINVAL);
+    data.io_buffer_count = OE_HOST_FILE_SYSTEM_MAX_IO_BUFFERS + 1;
+    OE_TEST(mount(tmp_dir, tmp_dir, OE_HOST_FILE_SYSTEM, 0, &data) != 0);
+    OE_TEST(oe_errno == OE_EINVAL);
+
+    data.io_buffer_count = 2;
+    _mount(tmp_dir, &data);
+    _make_path(path, tmp_dir, "io_buffers");
+
+    OE_TEST((fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0666)) >= 0);
+    OE_TEST(write(fd, alphabet, sizeof(alphabet)) == sizeof(alphabet));
+    OE_TEST(close(fd) == 0);
+
+    /* Read with two descriptors at once, then past the end of the file. */
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+    OE_TEST((fd2 = dup(fd)) >= 0);
+    OE_TEST(read(fd, buf, 3) == 3);
+    OE_TEST(read(fd2, buf + 3, sizeof(buf) - 3) == sizeof(buf) - 3);
+    OE_TEST(memcmp(alphabet, buf, sizeof(alphabet)) == 0);
+    OE_TEST(read(fd, buf, sizeof(buf)) == 0);
+    OE_TEST(close(fd2) == 0);
+
+    /* Files keep the buffers alive after the file system is unmounted. */
+    OE_TEST(umount(tmp_dir) == 0);
+    OE_TEST(lseek(fd, 0, SEEK_SET) == 0);
+    OE_TEST(read(fd, buf, sizeof(buf)) == sizeof(buf));
+    OE_TEST(memcmp(alphabet, buf, sizeof(alphabet)) == 0);
+    OE_TEST(close(fd) == 0);
+
+    printf("=== passed test_hostfs_io_buffers\n");
+}
+
+static void _fill_page(uint8_t* page, size_t index)
+{
+    for (size_t i = 0; i < OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE; i++)
+        page[i] = (uint8_t)(index + i);
+}
+
+void test_hostfs_cache(const char* tmp_dir)
+{
+    const size_t page_size = OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE;
+    const size_t num_pages = 12;
+    oe_host_file_system_mount_data_t data = {
+        .cache_page_count = 8,
+        .cache_read_ahead_pages = 5,
+    };
+    oe_host_file_system_cache_statistics_t stats;
+    uint8_t expected[OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE];
+    uint8_t buf[OE_HOST_FILE_SYSTEM_CACHE_PAGE_SIZE];
+    char path[PATH_MAX];
+    struct stat st;
+    int fd;
+    int fd2;
+
+    OE_TEST(oe_load_module_host_file_system() == OE_OK);
+
+    /* The read-ahead window cannot exceed half the cache. */
+    OE_TEST(mount(tmp_dir, tmp_dir, OE_HOST_FILE_SYSTEM, 0, &data) != 0);
+    OE_TEST(oe_errno == OE_EINVAL);
+    data.cache_read_ahead_pages = 4;
+
+    _mount(tmp_dir, &data);
+    _make_path(path, tmp_dir, "cache");
+
+    /* Write more pages than the cache holds: the oldest ones are evicted and
+     * written back, the others stay dirty but are visible to stat(). */
+    OE_TEST((fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0666)) >= 0);
+    for (size_t i = 0; i < num_pages; i++)
+    {
+        _fill_page(buf, i);
+        OE_TEST(write(fd, buf, page_size) == (ssize_t)page_size);
+    }
+
+    OE_TEST(stat(path, &st) == 0);
+    OE_TEST(st.st_size == (off_t)(num_pages * page_size));
+    OE_TEST(oe_host_file_system_get_cache_statistics(path, &stats) == 0);
+    OE_TEST(stats.evictions > 0 && stats.write_backs > 0);
+
+    /* A second open file sees the writes that are not written back yet. */
+    OE_TEST((fd2 = open(path, O_RDONLY)) >= 0);
+    OE_TEST(pread(fd2, buf, page_size, (num_pages - 1) * page_size) ==
+            (ssize_t)page_size);
+    _fill_page(expected, num_pages - 1);
+    OE_TEST(memcmp(buf, expected, page_size) == 0);
+
+    /* Read sequentially from the start, which reads ahead. */
+    for (size_t i = 0; i < num_pages; i++)
+    {
+        _fill_page(expected, i);
+        OE_TEST(read(fd2, buf, page_size) == (ssize_t)page_size);
+        OE_TEST(memcmp(buf, expected, page_size) == 0);
+    }
+    OE_TEST(read(fd2, buf, page_size) == 0);
+    OE_TEST(oe_host_file_system_get_cache_statistics(path, &stats) == 0);
+    OE_TEST(stats.read_ahead_pages > 0 && stats.hits > 0);
+
+    /* Partial writes across a page boundary, and appends. */
+    memset(buf, 'x', 10);
+    OE_TEST(pwrite(fd, buf, 10, page_size - 5) == 10);
+    OE_TEST(pread(fd2, expected, 10, page_size - 5) == 10);
+    OE_TEST(memcmp(buf, expected, 10) == 0);
+    OE_TEST((fcntl(fd, F_GETFL) & O_ACCMODE) == O_WRONLY);
+    OE_TEST(fcntl(fd, F_SETFL, O_APPEND) == 0);
+    OE_TEST((fcntl(fd, F_GETFL) & O_APPEND) != 0);
+    OE_TEST(lseek(fd, 0, SEEK_SET) == 0);
+    OE_TEST(write(fd, "end", 3) == 3);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == (off_t)(num_pages * page_size + 3));
+
+    /* fsync() writes back every dirty page. */
+    OE_TEST(oe_host_file_system_get_cache_statistics(path, &stats) == 0);
+    OE_TEST(fsync(fd) == 0);
+    {
+        oe_host_file_system_cache_statistics_t after;
+
+        OE_TEST(oe_host_file_system_get_cache_statistics(path, &after) == 0);
+        OE_TEST(after.write_backs > stats.write_backs);
+    }
+
+    /* Truncation drops the cached pages past the new end. */
+    OE_TEST(truncate(path, 100) == 0);
+    OE_TEST(stat(path, &st) == 0);
+    OE_TEST(st.st_size == 100);
+    OE_TEST(pread(fd2, buf, page_size, 0) == 100);
+
+    /* Writes are written back by the last close. */
+    OE_TEST(pwrite(fd, "abc", 3, 200) == 3);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(close(fd2) == 0);
+    OE_TEST(umount(tmp_dir) == 0);
+
+    _mount(tmp_dir, NULL);
+    OE_TEST(oe_host_file_system_get_cache_statistics(path, &stats) == -1);
+    OE_TEST(oe_errno == OE_EINVAL);
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+    OE_TEST(read(fd, buf, page_size) == 203);
+    OE_TEST(memcmp(buf + 200, "abc", 3) == 0);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(unlink(path) == 0);
+    OE_TEST(umount(tmp_dir) == 0);
+
+    printf("=== passed test_hostfs_cache\n");
+}
+
+void test_hostfs_throughput(
+    const char* tmp_dir,
+    bool use_io_buffers,
+    bool use_cache,
+    size_t total_size,
+    size_t record_size)
+{
+    oe_host_file_system_mount_data_t data = {0};
+    char path[PATH_MAX];
+    uint8_t* record;
+    int fd;
+
+    OE_TEST((record = malloc(record_size)) != NULL);
+    memset(record, 0xab, record_size);
+
+    if (use_io_buffers)
+    {
+        data.io_buffer_count = 2;
+        data.io_buffer_size = record_size;
+    }
+
+    if (use_cache)
+    {
+        data.cache_page_count = 1024;
+        data.cache_read_ahead_pages = 64;
+    }
+
+    _mount(tmp_dir, (use_io_buffers || use_cache) ? &data : NULL);
+    _make_path(path, tmp_dir, "throughput");
+
+    OE_TEST((fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0666)) >= 0);
+    for (size_t n = 0; n < total_size; n += record_size)
+        OE_TEST(write(fd, record, record_size) == (ssize_t)record_size);
+    OE_TEST(close(fd) == 0);
+
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+    for (size_t n = 0; n < total_size; n += record_size)
+        OE_TEST(read(fd, record, record_size) == (ssize_t)record_size);
+    OE_TEST(close(fd) == 0);
+
+    OE_TEST(unlink(path) == 0);
+    OE_TEST(umount(tmp_dir) == 0);
+
+    free(record);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -8,8 +8,48 @@
 #include <openenclave/internal/syscall/host.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
+#include <time.h>
 #include "test_hostfs_u.h"
 
+#define THROUGHPUT_TOTAL_SIZE (16 * 1024 * 1024)
+#define THROUGHPUT_RECORD_SIZE (64 * 1024)
+
+/* Write and read back a file through the regular OCALL path, through the
+ * registered I/O buffers and through the page cache, and report the
+ * throughput of each. */
+static void _test_hostfs_throughput(oe_enclave_t* enclave, const char* tmp_dir)
+{
+    static const char* _modes[] = {"ocall buffer", "I/O buffers", "page cache"};
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        struct timespec start;
+        struct timespec end;
+        double seconds;
+
+        OE_TEST(timespec_get(&start, TIME_UTC) == TIME_UTC);
+        OE_TEST(
+            test_hostfs_throughput(
+                enclave,
+                tmp_dir,
+                mode == 1,
+                mode == 2,
+                THROUGHPUT_TOTAL_SIZE,
+                THROUGHPUT_RECORD_SIZE) == OE_OK);
+        OE_TEST(timespec_get(&end, TIME_UTC) == TIME_UTC);
+
+        seconds = (double)(end.tv_sec - start.tv_sec) +
+                  (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf(
+            "hostfs %s: %.1f MB/s (%d MB written and read in %d KB records)\n",
+            _modes[mode],
+            2.0 * THROUGHPUT_TOTAL_SIZE / (1024 * 1024) / seconds,
+            THROUGHPUT_TOTAL_SIZE / (1024 * 1024),
+            THROUGHPUT_RECORD_SIZE / 1024);
+    }
+}
+
 void test_hostfs_posix(const char* enclave_path, const char* tmp_dir)
 {
     oe_result_t r;
@@ -24,6 +64,14 @@ void test_hostfs_posix(const char* enclave_path, const char* tmp_dir)
     r = test_hostfs(enclave, tmp_dir);
     OE_TEST(r == OE_OK);
 
+    r = test_hostfs_io_buffers(enclave, tmp_dir);
+    OE_TEST(r == OE_OK);
+
+    r = test_hostfs_cache(enclave, tmp_dir);
+    OE_TEST(r == OE_OK);
+
+    _test_hostfs_throughput(enclave, tmp_dir);
+
     r = oe_terminate_enclave(enclave);
     OE_TEST(r == OE_OK);
 
@@ -0,0 +1,230 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <fcntl.h>
+#include <limits.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/iov.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "test_iov_t.h"
+
+static oe_host_fd_t _get_host_fd(int fd)
+{
+    oe_fd_t* desc;
+
+    OE_TEST((desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)) != NULL);
+    return desc->ops.fd.get_host_fd(desc);
+}
+
+/* The vectored I/O path used before the IO vector was laid out in host
+ * memory: flatten it into enclave heap memory and copy it through the
+ * ocall buffer. */
+static ssize_t _packed_readv(
+    int fd,
+    bool use_socket,
+    const struct iovec* iov,
+    int iovcnt)
+{
+    const struct oe_iovec* oe_iov = (const struct oe_iovec*)iov;
+    void* buf = NULL;
+    size_t buf_size = 0;
+    ssize_t ret = -1;
+    oe_result_t result;
+
+    OE_TEST(oe_iov_pack(oe_iov, iovcnt, &buf, &buf_size) == 0);
+
+    if (use_socket)
+        result = oe_syscall_recvv_ocall(
+            &ret, _get_host_fd(fd), buf, iovcnt, buf_size);
+    else
+        result = oe_syscall_readv_ocall(
+            &ret, _get_host_fd(fd), buf, iovcnt, buf_size);
+
+    OE_TEST(result == OE_OK);
+
+    if (ret > 0)
+        OE_TEST(oe_iov_sync(oe_iov, iovcnt, buf, buf_size) == 0);
+
+    free(buf);
+    return ret;
+}
+
+static ssize_t _packed_writev(
+    int fd,
+    bool use_socket,
+    const struct iovec* iov,
+    int iovcnt)
+{
+    void* buf = NULL;
+    size_t buf_size = 0;
+    ssize_t ret = -1;
+    oe_result_t result;
+
+    OE_TEST(
+        oe_iov_pack(
+            (const struct oe_iovec*)iov, iovcnt, &buf, &buf_size) == 0);
+
+    if (use_socket)
+        result = oe_syscall_sendv_ocall(
+            &ret, _get_host_fd(fd), buf, iovcnt, buf_size);
+    else
+        result = oe_syscall_writev_ocall(
+            &ret, _get_host_fd(fd), buf, iovcnt, buf_size);
+
+    OE_TEST(result == OE_OK);
+
+    free(buf);
+    return ret;
+}
+
+static struct iovec* _new_iov(size_t iovcnt, size_t iov_len)
+{
+    struct iovec* iov;
+
+    OE_TEST((iov = calloc(iovcnt, sizeof(struct iovec))) != NULL);
+
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        OE_TEST((iov[i].iov_base = malloc(iov_len)) != NULL);
+        iov[i].iov_len = iov_len;
+    }
+
+    return iov;
+}
+
+static void _free_iov(struct iovec* iov, size_t iovcnt)
+{
+    for (size_t i = 0; i < iovcnt; i++)
+        free(iov[i].iov_base);
+
+    free(iov);
+}
+
+/* Set rest to the part of the IO vector that follows its first nread
+ * bytes and return its number of elements. */
+static int _get_remainder(
+    struct iovec* rest,
+    const struct iovec* iov,
+    size_t iovcnt,
+    size_t iov_len,
+    size_t nread)
+{
+    size_t count = 0;
+
+    for (size_t i = nread / iov_len; i < iovcnt; i++)
+        rest[count++] = iov[i];
+
+    rest[0].iov_base = (uint8_t*)rest[0].iov_base + nread % iov_len;
+    rest[0].iov_len -= nread % iov_len;
+
+    return (int)count;
+}
+
+/* Write then read back iovcnt buffers of iov_len bytes iterations times,
+ * through a host file or a socket pair. */
+void test_iov(
+    const char* tmp_dir,
+    bool use_socket,
+    bool packed,
+    size_t iovcnt,
+    size_t iov_len,
+    size_t iterations)
+{
+    const size_t total = iovcnt * iov_len;
+    struct iovec* out = _new_iov(iovcnt, iov_len);
+    struct iovec* in = _new_iov(iovcnt, iov_len);
+    struct iovec* rest;
+    char path[PATH_MAX];
+    int fds[2] = {-1, -1};
+
+    OE_TEST((rest = calloc(iovcnt, sizeof(struct iovec))) != NULL);
+
+    for (size_t i = 0; i < iovcnt; i++)
+        memset(out[i].iov_base, (int)('a' + i % 26), iov_len);
+
+    if (use_socket)
+    {
+        OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+        OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    }
+    else
+    {
+        OE_TEST(oe_load_module_host_file_system() == OE_OK);
+        OE_TEST(mount("/", "/", OE_HOST_FILE_SYSTEM, 0, NULL) == 0);
+        OE_TEST(snprintf(path, sizeof(path), "%s/iov", tmp_dir) < PATH_MAX);
+        OE_TEST((fds[0] = open(path, O_CREAT | O_TRUNC | O_RDWR, 0666)) >= 0);
+        fds[1] = fds[0];
+    }
+
+    for (size_t n = 0; n < iterations; n++)
+    {
+        ssize_t written;
+        size_t nread = 0;
+
+        if (!use_socket)
+            OE_TEST(lseek(fds[0], 0, SEEK_SET) == 0);
+
+        if (packed)
+            written = _packed_writev(fds[0], use_socket, out, (int)iovcnt);
+        else
+            written = writev(fds[0], out, (int)iovcnt);
+
+        OE_TEST(written == (ssize_t)total);
+
+        if (!use_socket)
+            OE_TEST(lseek(fds[1], 0, SEEK_SET) == 0);
+
+        /* A socket may return the data in several parts. */
+        while (nread < total)
+        {
+            int count = _get_remainder(rest, in, iovcnt, iov_len, nread);
+            ssize_t r;
+
+            if (packed)
+                r = _packed_readv(fds[1], use_socket, rest, count);
+            else
+                r = readv(fds[1], rest, count);
+
+            OE_TEST(r > 0);
+            nread += (size_t)r;
+        }
+
+        if (n == 0)
+        {
+            for (size_t i = 0; i < iovcnt; i++)
+                OE_TEST(memcmp(in[i].iov_base, out[i].iov_base, iov_len) == 0);
+        }
+    }
+
+    OE_TEST(close(fds[0]) == 0);
+
+    if (use_socket)
+    {
+        OE_TEST(close(fds[1]) == 0);
+    }
+    else
+    {
+        OE_TEST(unlink(path) == 0);
+        OE_TEST(umount("/") == 0);
+    }
+
+    _free_iov(out, iovcnt);
+    _free_iov(in, iovcnt);
+    free(rest);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    1024, /* NumStackPages */
+    1);   /* NumTCS */
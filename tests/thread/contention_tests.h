@@ -0,0 +1,19 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _contention_tests_h
+#define _contention_tests_h
+
+#include <openenclave/bits/types.h>
+
+// Number of lock acquisitions made by each thread.
+const size_t CONTENTION_TEST_ITERS = 20000;
+
+// Every CONTENTION_TEST_WRITE_INTERVAL-th acquisition of the readers-writer
+// lock is a write.
+const size_t CONTENTION_TEST_WRITE_INTERVAL = 10;
+
+// Maximum number of threads contending for a lock.
+const size_t MAX_CONTENTION_TEST_THREADS = 8;
+
+#endif /* _contention_tests_h */
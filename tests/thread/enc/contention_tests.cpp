@@ -0,0 +1,76 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifdef _PTHREAD_ENC_
+#include "thread.h"
+#endif
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/types.h>
+#include "../contention_tests.h"
+#include "thread_t.h"
+
+static oe_mutex_t contention_mutex = OE_MUTEX_INITIALIZER;
+static oe_rwlock_t contention_rw_lock = OE_RWLOCK_INITIALIZER;
+
+// Protected by the lock being benchmarked.
+static size_t g_contention_counter = 0;
+
+// Simulate a little work, inside or outside of a critical section.
+static size_t _work(size_t seed)
+{
+    volatile size_t x = seed;
+
+    for (size_t i = 0; i < 32; i++)
+        x = x * 31 + i;
+
+    return x;
+}
+
+void enc_mutex_contention(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+    {
+        oe_mutex_lock(&contention_mutex);
+        g_contention_counter++;
+        _work(g_contention_counter);
+        oe_mutex_unlock(&contention_mutex);
+
+        _work(i);
+    }
+}
+
+void enc_rwlock_contention(size_t iterations, size_t write_interval)
+{
+    for (size_t i = 0; i < iterations; i++)
+    {
+        if (i % write_interval == 0)
+        {
+            oe_rwlock_wrlock(&contention_rw_lock);
+            g_contention_counter++;
+            _work(g_contention_counter);
+        }
+        else
+        {
+            oe_rwlock_rdlock(&contention_rw_lock);
+            _work(g_contention_counter);
+        }
+
+        oe_rwlock_unlock(&contention_rw_lock);
+
+        _work(i);
+    }
+}
+
+size_t enc_get_and_reset_contention_counter()
+{
+    size_t counter;
+
+    oe_mutex_lock(&contention_mutex);
+    counter = g_contention_counter;
+    g_contention_counter = 0;
+    oe_mutex_unlock(&contention_mutex);
+
+    return counter;
+}
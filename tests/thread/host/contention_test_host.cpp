@@ -0,0 +1,81 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "../contention_tests.h"
+#include "thread_u.h"
+
+static void _mutex_contention_thread(oe_enclave_t* enclave)
+{
+    OE_TEST(enc_mutex_contention(enclave, CONTENTION_TEST_ITERS) == OE_OK);
+}
+
+static void _rwlock_contention_thread(oe_enclave_t* enclave)
+{
+    OE_TEST(
+        enc_rwlock_contention(
+            enclave, CONTENTION_TEST_ITERS, CONTENTION_TEST_WRITE_INTERVAL) ==
+        OE_OK);
+}
+
+// Run num_threads threads that acquire the same lock and report the number
+// of acquisitions per second.
+static void _run_contention(
+    oe_enclave_t* enclave,
+    bool rwlock,
+    size_t num_threads)
+{
+    std::thread threads[MAX_CONTENTION_TEST_THREADS];
+    size_t counter = 0;
+    size_t expected;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        if (rwlock)
+            threads[i] = std::thread(_rwlock_contention_thread, enclave);
+        else
+            threads[i] = std::thread(_mutex_contention_thread, enclave);
+    }
+
+    for (size_t i = 0; i < num_threads; i++)
+        threads[i].join();
+
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+
+    OE_TEST(enc_get_and_reset_contention_counter(enclave, &counter) == OE_OK);
+
+    // Every write must have been made under the lock.
+    if (rwlock)
+        expected = num_threads *
+                   ((CONTENTION_TEST_ITERS + CONTENTION_TEST_WRITE_INTERVAL -
+                     1) /
+                    CONTENTION_TEST_WRITE_INTERVAL);
+    else
+        expected = num_threads * CONTENTION_TEST_ITERS;
+
+    OE_TEST(counter == expected);
+
+    printf(
+        "%s contention, %zu threads: %.0f acquisitions/s\n",
+        rwlock ? "rwlock" : "mutex",
+        num_threads,
+        (double)(num_threads * CONTENTION_TEST_ITERS) / seconds.count());
+}
+
+// Benchmark mutexes and readers-writer locks under increasing contention.
+void test_lock_contention(oe_enclave_t* enclave)
+{
+    for (size_t n = 1; n <= MAX_CONTENTION_TEST_THREADS; n *= 2)
+    {
+        _run_contention(enclave, false, n);
+        _run_contention(enclave, true, n);
+    }
+}
@@ -211,6 +211,7 @@ void test_thread_locking_patterns(oe_enclave_t* enclave)
 }
 
 void test_readers_writer_lock(oe_enclave_t* enclave);
+void test_lock_contention(oe_enclave_t* enclave);
 void test_errno_multi_threads_sameenclave(oe_enclave_t* enclave);
 void test_errno_multi_threads_diffenclave(
     oe_enclave_t* enclave1,
@@ -337,6 +338,8 @@ int main(int argc, const char* argv[])
 
     test_readers_writer_lock(enclave);
 
+    test_lock_contention(enclave);
+
     test_tcs_exhaustion(enclave);
 
     /*